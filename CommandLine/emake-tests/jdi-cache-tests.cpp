@@ -0,0 +1,201 @@
+#include "languages/jdi_cache.h"
+#include <gtest/gtest.h>
+
+#include <API/jdi.h>
+#include <Storage/definition.h>
+#include <System/builtins.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kHeader[] = R"cpp(
+#define CACHE_TEST_LIMIT 64
+#define CACHE_TEST_TWICE(x) ((x) * 2)
+
+typedef unsigned long cache_size_t;
+
+namespace cache_test {
+  enum shape { circle, square = 4, triangle };
+
+  struct base {
+    int id;
+    virtual ~base();
+  };
+
+  class widget: public base {
+   public:
+    double width, height;
+    static const int limit = 16;
+    int area() const;
+    void resize(double w);
+    void resize(double w, double h);
+  };
+
+  int count_widgets(const widget *first, cache_size_t n);
+  extern widget *default_widget;
+
+  template<class T> struct box { T value; };
+  template<> struct box<int> { long wide; };
+  typedef box<char> char_box;
+  typedef box<int> int_box;
+}
+
+using namespace cache_test;
+)cpp";
+
+// Writes every definition under the scope, with its flags and type, so that
+// two contexts can be compared as text.
+void Dump(const jdi::definition_scope *scope, std::ostream &out, int depth = 0) {
+  for (const auto &member : scope->members) {
+    const jdi::definition *d = member.second;
+    out << std::string(depth, ' ') << member.first << ' ' << d->flags;
+    if (d->flags & jdi::DEF_TYPED) out << ' ' << d->toString();
+    if (d->flags & jdi::DEF_FUNCTION)
+      out << " overloads " << static_cast<const jdi::definition_function*>(d)->overloads.size();
+    out << '\n';
+    if (d->parent == scope && (d->flags & jdi::DEF_SCOPE))
+      Dump(static_cast<const jdi::definition_scope*>(d), out, depth + 1);
+  }
+}
+
+std::string Dump(jdi::context *ctx) {
+  std::ostringstream out;
+  Dump(ctx->get_global(), out);
+  return out.str();
+}
+
+class JdiCacheTest : public ::testing::Test {
+ protected:
+  fs::path dir, header, cache;
+  jdi::context *parsed = nullptr;
+
+  static void SetUpTestSuite() {
+    if (!jdi::builtin) jdi::initialize();
+  }
+
+  void SetUp() override {
+    dir = fs::temp_directory_path() / ("jdi-cache-test-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    fs::create_directories(dir);
+    header = dir / "cache_test.h";
+    cache = dir / "jdi_cache.dat";
+    std::ofstream(header) << kHeader;
+
+    parsed = new jdi::context();
+    llreader f(header.u8string().c_str());
+    std::set<std::string> sources;
+    ASSERT_EQ(parse_C_stream_sources(parsed, f, "cache_test.h", &sources), 0);
+    sources.insert(header.u8string());
+    save_jdi_cache(cache, *parsed, sources);
+  }
+
+  void TearDown() override {
+    delete parsed;
+    fs::remove_all(dir);
+  }
+};
+
+}  // namespace
+
+TEST_F(JdiCacheTest, LoadMatchesParse) {
+  jdi::context loaded;
+  ASSERT_TRUE(load_jdi_cache(cache, &loaded));
+  const std::string expected = Dump(parsed);
+  ASSERT_NE(expected.find("resize"), std::string::npos);
+  EXPECT_EQ(Dump(&loaded), expected);
+  EXPECT_EQ(loaded.get_macros().size(), parsed->get_macros().size());
+}
+
+TEST_F(JdiCacheTest, LoadedDefinitionsResolve) {
+  jdi::context loaded;
+  ASSERT_TRUE(load_jdi_cache(cache, &loaded));
+
+  jdi::definition *ns = loaded.get_global()->look_up("cache_test");
+  ASSERT_NE(ns, nullptr);
+  ASSERT_TRUE(ns->flags & jdi::DEF_NAMESPACE);
+
+  // found through the using directive, as well as by name
+  jdi::definition *widget = loaded.get_global()->look_up("widget");
+  ASSERT_NE(widget, nullptr);
+  EXPECT_EQ(widget, static_cast<jdi::definition_scope*>(ns)->look_up("widget"));
+  ASSERT_TRUE(widget->flags & jdi::DEF_CLASS);
+
+  jdi::definition_class *cls = static_cast<jdi::definition_class*>(widget);
+  ASSERT_EQ(cls->ancestors.size(), 1u);
+  EXPECT_EQ(cls->ancestors[0].def, static_cast<jdi::definition_scope*>(ns)->look_up("base"));
+  EXPECT_NE(cls->look_up("id"), nullptr);
+
+  jdi::definition *resize = cls->look_up("resize");
+  ASSERT_NE(resize, nullptr);
+  ASSERT_TRUE(resize->flags & jdi::DEF_FUNCTION);
+  EXPECT_EQ(static_cast<jdi::definition_function*>(resize)->overloads.size(), 2u);
+
+  EXPECT_TRUE(loaded.get_macros().count("CACHE_TEST_LIMIT"));
+  EXPECT_TRUE(loaded.get_macros().count("CACHE_TEST_TWICE"));
+}
+
+TEST_F(JdiCacheTest, TemplateInstancesResolve) {
+  jdi::context loaded;
+  ASSERT_TRUE(load_jdi_cache(cache, &loaded));
+
+  jdi::definition *box = loaded.get_global()->look_up("box");
+  ASSERT_NE(box, nullptr);
+  ASSERT_TRUE(box->flags & jdi::DEF_TEMPLATE);
+  jdi::definition_template *temp = static_cast<jdi::definition_template*>(box);
+  ASSERT_EQ(temp->specializations.size(), 1u);
+
+  // Both typedefs name a class made from the template, not null.
+  jdi::definition *char_box = loaded.get_global()->look_up("char_box");
+  ASSERT_NE(char_box, nullptr);
+  ASSERT_TRUE(char_box->flags & jdi::DEF_TYPED);
+  jdi::definition *char_type = static_cast<jdi::definition_typed*>(char_box)->type;
+  ASSERT_NE(char_type, nullptr);
+  ASSERT_TRUE(char_type->flags & jdi::DEF_CLASS);
+  EXPECT_EQ(static_cast<jdi::definition_class*>(char_type)->instance_of, temp);
+  EXPECT_NE(static_cast<jdi::definition_scope*>(char_type)->look_up("value"), nullptr);
+
+  jdi::definition *int_box = loaded.get_global()->look_up("int_box");
+  ASSERT_NE(int_box, nullptr);
+  jdi::definition *int_type = static_cast<jdi::definition_typed*>(int_box)->type;
+  ASSERT_NE(int_type, nullptr);
+  ASSERT_TRUE(int_type->flags & jdi::DEF_CLASS);
+  EXPECT_NE(static_cast<jdi::definition_scope*>(int_type)->look_up("wide"), nullptr);
+
+  // Instantiating again finds what was loaded rather than making another.
+  const jdi::error_context errc(jdi::def_error_handler, "cache_test.h", 0, 0);
+  jdi::arg_key key(1);
+  key.put_final_type(0, jdi::full_type(jdi::builtin_type__char));
+  EXPECT_EQ(temp->instantiate(key, errc), char_type);
+  key.put_final_type(0, jdi::full_type(jdi::builtin_type__int));
+  EXPECT_EQ(temp->instantiate(key, errc), int_type);
+}
+
+TEST_F(JdiCacheTest, ChangedSourceIsNotLoaded) {
+  std::ofstream(header, std::ios_base::app) << "int added_later;\n";
+  jdi::context loaded;
+  EXPECT_FALSE(load_jdi_cache(cache, &loaded));
+}
+
+TEST_F(JdiCacheTest, DamagedCacheIsNotLoaded) {
+  std::string data;
+  {
+    std::ifstream in(cache, std::ios_base::binary);
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  ASSERT_GT(data.size(), 16u);
+  data[data.size() - 8] ^= 0x5A;
+  std::ofstream(cache, std::ios_base::binary | std::ios_base::trunc) << data;
+
+  jdi::context loaded;
+  EXPECT_FALSE(load_jdi_cache(cache, &loaded));
+}
+
+TEST_F(JdiCacheTest, MissingCacheIsNotLoaded) {
+  jdi::context loaded;
+  EXPECT_FALSE(load_jdi_cache(dir / "missing.dat", &loaded));
+}
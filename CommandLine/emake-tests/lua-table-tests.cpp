@@ -0,0 +1,76 @@
+#include "Universal_System/lua_table.h"
+#include <gtest/gtest.h>
+
+#include <utility>
+
+namespace {
+
+// Indices this far apart stay in the sparse part.
+const size_t kSparseStride = 100000;
+
+lua_table<int> SparseTable(int entries) {
+  lua_table<int> table;
+  for (int i = 1; i <= entries; ++i) table[i * kSparseStride] = i;
+  return table;
+}
+
+TEST(LuaTableTest, SparseEntriesSurviveMove) {
+  lua_table<int> table = SparseTable(10);
+  lua_table<int> moved(std::move(table));
+  for (int i = 1; i <= 10; ++i) EXPECT_EQ(moved[i * kSparseStride], i);
+}
+
+TEST(LuaTableTest, MovedFromTableIsReusable) {
+  lua_table<int> table = SparseTable(10);
+  lua_table<int> moved(std::move(table));
+
+  const lua_table<int> &read = table;
+  EXPECT_EQ(table.max_index(), 0);
+  EXPECT_EQ(read[3 * kSparseStride], 0);
+
+  table[5 * kSparseStride] = 50;
+  table[7] = 70;
+  EXPECT_EQ(read[5 * kSparseStride], 50);
+  EXPECT_EQ(read[7], 70);
+  EXPECT_EQ(read[3 * kSparseStride], 0);
+}
+
+TEST(LuaTableTest, MoveAssignedFromTableIsReusable) {
+  lua_table<int> table = SparseTable(10), other;
+  other = std::move(table);
+  EXPECT_EQ(other[4 * kSparseStride], 4);
+
+  const lua_table<int> &read = table;
+  EXPECT_EQ(read[4 * kSparseStride], 0);
+  table[4 * kSparseStride] = 40;
+  EXPECT_EQ(read[4 * kSparseStride], 40);
+}
+
+TEST(LuaTableTest, MovedFromHashPartIsEmpty) {
+  lua_hash_part<int> part;
+  for (size_t i = 0; i < 20; ++i) part[i * kSparseStride] = int(i);
+  lua_hash_part<int> moved(std::move(part));
+  EXPECT_EQ(moved.size(), 20u);
+
+  EXPECT_EQ(part.size(), 0u);
+  EXPECT_EQ(part.find(3 * kSparseStride), nullptr);
+  part.erase(3 * kSparseStride);
+  part[3 * kSparseStride] = 33;
+  ASSERT_NE(part.find(3 * kSparseStride), nullptr);
+  EXPECT_EQ(*part.find(3 * kSparseStride), 33);
+
+  lua_hash_part<int> assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.size(), 20u);
+  EXPECT_EQ(moved.find(5 * kSparseStride), nullptr);
+  moved[5 * kSparseStride] = 55;
+  EXPECT_EQ(moved.size(), 1u);
+}
+
+TEST(LuaTableTest, RowsOfMovedTablesStayIntact) {
+  lua_table<lua_table<int>> grid;
+  for (int row = 0; row < 200; ++row) grid[row][row * kSparseStride] = row;
+  for (int row = 0; row < 200; ++row) EXPECT_EQ(grid[row][row * kSparseStride], row);
+}
+
+}  // namespace
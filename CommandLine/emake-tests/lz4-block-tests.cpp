@@ -0,0 +1,103 @@
+#include "lz4/lz4block.h"
+#include <gtest/gtest.h>
+
+#include <zlib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace enigma;
+
+namespace {
+
+std::vector<unsigned char> RoundTrip(const std::vector<unsigned char> &data) {
+  std::vector<unsigned char> packed(lz4::compress_bound(data.size()));
+  packed.resize(lz4::compress(data.data(), data.size(), packed.data()));
+  std::vector<unsigned char> unpacked(data.size());
+  long size = lz4::decompress(packed.data(), packed.size(), unpacked.data(), unpacked.size());
+  EXPECT_EQ(size, (long) data.size());
+  return unpacked;
+}
+
+// A sprite-like image: a shaded disc on a transparent field, in BGRA.
+std::vector<unsigned char> TestImage(int w, int h) {
+  std::vector<unsigned char> image(w * h * 4, 0);
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      int dx = x - w / 2, dy = y - h / 2;
+      if (dx * dx + dy * dy > w * h / 5) continue;
+      unsigned char *px = &image[(y * w + x) * 4];
+      px[0] = 40 + y / 4, px[1] = 120 + x / 8, px[2] = 200, px[3] = 255;
+    }
+  }
+  return image;
+}
+
+}  // namespace
+
+TEST(LZ4BlockTest, EmptyAndTinyInputs) {
+  EXPECT_TRUE(RoundTrip({}).empty());
+  std::vector<unsigned char> tiny { 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4 };
+  EXPECT_EQ(RoundTrip(tiny), tiny);
+}
+
+TEST(LZ4BlockTest, RandomData) {
+  std::mt19937 rng(7);
+  std::vector<unsigned char> data(100000);
+  for (unsigned char &c : data) c = rng();
+  EXPECT_EQ(RoundTrip(data), data);
+}
+
+TEST(LZ4BlockTest, RepeatingRuns) {
+  std::vector<unsigned char> data;
+  for (int run = 1; run < 300; ++run)
+    for (int i = 0; i < run * 7; ++i) data.push_back(i % run);
+  EXPECT_EQ(RoundTrip(data), data);
+}
+
+TEST(LZ4BlockTest, RejectsMalformedData) {
+  std::vector<unsigned char> image = TestImage(64, 64);
+  std::vector<unsigned char> packed(lz4::compress_bound(image.size()));
+  packed.resize(lz4::compress(image.data(), image.size(), packed.data()));
+  std::vector<unsigned char> out(image.size());
+
+  EXPECT_EQ(lz4::decompress(packed.data(), packed.size(), out.data(), out.size() - 1), -1);
+  EXPECT_EQ(lz4::decompress(packed.data(), packed.size() / 2, out.data(), out.size()), -1);
+  const unsigned char bad_offset[] = { 0x10, 'a', 0x09, 0x00 };
+  EXPECT_EQ(lz4::decompress(bad_offset, sizeof(bad_offset), out.data(), out.size()), -1);
+}
+
+// Not a pass/fail test: reports how LZ4 compares to zlib on image data.
+TEST(LZ4BlockTest, CompareWithZlib) {
+  using Clock = std::chrono::steady_clock;
+  std::vector<unsigned char> image = TestImage(512, 512);
+  const int kRuns = 20;
+
+  std::vector<unsigned char> lz4_packed(lz4::compress_bound(image.size()));
+  lz4_packed.resize(lz4::compress(image.data(), image.size(), lz4_packed.data()));
+  uLongf zlib_size = compressBound(image.size());
+  std::vector<unsigned char> zlib_packed(zlib_size);
+  ASSERT_EQ(compress(zlib_packed.data(), &zlib_size, image.data(), image.size()), Z_OK);
+
+  std::vector<unsigned char> out(image.size());
+  auto start = Clock::now();
+  for (int i = 0; i < kRuns; ++i)
+    ASSERT_EQ(lz4::decompress(lz4_packed.data(), lz4_packed.size(), out.data(), out.size()), (long) out.size());
+  auto lz4_time = Clock::now() - start;
+  EXPECT_EQ(out, image);
+
+  start = Clock::now();
+  for (int i = 0; i < kRuns; ++i) {
+    uLongf size = out.size();
+    ASSERT_EQ(uncompress(out.data(), &size, zlib_packed.data(), zlib_size), Z_OK);
+  }
+  auto zlib_time = Clock::now() - start;
+
+  auto us = [](Clock::duration d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count() / kRuns; };
+  std::cout << "512x512 image, " << image.size() << " bytes: lz4 " << lz4_packed.size() << " bytes, "
+            << us(lz4_time) << "us to unpack; zlib " << zlib_size << " bytes, " << us(zlib_time) << "us to unpack"
+            << std::endl;
+}
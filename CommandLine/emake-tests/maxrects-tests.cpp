@@ -0,0 +1,55 @@
+#include "rectpacker/maxrects.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using enigma::Rect;
+using enigma::rect_packer::MaxRectsBin;
+
+namespace {
+
+bool Overlap(const Rect<int> &a, const Rect<int> &b) {
+  return a.x < b.right() && b.x < a.right() && a.y < b.bottom() && b.y < a.bottom();
+}
+
+}  // namespace
+
+TEST(MaxRectsTest, FillsBinExactly) {
+  MaxRectsBin bin(64, 64);
+  Rect<int> r;
+  for (int i = 0; i < 16; ++i) ASSERT_TRUE(bin.insert(16, 16, &r));
+  EXPECT_FALSE(bin.insert(1, 1, &r));
+  EXPECT_EQ(bin.used_width(), 64);
+  EXPECT_EQ(bin.used_height(), 64);
+}
+
+TEST(MaxRectsTest, RejectsOversizedRects) {
+  MaxRectsBin bin(32, 32);
+  Rect<int> r;
+  EXPECT_FALSE(bin.insert(33, 8, &r));
+  EXPECT_TRUE(bin.insert(32, 8, &r));
+}
+
+TEST(MaxRectsTest, PlacementsStayInsideAndApart) {
+  std::mt19937 rng(3);
+  MaxRectsBin bin(512, 512);
+  std::vector<Rect<int>> placed;
+  int area = 0;
+  for (int i = 0; i < 400; ++i) {
+    Rect<int> r;
+    int w = 4 + rng() % 60, h = 4 + rng() % 60;
+    if (!bin.insert(w, h, &r)) continue;
+    EXPECT_EQ(r.w, w);
+    EXPECT_EQ(r.h, h);
+    EXPECT_GE(r.x, 0);
+    EXPECT_GE(r.y, 0);
+    EXPECT_LE(r.right(), 512);
+    EXPECT_LE(r.bottom(), 512);
+    for (const Rect<int> &other : placed) EXPECT_FALSE(Overlap(r, other));
+    placed.push_back(r);
+    area += w * h;
+  }
+  // Random sizes in arrival order should still fill most of the bin.
+  EXPECT_GT(area, 512 * 512 * 3 / 4);
+}
@@ -0,0 +1,128 @@
+#define PATH_EXT_SET
+#include "Universal_System/Extensions/MotionPlanning/motion_planning_struct.cpp"
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+using enigma::grid;
+
+namespace {
+
+const unsigned kBlocked = 10;
+
+class GridTest : public ::testing::Test {
+ protected:
+  void SetUp() override { enigma::gridstructarray = new grid*[1]; }
+  void TearDown() override { delete[] enigma::gridstructarray; }
+};
+
+bool Diagonal(const grid &gr, unsigned from, unsigned to) {
+  return gr.nodearray[from].x != gr.nodearray[to].x && gr.nodearray[from].y != gr.nodearray[to].y;
+}
+
+// Cost of stepping into cell to, or kBlocked if the search may not step there.
+unsigned StepCost(const grid &gr, unsigned from, unsigned to, bool allow_diag) {
+  const enigma::node &a = gr.nodearray[from], &b = gr.nodearray[to];
+  if (b.cost >= gr.threshold) return kBlocked;
+  if (!Diagonal(gr, from, to)) return b.cost;
+  if (!allow_diag || gr.nodearray[a.x * gr.vcells + b.y].cost >= gr.threshold ||
+      gr.nodearray[b.x * gr.vcells + a.y].cost >= gr.threshold)
+    return kBlocked;
+  return b.cost + unsigned(std::ceil(b.cost / 2.5));
+}
+
+// Cheapest cost from start to goal by Dijkstra, or -1 if goal can't be reached.
+long Cheapest(const grid &gr, unsigned start, unsigned goal, bool allow_diag) {
+  typedef std::pair<unsigned, unsigned> entry;
+  std::vector<unsigned> dist(gr.nodearray.size(), ~0u);
+  std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+  dist[start] = 0;
+  open.push(entry(0, start));
+  unsigned around[8];
+  while (!open.empty()) {
+    const entry e = open.top();
+    open.pop();
+    if (e.first != dist[e.second]) continue;
+    if (e.second == goal) return e.first;
+    for (unsigned k = 0, n = gr.neighbors(e.second, around); k < n; ++k) {
+      const unsigned step = StepCost(gr, e.second, around[k], allow_diag);
+      if (step == kBlocked || e.first + step >= dist[around[k]]) continue;
+      dist[around[k]] = e.first + step;
+      open.push(entry(dist[around[k]], around[k]));
+    }
+  }
+  return -1;
+}
+
+// Cost of walking start, path..., goal, checking each step is allowed.
+long PathCost(const grid &gr, unsigned start, unsigned goal, const std::vector<unsigned> &path, bool allow_diag) {
+  std::vector<unsigned> cells(1, start);
+  cells.insert(cells.end(), path.begin(), path.end());
+  cells.push_back(goal);
+  long total = 0;
+  unsigned around[8];
+  for (size_t i = 1; i < cells.size(); ++i) {
+    const unsigned n = gr.neighbors(cells[i - 1], around);
+    bool adjacent = false;
+    for (unsigned k = 0; k < n; ++k) adjacent |= around[k] == cells[i];
+    EXPECT_TRUE(adjacent) << "step " << i;
+    const unsigned step = StepCost(gr, cells[i - 1], cells[i], allow_diag);
+    EXPECT_NE(step, kBlocked) << "step " << i;
+    total += step;
+  }
+  return total;
+}
+
+void ExpectCheapest(const grid &gr, unsigned start, unsigned goal, bool allow_diag, enigma::path_search &search) {
+  std::vector<unsigned> path;
+  const long best = Cheapest(gr, start, goal, allow_diag);
+  ASSERT_EQ(enigma::find_path(gr, start, goal, allow_diag, search, path), best >= 0);
+  if (best >= 0) {
+    EXPECT_EQ(PathCost(gr, start, goal, path, allow_diag), best);
+  }
+}
+
+TEST_F(GridTest, FreeCorridorIsPreferred) {
+  // A free column one step off the straight line beats the direct route.
+  grid gr(0, 0, 0, 12, 3, 16, 16, kBlocked, 1);
+  for (unsigned h = 0; h < 12; ++h) {
+    gr.nodearray[h * 3 + 1].cost = 5;
+    gr.nodearray[h * 3 + 2].cost = 0;
+  }
+  gr.costs_changed();
+  enigma::path_search search;
+  for (bool allow_diag : {false, true}) ExpectCheapest(gr, 1, 11 * 3 + 1, allow_diag, search);
+}
+
+TEST_F(GridTest, MatchesDijkstraWithFreeCells) {
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<unsigned> cost(0, 4);
+  enigma::path_search search;
+  for (int round = 0; round < 200; ++round) {
+    grid gr(0, 0, 0, 10, 8, 16, 16, 4, 1);
+    for (enigma::node &n : gr.nodearray) n.cost = cost(rng);
+    gr.costs_changed();
+    const unsigned start = rng() % gr.nodearray.size();
+    const unsigned goal = (start + 1 + rng() % (gr.nodearray.size() - 1)) % gr.nodearray.size();
+    gr.nodearray[start].cost = gr.nodearray[goal].cost = 1;
+    gr.costs_changed();
+    for (bool allow_diag : {false, true}) ExpectCheapest(gr, start, goal, allow_diag, search);
+  }
+}
+
+TEST_F(GridTest, MinCostFollowsChanges) {
+  grid gr(0, 0, 0, 4, 4, 16, 16, 3, 1);
+  EXPECT_EQ(gr.min_cost(), 1u);
+  gr.nodearray[5].cost = 0;
+  gr.costs_changed();
+  EXPECT_EQ(gr.min_cost(), 0u);
+  for (enigma::node &n : gr.nodearray) n.cost = 3;
+  gr.costs_changed();
+  EXPECT_EQ(gr.min_cost(), 3u);
+}
+
+}  // namespace
@@ -0,0 +1,168 @@
+#include "Universal_System/Instances/parallel_step.cpp"
+#include "Universal_System/worker_pool.cpp"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+using enigma::object_basic;
+
+// Parallel Step is linked here without the rest of the engine; these stand in
+// for the parts of it that it calls.
+namespace enigma {
+
+int maxid = 100000;
+thread_local inst_iter *instance_event_iterator = nullptr;
+thread_local object_basic *instance_other = nullptr;
+bool profiler_enabled = false;
+
+inst_iter::inst_iter(object_basic* i, inst_iter *n, inst_iter *p): inst(i), next(n), prev(p) {}
+
+std::vector<object_basic*> touched;
+void collision_touch(object_basic *inst) { touched.push_back(inst); }
+
+object_basic::object_basic(): id(0), object_index(-1), $destroyed(false) {}
+object_basic::object_basic(int uid, int uoid): id(uid), object_index(uoid), $destroyed(false) {}
+object_basic::~object_basic() {}
+void object_basic::unlink() {}
+void object_basic::deactivate() {}
+void object_basic::activate() {}
+variant object_basic::myevent_create() { return 0; }
+variant object_basic::myevent_gamestart() { return 0; }
+variant object_basic::myevent_gameend() { return 0; }
+variant object_basic::myevent_closebutton() { return 0; }
+variant object_basic::myevent_roomstart() { return 0; }
+variant object_basic::myevent_roomend() { return 0; }
+variant object_basic::myevent_destroy() { return 0; }
+bool object_basic::can_cast(int) const { return false; }
+
+}  // namespace enigma
+
+namespace {
+
+const int kParallelObject = 2, kSerialObject = 3;
+// Enough instances for several chunks, with a partly filled one at the end.
+const int kInstances = 1000;
+
+struct counted_instance : object_basic {
+  std::atomic<int> steps{0};
+  counted_instance(int id, int object): object_basic(id, object) {}
+};
+
+class ParallelStepTest : public ::testing::Test {
+ protected:
+  std::vector<std::unique_ptr<counted_instance>> instances;
+  enigma::inst_iter main_iterator{nullptr, nullptr, nullptr};
+
+  void SetUp() override {
+    enigma::parallel_step_set_object(kParallelObject);
+    enigma::parallel_step_begin();
+    enigma::touched.clear();
+    for (int i = 0; i < kInstances; ++i)
+      instances.emplace_back(new counted_instance(100001 + i, kParallelObject));
+    enigma::instance_event_iterator = &main_iterator;
+  }
+
+  void ClaimAll() {
+    for (auto &inst : instances) ASSERT_TRUE(enigma::parallel_step_claim(inst.get()));
+  }
+};
+
+// Checks what a worker sees, then counts the step.
+void CountStep(object_basic *inst) {
+  EXPECT_NE(enigma::parallel_step_worker, nullptr);
+  if (enigma::parallel_step_worker) {
+    EXPECT_EQ(enigma::parallel_step_worker->self, inst);
+  }
+  static_cast<counted_instance*>(inst)->steps++;
+}
+
+TEST_F(ParallelStepTest, EachInstanceStepsOnce) {
+  ClaimAll();
+  enigma::parallel_step_run(CountStep);
+  for (auto &inst : instances) EXPECT_EQ(inst->steps, 1) << "instance " << inst->id;
+  EXPECT_EQ(enigma::touched.size(), size_t(kInstances));
+  EXPECT_EQ(enigma::parallel_step_worker, nullptr);
+
+  // The batch was used up; running again steps nothing.
+  enigma::parallel_step_run(CountStep);
+  for (auto &inst : instances) EXPECT_EQ(inst->steps, 1) << "instance " << inst->id;
+}
+
+TEST_F(ParallelStepTest, OnlyMarkedObjectsAreClaimed) {
+  counted_instance serial(99999, kSerialObject), unknown(99998, 1000);
+  EXPECT_FALSE(enigma::parallel_step_claim(&serial));
+  EXPECT_FALSE(enigma::parallel_step_claim(&unknown));
+  EXPECT_TRUE(enigma::parallel_step_claim(instances[0].get()));
+}
+
+TEST_F(ParallelStepTest, EventIteratorIsTheWorkers) {
+  ClaimAll();
+  enigma::instance_other = instances[0].get();
+  enigma::parallel_step_run([](object_basic *inst) {
+    // As any engine function acting on the calling instance reads it.
+    EXPECT_NE(enigma::instance_event_iterator, nullptr);
+    if (enigma::instance_event_iterator) {
+      EXPECT_EQ(enigma::instance_event_iterator->inst, inst);
+    }
+    EXPECT_EQ(enigma::instance_other, inst);
+    static_cast<counted_instance*>(inst)->steps++;
+  });
+  // The main thread steps a share too, and gets its own back after.
+  EXPECT_EQ(enigma::instance_event_iterator, &main_iterator);
+  EXPECT_EQ(enigma::instance_other, instances[0].get());
+}
+
+std::vector<unsigned> applied;
+
+TEST_F(ParallelStepTest, CommandsRunInInstanceOrder) {
+  ClaimAll();
+  applied.clear();
+  enigma::parallel_step_run([](object_basic *inst) {
+    // As instance_destroy does from a worker.
+    enigma::parallel_step_defer([inst]() {
+      EXPECT_EQ(enigma::parallel_step_worker, nullptr);
+      applied.push_back(inst->id);
+    });
+  });
+  ASSERT_EQ(applied.size(), size_t(kInstances));
+  for (int i = 0; i < kInstances; ++i) EXPECT_EQ(applied[i], instances[i]->id);
+
+  // Outside the batch, commands run at once.
+  enigma::parallel_step_defer([]() { applied.push_back(0); });
+  EXPECT_EQ(applied.back(), 0u);
+}
+
+TEST_F(ParallelStepTest, ReservedIdsAreDistinct) {
+  ClaimAll();
+  static std::vector<int> ids(kInstances);
+  const int first = enigma::maxid;
+  enigma::parallel_step_run([](object_basic *inst) {
+    // As instance_create does from a worker.
+    ids[inst->id - 100001] = enigma::parallel_step_reserve_id();
+  });
+  std::vector<bool> seen(kInstances);
+  for (int id : ids) {
+    ASSERT_GE(id, first);
+    ASSERT_LT(id, first + kInstances);
+    EXPECT_FALSE(seen[id - first]) << "id " << id;
+    seen[id - first] = true;
+  }
+  EXPECT_EQ(enigma::maxid, first + kInstances);
+}
+
+TEST_F(ParallelStepTest, DestroyedInstancesAreSkipped) {
+  ClaimAll();
+  for (int i = 0; i < kInstances; i += 3) instances[i]->$destroyed = true;
+  enigma::parallel_step_run(CountStep);
+  size_t live = 0;
+  for (auto &inst : instances) {
+    EXPECT_EQ(inst->steps, inst->$destroyed ? 0 : 1) << "instance " << inst->id;
+    live += !inst->$destroyed;
+  }
+  EXPECT_EQ(enigma::touched.size(), live);
+  for (object_basic *inst : enigma::touched) EXPECT_FALSE(inst->$destroyed);
+}
+
+}  // namespace
@@ -130,6 +130,10 @@ OptionsParser::OptionsParser() : _desc("Options")
     ("compiler,x", opt::value<std::string>()->default_value(defAPI.has_target_compiler() ? defAPI.target_compiler() : def_compiler), "Compiler.ey Descriptor")
     ("enigma-root", opt::value<std::string>()->default_value(fs::current_path().string()), "Path to ENIGMA's sources")
     ("codegen-only", opt::bool_switch()->default_value(false), "Only generate code and exit")
+    ("resource-codec", opt::value<std::string>()->default_value("zlib"), "How to pack sprite and background images: zlib (smaller) or lz4 (faster to load)")
+    ("lazy-resources", opt::bool_switch()->default_value(false), "Decode sprites and backgrounds when first used instead of at startup")
+    ("benchmark", opt::bool_switch()->default_value(false), "Build a game that runs unthrottled, times its events and reports on exit")
+    ("profile", opt::value<std::string>()->default_value("none"), "Build in the event profiler: none, events (by object) or scripts (events and scripts)")
     ("run,r", opt::bool_switch()->default_value(false), "Automatically run the game after it is built")
     ("jobs,j", opt::value<int>()->default_value(1), "The number of compile jobs to run simultaneously")
   ;
@@ -307,6 +311,11 @@ std::string OptionsParser::APIyaml(const buffers::resources::Settings* currentCo
   yaml += "target-networking: " + network + "\n";
   yaml += "extensions: " + _extensions + "\n";
   yaml += std::string("codegen-only: ") + (_rawArgs["codegen-only"].as<bool>() ? "true" : "false") + "\n";
+  yaml += std::string("resource-codec: ") + (_rawArgs["resource-codec"].as<std::string>() == "lz4" ? "1" : "0") + "\n";
+  yaml += std::string("lazy-resources: ") + (_rawArgs["lazy-resources"].as<bool>() ? "true" : "false") + "\n";
+  yaml += std::string("benchmark-build: ") + (_rawArgs["benchmark"].as<bool>() ? "true" : "false") + "\n";
+  const std::string profile = _rawArgs["profile"].as<std::string>();
+  yaml += std::string("profile-events: ") + (profile == "scripts" ? "2" : profile == "events" ? "1" : "0") + "\n";
   yaml += "enigma-root: " + _enigmaRoot + "\n";
   yaml += "jobs: " + jobs + "\n";
 
@@ -0,0 +1,65 @@
+#include "TestHarness.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+namespace fs = std::filesystem;
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using std::string;
+using std::vector;
+
+const char *const kBenchmarkDirectory = "CommandLine/testing/SimpleTests";
+const char *const kBenchmarkOutputDirectory = "test-harness-out";
+const char *const kBenchmarkSuffix = "_bench";
+constexpr int kBenchmarkSteps = 100;
+
+// Simple tests named like "something_bench" double as benchmarks.
+vector<string> enumerate_benchmarks() {
+  vector<string> result;
+  for (auto &p : fs::directory_iterator(kBenchmarkDirectory)) {
+    const string stem = p.path().stem().string();
+    if (stem.size() > std::strlen(kBenchmarkSuffix) &&
+        stem.compare(stem.size() - std::strlen(kBenchmarkSuffix), string::npos, kBenchmarkSuffix) == 0)
+      result.push_back(p.path().string());
+  }
+  return result;
+}
+
+class BenchmarkHarness : public testing::TestWithParam<string> {};
+
+// Runs each benchmark headless and leaves its report behind in the harness's
+// output directory as benchmark_<name>.json, to be compared between revisions.
+TEST_P(BenchmarkHarness, BenchmarkRunner) {
+  const string game = GetParam();
+  fs::create_directories(kBenchmarkOutputDirectory);
+  const string report = string(kBenchmarkOutputDirectory) + "/benchmark_"
+                      + fs::path(game).stem().string() + ".json";
+  fs::remove(report);
+
+  TestConfig tc;
+  tc.extensions = "Alarms,Timelines,Paths,MotionPlanning,DateTime,DataStructures,GTest";
+  int ret = TestHarness::run_benchmark(game, tc, kBenchmarkSteps, report);
+  ASSERT_EQ(ret, 0) << "Benchmark \"" << game << "\" did not run to completion.";
+
+  std::ifstream in(report);
+  ASSERT_TRUE(in) << "Benchmark \"" << game << "\" did not write a report.";
+  std::stringstream json;
+  json << in.rdbuf();
+  EXPECT_NE(json.str().find("\"steps_per_second\""), string::npos) << json.str();
+  EXPECT_NE(json.str().find("\"events\""), string::npos) << json.str();
+  std::cout << game << ": " << json.str() << std::endl;
+}
+
+INSTANTIATE_TEST_CASE_P(Benchmarks, BenchmarkHarness,
+                        testing::ValuesIn(enumerate_benchmarks()));
+
+}  // namespace
@@ -4,6 +4,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -224,7 +225,7 @@ int build_game(const string &game, const TestConfig &tc, const string &out) {
   string extensions = "--extensions="
       + tc.get_or(&TC::extensions, kDefaultExtensions);
 
-  const char *const args[] = {
+  std::vector<const char*> args = {
     emake_cmd.c_str(),
     compiler.c_str(),
     mode.c_str(),
@@ -235,13 +236,11 @@ int build_game(const string &game, const TestConfig &tc, const string &out) {
     network.c_str(),
     collision.c_str(),
     extensions.c_str(),
-    game.c_str(),
-    "-o",
-    out.c_str(),
-    nullptr
   };
+  if (tc.benchmark) args.push_back("--benchmark");
+  args.insert(args.end(), {game.c_str(), "-o", out.c_str(), nullptr});
 
-  execvp(emake_cmd.c_str(), (char**) args);
+  execvp(emake_cmd.c_str(), (char**) args.data());
   abort();
 }
 
@@ -340,7 +339,8 @@ constexpr int operator"" _million(unsigned long long x) {
   return x * 1000 * 1000;
 }
 
-int TestHarness::run_to_completion(const string &game, const TestConfig &tc) {
+int TestHarness::run_to_completion(const string &game, const TestConfig &tc,
+                                   const std::vector<string> &args) {
   string out = "/tmp/test-game";
   if (int retcode = build_game(game, tc, out)) {
     if (retcode == -1) {
@@ -351,10 +351,14 @@ int TestHarness::run_to_completion(const string &game, const TestConfig &tc) {
     return ErrorCodes::BUILD_FAILED;
   }
 
+  std::vector<const char*> argv = {out.c_str()};
+  for (const string &arg : args) argv.push_back(arg.c_str());
+  argv.push_back(nullptr);
+
   pid_t pid = fork();
   if (!pid) {
     chdir(game.substr(0, game.find_last_of("\\/")).c_str());
-    execl(out.c_str(), out.c_str(), nullptr);
+    execv(out.c_str(), (char**) argv.data());
     abort();
   }
   if (pid == -1) {
@@ -379,3 +383,17 @@ int TestHarness::run_to_completion(const string &game, const TestConfig &tc) {
   kill(pid, SIGKILL);  // We're not dicking around with this.
   return ErrorCodes::TIMED_OUT;
 }
+
+int TestHarness::run_benchmark(const string &game, TestConfig tc, int steps,
+                               const string &report) {
+  tc.platform = "None";
+  tc.graphics = "None";
+  tc.audio = "None";
+  tc.widgets = "None";
+  tc.network = "None";
+  tc.benchmark = true;
+  // The game runs from its own directory, so the report needs a full path.
+  const string report_path = std::filesystem::absolute(report).string();
+  return run_to_completion(game, tc, {"--benchmark-steps=" + to_string(steps),
+                                      "--benchmark-report=" + report_path});
+}
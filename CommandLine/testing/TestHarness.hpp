@@ -21,6 +21,7 @@ struct TestConfig {
   std::string network;
   std::string collision;
   std::string extensions;
+  bool benchmark = false;  // Build with per-event timers and allocation counts.
 
   std::string get_or(std::string(TestConfig::*option), std::string alt) const {
     std::string mine = this->*option;
@@ -87,7 +88,14 @@ class TestHarness {
 
   /// Launch a game's executable file and let it run to completion.
   /// Return its exit code.
-  static int run_to_completion(const std::string &game, const TestConfig &tc);
+  static int run_to_completion(const std::string &game, const TestConfig &tc,
+                               const std::vector<std::string> &args = {});
+
+  /// Build a game headless as a benchmark build, run it unthrottled for the
+  /// given number of steps and have it write its JSON report to the given file.
+  /// Return its exit code.
+  static int run_benchmark(const std::string &game, TestConfig tc, int steps,
+                           const std::string &report);
 
   enum ErrorCodes {
     BUILD_FAILED = -1,      ///< Used if the game failed to build.
@@ -0,0 +1,48 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "codegen_file.h"
+
+#include <fstream>
+#include <iterator>
+
+bool write_if_changed(const std::filesystem::path &path, const std::string &contents) {
+  std::error_code ec;
+  if (std::filesystem::file_size(path, ec) == contents.size() && !ec) {
+    std::ifstream in(path, std::ios_base::binary);
+    if (std::equal(contents.begin(), contents.end(), std::istreambuf_iterator<char>(in)))
+      return false;
+  }
+  std::ofstream out(path, std::ios_base::binary);
+  out << contents;
+  return true;
+}
+
+void codegen_ofstream::open(const std::filesystem::path &path) {
+  close();
+  str(std::string());
+  clear();
+  path_ = path;
+  open_ = true;
+}
+
+void codegen_ofstream::close() {
+  if (!open_) return;
+  open_ = false;
+  write_if_changed(path_, str());
+  str(std::string());
+}
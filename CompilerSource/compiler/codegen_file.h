@@ -0,0 +1,47 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_CODEGEN_FILE_H
+#define ENIGMA_CODEGEN_FILE_H
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+// Writes the given contents to a file, unless the file already holds exactly
+// those contents. Returns whether the file was written.
+bool write_if_changed(const std::filesystem::path &path, const std::string &contents);
+
+// An output stream for a generated file. The file is collected in memory and
+// only written out on close if it changed, so that files which come out the
+// same keep their modification times and make does not rebuild what uses them.
+class codegen_ofstream : public std::ostringstream {
+ public:
+  codegen_ofstream() = default;
+  explicit codegen_ofstream(const std::filesystem::path &path) { open(path); }
+  ~codegen_ofstream() { close(); }
+
+  void open(const std::filesystem::path &path);
+  bool is_open() const { return open_; }
+  void close();
+
+ private:
+  std::filesystem::path path_;
+  bool open_ = false;
+};
+
+#endif
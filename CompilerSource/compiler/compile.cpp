@@ -67,6 +67,9 @@ using namespace std;
 #include "event_reader/event_parser.h"
 
 #include "languages/lang_CPP.h"
+#include "codegen_file.h"
+#include "resource_index.h"
+#include "texture_pages.h"
 
 #ifdef WRITE_UNIMPLEMENTED_TXT
 std::map <string, char> unimplemented_function_list;
@@ -109,11 +112,11 @@ inline void write_desktop_entry(const std::filesystem::path& fname, const GameDa
 }
 
 inline void write_exe_info(const std::filesystem::path& codegen_directory, const GameData &game) {
-  std::ofstream wto;
+  codegen_ofstream wto;
   const buffers::resources::General &gameSet = game.settings.general();
   const string &gloss_version = game.settings.info().version();
 
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/Resources.rc").u8string().c_str(),ios_base::out);
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/Resources.rc");
   wto << license;
   wto << "#include <windows.h>\n";
   if (!gameSet.game_icon().empty()) {
@@ -145,13 +148,51 @@ inline void write_exe_info(const std::filesystem::path& codegen_directory, const
 
 #define irrr() if (res) { idpr("Error occurred; see scrollback for details.",-1); return res; }
 
+// Lists the sprites and backgrounds each room's instances and tiles use, so
+// the game can load them before the room starts.
+static void add_room_manifests(ResourceIndex &index, const GameData &game) {
+  using enigma::resource_format::kind;
+  map<string, int> sprite_ids, background_ids;
+  map<string, pair<string, string>> object_sprites;
+  for (const auto &spr : game.sprites) sprite_ids[spr.name] = spr.id();
+  for (const auto &bkg : game.backgrounds) background_ids[bkg.name] = bkg.id();
+  for (const auto &obj : game.objects)
+    object_sprites[obj.name] = make_pair(obj->sprite_name(), obj->mask_name());
+
+  for (const auto &room : game.rooms) {
+    set<pair<int, int>> assets;
+    auto add = [&assets](int type, const map<string, int> &ids, const string &name) {
+      auto it = ids.find(name);
+      if (it != ids.end()) assets.insert(make_pair(type, it->second));
+    };
+    for (const auto &instance : room->instances()) {
+      auto obj = object_sprites.find(instance.object_type());
+      if (obj == object_sprites.end()) continue;
+      add(kind("SPR "), sprite_ids, obj->second.first);
+      add(kind("SPR "), sprite_ids, obj->second.second);
+    }
+    for (const auto &tile : room->tiles())
+      add(kind("BKG "), background_ids, tile.background_name());
+    for (const auto &background : room->backgrounds())
+      add(kind("BKG "), background_ids, background.background_name());
+    index.add_room(room.id(), vector<pair<int, int>>(assets.begin(), assets.end()));
+  }
+}
+
 static int write_res_helper(FILE* gameModule, int& resourceblock_start, const GameData &game) {
+  ResourceIndex index(gameModule);
+
   // Start by setting off our location with a DWord of NULLs
   fwrite("\0\0\0",1,4,gameModule);
 
+  // Sprites and backgrounds on texture pages refer to them, so they go first
+  idpr("Packing Texture Pages",89);
+  TexturePages pages(game, game.settings.graphics().texture_page_size());
+  pages.write(gameModule, setting::resource_codec);
+
   idpr("Adding Sprites",90);
 
-  int res = current_language->module_write_sprites(game, gameModule);
+  int res = current_language->module_write_sprites(game, gameModule, index, pages);
   if (res) { 
     idpr("Error occurred; see scrollback for details.",-1); 
     return res;
@@ -160,16 +201,21 @@ static int write_res_helper(FILE* gameModule, int& resourceblock_start, const Ga
   edbg << "Finalized sprites." << flushl;
   idpr("Adding Sounds",93);
 
-  current_language->module_write_sounds(game, gameModule);
+  current_language->module_write_sounds(game, gameModule, index);
 
-  current_language->module_write_backgrounds(game, gameModule);
+  current_language->module_write_backgrounds(game, gameModule, index, pages);
 
   current_language->module_write_fonts(game, gameModule);
 
   current_language->module_write_paths(game, gameModule);
 
-  // Tell where the resources start
-  fwrite("\0\0\0\0res0",8,1,gameModule);
+  // Add the table of contents
+  add_room_manifests(index, game);
+  int index_pos = index.write(setting::lazy_resources ? enigma::resource_format::INDEX_LAZY : 0);
+
+  // Tell where the index and the resources start
+  fwrite(&index_pos,4,1,gameModule);
+  fwrite("res0",4,1,gameModule);
   fwrite(&resourceblock_start,4,1,gameModule);
 
   // Close the game module; we're done adding resources
@@ -196,7 +242,7 @@ DLLEXPORT void ide_handles_game_launch() { run_game = false; }
 static bool redirect_make = true;
 DLLEXPORT void log_make_to_console() { redirect_make = false; }
 
-template<typename T> void write_resource_meta(ofstream &wto, const char *kind, vector<T> resources, bool gen_names = true) {
+template<typename T> void write_resource_meta(std::ostream &wto, const char *kind, vector<T> resources, bool gen_names = true) {
   int max = 0;
   stringstream swb;  // switch body
   wto << "namespace enigma_user {\n"
@@ -207,6 +253,7 @@ template<typename T> void write_resource_meta(ofstream &wto, const char *kind, v
     swb << "      case " << res.id() << ": return \""  << res.name << "\";\n";
   }
   wto << "  };\n\n";
+  wto << "#ifndef ENIGMA_DECLARATIONS_ONLY\n";
   if (gen_names) {
     wto << "  string " << kind << "_get_name(int i) {\n"
            "    switch (i) {\n";
@@ -214,13 +261,15 @@ template<typename T> void write_resource_meta(ofstream &wto, const char *kind, v
     wto << "    }\n"
            "  }\n";
   }
+  wto << "#endif\n";
   wto << "}\n";
-  wto << "namespace enigma { size_t " << kind << "_idmax = " << max << "; }\n\n";
+  wto << "#ifndef ENIGMA_DECLARATIONS_ONLY\n";
+  wto << "namespace enigma { size_t " << kind << "_idmax = " << max << "; }\n";
+  wto << "#endif\n\n";
 }   
  
 void wite_asset_enum(const std::filesystem::path& fName) {
-  std::ofstream wto;
-  wto.open(fName.u8string().c_str());
+  codegen_ofstream wto(fName);
   
   wto<< "#ifndef ASSET_ENUM_H\n#define ASSET_ENUM_H\n\n";
   
@@ -482,7 +531,7 @@ int lang_CPP::compile(const GameData &game, const char* exe_filename, int mode)
 
   //Export resources to each file.
 
-  ofstream wto;
+  codegen_ofstream wto;
   idpr("Outputting Resources in Various Places...",10);
 
   // FIRST FILE
@@ -499,7 +548,7 @@ int lang_CPP::compile(const GameData &game, const char* exe_filename, int mode)
     write_desktop_entry(gameFname, game);
 
   edbg << "Writing modes and settings" << flushl;
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/GAME_SETTINGS.h").u8string().c_str(),ios_base::out);
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/GAME_SETTINGS.h");
   wto << license;
   wto << "#define ASSUMEZERO 0\n";
   wto << "#define PRIMBUFFER 0\n";
@@ -507,24 +556,26 @@ int lang_CPP::compile(const GameData &game, const char* exe_filename, int mode)
   wto << "#define AUTOLOCALS 0\n";
   wto << "#define MODE3DVARS 0\n";
   wto << "#define GM_COMPATIBILITY_VERSION " << setting::compliance_mode << "\n";
+  wto << "#ifndef ENIGMA_DECLARATIONS_ONLY\n";
   wto << "void ABORT_ON_ALL_ERRORS() { " << (false?"game_end();":"") << " }\n";
+  wto << "#endif\n";
   wto << '\n';
   wto.close();
 
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_modesenabled.h").u8string().c_str(),ios_base::out);
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_modesenabled.h");
   wto << license;
   wto << "#define BUILDMODE " << 0 << "\n";
   wto << "#define DEBUGMODE " << 0 << "\n";
   wto << '\n';
   wto.close();
 
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_inherited_locals.h").u8string().c_str(),ios_base::out);
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_inherited_locals.h");
   wto.close();
 
   //NEXT FILE ----------------------------------------
   //Object switch: A listing of all object IDs and the code to allocate them.
   edbg << "Writing object switch" << flushl;
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_object_switch.h").u8string().c_str(),ios_base::out);
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_object_switch.h");
     wto << license;
     wto << "#ifndef NEW_OBJ_PREFIX\n#  define NEW_OBJ_PREFIX\n#endif\n\n";
     for (auto *obj : state.parsed_objects) {
@@ -539,13 +590,16 @@ int lang_CPP::compile(const GameData &game, const char* exe_filename, int mode)
   //NEXT FILE ----------------------------------------
   //Resource names: Defines integer constants for all resources.
   edbg << "Writing resource names and maxima" << flushl;
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_resourcenames.h").u8string().c_str(),ios_base::out);
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_resourcenames.h");
   wto << license;
 
+  // Units of game code other than SHELLmain only need the names themselves.
+  wto << "#ifndef ENIGMA_DECLARATIONS_ONLY\n";
   wto << "namespace enigma {\n";
   std::string res_in = (compilerInfo.exe_vars["RESOURCES_IN"] != "") ? "RESOURCES_IN" : "RESOURCES";
   wto << "const char *resource_file_path=\"" << compilerInfo.exe_vars[res_in] << "\";\n";
   wto << "}\n";
+  wto << "#endif\n";
 
   write_resource_meta(wto,     "object", game.objects);
   write_resource_meta(wto,     "sprite", game.sprites);
@@ -562,6 +616,7 @@ int lang_CPP::compile(const GameData &game, const char* exe_filename, int mode)
   wite_asset_enum(codegen_directory/"AssetEnum.h");
   
   wto << "#include \"AssetEnum.h\"\n";
+  wto << "#ifndef ENIGMA_DECLARATIONS_ONLY\n";
   wto << "namespace enigma {\n\n";
   wto << "std::map<enigma_user::AssetType, std::map<std::string, int>> assetMap = {\n";
   
@@ -584,13 +639,14 @@ int lang_CPP::compile(const GameData &game, const char* exe_filename, int mode)
   
   wto << "\n};\n";
   wto << "\n\n}\n";
+  wto << "#endif\n";
   wto.close();
 
 
   //NEXT FILE ----------------------------------------
   //Timelines: Defines "moment" lookup structures for timelines.
   edbg << "Writing timeline control information" << flushl;
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_timelines.h").u8string().c_str(),ios_base::out);
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_timelines.h");
   {
     wto << license;
     wto <<"namespace enigma {\n\n";
@@ -38,13 +38,15 @@ using namespace std;
 #include "compiler/compile_common.h"
 
 #include "backend/ideprint.h"
+#include "compiler/resource_codec.h"
+#include "settings.h"
 #include "languages/lang_CPP.h"
 
 inline void writei(int x, FILE *f) {
   fwrite(&x,4,1,f);
 }
 
-int lang_CPP::module_write_backgrounds(const GameData &game, FILE *gameModule)
+int lang_CPP::module_write_backgrounds(const GameData &game, FILE *gameModule, ResourceIndex &index, const TexturePages &pages)
 {
   // Now we're going to add backgrounds
   edbg << game.backgrounds.size() << " Adding Backgrounds to Game Module: " << flushl;
@@ -62,8 +64,12 @@ int lang_CPP::module_write_backgrounds(const GameData &game, FILE *gameModule)
       back_maxid = game.backgrounds[i].id();
   fwrite(&back_maxid,4,1,gameModule);
 
+  const int codec = setting::resource_codec;
+  size_t packed_size = 0;
+
   for (int i = 0; i < back_count; i++)
   {
+    index.begin(enigma::resource_format::kind("BKG "), game.backgrounds[i].id(), codec);
     writei(game.backgrounds[i].id(), gameModule);  // id
     writei(game.backgrounds[i].image_data.width,  gameModule);  // width
     writei(game.backgrounds[i].image_data.height, gameModule);  // height
@@ -79,11 +85,28 @@ int lang_CPP::module_write_backgrounds(const GameData &game, FILE *gameModule)
     writei(game.backgrounds[i]->horizontal_spacing(), gameModule);
     writei(game.backgrounds[i]->vertical_spacing(),   gameModule);
 
-    const int sz = game.backgrounds[i].image_data.pixels.size();
-    writei(sz, gameModule); // size
-    fwrite(game.backgrounds[i].image_data.pixels.data(), 1, sz, gameModule); // data
+    if (const TexturePages::Placement *placement = pages.background(i)) {
+      writei(placement->page, gameModule); // texture page
+      writei(placement->x, gameModule);
+      writei(placement->y, gameModule);
+      index.end();
+      continue;
+    }
+    writei(-1, gameModule); // own texture
+
+    const ImageData &image = game.backgrounds[i].image_data;
+    const std::vector<uint8_t> pixels = encode_image(image.pixels, image.width * image.height * 4, codec);
+    if (pixels.empty() && !image.pixels.empty()) {
+      user << "Background `" << game.backgrounds[i].name << "' is corrupt." << flushl;
+      return 14;
+    }
+    writei(codec, gameModule); // image codec
+    writei(pixels.size(), gameModule); // size
+    fwrite(pixels.data(), 1, pixels.size(), gameModule); // data
+    packed_size += pixels.size();
+    index.end();
   }
 
-  edbg << "Done writing backgrounds." << flushl;
+  edbg << "Done writing backgrounds; their images take " << packed_size << " bytes." << flushl;
   return 0;
 }
@@ -45,7 +45,7 @@ inline void writei(int x, FILE *f) {
   fwrite(&x,4,1,f);
 }
 
-int lang_CPP::module_write_sounds(const GameData &game, FILE *gameModule)
+int lang_CPP::module_write_sounds(const GameData &game, FILE *gameModule, ResourceIndex &index)
 {
   // Now we're going to add sounds
   edbg << game.sounds.size() << " Sounds:" << flushl;
@@ -75,9 +75,11 @@ int lang_CPP::module_write_sounds(const GameData &game, FILE *gameModule)
       continue;
     }
 
+    index.begin(enigma::resource_format::kind("SND "), game.sounds[i].id(), enigma::resource_format::CODEC_RAW);
     writei(game.sounds[i].id(), gameModule); // ID
     writei(sndsz, gameModule); // Size
     fwrite(game.sounds[i].audio.data(), 1, sndsz, gameModule); // Data
+    index.end();
   }
 
   edbg << "Done writing sounds." << flushl;
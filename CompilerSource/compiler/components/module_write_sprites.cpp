@@ -40,13 +40,15 @@ using namespace std;
 #include "compiler/compile_common.h"
 
 #include "backend/ideprint.h"
+#include "compiler/resource_codec.h"
+#include "settings.h"
 
 inline void writei(int x, FILE *f) {
   fwrite(&x,4,1,f);
 }
 
 #include "languages/lang_CPP.h"
-int lang_CPP::module_write_sprites(const GameData &game, FILE *gameModule)
+int lang_CPP::module_write_sprites(const GameData &game, FILE *gameModule, ResourceIndex &index, const TexturePages &pages)
 {
   // Now we're going to add sprites
   edbg << game.sprites.size() << " Adding Sprites to Game Module: " << flushl;
@@ -64,8 +66,12 @@ int lang_CPP::module_write_sprites(const GameData &game, FILE *gameModule)
       sprite_maxid = game.sprites[i].id();
   fwrite(&sprite_maxid,4,1,gameModule);
 
+  const int codec = setting::resource_codec;
+  size_t packed_size = 0;
+
   for (int i = 0; i < sprite_count; i++)
   {
+    index.begin(enigma::resource_format::kind("SPR "), game.sprites[i].id(), codec);
     writei(game.sprites[i].id(), gameModule); //id
 
     // Track how many subImages we're copying
@@ -100,19 +106,34 @@ int lang_CPP::module_write_sprites(const GameData &game, FILE *gameModule)
     writei(game.sprites[i]->bbox_mode(),   gameModule); // BBox Mode
     writei(game.sprites[i]->shape(),    gameModule); // Mask shape
 
+    writei(codec,gameModule); // image codec
     writei(subCount,gameModule); //subimages
 
     for (int ii = 0;ii < subCount; ii++)
     {
+      if (const TexturePages::Placement *placement = pages.sprite(i, ii)) {
+        writei(placement->page, gameModule); // texture page
+        writei(placement->x, gameModule);
+        writei(placement->y, gameModule);
+        writei(0,gameModule);
+        continue;
+      }
+      writei(-1, gameModule); // own texture
       //strans = game.sprites[i].image_data[ii].transColor, fwrite(&idttrans,4,1,exe); //Transparent color
+      const std::vector<uint8_t> pixels = encode_image(game.sprites[i].image_data[ii].pixels, swidth * sheight * 4, codec);
+      if (pixels.empty()) {
+        user << "Subimage " << ii << " of sprite `" << game.sprites[i].name << "' is corrupt." << flushl;
+        return 14;
+      }
       writei(swidth * sheight * 4, gameModule); // size when unpacked
-      writei(game.sprites[i].image_data[ii].pixels.size(), gameModule);  // size
-      fwrite(game.sprites[i].image_data[ii].pixels.data(), 1,
-             game.sprites[i].image_data[ii].pixels.size(), gameModule);  // data
+      writei(pixels.size(), gameModule);  // size
+      fwrite(pixels.data(), 1, pixels.size(), gameModule);  // data
+      packed_size += pixels.size();
       writei(0,gameModule);
     }
+    index.end();
   }
 
-  edbg << "Done writing sprites." << flushl;
+  edbg << "Done writing sprites; their images take " << packed_size << " bytes." << flushl;
   return 0;
 }
@@ -38,10 +38,14 @@ using namespace std;
 
 #include "backend/GameData.h"
 #include "parser/object_storage.h"
+#include "parser/parse_cache.h"
 #include "compiler/compile_common.h"
 #include "event_reader/event_parser.h"
 
 #include <math.h> //log2 to calculate passes.
+#include <atomic>
+#include <thread>
+#include <vector>
 
 #include <languages/lang_CPP.h>
 
@@ -50,6 +54,110 @@ using namespace std;
 
 extern string tostring(int);
 
+namespace {
+
+// Outcome of syntax checking and parsing one unit of code. Units are parsed
+// on several threads, so errors are kept here and reported afterward in the
+// order the units would have been parsed one by one.
+struct ParseResult {
+  int error_pos = -1; // as returned by syncheck::syntaxcheck
+  string error;       // syncheck::syerr for that error
+  size_t unit = 0;    // which of a group of units failed, where that matters
+};
+
+// Calls work(i) for each i in [0, count) from a few threads. Each call may
+// only modify state belonging to unit i.
+template<typename Work> void parallel_for(size_t count, const Work &work) {
+  size_t threads = thread::hardware_concurrency();
+  if (threads > count) threads = count;
+  if (threads <= 1) {
+    for (size_t i = 0; i < count; ++i) work(i);
+    return;
+  }
+  atomic<size_t> next(0);
+  auto run = [&]() {
+    for (size_t i; (i = next++) < count; ) work(i);
+  };
+  vector<thread> pool;
+  for (size_t t = 1; t < threads; ++t) pool.emplace_back(run);
+  run();
+  for (thread &worker : pool) worker.join();
+}
+
+// Syntax checks and parses a script or timeline moment into its record.
+ParseResult parse_script(const string &code, ParsedScript *script, const set<string> &script_names) {
+  ParseResult result;
+  string newcode;
+  result.error_pos = syncheck::syntaxcheck(code, newcode);
+  if (result.error_pos != -1) {
+    result.error = syncheck::syerr;
+    return result;
+  }
+  script->code.code = newcode;
+  parser_main(&script->code, script_names);
+
+  // If the script accesses variables from outside its scope implicitly
+  if (script->scope.locals.size() or script->scope.globallocals.size() or script->scope.ambiguous.size()) {
+    // This is a neat hack to treat everything in the script as with().
+    // We make a temporary scope so that anything local to it is ignored, then
+    // ultimately throw it away.
+    // TODO: Looking at this now, I'm not sure if we actually want to throw
+    // locals away; what if a script explicitly declares `local var foo;`?
+    ParsedScope temporary_scope = *script->code.my_scope;
+    script->global_code = new ParsedCode(&temporary_scope);
+    script->global_code->code =
+        string("with (self) {\n") + newcode + "\n/* */}";
+    parser_main(script->global_code, script_names);
+    script->global_code->my_scope = nullptr;
+  }
+  return result;
+}
+
+template<typename Resources> void hash_names(ParseHash &hash, const Resources &resources) {
+  hash.add(resources.size());
+  for (const auto &res : resources) hash.add(res.name);
+}
+
+void hash_members(ParseHash &hash, const jdi::definition_scope *scope) {
+  hash.add(scope->members.size());
+  for (const auto &member : scope->members) hash.add(member.first).add(member.second->flags);
+}
+
+// Hashes everything besides a unit's own code that its parse depends on: the
+// names the parser treats specially, the settings it reads, and the names
+// declared by the engine and extensions. This is coarse, in that any change
+// to these invalidates every cached unit.
+ParseCache::Key parse_signature(const GameData &game, const jdi::definition_scope *enigma_user,
+                                const jdi::definition_scope *global) {
+  ParseHash hash;
+  hash_names(hash, game.sprites);
+  hash_names(hash, game.sounds);
+  hash_names(hash, game.backgrounds);
+  hash_names(hash, game.paths);
+  hash_names(hash, game.scripts);
+  hash_names(hash, game.shaders);
+  hash_names(hash, game.fonts);
+  hash_names(hash, game.timelines);
+  hash_names(hash, game.objects);
+  hash_names(hash, game.rooms);
+  hash_names(hash, game.constants);
+  hash.add(setting::compliance_mode).add(setting::automatic_semicolons);
+  hash.add(setting::keyword_blacklist);
+  hash.add(requested_extensions_last_parse.size());
+  for (const string &ext : requested_extensions_last_parse) hash.add(ext);
+  hash.add(shared_object_locals.size());
+  for (const string &local : shared_object_locals) hash.add(local);
+  hash_members(hash, enigma_user);
+  hash_members(hash, global);
+  return hash.get();
+}
+
+ParseCache::Key script_key(ParseCache::Key signature, const string &code) {
+  return ParseHash().add(signature).add("script").add(code).get();
+}
+
+}  // namespace
+
 int lang_CPP::compile_parseAndLink(const GameData &game, CompileState &state) {
   auto &scripts = state.parsed_scripts;
   auto &tlines = state.parsed_tlines;
@@ -60,54 +168,47 @@ int lang_CPP::compile_parseAndLink(const GameData &game, CompileState &state) {
   for (const auto &script : game.scripts)
     script_names.insert(script.name);
 
-  // First we just parse the scripts to add semicolons and collect variable names
+  // Units whose code is unchanged since the last build are restored from the
+  // cache instead of being checked and parsed again.
+  const std::filesystem::path cache_file = codegen_directory/"parse_cache.dat";
+  const ParseCache::Key signature =
+      parse_signature(game, namespace_enigma_user, main_context->get_global());
+  ParseCache cache;
+  cache.load(cache_file, signature);
+
+  // First we just parse the scripts to add semicolons and collect variable names.
+  // Each one only writes its own record, so they are parsed in parallel.
   scripts.resize(game.scripts.size());
+  for (size_t i = 0; i < game.scripts.size(); i++)
+    scr_lookup[game.scripts[i].name] = scripts[i] = new ParsedScript;
+
+  vector<ParseResult> script_results(game.scripts.size());
+  vector<ParseCache::Key> script_keys(game.scripts.size());
+  parallel_for(game.scripts.size(), [&](size_t i) {
+    script_keys[i] = script_key(signature, game.scripts[i]->code());
+    if (!cache.restore(script_keys[i], scripts[i]))
+      script_results[i] = parse_script(game.scripts[i]->code(), scripts[i], script_names);
+  });
+
   for (size_t i = 0; i < game.scripts.size(); i++) {
-    std::string newcode;
-    int a = syncheck::syntaxcheck(game.scripts[i]->code(), newcode);
-    if (a != -1) {
+    const ParseResult &result = script_results[i];
+    if (result.error_pos != -1) {
       user << "Syntax error in script `" << game.scripts[i].name << "'\n"
-           << format_error(game.scripts[i]->code(), syncheck::syerr, a) << flushl;
+           << format_error(game.scripts[i]->code(), result.error, result.error_pos) << flushl;
       return E_ERROR_SYNTAX;
     }
-    // Keep a parsed record of this script
-    scr_lookup[game.scripts[i].name] = scripts[i] = new ParsedScript;
-    scripts[i]->code.code = newcode;
-    parser_main(&scripts[i]->code, script_names);
+    cache.store(script_keys[i], *scripts[i]);
     edbg << "Parsed `" << game.scripts[i].name << "': " << scripts[i]->scope.locals.size() << " locals, " << scripts[i]->scope.globals.size() << " globals" << flushl;
-
-    // If the script accesses variables from outside its scope implicitly
-    if (scripts[i]->scope.locals.size() or scripts[i]->scope.globallocals.size() or scripts[i]->scope.ambiguous.size()) {
-      // This is a neat hack to treat everything in the script as with().
-      // We make a temporary scope so that anything local to it is ignored, then
-      // ultimately throw it away.
-      // TODO: Looking at this now, I'm not sure if we actually want to throw
-      // locals away; what if a script explicitly declares `local var foo;`?
-      ParsedScope temporary_scope = *scripts[i]->code.my_scope;
-      scripts[i]->global_code = new ParsedCode(&temporary_scope);
-      scripts[i]->global_code->code =
-          string("with (self) {\n") + newcode + "\n/* */}";
-      parser_main(scripts[i]->global_code, script_names);
-      scripts[i]->global_code->my_scope = nullptr;
-    }
-    fflush(stdout);
   }
 
   // Next we just parse the timeline scripts to add semicolons and collect variable names
+  struct MomentSource { const string *timeline; int step; const string *code; };
+  vector<MomentSource> moment_sources;
   for (const auto &timeline : game.timelines)
   {
     tline_lookup[timeline.name].id = timeline.id();
     for (const auto &moment : timeline->moments())
     {
-      std::string newcode;
-      int a = syncheck::syntaxcheck(moment.code(), newcode);
-      if (a != -1) {
-        user << "Syntax error in timeline `" << timeline.name
-             << ", moment: " << moment.step() << "'\n"
-             << format_error(moment.code(), syncheck::syerr, a) << flushl;
-        return E_ERROR_SYNTAX;
-      }
-
       // Add a parsed_script record. We can retrieve this later; its order is well-defined (timeline i, moment j) and can be calculated with a global counter.
       // Note from 2019: yeah, we're not relying on that ordering anymore. Or at least, we're really gonna try not to.
       auto *tline = new ParsedScript();
@@ -115,28 +216,35 @@ int lang_CPP::compile_parseAndLink(const GameData &game, CompileState &state) {
       // Two places to log this.
       tlines.push_back(tline);
       tline_lookup[timeline.name].moments.emplace_back(moment.step(), tline);
+      moment_sources.push_back({&timeline.name, moment.step(), &moment.code()});
+    }
+  }
 
-      tline->code.code = newcode;
-      parser_main(&tline->code, script_names);
-      edbg << "Parsed `" << timeline.name << ", moment: "
-           << moment.step() << "': "
-           << tline->scope.locals.size() << " locals, "
-           << tline->scope.globals.size() << " globals" << flushl;
-
-      // If the timeline accesses variables from outside its scope implicitly
-      if (tline->scope.locals.size() or tline->scope.globallocals.size() or tline->scope.ambiguous.size()) {
-        // TODO: as above... except this whole func's redundant so just delete it.
-        // At some point, timelines should just be refactored into collections of scripts and a controller to call them.
-        // Or maybe into one big script made from a switch statement based on the current moment.
-        ParsedScope temporary_object = *tline->code.my_scope;
-        tline->global_code = new ParsedCode(&temporary_object);
-        tline->global_code->code =
-            string("with (self) {\n") + newcode + "\n/* */}";
-        parser_main(tline->global_code, script_names);
-        tline->global_code->my_scope = NULL;
-      }
-      fflush(stdout);
+  // TODO: as above... except this whole func's redundant so just delete it.
+  // At some point, timelines should just be refactored into collections of scripts and a controller to call them.
+  // Or maybe into one big script made from a switch statement based on the current moment.
+  vector<ParseResult> tline_results(tlines.size());
+  vector<ParseCache::Key> tline_keys(tlines.size());
+  parallel_for(tlines.size(), [&](size_t i) {
+    tline_keys[i] = script_key(signature, *moment_sources[i].code);
+    if (!cache.restore(tline_keys[i], tlines[i]))
+      tline_results[i] = parse_script(*moment_sources[i].code, tlines[i], script_names);
+  });
+
+  for (size_t i = 0; i < tlines.size(); i++) {
+    const MomentSource &source = moment_sources[i];
+    const ParseResult &result = tline_results[i];
+    if (result.error_pos != -1) {
+      user << "Syntax error in timeline `" << *source.timeline
+           << ", moment: " << source.step << "'\n"
+           << format_error(*source.code, result.error, result.error_pos) << flushl;
+      return E_ERROR_SYNTAX;
     }
+    cache.store(tline_keys[i], *tlines[i]);
+    edbg << "Parsed `" << *source.timeline << ", moment: "
+         << source.step << "': "
+         << tlines[i]->scope.locals.size() << " locals, "
+         << tlines[i]->scope.globals.size() << " globals" << flushl;
   }
 
   edbg << "\"Linking\" scripts" << flushl;
@@ -256,45 +364,76 @@ int lang_CPP::compile_parseAndLink(const GameData &game, CompileState &state) {
         object->persistent()
       ));
     parsed_object* pob = state.parsed_objects.back();
-
-    edbg << " " << object.name << ": " << object->legacy_events().size() << " events: " << flushl;
+    pob->parallel_step = object->parallel_step();
 
     if (object->egm_events_size() == 0 && object->legacy_events_size() != 0) {
       std::cerr << "Some asshole populated legacy_events and not egm_events.\n";
       abort();
     }
     for (const auto& event : object->egm_events()) {
-        // For each individual event (like begin_step) in the main event (Step), parse the code
-        ParsedEvent &pev = pob->all_events.emplace_back(evdata_.get_event(event), pob);
-
-        //Copy the code into a string, and its attributes elsewhere
-        string newcode = event.code();
-
-        //Syntax check the code
-
-        // Print debug info
-        edbg << "Check `" << object.name << "::" << pev.ev_id.TrueFunctionName() << "...";
-
-        // Check the code
-        int sc = syncheck::syntaxcheck(event.code(), newcode);
-        if (sc != -1) {
-          // Error. Report it.
-          user << "Syntax error in object `" << object.name << "', "
-               << pev.ev_id.HumanName() << " (" << event.DebugString() << "):\n"
-               << format_error(event.code(), syncheck::syerr, sc) << flushl;
-          return E_ERROR_SYNTAX;
-        }
+      // For each individual event (like begin_step) in the main event (Step), make a record
+      pob->all_events.emplace_back(evdata_.get_event(event), pob);
+    }
+  }
 
-        edbg << " Done. Parse...";
+  // Events of one object share its scope, so objects are parsed in parallel
+  // but each object's events are parsed in order.
+  const size_t first_object = state.parsed_objects.size() - game.objects.size();
+  const bool track_gotos = setting::compliance_mode != setting::COMPL_STANDARD;
+  vector<ParseResult> object_results(game.objects.size());
+  vector<ParseCache::Key> object_keys(game.objects.size());
+  parallel_for(game.objects.size(), [&](size_t i) {
+    const auto &object = game.objects[i];
+    parsed_object *pob = state.parsed_objects[first_object + i];
+    ParseResult &result = object_results[i];
+
+    ParseHash key;
+    key.add(signature).add("object").add(object->egm_events_size());
+    for (const auto &event : object->egm_events()) key.add(event.code());
+    object_keys[i] = key.get();
+    if (cache.restore(object_keys[i], pob)) return;
+
+    for (int e = 0; e < object->egm_events_size(); ++e) {
+      const auto &event = object->egm_events(e);
+      ParsedEvent &pev = pob->all_events[e];
+
+      //Copy the code into a string, and its attributes elsewhere
+      string newcode = event.code();
+
+      //Syntax check the code
+      result.error_pos = syncheck::syntaxcheck(event.code(), newcode);
+      if (result.error_pos != -1) {
+        result.error = syncheck::syerr;
+        result.unit = e;
+        return;
+      }
 
-        //Add this to our objects map
-        pev.code = newcode;
-        parser_main(&pev, script_names, setting::compliance_mode!=setting::COMPL_STANDARD); //Format it to C++
+      //Add this to our objects map
+      pev.code = newcode;
+      parser_main(&pev, script_names, track_gotos); //Format it to C++
+    }
+  });
 
-        edbg << " Done." << flushl;
+  for (size_t i = 0; i < game.objects.size(); i++) {
+    const auto &object = game.objects[i];
+    const parsed_object *pob = state.parsed_objects[first_object + i];
+    const ParseResult &result = object_results[i];
+    edbg << " " << object.name << ": " << object->legacy_events().size() << " events: " << flushl;
+    if (result.error_pos != -1) {
+      // Error. Report it.
+      const auto &event = object->egm_events(result.unit);
+      user << "Syntax error in object `" << object.name << "', "
+           << pob->all_events[result.unit].ev_id.HumanName() << " (" << event.DebugString() << "):\n"
+           << format_error(event.code(), result.error, result.error_pos) << flushl;
+      return E_ERROR_SYNTAX;
     }
+    cache.store(object_keys[i], *pob);
+    for (const ParsedEvent &pev : pob->all_events)
+      edbg << "  Parsed `" << object.name << "::" << pev.ev_id.TrueFunctionName() << "'" << flushl;
   }
 
+  cache.save(cache_file);
+
   // Index parsed objects by name for lookup from instance object_types.
   map<string, parsed_object*> parsed_objects;
   for (parsed_object *obj : state.parsed_objects)
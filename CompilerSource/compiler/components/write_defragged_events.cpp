@@ -34,6 +34,7 @@ using namespace std;
 
 #include "backend/GameData.h"
 #include "compiler/compile_common.h"
+#include "compiler/codegen_file.h"
 
 #include "event_reader/event_parser.h"
 #include "languages/lang_CPP.h"
@@ -42,7 +43,7 @@ using namespace std;
 int lang_CPP::compile_writeDefraggedEvents(
     const GameData &game, const std::set<EventGroupKey> &used_events,
     const ParsedObjectVec &parsed_objects) {
-  ofstream wto((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_evparent.h").u8string().c_str());
+  codegen_ofstream wto(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_evparent.h");
   wto << license;
 
   //Write timeline/moment names. Timelines are like scripts, but we don't have to worry about arguments or return types.
@@ -122,11 +123,16 @@ int lang_CPP::compile_writeDefraggedEvents(
   /* Now we writes an initializer function for the whole system. This allocates
   ** event iterator queue heads and populates some metadata for error reporting.
   *****************************************************************************/
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_events.h").u8string().c_str());
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_events.h");
   wto << license;
   wto << "namespace enigma" << endl << "{" << endl;
 
   // Start by defining storage locations for our event lists to iterate.
+  // Objects compiled apart from SHELLmain only link into these lists.
+  wto << "#ifdef ENIGMA_DECLARATIONS_ONLY" << endl;
+  for (const auto &event : used_events)
+    wto << "  extern event_iter *event_" << event.FunctionName() << ";" << endl;
+  wto << "#else" << endl;
   for (const auto &event : used_events)
     wto << "  event_iter *event_" << event.FunctionName() << ";" << endl;
 
@@ -139,6 +145,14 @@ int lang_CPP::compile_writeDefraggedEvents(
     if (obj->id > obj_high_id) obj_high_id = obj->id;
   }
   wto << "    objects = new objectid_base[" << (obj_high_id+1) << "]; // Allocated here; not really meant to change." << endl;
+  if (setting::profile_level != setting::PROFILE_NONE)
+    wto << "    profiler_initialize(" << used_events.size() << ", " << (obj_high_id+1) << ");" << endl;
+  bool any_parallel_step = false;
+  for (parsed_object *obj : parsed_objects) {
+    if (!obj->parallel_step) continue;
+    wto << "    parallel_step_set_object(" << obj->id << "); // " << obj->name << endl;
+    any_parallel_step = true;
+  }
 
   int ind = 0;
   for (const auto &event : used_events) {
@@ -159,6 +173,9 @@ int lang_CPP::compile_writeDefraggedEvents(
   if (game.settings.windowing().stay_on_top())
     wto << "    window_set_stayontop(true);" << endl;
 
+  if (setting::benchmark_build)
+    wto << "    enigma::benchmark_instrumented = true;" << endl;
+
   wto << "    return 0;" << endl;
   wto << "  }" << endl;
 
@@ -177,16 +194,37 @@ int lang_CPP::compile_writeDefraggedEvents(
   /* Now for the grand finale:  the actual event sequence.
   *****************************************************************************/
   wto << "  int ENIGMA_events()" << endl << "  {" << endl;
+  // Anything may have moved between frames; have the collision index check.
+  wto << "    enigma::collision_touch_all();" << endl << endl;
+  ind = 0;
   for (const EventGroupKey &event : used_events) {
+    const int event_index = ind++;
     if (!event.UsesEventLoop()) continue;
 
     string base_indent =  string(4, ' ');
+    // Benchmark builds time each event by its index in the events array.
+    if (setting::benchmark_build) {
+      wto << base_indent << "{\n"
+          << base_indent << "  enigma::benchmark_scope benchmark_timer(" << event_index << ");\n";
+      base_indent += "  ";
+    }
     bool callsubcheck =   event.HasSubCheck()   && !event.IsStacked();
     bool emitsupercheck = event.HasSuperCheck() && !event.IsStacked();
     const string fname =  event.FunctionName();
 
+    const bool profile = setting::profile_level != setting::PROFILE_NONE;
+    // Instances of objects marked for parallel Step are set aside by the loop
+    // and stepped together afterward.
+    const bool parallel = any_parallel_step && fname == "step" && !callsubcheck
+                       && !emitsupercheck && !event.HasDispatcher();
     if (((EventDescriptor&) event).HasInsteadCode()) {
-      wto << base_indent << event.InsteadCode();
+      if (profile) {
+        wto << base_indent << "{\n" << base_indent
+            << "  enigma::profiler_scope $profile_scope(enigma::profile_event, " << event_index << ");\n"
+            << base_indent << "  " << event.InsteadCode() << "\n" << base_indent << "}\n";
+      } else {
+        wto << base_indent << event.InsteadCode();
+      }
     } else {
       if (emitsupercheck) {
         if (event.HasSuperCheckExpression()) {
@@ -195,28 +233,59 @@ int lang_CPP::compile_writeDefraggedEvents(
           wto << base_indent << "if (myevent_" << fname + "_supercheck())\n";
         }
       }
+      if (parallel) {
+        wto << base_indent << "  enigma::parallel_step_begin();\n";
+      }
       wto <<   base_indent << "  for (instance_event_iterator = event_" << fname << "->next; instance_event_iterator != NULL; instance_event_iterator = instance_event_iterator->next) {\n";
+      if (parallel) {
+        wto << base_indent << "    if (enigma::parallel_step_claim(instance_event_iterator->inst)) continue;\n";
+      }
       if (callsubcheck) {
         wto << base_indent << "    if (((enigma::event_parent*)(instance_event_iterator->inst))->myevent_" << fname << "_subcheck()) {\n";
       }
 
-      // Invoke the actual event function (or its dispatcher).
+      // Invoke the actual event function (or its dispatcher), timing it by object if profiling.
+      if (profile) {
+        wto << base_indent << "      {\n" << base_indent
+            << "        enigma::profiler_scope $profile_scope(enigma::profile_event, " << event_index
+            << ", instance_event_iterator->inst->object_index);\n  ";
+      }
       wto <<   base_indent << "      ((enigma::event_parent*) (instance_event_iterator->inst))->myevent_" << fname;
       if (event.HasDispatcher()) {
         wto << "_dispatcher();\n";
       } else {
         wto << "();\n";
       }
+      if (profile) {
+        wto << base_indent << "      }\n";
+      }
 
       if (callsubcheck) {
         wto << base_indent << "    }\n";
       }
+      // The event may have moved the instance; let the collision system know.
+      wto <<   base_indent << "    enigma::collision_touch(instance_event_iterator->inst);\n";
       wto <<   base_indent << "    if (enigma::room_switching_id != -1) goto after_events;\n"
           <<   base_indent << "  }\n";
+      if (parallel) {
+        // The profiler can't follow the worker threads; time the batch as a whole.
+        if (profile) {
+          wto << base_indent << "  {\n" << base_indent
+              << "    enigma::profiler_scope $profile_scope(enigma::profile_event, " << event_index << ");\n  ";
+        }
+        wto << base_indent << "  enigma::parallel_step_run([](enigma::object_basic *inst) { "
+                              "((enigma::event_parent*) inst)->myevent_" << fname << "(); });\n";
+        if (profile) {
+          wto << base_indent << "  }\n";
+        }
+        wto << base_indent << "  if (enigma::room_switching_id != -1) goto after_events;\n";
+      }
     }
     wto <<     base_indent << endl
-        <<     base_indent << "enigma::update_globals();" << endl
-        <<     base_indent << endl;
+        <<     base_indent << "enigma::update_globals();" << endl;
+    if (setting::benchmark_build)
+      wto << string(4, ' ') << "}" << endl;
+    wto <<     base_indent << endl;
   }
   wto << "    after_events:" << endl;
   if (game.settings.shortcuts().let_escape_end_game())
@@ -239,9 +308,22 @@ int lang_CPP::compile_writeDefraggedEvents(
   wto << "    " << endl;
   wto << "    return 0;" << endl;
   wto << "  } // event function" << endl;
+  wto << "#endif" << endl;
 
   // Done, end the namespace
   wto << "} // namespace enigma" << endl;
+
+  // Benchmark builds also count every allocation the game makes.
+  if (setting::benchmark_build) {
+    wto << "\n#ifndef ENIGMA_DECLARATIONS_ONLY\n"
+           "void *operator new(std::size_t size) { return enigma::benchmark_allocate(size); }\n"
+           "void *operator new[](std::size_t size) { return enigma::benchmark_allocate(size); }\n"
+           "void operator delete(void *ptr) noexcept { enigma::benchmark_free(ptr); }\n"
+           "void operator delete[](void *ptr) noexcept { enigma::benchmark_free(ptr); }\n"
+           "void operator delete(void *ptr, std::size_t) noexcept { enigma::benchmark_free(ptr); }\n"
+           "void operator delete[](void *ptr, std::size_t) noexcept { enigma::benchmark_free(ptr); }\n"
+           "#endif\n";
+  }
   wto.close();
 
   return 0;
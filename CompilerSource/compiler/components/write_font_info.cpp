@@ -29,6 +29,7 @@
 
 #include "backend/GameData.h"
 #include "compiler/compile_common.h"
+#include "compiler/codegen_file.h"
 #include "languages/lang_CPP.h"
 
 #include <cstdio>
@@ -40,7 +41,7 @@ using namespace std;
 
 int lang_CPP::compile_writeFontInfo(const GameData &game)
 {
-  ofstream wto((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_fontinfo.h").u8string().c_str(),ios_base::out);
+  codegen_ofstream wto(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_fontinfo.h");
   wto << license
       << "#ifndef JUST_DEFINE_IT_RUN" << endl
       << "#undef INCLUDED_FROM_SHELLMAIN" << endl
@@ -39,6 +39,7 @@ using namespace std;
 
 #include "backend/GameData.h"
 #include "compiler/compile_common.h"
+#include "compiler/codegen_file.h"
 
 #include "languages/lang_CPP.h"
 
@@ -61,11 +62,25 @@ static string esc(const string &str) {
 int lang_CPP::compile_writeGlobals(const GameData &game,
                                    const ParsedScope* global,
                                    const DotLocalMap &dot_accessed_locals) {
-  ofstream wto;
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_globals.h").u8string().c_str(),ios_base::out);
+  codegen_ofstream wto;
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_globals.h");
   wto << license;
 
+  // Units of game code other than SHELLmain see these variables declared,
+  // but not defined; only SHELLmain needs the settings at all.
+  wto << "#ifdef ENIGMA_DECLARATIONS_ONLY\n";
   global_script_argument_count=16; //write all 16 arguments
+  if (global_script_argument_count) {
+    wto << "extern variant argument0";
+    for (int i = 1; i < global_script_argument_count; i++)
+      wto << ", argument" << i;
+    wto << ";\n";
+  }
+  wto << "namespace enigma_user { extern unsigned int game_id; }\n";
+  for (parsed_object::cglobit i = global->globals.begin(); i != global->globals.end(); i++)
+    wto << "extern " << i->second.type << " " << i->second.prefix << i->first << i->second.suffix << ";" << endl;
+  wto << "#else\n\n";
+
   if (global_script_argument_count) {
     wto << "// Script arguments\n";
     wto << "variant argument0 = 0";
@@ -80,12 +95,6 @@ int lang_CPP::compile_writeGlobals(const GameData &game,
       << endl;
   wto << "}" << endl <<endl;
 
-  wto << "namespace enigma_user {" << endl;
-  for (size_t i = 0; i < game.constants.size(); i++) {
-    const GameData::Constant &con = game.constants[i];
-    wto << "  #define " << con.name << " (" << con.value <<")" << endl;
-  }
-  wto << "}" << endl;
 
   const auto &csets = game.settings.compiler();
   const auto &gsets = game.settings.graphics();
@@ -129,13 +138,25 @@ int lang_CPP::compile_writeGlobals(const GameData &game,
   //This part needs written into a global object_parent class instance elsewhere.
   //for (globit i = global->dots.begin(); i != global->globals.end(); i++)
   //  wto << i->second->type << " " << i->second->prefixes << i->second->name << i->second->suffixes << ";" << endl;
-  wto << endl;
+  wto << "#endif" << endl << endl;
+
+  wto << "namespace enigma_user {" << endl;
+  for (size_t i = 0; i < game.constants.size(); i++) {
+    const GameData::Constant &con = game.constants[i];
+    wto << "  #define " << con.name << " (" << con.value <<")" << endl;
+  }
+  wto << "}" << endl;
 
   wto << "namespace enigma" << endl << "{" << endl << "  struct ENIGMA_global_structure: object_locals" << endl << "  {" << endl;
   for (decciter i = dot_accessed_locals.begin(); i != dot_accessed_locals.end(); i++) // Dots are vars that are accessed as something.varname.
     wto << "    " << i->second.type << " " << i->second.prefix << i->first << i->second.suffix << ";" << endl;
 
-  wto << "    ENIGMA_global_structure(const int _x, const int _y): object_locals(_x,_y) {}" << endl << "  };" << endl << "  object_basic *ENIGMA_global_instance = new ENIGMA_global_structure(global,global);" << endl << "}";
+  wto << "    ENIGMA_global_structure(const int _x, const int _y): object_locals(_x,_y) {}" << endl << "  };" << endl;
+  wto << "#ifdef ENIGMA_DECLARATIONS_ONLY" << endl;
+  wto << "  extern object_basic *ENIGMA_global_instance;" << endl;
+  wto << "#else" << endl;
+  wto << "  object_basic *ENIGMA_global_instance = new ENIGMA_global_structure(global,global);" << endl;
+  wto << "#endif" << endl << "}";
   wto << endl;
   wto.close();
   return 0;
@@ -38,6 +38,7 @@ using namespace std;
 
 #include "backend/GameData.h"
 #include "compiler/compile_common.h"
+#include "compiler/codegen_file.h"
 #include "event_reader/event_parser.h"
 #include "parser/object_storage.h"
 
@@ -68,16 +69,28 @@ string REFERENCE_POSTFIX(string ref) {
 struct usedtype { int uc; dectrip original; usedtype(): uc(0) {} }; // uc is the use count, then after polling, the dummy number.
 int lang_CPP::compile_writeObjAccess(const ParsedObjectVec &parsed_objects, const DotLocalMap &dot_accessed_locals, const ParsedScope *global, bool treatUninitAs0)
 {
-  ofstream wto;
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_objectaccess.h").u8string().c_str(),ios_base::out);
+  codegen_ofstream wto;
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_objectaccess.h");
   wto << license;
   wto << "// Depending on how many times your game accesses variables via OBJECT.varname, this file may be empty." << endl << endl;
   wto << "namespace enigma" << endl << "{" << endl;
 
+  // Other units of game code only need to call the accessors.
+  wto << "#ifdef ENIGMA_DECLARATIONS_ONLY" << endl;
+  wto << "  extern object_locals ldummy;" << endl;
+  wto << "  object_locals *glaccess(int x);" << endl;
+  wto << "  var &map_var(std::map<string, var> **vmap, string str);" << endl;
+  for (auto dait = dot_accessed_locals.begin(); dait != dot_accessed_locals.end(); dait++)
+    wto << "  " << dait->second.type << " " << dait->second.prefix << REFERENCE_POSTFIX(dait->second.suffix) << " &varaccess_" << dait->first << "(int x);" << endl;
+  wto << "#else" << endl;
+
   wto <<
   "  object_locals ldummy;" << endl <<
   "  object_locals *glaccess(int x)" << endl <<
-  "  {" << endl << "    object_locals* ri = (object_locals*)fetch_instance_by_int(x);" << endl << "    return ri ? ri : &ldummy;" << endl << "  }" << endl << endl;
+  "  {" << endl << "    object_locals* ri = (object_locals*)fetch_instance_by_int(x);" << endl <<
+  "    if (!ri) return &ldummy;" << endl <<
+  "    collision_touch(ri); // The caller may be about to move it" << endl <<
+  "    return ri;" << endl << "  }" << endl << endl;
 
   wto <<
   "  var &map_var(std::map<string, var> **vmap, string str)" << endl <<
@@ -141,6 +154,7 @@ int lang_CPP::compile_writeObjAccess(const ParsedObjectVec &parsed_objects, cons
     wto << "    return dummy_" << usedtypes[dait->second.type + " " + dait->second.prefix + dait->second.suffix].uc << ";" << endl;
     wto << "  }" << endl;
   }
+  wto << "#endif" << endl;
   wto << "} // namespace enigma" << endl;
   wto.close();
   return 0;
@@ -21,6 +21,7 @@
 #include "parser/parser.h"
 #include "backend/GameData.h"
 #include "compiler/compile_common.h"
+#include "compiler/codegen_file.h"
 #include "event_reader/event_parser.h"
 #include "general/parse_basics_old.h"
 #include "settings.h"
@@ -31,6 +32,8 @@
 #include <fstream>
 #include <algorithm>
 #include <vector>
+#include <set>
+#include <filesystem>
 
 using namespace std;
 
@@ -85,7 +88,7 @@ static inline void declare_extension_casts(std::ostream &wto,
   wto << "  namespace extension_cast {\n";
   for (unsigned i = 0; i < parsed_extensions.size(); i++) {
     if (!parsed_extensions[i].implements.empty()) {
-      wto << "    " << parsed_extensions[i].implements << " *as_" << parsed_extensions[i].implements << "(object_basic* x) {\n";
+      wto << "    inline " << parsed_extensions[i].implements << " *as_" << parsed_extensions[i].implements << "(object_basic* x) {\n";
       wto << "      return (" << parsed_extensions[i].implements << "*)(object_locals*)x;\n";
       wto << "    }\n";
     }
@@ -95,7 +98,7 @@ static inline void declare_extension_casts(std::ostream &wto,
 
 static inline void declare_object_locals_class(std::ostream &wto,
     const ParsedExtensionVec &parsed_extensions) {
-  wto << "  extern std::map<int,object_basic*> instance_deactivated_list;\n";
+  wto << "  extern instance_table<object_basic*> instance_deactivated_list;\n";
   wto << "  extern objectstruct** objectdata;\n\n";
 
   wto << "  struct object_locals: event_parent";
@@ -124,7 +127,7 @@ static inline void write_extension_casts(std::ostream &wto,
   wto << "  namespace extension_cast {\n";
   for (unsigned i = 0; i < parsed_extensions.size(); i++) {
     if (!parsed_extensions[i].implements.empty()) {
-      wto << "    " << parsed_extensions[i].implements << " *as_" << parsed_extensions[i].implements << "(object_basic* x) {\n";
+      wto << "    inline " << parsed_extensions[i].implements << " *as_" << parsed_extensions[i].implements << "(object_basic* x) {\n";
       wto << "      return (" << parsed_extensions[i].implements << "*)(object_locals*)x;\n";
       wto << "    }\n";
     }
@@ -349,7 +352,7 @@ static void write_object_events(std::ostream &wto, parsed_object *object) {
     if (!pev.code.empty() || pev.ev_id.HasDefaultCode()) {
       wto << "    variant myevent_" << evname << "();\n";
       if (pev.ev_id.HasSubCheck()) {
-        wto << "    inline bool myevent_" << evname << "_subcheck();\n";
+        wto << "    bool myevent_" << evname << "_subcheck();\n";
       }
     }
   }
@@ -601,6 +604,12 @@ static void write_object_destructor(std::ostream &wto, parsed_object *object) {
   wto << "    virtual bool can_cast(int obj) const;\n";
 }
 
+static void write_object_allocator(std::ostream &wto, parsed_object *object) {
+  // Instances of each object come from a pool of their own; see instance_pool.h.
+  wto << "    static void *operator new(size_t size) { return enigma::instance_alloc(" << object->id << ", size); }\n";
+  wto << "    static void operator delete(void *block, size_t size) { enigma::instance_free(" << object->id << ", block, size); }\n";
+}
+
 static void write_object_class_body(parsed_object* object, language_adapter *lang, std::ostream &wto, const GameData &game, const CompileState &state) {
   wto << "  \n  struct OBJ_" << object->name;
   if (object->parent) {
@@ -620,6 +629,7 @@ static void write_object_class_body(parsed_object* object, language_adapter *lan
   write_object_unlink(wto, object);
   write_object_constructors(wto, object);
   write_object_destructor(wto, object);
+  write_object_allocator(wto, object);
 
   wto << "  };\n";
 }
@@ -674,11 +684,13 @@ static inline void write_object_data_structs(std::ostream &wto,
 // -----------------------------------------------------------------------------
 static inline void write_object_declarations(
     lang_CPP* lcpp, const GameData &game, const CompileState &state) {
-  ofstream wto;
-  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_objectdeclarations.h",ios_base::out);
+  codegen_ofstream wto;
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_objectdeclarations.h");
   wto << license;
   wto << "#include \"Universal_System/Object_Tiers/collisions_object.h\"\n";
-  wto << "#include \"Universal_System/Object_Tiers/object.h\"\n\n";
+  wto << "#include \"Universal_System/Object_Tiers/object.h\"\n";
+  wto << "#include \"Universal_System/Instances/instance_table.h\"\n";
+  wto << "#include \"Universal_System/Instances/instance_pool.h\"\n\n";
   wto << "#include <map>";
 
   declare_scripts(wto, game, state);
@@ -696,42 +708,95 @@ static inline void write_object_declarations(
   write_object_class_bodies(lcpp, wto, game, state);
   wto << "}\n\n";
 
+  wto << "#ifndef ENIGMA_DECLARATIONS_ONLY\n";
   wto << "namespace enigma {\n";
   write_object_data_structs(wto, state.parsed_objects);
   wto << "}\n";
+  wto << "#endif\n";
   wto.close();
 }
 
-static inline void write_script_implementations(ofstream& wto, const GameData &game, const CompileState &state, int mode);
-static inline void write_timeline_implementations(ofstream& wto, const GameData &game, const CompileState &state);
-static inline void write_event_bodies(ofstream& wto, const GameData &game, int mode, const ParsedObjectVec &parsed_objects, const ScriptLookupMap &script_lookup, const TimelineLookupMap &timeline_lookup);
-static inline void write_global_script_array(ofstream &wto, const GameData &game, const CompileState &state);
-static inline void write_basic_constructor(ofstream &wto);
+static inline void write_script_implementations(std::ostream& wto, const GameData &game, const CompileState &state, int mode);
+static inline void write_timeline_implementations(std::ostream& wto, const GameData &game, const CompileState &state);
+static inline void write_event_bodies(std::ostream& wto, const GameData &game, int mode, const ParsedObjectVec &parsed_objects, const ScriptLookupMap &script_lookup, const TimelineLookupMap &timeline_lookup);
+static void write_object_body(std::ostream& wto, const GameData &game, int mode, const parsed_object *obj, const ScriptLookupMap &script_lookup, const TimelineLookupMap &timeline_lookup);
+static inline void write_global_script_array(std::ostream &wto, const GameData &game, const CompileState &state);
+static inline void write_basic_constructor(std::ostream &wto);
 
 // [ CODEGEN FILE ] ------------------------------------------------------------
 // Object functionality: implements event routines and scripts declared earlier.
 // -----------------------------------------------------------------------------
-static inline void write_object_functionality(
-    const GameData &game, const CompileState &state, int mode) {
-  vector<unsigned> parent_undefined;
-  ofstream wto((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_objectfunctionality.h").u8string().c_str(),ios_base::out);
-
-  wto << license;
+static inline void write_log_xor(std::ostream &wto) {
   wto << endl << "#define log_xor || log_xor_helper() ||" << endl;
   wto << "struct log_xor_helper { bool value; };" << endl;
   wto << "template<typename LEFT> log_xor_helper operator ||(const LEFT &left, const log_xor_helper &xorh) { log_xor_helper nxor; nxor.value = (bool)left; return nxor; }" << endl;
   wto << "template<typename RIGHT> bool operator ||(const log_xor_helper &xorh, const RIGHT &right) { return xorh.value ^ (bool)right; }" << endl << endl;
+}
+
+// [ CODEGEN FILE ] ------------------------------------------------------------
+// Object functionality: implements event routines and scripts declared earlier.
+// Event routines go here only when objects are not written as units of their
+// own (see write_object_units).
+// -----------------------------------------------------------------------------
+static inline void write_object_functionality(
+    const GameData &game, const CompileState &state, int mode, bool split) {
+  vector<unsigned> parent_undefined;
+  codegen_ofstream wto(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_objectfunctionality.h");
+
+  wto << license;
+  write_log_xor(wto);
 
   write_script_implementations(wto, game, state, mode);
   write_timeline_implementations(wto, game, state);
-  write_event_bodies(wto, game, mode, state.parsed_objects, state.script_lookup, state.timeline_lookup);
+  if (!split)
+    write_event_bodies(wto, game, mode, state.parsed_objects, state.script_lookup, state.timeline_lookup);
   write_global_script_array(wto, game, state);
   write_basic_constructor(wto);
 
   wto.close();
 }
 
-static inline void write_script_implementations(ofstream& wto, const GameData &game, const CompileState &state, int mode) {
+// [ CODEGEN FILES ] -----------------------------------------------------------
+// Object units: one source file per object, holding its event routines, so
+// that make only recompiles the objects whose code changed. These are built
+// against SHELLmain.h with ENIGMA_DECLARATIONS_ONLY, so the generated headers
+// only declare what SHELLmain defines. Units left over from objects that no
+// longer exist (or from a split build, when !split) are removed.
+// -----------------------------------------------------------------------------
+static inline void write_object_units(
+    const GameData &game, const CompileState &state, int mode, bool split) {
+  const std::filesystem::path dir = codegen_directory/"Preprocessor_Environment_Editable/Objects";
+  std::filesystem::create_directories(dir);
+
+  set<std::filesystem::path> units;
+  if (split) for (const parsed_object *obj : state.parsed_objects) {
+    const std::filesystem::path unit = dir/("OBJ_" + obj->name + ".cpp");
+    codegen_ofstream wto(unit);
+    wto << license;
+    wto << "#define ENIGMA_DECLARATIONS_ONLY 1\n";
+    wto << "#include \"SHELLmain.h\"\n";
+    write_log_xor(wto);
+    write_object_body(wto, game, mode, obj, state.script_lookup, state.timeline_lookup);
+    units.insert(unit);
+  }
+
+  for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+    if (!units.count(entry.path()))
+      std::filesystem::remove(entry.path());
+  }
+}
+
+// Definitions the user typed into the IDE are pasted into SHELLmain.h, and
+// would be defined once per object unit; games with any fall back to
+// implementing every object in SHELLmain.
+static inline bool has_user_definitions() {
+  std::error_code ec;
+  auto size = std::filesystem::file_size(
+      codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_whitespace.h", ec);
+  return !ec && size;
+}
+
+static inline void write_script_implementations(std::ostream& wto, const GameData &game, const CompileState &state, int mode) {
   // Export globalized scripts
   for (size_t i = 0; i < game.scripts.size(); i++) {
     ParsedScript* scr = state.script_lookup.at(game.scripts[i].name);
@@ -745,6 +810,9 @@ static inline void write_script_implementations(ofstream& wto, const GameData &g
     if (mode == emode_debug) {
       wto << "  enigma::debug_scope $current_scope(\"script '" << game.scripts[i].name << "'\");\n";
     }
+    if (setting::profile_level == setting::PROFILE_SCRIPTS) {
+      wto << "  enigma::profiler_scope $profile_scope(enigma::profile_script, " << game.scripts[i].id() << ");\n";
+    }
     wto << "  ";
     ParsedCode &upev = scr->global_code ? *scr->global_code : scr->code;
 
@@ -765,7 +833,7 @@ static inline void write_script_implementations(ofstream& wto, const GameData &g
   }
 }
 
-static inline void write_timeline_implementations(ofstream& wto, const GameData &game, const CompileState &state) {
+static inline void write_timeline_implementations(std::ostream& wto, const GameData &game, const CompileState &state) {
   // Export globalized timelines.
   // TODO: Is there such a thing as a localized timeline?
   (void) game;  // XXX: why the hell is this needed for everything but timelines?
@@ -791,35 +859,41 @@ static inline void write_timeline_implementations(ofstream& wto, const GameData
   }
 }
 
-static void write_event_func(ofstream& wto, const ParsedEvent &event, string objname, string evname, int mode);
-static void write_object_event_funcs(ofstream& wto, const parsed_object *const object, int mode);
-static void write_object_script_funcs(ofstream& wto, const parsed_object *const t, const ScriptLookupMap &script_lookup);
-static void write_object_timeline_funcs(ofstream& wto, const GameData &game, const parsed_object *const t, const TimelineLookupMap &timeline_lookup);
-static void write_can_cast_func(ofstream& wto, const parsed_object *const pobj);
+static void write_event_func(std::ostream& wto, const ParsedEvent &event, string objname, string evname, int mode);
+static void write_object_event_funcs(std::ostream& wto, const parsed_object *const object, int mode);
+static void write_object_script_funcs(std::ostream& wto, const GameData &game, const parsed_object *const t, const ScriptLookupMap &script_lookup);
+static void write_object_timeline_funcs(std::ostream& wto, const GameData &game, const parsed_object *const t, const TimelineLookupMap &timeline_lookup);
+static void write_can_cast_func(std::ostream& wto, const parsed_object *const pobj);
 
 static void write_event_bodies(
-    ofstream& wto, const GameData &game, int mode,
+    std::ostream& wto, const GameData &game, int mode,
     const ParsedObjectVec &parsed_objects, const ScriptLookupMap &script_lookup,
     const TimelineLookupMap &timeline_lookup) {
-  for (const auto *obj : parsed_objects) {
-    // Write infrastructure to trigger grouped events (stacked/dispatched)
-    implement_event_groups(wto, obj);
+  for (const auto *obj : parsed_objects)
+    write_object_body(wto, game, mode, obj, script_lookup, timeline_lookup);
+}
 
-    // Write the user-defined event implementations.
-    write_object_event_funcs(wto, obj, mode);
+static void write_object_body(
+    std::ostream& wto, const GameData &game, int mode,
+    const parsed_object *obj, const ScriptLookupMap &script_lookup,
+    const TimelineLookupMap &timeline_lookup) {
+  // Write infrastructure to trigger grouped events (stacked/dispatched)
+  implement_event_groups(wto, obj);
 
-    // Write local object copies of scripts
-    write_object_script_funcs(wto, obj, script_lookup);
+  // Write the user-defined event implementations.
+  write_object_event_funcs(wto, obj, mode);
 
-    // Write local object copies of timelines
-    write_object_timeline_funcs(wto, game, obj, timeline_lookup);
+  // Write local object copies of scripts
+  write_object_script_funcs(wto, game, obj, script_lookup);
 
-    //Write the required "can_cast()" function.
-    write_can_cast_func(wto, obj);
-  }
+  // Write local object copies of timelines
+  write_object_timeline_funcs(wto, game, obj, timeline_lookup);
+
+  //Write the required "can_cast()" function.
+  write_can_cast_func(wto, obj);
 }
 
-static void write_object_event_funcs(ofstream& wto, const parsed_object *const object, int mode) {
+static void write_object_event_funcs(std::ostream& wto, const parsed_object *const object, int mode) {
   for (const ParsedEvent &event : object->all_events) {
     string evname = event.ev_id.TrueFunctionName();
 
@@ -846,7 +920,7 @@ static void write_object_event_funcs(ofstream& wto, const parsed_object *const o
 
     if (event.ev_id.HasSubCheck()) {
       // Write event sub check code
-      wto << "inline bool enigma::OBJ_" << object->name
+      wto << "bool enigma::OBJ_" << object->name
           << "::myevent_" << evname << "_subcheck() ";
       if (event.ev_id.HasSubCheckFunction()) {
         wto << event.ev_id.SubCheckFunction();
@@ -858,7 +932,7 @@ static void write_object_event_funcs(ofstream& wto, const parsed_object *const o
   }
 }
 
-static void write_event_func(ofstream& wto, const ParsedEvent &event, string objname, string evname, int mode) {
+static void write_event_func(std::ostream& wto, const ParsedEvent &event, string objname, string evname, int mode) {
   std::string evfuncname = "myevent_" + evname;
   wto << "variant enigma::OBJ_" << objname << "::" << evfuncname << "()\n{\n";
   if (mode == emode_debug) {
@@ -874,7 +948,7 @@ static void write_event_func(ofstream& wto, const ParsedEvent &event, string obj
   wto << "\n  return 0;\n}\n\n";
 }
 
-static inline void write_object_script_funcs(ofstream& wto, const parsed_object *const t, const ScriptLookupMap &script_lookup) {
+static inline void write_object_script_funcs(std::ostream& wto, const GameData &game, const parsed_object *const t, const ScriptLookupMap &script_lookup) {
   for (parsed_object::const_funcit it = t->funcs.begin(); it != t->funcs.end(); ++it) { // For each function called by this object
     auto subscr = script_lookup.find(it->first); // Check if it's a script
     if (subscr != script_lookup.end() // If we've got ourselves a script
@@ -888,14 +962,20 @@ static inline void write_object_script_funcs(ofstream& wto, const parsed_object
       }
 
       wto << ")\n{\n  ";
+      if (setting::profile_level == setting::PROFILE_SCRIPTS) {
+        for (const auto &script : game.scripts) {
+          if (script.name == it->first)
+            wto << "enigma::profiler_scope $profile_scope(enigma::profile_script, " << script.id() << ");\n  ";
+        }
+      }
       print_to_file(subscr->second->code.code,subscr->second->code.synt,subscr->second->code.strc,subscr->second->code.strs,2,wto);
       wto << "\n  return 0;\n}\n\n";
     }
   }
 }
 
-static inline void write_known_timelines(ofstream& wto, const GameData &game, const parsed_object *const t, const TimelineLookupMap &timeline_lookup);
-static inline void write_object_timeline_funcs(ofstream& wto, const GameData &game, const parsed_object *const t, const TimelineLookupMap &timeline_lookup) {
+static inline void write_known_timelines(std::ostream& wto, const GameData &game, const parsed_object *const t, const TimelineLookupMap &timeline_lookup);
+static inline void write_object_timeline_funcs(std::ostream& wto, const GameData &game, const parsed_object *const t, const TimelineLookupMap &timeline_lookup) {
   bool hasKnownTlines = false;
   for (parsed_object::const_tlineit it = t->tlines.begin(); it != t->tlines.end(); ++it) { //For each timeline potentially set by this object
     auto timit = timeline_lookup.find(it->first); //Check if it's a timeline
@@ -919,7 +999,7 @@ static inline void write_object_timeline_funcs(ofstream& wto, const GameData &ga
   }
 }
 
-static inline void write_known_timelines(ofstream& wto, const GameData &game, const parsed_object *const t, const TimelineLookupMap &timeline_lookup) {
+static inline void write_known_timelines(std::ostream& wto, const GameData &game, const parsed_object *const t, const TimelineLookupMap &timeline_lookup) {
   (void) game;  // XXX: why the hell is this needed for everything but timelines?
   wto << "void enigma::OBJ_" << t->name << "::timeline_call_moment_script(int timeline_index, int moment_index) {\n";
   wto << "  switch (timeline_index) {\n";
@@ -946,7 +1026,7 @@ static inline void write_known_timelines(ofstream& wto, const GameData &game, co
   wto << "}\n\n";
 }
 
-static inline void write_can_cast_func(ofstream& wto, const parsed_object *const pobj) {
+static inline void write_can_cast_func(std::ostream& wto, const parsed_object *const pobj) {
   wto << "bool enigma::OBJ_" << pobj->name << "::can_cast(int obj) const {\n";
   bool written = false;
   wto << "  return ";
@@ -959,7 +1039,7 @@ static inline void write_can_cast_func(ofstream& wto, const parsed_object *const
   wto << ";\n" << "}\n\n";
 }
 
-static inline void write_global_script_array(ofstream &wto, const GameData &game, const CompileState &state) {
+static inline void write_global_script_array(std::ostream &wto, const GameData &game, const CompileState &state) {
   wto << "namespace enigma\n{\n"
   "  std::vector<callable_script> callable_scripts = {\n";
   int scr_count = 0;
@@ -977,7 +1057,7 @@ static inline void write_global_script_array(ofstream &wto, const GameData &game
   wto << "  };\n  \n";
 }
 
-static inline void write_basic_constructor(ofstream &wto) {
+static inline void write_basic_constructor(std::ostream &wto) {
   wto <<
       "  void constructor(object_basic* instance_b) {\n"
       "    //This is the universal create event code\n"
@@ -1012,7 +1092,9 @@ static inline void write_basic_constructor(ofstream &wto) {
 }
 
 int lang_CPP::compile_writeObjectData(const GameData &game, const CompileState &state, int mode) {
+  const bool split = !has_user_definitions();
   write_object_declarations(this, game, state);
-  write_object_functionality(game, state, mode);
+  write_object_functionality(game, state, mode, split);
+  write_object_units(game, state, mode, split);
   return 0;
 }
@@ -42,6 +42,7 @@ using namespace std;
 #include "backend/GameData.h"
 #include "parser/object_storage.h"
 #include "compiler/compile_common.h"
+#include "compiler/codegen_file.h"
 
 #include <math.h> //log2 to calculate passes.
 
@@ -62,7 +63,7 @@ inline string resname(string name) {
 
 int lang_CPP::compile_writeRoomData(const GameData &game, const ParsedRoomVec &parsed_rooms, ParsedScope *EGMglobal, int mode)
 {
-  ofstream wto((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_roomarrays.h").u8string().c_str(),ios_base::out);
+  codegen_ofstream wto(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_roomarrays.h");
 
   wto << license << "namespace enigma {\n"
   << "  int room_loadtimecount = " << game.rooms.size() << ";\n";
@@ -196,7 +197,7 @@ int lang_CPP::compile_writeRoomData(const GameData &game, const ParsedRoomVec &p
   wto.close();
 
 
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_roomcreates.h").u8string().c_str(),ios_base::out);
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_roomcreates.h");
   wto << license;
 
   wto << "namespace enigma {\n\n";
@@ -0,0 +1,53 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "resource_codec.h"
+#include "resource_format.h"
+#include "lz4/lz4block.h"
+
+#include <zlib.h>
+
+using namespace enigma::resource_format;
+
+std::vector<uint8_t> decode_image(const std::vector<uint8_t> &zlib_data, size_t unpacked) {
+  std::vector<uint8_t> pixels(unpacked);
+  uLongf size = unpacked;
+  if (uncompress(pixels.data(), &size, zlib_data.data(), zlib_data.size()) != Z_OK || size != unpacked)
+    return std::vector<uint8_t>();
+  return pixels;
+}
+
+std::vector<uint8_t> encode_pixels(const std::vector<uint8_t> &pixels, int codec) {
+  if (codec == CODEC_RAW) return pixels;
+  if (codec == CODEC_ZLIB) {
+    uLongf size = compressBound(pixels.size());
+    std::vector<uint8_t> packed(size);
+    compress(packed.data(), &size, pixels.data(), pixels.size());
+    packed.resize(size);
+    return packed;
+  }
+  std::vector<uint8_t> packed(enigma::lz4::compress_bound(pixels.size()));
+  packed.resize(enigma::lz4::compress(pixels.data(), pixels.size(), packed.data()));
+  return packed;
+}
+
+std::vector<uint8_t> encode_image(const std::vector<uint8_t> &zlib_data, size_t unpacked, int codec) {
+  if (codec == CODEC_ZLIB) return zlib_data;
+  std::vector<uint8_t> pixels = decode_image(zlib_data, unpacked);
+  if (pixels.empty()) return pixels;
+  return encode_pixels(pixels, codec);
+}
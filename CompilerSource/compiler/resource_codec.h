@@ -0,0 +1,36 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_RESOURCE_CODEC_H
+#define ENIGMA_RESOURCE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Inflates image data, which the IDE and loaders hand over zlib-compressed.
+// Returns an empty vector if it does not inflate to the expected size.
+std::vector<uint8_t> decode_image(const std::vector<uint8_t> &zlib_data, size_t unpacked);
+
+// Packs raw pixels with the given codec (see resource_format::Codec).
+std::vector<uint8_t> encode_pixels(const std::vector<uint8_t> &pixels, int codec);
+
+// Repacks zlib-compressed image data with the given codec. Returns an empty
+// vector if the data does not inflate to the expected size.
+std::vector<uint8_t> encode_image(const std::vector<uint8_t> &zlib_data, size_t unpacked, int codec);
+
+#endif
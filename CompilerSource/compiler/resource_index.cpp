@@ -0,0 +1,66 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "resource_index.h"
+
+using namespace enigma::resource_format;
+
+static void writei(int x, FILE *f) {
+  fwrite(&x,4,1,f);
+}
+
+ResourceIndex::ResourceIndex(FILE *module): module_(module), start_(ftell(module)) {}
+
+int ResourceIndex::offset() const {
+  return int(ftell(module_) - start_);
+}
+
+void ResourceIndex::begin(int kind, int id, int codec) {
+  entries_.push_back({kind, id, offset(), 0, codec});
+}
+
+void ResourceIndex::end() {
+  entries_.back().size = offset() - entries_.back().offset;
+}
+
+void ResourceIndex::add_room(int id, const std::vector<std::pair<int, int>> &assets) {
+  rooms_.push_back({id, assets});
+}
+
+int ResourceIndex::write(int flags) {
+  const int pos = offset();
+  writei(kind("IDX "), module_);
+  writei(flags, module_);
+  writei(entries_.size(), module_);
+  for (const Entry &e : entries_) {
+    writei(e.kind, module_);
+    writei(e.id, module_);
+    writei(e.offset, module_);
+    writei(e.size, module_);
+    writei(e.codec, module_);
+  }
+  writei(rooms_.size(), module_);
+  for (const Room &room : rooms_) {
+    writei(room.id, module_);
+    writei(room.assets.size(), module_);
+    for (const auto &asset : room.assets) {
+      writei(asset.first, module_);
+      writei(asset.second, module_);
+    }
+  }
+  return pos;
+}
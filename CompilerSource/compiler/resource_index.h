@@ -0,0 +1,55 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_RESOURCE_INDEX_H
+#define ENIGMA_RESOURCE_INDEX_H
+
+#include "resource_format.h"
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+// Collects the index of the resource data while it is written; see
+// shared/resource_format.h for the layout.
+class ResourceIndex {
+ public:
+  // The data starts at the current position of the module.
+  explicit ResourceIndex(FILE *module);
+
+  // Call around writing the record of each asset.
+  void begin(int kind, int id, int codec);
+  void end();
+
+  void add_room(int id, const std::vector<std::pair<int, int>> &assets);
+
+  // Writes the index and returns its offset from the start of the data.
+  int write(int flags);
+
+ private:
+  struct Entry { int kind, id, offset, size, codec; };
+  struct Room { int id; std::vector<std::pair<int, int>> assets; };
+
+  int offset() const;
+
+  FILE *module_;
+  long start_;
+  std::vector<Entry> entries_;
+  std::vector<Room> rooms_;
+};
+
+#endif
@@ -0,0 +1,149 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "texture_pages.h"
+#include "resource_codec.h"
+#include "rectpacker/maxrects.h"
+
+#include "backend/ideprint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+using enigma::Rect;
+using enigma::rect_packer::MaxRectsBin;
+
+namespace {
+
+const int kPadding = 2;
+
+struct Item {
+  int group, w, h;
+  const ImageData *image;
+  bool is_sprite;
+  size_t index, subimage;
+};
+
+unsigned next_pow2(unsigned x) {
+  unsigned p = 1;
+  while (p < x) p <<= 1;
+  return p;
+}
+
+// Copies the image into the page at x, y and repeats its edge pixels out
+// into the gutter around it.
+void blit(std::vector<uint8_t> &page, int page_width, const std::vector<uint8_t> &pixels, int w, int h, int x, int y) {
+  for (int row = -kPadding; row < h + kPadding; ++row) {
+    const uint8_t *src = &pixels[std::min(std::max(row, 0), h - 1) * w * 4];
+    uint8_t *dst = &page[((y + row) * page_width + x) * 4];
+    for (int col = -kPadding; col < 0; ++col) memcpy(dst + col * 4, src, 4);
+    memcpy(dst, src, w * 4);
+    for (int col = w; col < w + kPadding; ++col) memcpy(dst + col * 4, src + (w - 1) * 4, 4);
+  }
+}
+
+}  // namespace
+
+TexturePages::TexturePages(const GameData &game, int page_size) {
+  if (page_size <= 0) return;
+
+  std::vector<Item> items;
+  for (size_t i = 0; i < game.sprites.size(); ++i) {
+    const SpriteData &spr = game.sprites[i];
+    if (spr->texture_group() < 0 || spr->for3d()) continue;
+    for (size_t s = 0; s < spr.image_data.size(); ++s) {
+      const ImageData &img = spr.image_data[s];
+      items.push_back({spr->texture_group(), img.width, img.height, &img, true, i, s});
+    }
+  }
+  for (size_t i = 0; i < game.backgrounds.size(); ++i) {
+    const BackgroundData &bkg = game.backgrounds[i];
+    if (bkg->texture_group() < 0 || bkg->for3d()) continue;
+    const ImageData &img = bkg.image_data;
+    items.push_back({bkg->texture_group(), img.width, img.height, &img, false, i, 0});
+  }
+
+  // Largest first within each group packs tightest.
+  std::stable_sort(items.begin(), items.end(), [](const Item &a, const Item &b) {
+    if (a.group != b.group) return a.group < b.group;
+    return std::max(a.w, a.h) > std::max(b.w, b.h);
+  });
+
+  std::vector<std::unique_ptr<MaxRectsBin>> bins;
+  std::vector<std::pair<const Item*, Placement>> placed;
+  for (const Item &item : items) {
+    const int w = item.w + 2 * kPadding, h = item.h + 2 * kPadding;
+    if (item.w <= 0 || item.h <= 0 || w > page_size || h > page_size) continue;
+
+    Rect<int> rect;
+    int page = -1;
+    for (size_t p = 0; p < pages_.size() && page < 0; ++p)
+      if (pages_[p].group == item.group && bins[p]->insert(w, h, &rect)) page = p;
+    if (page < 0) {
+      bins.emplace_back(new MaxRectsBin(page_size, page_size));
+      pages_.push_back({item.group, 0, 0, {}});
+      page = pages_.size() - 1;
+      bins.back()->insert(w, h, &rect);
+    }
+    placed.push_back({&item, {page, rect.x + kPadding, rect.y + kPadding}});
+  }
+
+  // Shrink each page to what it uses, then fill it in.
+  for (size_t p = 0; p < pages_.size(); ++p) {
+    pages_[p].width = next_pow2(bins[p]->used_width());
+    pages_[p].height = next_pow2(bins[p]->used_height());
+    pages_[p].pixels.assign(size_t(pages_[p].width) * pages_[p].height * 4, 0);
+  }
+  for (const auto &entry : placed) {
+    const Item &item = *entry.first;
+    const Placement &at = entry.second;
+    std::vector<uint8_t> pixels = decode_image(item.image->pixels, size_t(item.w) * item.h * 4);
+    if (pixels.empty()) continue;  // Left to the writer to report
+    blit(pages_[at.page].pixels, pages_[at.page].width, pixels, item.w, item.h, at.x, at.y);
+    if (item.is_sprite) sprites_[{item.index, item.subimage}] = at;
+    else backgrounds_[item.index] = at;
+  }
+
+  if (!pages_.empty())
+    edbg << "Packed " << placed.size() << " images into " << pages_.size() << " texture pages." << flushl;
+}
+
+const TexturePages::Placement *TexturePages::sprite(size_t sprite, size_t subimage) const {
+  auto it = sprites_.find({sprite, subimage});
+  return it == sprites_.end() ? nullptr : &it->second;
+}
+
+const TexturePages::Placement *TexturePages::background(size_t background) const {
+  auto it = backgrounds_.find(background);
+  return it == backgrounds_.end() ? nullptr : &it->second;
+}
+
+void TexturePages::write(FILE *module, int codec) const {
+  fwrite("TXP ", 4, 1, module);
+  const int count = pages_.size();
+  fwrite(&count, 4, 1, module);
+  for (const Page &page : pages_) {
+    const std::vector<uint8_t> packed = encode_pixels(page.pixels, codec);
+    const int size = packed.size();
+    fwrite(&page.width, 4, 1, module);
+    fwrite(&page.height, 4, 1, module);
+    fwrite(&codec, 4, 1, module);
+    fwrite(&size, 4, 1, module);
+    fwrite(packed.data(), 1, size, module);
+  }
+}
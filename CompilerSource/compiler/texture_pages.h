@@ -0,0 +1,58 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_TEXTURE_PAGES_H
+#define ENIGMA_TEXTURE_PAGES_H
+
+#include "backend/GameData.h"
+
+#include <cstdio>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Packs the images of sprites and backgrounds into shared texture pages, one
+// set of pages per texture group, so drawing them binds fewer textures. Each
+// image keeps a gutter of its edge pixels around it so filtering does not
+// bleed its neighbours in. Sprites and backgrounds meant for 3D, in a negative
+// texture group or too large for a page keep textures of their own.
+class TexturePages {
+ public:
+  struct Placement { int page, x, y; };
+
+  // Packs nothing if page_size is 0.
+  TexturePages(const GameData &game, int page_size);
+
+  // Where the image went, or nullptr if it has a texture of its own.
+  const Placement *sprite(size_t sprite, size_t subimage) const;
+  const Placement *background(size_t background) const;
+
+  // Writes the "TXP " section.
+  void write(FILE *module, int codec) const;
+
+ private:
+  struct Page {
+    int group, width, height;
+    std::vector<uint8_t> pixels;
+  };
+
+  std::map<std::pair<size_t, size_t>, Placement> sprites_;
+  std::map<size_t, Placement> backgrounds_;
+  std::vector<Page> pages_;
+};
+
+#endif
@@ -0,0 +1,731 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "jdi_cache.h"
+
+#include "parser/parse_cache.h"
+
+#include <API/AST.h>
+#include <Storage/definition.h>
+#include <System/builtins.h>
+#include <System/lex_cpp.h>
+#include <System/macros.h>
+
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+using namespace jdi;
+
+int parse_C_stream_sources(context *ctx, llreader &file, const char *fname,
+                           std::set<std::string> *sources) {
+  // The lexer only adds to the macros; context keeps them const to callers.
+  jdip::lexer_cpp lex(file, const_cast<macro_map&>(ctx->get_macros()), fname);
+  int res = ctx->parse_stream(&lex);
+  sources->insert(lex.visited_files.begin(), lex.visited_files.end());
+  return res;
+}
+
+namespace {
+
+// Bump this whenever JDI's storage classes or the layout below change.
+const uint64_t kCacheVersion = 2;
+const char kCacheMagic[8] = {'E', 'G', 'M', 'J', 'D', 'I', 'C', 'X'};
+
+// The kinds of definition the cache rebuilds.
+enum Kind : char {
+  kPlain = 'd', kTyped = 't', kValued = 'v', kFunction = 'f', kOverload = 'o',
+  kScope = 'n', kClass = 'c', kUnion = 'u', kEnum = 'e', kTemplate = 'T',
+  kTempParam = 'p'
+};
+
+// How a reference to a definition is stored. Specialization keys hold
+// arg_key::abstract where the specialization's own parameters go.
+enum RefTag : uint64_t { kNull = 0, kNode = 1, kBuiltin = 2, kAbstract = 3 };
+
+// Returns 0 for what is left out: primitives belong to the builtin context
+// and dependent types only mean something to the template parser.
+char kind_of(const definition *d) {
+  if (dynamic_cast<const definition_hypothetical*>(d)) return 0;
+  if (dynamic_cast<const definition_atomic*>(d)) return 0;
+  if (dynamic_cast<const definition_overload*>(d)) return kOverload;
+  if (dynamic_cast<const definition_tempparam*>(d)) return kTempParam;
+  if (dynamic_cast<const definition_enum*>(d)) return kEnum;
+  if (dynamic_cast<const definition_class*>(d)) return kClass;
+  if (dynamic_cast<const definition_union*>(d)) return kUnion;
+  if (dynamic_cast<const definition_template*>(d)) return kTemplate;
+  if (dynamic_cast<const definition_scope*>(d)) return kScope;
+  if (dynamic_cast<const definition_function*>(d)) return kFunction;
+  if (dynamic_cast<const definition_valued*>(d)) return kValued;
+  if (dynamic_cast<const definition_typed*>(d)) return kTyped;
+  if (typeid(*d) == typeid(definition)) return kPlain;
+  return 0;
+}
+
+bool is_scope(char kind) {
+  return kind == kScope || kind == kClass || kind == kUnion || kind == kEnum ||
+         kind == kTemplate || kind == kTempParam;
+}
+bool is_class(char kind) {
+  return kind == kClass || kind == kEnum || kind == kTempParam;
+}
+
+// The using list of a scope is protected; this reads it the way a subclass may.
+struct scope_access: definition_scope {
+  static const using_node *using_list(const definition_scope *s) {
+    return s->*(&scope_access::using_front);
+  }
+};
+
+uint64_t file_hash(const std::string &path) {
+  llreader f(path.c_str());
+  if (!f.is_open()) return 0;
+  return ParseHash().add(f.data, f.length).get();
+}
+
+// Covers what the parse took from jdi::builtin. Declarator flag bits are
+// stored in the cache as they are, so those must match too.
+uint64_t builtin_signature() {
+  ParseHash h;
+  h.add(jdip::builtin_declarators.size());
+  for (const auto &decl : jdip::builtin_declarators) {
+    h.add(decl.first).add(decl.second->flagbit).add(decl.second->usage);
+    h.add(decl.second->def != NULL);
+  }
+  h.add(builtin->search_dir_count());
+  for (size_t i = 0; i < builtin->search_dir_count(); ++i)
+    h.add(builtin->search_dir(i));
+  h.add(builtin->get_macros().size());
+  for (const auto &macro : builtin->get_macros())
+    h.add(macro.first).add(macro.second->toString());
+  return h.get();
+}
+
+struct Writer {
+  std::string &out;
+
+  void num(uint64_t value) {
+    for (int i = 0; i < 8; ++i) out += char((value >> (i * 8)) & 0xFF);
+  }
+  void str(const std::string &s) { num(s.size()); out += s; }
+};
+
+struct Reader {
+  const char *in;
+  size_t size, pos = 0;
+  bool ok = true;
+
+  uint64_t num() {
+    if (size - pos < 8) { ok = false; return 0; }
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) value |= uint64_t((unsigned char) in[pos++]) << (i * 8);
+    return value;
+  }
+  std::string str() {
+    uint64_t len = num();
+    if (!ok || size - pos < len) { ok = false; return {}; }
+    pos += len;
+    return std::string(in + pos - len, len);
+  }
+};
+
+// Numbers every definition the context owns, then writes them out in two
+// passes: first what it takes to construct each one, then everything that
+// refers to other definitions, so that references can point anywhere.
+class ContextWriter {
+ public:
+  ContextWriter(const context &ctx, std::string &out): ctx_(ctx), w_{out} {
+    for (const auto &decl : jdip::builtin_declarators)
+      if (decl.second->def) builtins_.emplace(decl.second->def, decl.first);
+    collect(ctx.get_global());
+  }
+
+  void write() {
+    w_.num(nodes_.size());
+    for (size_t i = 1; i < nodes_.size(); ++i) header(nodes_[i]);
+    for (const definition *d : nodes_) body(d);
+    macros();
+  }
+
+ private:
+  const context &ctx_;
+  Writer w_;
+  std::unordered_map<const definition*, uint64_t> ids_;
+  std::vector<const definition*> nodes_;
+  std::unordered_map<const definition*, std::string> builtins_;
+
+  // A scope owns the members that name it as their parent; the rest are
+  // aliases of definitions owned elsewhere. The overloads of a function are
+  // rebuilt along with it, so only those of function templates are numbered.
+  // A template owns its specializations and instantiations; those made with
+  // dependent arguments are left to the template parser to make again.
+  void collect(const definition *d) {
+    if (!d || ids_.count(d) || !kind_of(d)) return;
+    ids_.emplace(d, nodes_.size());
+    nodes_.push_back(d);
+    if (auto *s = dynamic_cast<const definition_scope*>(d)) {
+      for (const auto &m : s->members) if (m.second->parent == s) collect(m.second);
+      for (const auto &m : s->c_structs) if (m.second->parent == s) collect(m.second);
+      for (const auto &m : s->using_general) if (m.second->parent == s) collect(m.second);
+    }
+    if (auto *e = dynamic_cast<const definition_enum*>(d))
+      for (const auto &c : e->constants) collect(c.def);
+    if (auto *t = dynamic_cast<const definition_template*>(d)) {
+      for (const definition_tempparam *p : t->params) collect(p);
+      collect(t->def);
+      for (const auto *spec : t->specializations) collect(spec->spec_temp);
+      for (const auto &inst : t->instantiations) {
+        if (inst.first.is_abstract()) continue;
+        collect(inst.second->def);
+        for (const definition *p : inst.second->parameter_defs) collect(p);
+      }
+    }
+    if (auto *f = dynamic_cast<const definition_function*>(d))
+      for (const definition_template *t : f->template_overloads) collect(t);
+  }
+
+  void ref(const definition *d) {
+    if (d == arg_key::abstract) { w_.num(kAbstract); return; }
+    if (d) {
+      auto node = ids_.find(d);
+      if (node != ids_.end()) { w_.num(kNode); w_.num(node->second); return; }
+      auto builtin = builtins_.find(d);
+      if (builtin != builtins_.end()) { w_.num(kBuiltin); w_.str(builtin->second); return; }
+    }
+    w_.num(kNull);
+  }
+
+  void type(const full_type &ft) {
+    ref(ft.def);
+    refs(ft.refs);
+    w_.num(ft.flags);
+  }
+
+  void refs(const ref_stack &rf) {
+    w_.str(rf.name);
+    // Count the nodes; some of ref_stack's splicing leaves its size stale.
+    uint64_t count = 0;
+    for (ref_stack::iterator it = rf.begin(); it; ++it) ++count;
+    w_.num(count);
+    for (ref_stack::iterator it = rf.begin(); it; ++it) {
+      w_.num(it->type);
+      if (it->type == ref_stack::RT_ARRAYBOUND) {
+        w_.num(it->arraysize());
+      } else if (it->type == ref_stack::RT_FUNCTION) {
+        const ref_stack::parameter_ct &params = ((ref_stack::node_func*) *it)->params;
+        w_.num(params.size());
+        for (size_t i = 0; i < params.size(); ++i) {
+          type(params[i]);
+          w_.num(params[i].variadic);
+          w_.num(params[i].default_value != NULL);
+        }
+      } else if (it->type == ref_stack::RT_MEMBER_POINTER) {
+        ref(((ref_stack::node_memptr*) *it)->member_of);
+      }
+    }
+  }
+
+  void val(const value &v) {
+    w_.num(v.type);
+    if (v.type == VT_DOUBLE) {
+      uint64_t bits;
+      memcpy(&bits, &v.val.d, sizeof bits);
+      w_.num(bits);
+    } else if (v.type == VT_INTEGER) {
+      w_.num(v.val.i);
+    } else if (v.type == VT_STRING) {
+      w_.str(v.val.s);
+    }
+  }
+
+  void key(const arg_key &k) {
+    w_.num(k.size());
+    for (const arg_key::node &n : k) {
+      w_.num(n.type);
+      if (n.type == arg_key::AKT_FULLTYPE) type(n.ft());
+      else if (n.type == arg_key::AKT_VALUE) val(n.val());
+    }
+  }
+
+  void entries(const definition_scope::defmap &m) {
+    w_.num(m.size());
+    for (const auto &entry : m) { w_.str(entry.first); ref(entry.second); }
+  }
+
+  void header(const definition *d) {
+    const char kind = kind_of(d);
+    w_.num(kind);
+    w_.str(d->name);
+    w_.num(d->flags);
+    if (kind == kValued) val(((const definition_valued*) d)->value_of);
+    if (kind == kTempParam) w_.num(((const definition_tempparam*) d)->default_assignment != NULL);
+  }
+
+  void body(const definition *d) {
+    const char kind = kind_of(d);
+    ref(d->parent);
+    if (kind == kTyped || kind == kValued || kind == kOverload) {
+      auto *t = (const definition_typed*) d;
+      ref(t->type);
+      refs(t->referencers);
+      w_.num(t->modifiers);
+    }
+    if (kind == kFunction) {
+      auto *f = (const definition_function*) d;
+      w_.num(f->overloads.size());
+      for (const auto &ov : f->overloads) {
+        ref(ov.second->type);
+        refs(ov.second->referencers);
+        w_.num(ov.second->modifiers);
+        w_.num(ov.second->flags);
+      }
+      w_.num(f->template_overloads.size());
+      for (const definition_template *t : f->template_overloads) ref(t);
+    }
+    if (is_scope(kind)) {
+      auto *s = (const definition_scope*) d;
+      entries(s->members);
+      entries(s->c_structs);
+      entries(s->using_general);
+      std::vector<const definition_scope*> used;
+      for (auto *u = scope_access::using_list(s); u; u = u->next) used.push_back(u->use);
+      w_.num(used.size());
+      for (const definition_scope *u : used) ref(u);
+      // Declaration order points into one of the two maps above.
+      std::vector<std::pair<char, std::string>> order;
+      for (const definition_scope::dec_order_g *o : s->dec_order) {
+        auto *di = dynamic_cast<const definition_scope::dec_order_defiter*>(o);
+        if (!di) continue;
+        auto m = s->members.find(di->it->first);
+        order.emplace_back(m != s->members.end() && &*m == &*di->it ? 'm' : 'c', di->it->first);
+      }
+      w_.num(order.size());
+      for (const auto &o : order) { w_.num(o.first); w_.str(o.second); }
+    }
+    if (is_class(kind)) {
+      auto *c = (const definition_class*) d;
+      w_.num(c->ancestors.size());
+      for (const auto &a : c->ancestors) { w_.num(a.protection); ref(a.def); }
+      ref(c->instance_of);
+    }
+    if (kind == kEnum) {
+      auto *e = (const definition_enum*) d;
+      ref(e->type);
+      w_.num(e->modifiers);
+      w_.num(e->constants.size());
+      for (const auto &c : e->constants) ref(c.def);
+    }
+    if (kind == kTemplate) {
+      auto *t = (const definition_template*) d;
+      ref(t->def);
+      w_.num(t->params.size());
+      for (const definition_tempparam *p : t->params) ref(p);
+      w_.num(t->specializations.size());
+      for (const auto *spec : t->specializations) {
+        ref(spec->spec_temp);
+        key(spec->filter);
+        // Each of the specialization's parameters: the arguments it is used in.
+        w_.num(spec->key.ind_count);
+        for (unsigned i = 0; i < spec->key.ind_count; ++i) {
+          const unsigned *uses = spec->key.arg_inds[i];
+          w_.num(uses[0]);
+          for (unsigned j = 1; j <= uses[0]; ++j) w_.num(uses[j]);
+        }
+      }
+      uint64_t concrete = 0;
+      for (const auto &inst : t->instantiations) concrete += !inst.first.is_abstract();
+      w_.num(concrete);
+      for (const auto &inst : t->instantiations) {
+        if (inst.first.is_abstract()) continue;
+        key(inst.first);
+        ref(inst.second->def);
+        w_.num(inst.second->parameter_defs.size());
+        for (const definition *p : inst.second->parameter_defs) ref(p);
+      }
+    }
+    if (kind == kTempParam) {
+      auto *p = (const definition_tempparam*) d;
+      type(p->integer_type);
+      w_.num(p->must_be_class);
+    }
+  }
+
+  // Macros the context shares with the builtin context are left to it.
+  void macros() {
+    const macro_map &ours = ctx_.get_macros(), &theirs = builtin->get_macros();
+    std::vector<std::string> removed;
+    for (const auto &m : theirs) if (!ours.count(m.first)) removed.push_back(m.first);
+    w_.num(removed.size());
+    for (const std::string &name : removed) w_.str(name);
+
+    std::vector<const jdip::macro_type*> added;
+    for (const auto &m : ours) {
+      auto builtin = theirs.find(m.first);
+      if (builtin == theirs.end() || builtin->second != m.second) added.push_back(m.second);
+    }
+    w_.num(added.size());
+    for (const jdip::macro_type *m : added) {
+      w_.num(int64_t(m->argc));
+      w_.str(m->name);
+      if (m->argc < 0) {
+        w_.str(((const jdip::macro_scalar*) m)->value);
+        continue;
+      }
+      auto *mf = (const jdip::macro_function*) m;
+      w_.num(mf->args.size());
+      for (const std::string &arg : mf->args) w_.str(arg);
+      w_.num(mf->value.size());
+      for (const auto &chunk : mf->value) {
+        w_.num(chunk.is_arg);
+        if (chunk.is_arg) w_.num(chunk.metric);
+        else w_.str(std::string(chunk.data, chunk.metric));
+      }
+    }
+  }
+};
+
+class ContextReader {
+ public:
+  ContextReader(Reader &r, context *ctx): r_(r), ctx_(ctx) {}
+
+  bool read() {
+    const uint64_t count = r_.num();
+    if (!r_.ok || !count || count > r_.size - r_.pos) return false;
+    nodes_.reserve(count);
+    kinds_.reserve(count);
+    nodes_.push_back(ctx_->get_global());
+    kinds_.push_back(kScope);
+    for (uint64_t i = 1; i < count; ++i) {
+      if (!header()) {
+        for (size_t j = 1; j < nodes_.size(); ++j) delete nodes_[j];
+        return false;
+      }
+    }
+    for (size_t i = 0; r_.ok && i < nodes_.size(); ++i) body(i);
+    if (r_.ok) macros();
+    return r_.ok && r_.pos == r_.size;
+  }
+
+ private:
+  Reader &r_;
+  context *ctx_;
+  std::vector<definition*> nodes_;
+  std::vector<char> kinds_;
+
+  definition *ref() {
+    switch (r_.num()) {
+      case kNull: return NULL;
+      case kNode: {
+        const uint64_t id = r_.num();
+        if (id < nodes_.size()) return nodes_[id];
+        break;
+      }
+      case kBuiltin: {
+        auto decl = jdip::builtin_declarators.find(r_.str());
+        return decl != jdip::builtin_declarators.end() ? decl->second->def : NULL;
+      }
+      case kAbstract: return arg_key::abstract;
+    }
+    r_.ok = false;
+    return NULL;
+  }
+
+  void type(full_type &ft) {
+    ft.def = ref();
+    refs(ft.refs);
+    ft.flags = int(r_.num());
+  }
+
+  // Stacks grow at both ends depending on the kind of node; build each node
+  // alone and stack them from the bottom up.
+  void refs(ref_stack &rf) {
+    rf.name = r_.str();
+    std::deque<ref_stack> nodes;
+    for (uint64_t n = r_.num(); r_.ok && n; --n) {
+      nodes.emplace_back();
+      ref_stack &node = nodes.back();
+      const ref_stack::ref_type rt = ref_stack::ref_type(r_.num());
+      if (rt == ref_stack::RT_POINTERTO || rt == ref_stack::RT_REFERENCE) {
+        node.push(rt);
+      } else if (rt == ref_stack::RT_ARRAYBOUND) {
+        node.push_array(r_.num());
+      } else if (rt == ref_stack::RT_FUNCTION) {
+        ref_stack::parameter_ct params;
+        for (uint64_t p = r_.num(); r_.ok && p; --p) {
+          ref_stack::parameter param;
+          type(param);
+          param.variadic = r_.num();
+          if (r_.num()) param.default_value = new AST();
+          params.throw_on(param);
+        }
+        node.push_func(params);
+      } else if (rt == ref_stack::RT_MEMBER_POINTER) {
+        node.push_memptr(dynamic_cast<definition_class*>(ref()));
+      } else {
+        r_.ok = false;
+      }
+    }
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) rf.append_c(*it);
+  }
+
+  value val() {
+    const uint64_t type = r_.num();
+    if (type == VT_DOUBLE) {
+      const uint64_t bits = r_.num();
+      double d;
+      memcpy(&d, &bits, sizeof d);
+      return value(d);
+    }
+    if (type == VT_INTEGER) return value(long(int64_t(r_.num())));
+    if (type == VT_STRING) return value(r_.str());
+    if (type == VT_DEPENDENT) return value(VT_DEPENDENT);
+    return value();
+  }
+
+  arg_key key() {
+    const uint64_t size = r_.num();
+    if (!r_.ok || size > r_.size - r_.pos) { r_.ok = false; return arg_key(); }
+    arg_key k(size);
+    for (uint64_t i = 0; r_.ok && i < size; ++i) {
+      const uint64_t kind = r_.num();
+      if (kind == arg_key::AKT_FULLTYPE) {
+        full_type ft;
+        type(ft);
+        k.put_final_type(i, ft);
+      } else if (kind == arg_key::AKT_VALUE) {
+        k.put_value(i, val());
+      } else if (kind != arg_key::AKT_NONE) {
+        r_.ok = false;
+      }
+    }
+    return k;
+  }
+
+  void entries(definition_scope::defmap &m) {
+    for (uint64_t n = r_.num(); r_.ok && n; --n) {
+      std::string key = r_.str();
+      if (definition *d = ref()) m[key] = d;
+    }
+  }
+
+  bool header() {
+    const char kind = char(r_.num());
+    const std::string name = r_.str();
+    const unsigned flags = unsigned(r_.num());
+    if (!r_.ok) return false;
+    definition *d;
+    switch (kind) {
+      case kPlain: d = new definition(name, NULL, flags); break;
+      case kTyped: d = new definition_typed(name, NULL, full_type(), flags); break;
+      case kValued: d = new definition_valued(name, NULL, NULL, 0, flags, val()); break;
+      case kFunction: d = new definition_function(name, NULL, flags); break;
+      case kOverload: d = new definition_overload(name, NULL, NULL, ref_stack(), 0, flags); break;
+      case kScope: d = new definition_scope(name, NULL, flags); break;
+      case kClass: d = new definition_class(name, NULL, flags); break;
+      case kUnion: d = new definition_union(name, NULL, flags); break;
+      case kEnum: d = new definition_enum(name, NULL, flags); break;
+      case kTemplate: d = new definition_template(name, NULL, flags); break;
+      case kTempParam:
+        d = new definition_tempparam(name, NULL, r_.num() ? new AST() : NULL, flags);
+        break;
+      default: return false;
+    }
+    // Constructors add their own flags; keep exactly what was saved.
+    d->flags = flags;
+    nodes_.push_back(d);
+    kinds_.push_back(kind);
+    return r_.ok;
+  }
+
+  void body(size_t id) {
+    definition *d = nodes_[id];
+    const char kind = kinds_[id];
+    definition *parent = ref();
+    if (id) d->parent = (definition_scope*) parent;
+    if (kind == kTyped || kind == kValued || kind == kOverload) {
+      auto *t = (definition_typed*) d;
+      t->type = ref();
+      refs(t->referencers);
+      t->modifiers = unsigned(r_.num());
+    }
+    if (kind == kFunction) {
+      auto *f = (definition_function*) d;
+      for (uint64_t n = r_.num(); r_.ok && n; --n) {
+        definition *type = ref();
+        ref_stack rf;
+        refs(rf);
+        const unsigned modifiers = unsigned(r_.num()), flags = unsigned(r_.num());
+        f->overload(type, rf, modifiers, flags, NULL, def_error_handler);
+      }
+      for (uint64_t n = r_.num(); r_.ok && n; --n)
+        if (auto *t = dynamic_cast<definition_template*>(ref())) f->template_overloads.push_back(t);
+    }
+    if (is_scope(kind)) {
+      auto *s = (definition_scope*) d;
+      entries(s->members);
+      entries(s->c_structs);
+      entries(s->using_general);
+      for (uint64_t n = r_.num(); r_.ok && n; --n)
+        if (auto *u = dynamic_cast<definition_scope*>(ref())) s->use_namespace(u);
+      for (uint64_t n = r_.num(); r_.ok && n; --n) {
+        definition_scope::defmap &m = r_.num() == 'm' ? s->members : s->c_structs;
+        auto it = m.find(r_.str());
+        if (it != m.end()) s->dec_order.push_back(new definition_scope::dec_order_defiter(it));
+      }
+    }
+    if (is_class(kind)) {
+      auto *c = (definition_class*) d;
+      for (uint64_t n = r_.num(); r_.ok && n; --n) {
+        const unsigned protection = unsigned(r_.num());
+        if (auto *a = dynamic_cast<definition_class*>(ref()))
+          c->ancestors.push_back(definition_class::ancestor(protection, a));
+      }
+      c->instance_of = dynamic_cast<definition_template*>(ref());
+    }
+    if (kind == kEnum) {
+      auto *e = (definition_enum*) d;
+      e->type = ref();
+      e->modifiers = unsigned(r_.num());
+      for (uint64_t n = r_.num(); r_.ok && n; --n)
+        if (auto *v = dynamic_cast<definition_valued*>(ref()))
+          e->constants.push_back(definition_enum::const_pair(v, NULL));
+    }
+    if (kind == kTemplate) {
+      auto *t = (definition_template*) d;
+      t->def = ref();
+      for (uint64_t n = r_.num(); r_.ok && n; --n)
+        if (auto *p = dynamic_cast<definition_tempparam*>(ref())) t->params.push_back(p);
+      for (uint64_t n = r_.num(); r_.ok && n; --n) {
+        auto *spec_temp = dynamic_cast<definition_template*>(ref());
+        arg_key filter = key();
+        const uint64_t params = r_.num();
+        if (!r_.ok || !spec_temp || params > r_.size - r_.pos) { r_.ok = false; break; }
+        auto *spec = new definition_template::specialization(filter.size(), params, spec_temp);
+        spec->filter = filter;
+        t->specializations.push_back(spec);
+        for (uint64_t i = 0; r_.ok && i < params; ++i) {
+          unsigned *uses = spec->key.arg_inds[i];
+          uses[0] = unsigned(r_.num());
+          // The key is matched against arguments by these indices.
+          if (uses[0] > filter.size()) { r_.ok = false; break; }
+          for (unsigned j = 1; j <= uses[0]; ++j)
+            if ((uses[j] = unsigned(r_.num())) >= filter.size()) r_.ok = false;
+        }
+      }
+      for (uint64_t n = r_.num(); r_.ok && n; --n) {
+        arg_key k = key();
+        auto *inst = new definition_template::instantiation();
+        inst->def = ref();
+        for (uint64_t p = r_.num(); r_.ok && p; --p) inst->parameter_defs.push_back(ref());
+        // Two keys only collide if the cache is damaged; the definitions
+        // belong to the node list either way.
+        if (!r_.ok || !t->instantiations.insert(std::make_pair(k, inst)).second) {
+          inst->def = NULL;
+          inst->parameter_defs.clear();
+          delete inst;
+          r_.ok = false;
+        }
+      }
+    }
+    if (kind == kTempParam) {
+      auto *p = (definition_tempparam*) d;
+      type(p->integer_type);
+      p->must_be_class = r_.num();
+    }
+  }
+
+  void macros() {
+    macro_map &macros = const_cast<macro_map&>(ctx_->get_macros());
+    for (uint64_t n = r_.num(); r_.ok && n; --n) {
+      auto it = macros.find(r_.str());
+      if (it == macros.end()) continue;
+      jdip::macro_type::free(it->second);
+      macros.erase(it);
+    }
+    for (uint64_t n = r_.num(); r_.ok && n; --n) {
+      const int argc = int(int64_t(r_.num()));
+      const std::string name = r_.str();
+      const jdip::macro_type *m;
+      if (argc < 0) {
+        m = new jdip::macro_scalar(name, r_.str());
+      } else {
+        std::vector<std::string> args;
+        for (uint64_t a = r_.num(); r_.ok && a; --a) args.push_back(r_.str());
+        auto *mf = new jdip::macro_function(name, args, "", size_t(argc) > args.size());
+        for (uint64_t c = r_.num(); r_.ok && c; --c) {
+          if (r_.num()) {
+            mf->value.push_back(jdip::macro_function::mv_chunk(size_t(r_.num())));
+          } else {
+            const std::string data = r_.str();
+            char *buf = new char[data.size()];
+            memcpy(buf, data.data(), data.size());
+            mf->value.push_back(jdip::macro_function::mv_chunk(buf, data.size()));
+          }
+        }
+        m = mf;
+      }
+      auto ins = macros.insert(std::make_pair(name, m));
+      if (!ins.second) {
+        jdip::macro_type::free(ins.first->second);
+        ins.first->second = m;
+      }
+    }
+  }
+};
+
+}  // namespace
+
+void save_jdi_cache(const std::filesystem::path &file, const context &ctx,
+                    const std::set<std::string> &sources) {
+  std::string payload;
+  ContextWriter(ctx, payload).write();
+
+  std::string data(kCacheMagic, sizeof(kCacheMagic));
+  Writer w{data};
+  w.num(kCacheVersion);
+  w.num(builtin_signature());
+  w.num(sources.size());
+  for (const std::string &source : sources) {
+    w.str(source);
+    w.num(file_hash(source));
+  }
+  w.num(ParseHash().add(payload).get());
+  w.str(payload);
+  std::ofstream(file, std::ios_base::binary) << data;
+}
+
+bool load_jdi_cache(const std::filesystem::path &file, context *ctx) {
+  llreader f(file.u8string().c_str());
+  if (!f.is_open() || f.length < sizeof(kCacheMagic)) return false;
+  if (memcmp(f.data, kCacheMagic, sizeof(kCacheMagic))) return false;
+
+  Reader r{f.data, f.length, sizeof(kCacheMagic)};
+  if (r.num() != kCacheVersion || r.num() != builtin_signature() || !r.ok) return false;
+  for (uint64_t n = r.num(); n; --n) {
+    const std::string source = r.str();
+    if (!r.ok || r.num() != file_hash(source)) return false;
+  }
+  const uint64_t checksum = r.num(), size = r.num();
+  if (!r.ok || size != r.size - r.pos) return false;
+  if (ParseHash().add(f.data + r.pos, size).get() != checksum) return false;
+
+  Reader payload{f.data + r.pos, size};
+  return ContextReader(payload, ctx).read();
+}
@@ -0,0 +1,56 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_JDI_CACHE_H
+#define ENIGMA_JDI_CACHE_H
+
+#include <API/context.h>
+#include <General/llreader.h>
+
+#include <filesystem>
+#include <set>
+#include <string>
+
+// Same as context::parse_C_stream, but also collects the full path of every
+// file the parse included.
+int parse_C_stream_sources(jdi::context *ctx, llreader &file, const char *fname,
+                           std::set<std::string> *sources);
+
+// Saves the definitions, scopes and macros the context holds beyond those of
+// jdi::builtin. The cache is keyed by the contents of the given source files
+// and by the builtin context: the toolchain's macros, search directories and
+// declarators.
+//
+// Everything the compiler reads is kept: namespaces, classes and their
+// ancestors, enums, typedefs, variables, constants, function overloads with
+// their parameters, using directives, macros, and templates with their
+// parameters, specializations and instantiations. The dependent types inside
+// templates, and instantiations made from them, are not; references to them
+// load as null.
+void save_jdi_cache(const std::filesystem::path &file, const jdi::context &ctx,
+                    const std::set<std::string> &sources);
+
+// Fills a context fresh from jdi::builtin from the cache, which is mapped
+// rather than read in. Returns false if the cache is missing, damaged or any
+// of its keys changed; the context is left alone unless the cache turned out
+// to be damaged after it was checked, in which case it should be discarded.
+//
+// A header added to a search directory ahead of the one a saved include was
+// found in is not noticed; neither is one that was not found at all.
+bool load_jdi_cache(const std::filesystem::path &file, jdi::context *ctx);
+
+#endif
@@ -71,6 +71,8 @@ void lang_CPP::load_extension_locals() {
 
 #include "settings-parse/parse_ide_settings.h"
 #include "settings-parse/crawler.h"
+#include "compiler/codegen_file.h"
+#include "languages/jdi_cache.h"
 
 #include <System/builtins.h>
 
@@ -88,19 +90,35 @@ syntax_error *lang_CPP::definitionsModified(const char* wscode, const char* targ
   main_context = new jdi::context();
   
   cout << "Dumping whiteSpace definitions..." << endl;
-  FILE *of = wscode ? fopen((codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_whitespace.h").u8string().c_str(),"wb") : NULL;
-  if (of) fputs(wscode,of), fclose(of);
+  if (wscode) write_if_changed(codegen_directory/"Preprocessor_Environment_Editable/IDE_EDIT_whitespace.h", wscode);
   
   cout << "Opening ENIGMA for parse..." << endl;
   
-  llreader f((enigma_root/"ENIGMAsystem/SHELL/SHELLmain.cpp").u8string().c_str());
+  const std::filesystem::path cache_file = codegen_directory/"jdi_cache.dat";
   int res = 1;
+  bool cached = false;
   DECLARE_TIME_TYPE ts, te;
-  if (f.is_open()) {
-    CURRENT_TIME(ts);
-    res = main_context->parse_C_stream(f, "SHELLmain.cpp");
-    CURRENT_TIME(te);
+  CURRENT_TIME(ts);
+  if (load_jdi_cache(cache_file, main_context)) {
+    res = 0;
+    cached = true;
+  } else {
+    // A cache that fails partway through may leave definitions behind.
+    delete main_context;
+    main_context = new jdi::context();
+    llreader f((enigma_root/"ENIGMAsystem/SHELL/SHELLmain.cpp").u8string().c_str());
+    if (f.is_open()) {
+      CURRENT_TIME(ts);
+      std::set<std::string> sources;
+      res = parse_C_stream_sources(main_context, f, "SHELLmain.cpp", &sources);
+      CURRENT_TIME(te);
+      if (!res) {
+        sources.insert((enigma_root/"ENIGMAsystem/SHELL/SHELLmain.cpp").u8string());
+        save_jdi_cache(cache_file, *main_context, sources);
+      }
+    }
   }
+  if (cached) CURRENT_TIME(te);
   
   jdi::definition *d;
   if ((d = main_context->get_global()->look_up("variant"))) {
@@ -143,7 +161,8 @@ syntax_error *lang_CPP::definitionsModified(const char* wscode, const char* targ
     cout << "Continuing anyway." << endl;
     // return &ide_passback_error;
   } else {    
-    cout << "Successfully parsed ENIGMA's engine (" << PRINT_TIME(ts,te) << "ms)\n"
+    cout << "Successfully " << (cached ? "loaded cached definitions of" : "parsed")
+         << " ENIGMA's engine (" << PRINT_TIME(ts,te) << "ms)\n"
     << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n";
     //cout << "Namespace std contains " << global_scope.members["std"]->members.size() << " items.\n";
   }
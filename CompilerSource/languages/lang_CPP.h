@@ -53,9 +53,9 @@ struct lang_CPP: language_adapter {
   int compile_writeDefraggedEvents(const GameData &game, const std::set<EventGroupKey> &used_events, const ParsedObjectVec &parsed_objects) final;
 
   // Resources added to module
-  int module_write_sprites(const GameData &game, FILE *gameModule) final;
-  int module_write_sounds(const GameData &game, FILE *gameModule) final;
-  int module_write_backgrounds(const GameData &game, FILE *gameModule) final;
+  int module_write_sprites(const GameData &game, FILE *gameModule, ResourceIndex &index, const TexturePages &pages) final;
+  int module_write_sounds(const GameData &game, FILE *gameModule, ResourceIndex &index) final;
+  int module_write_backgrounds(const GameData &game, FILE *gameModule, ResourceIndex &index, const TexturePages &pages) final;
   int module_write_paths(const GameData &game, FILE *gameModule) final;
   int module_write_fonts(const GameData &game, FILE *gameModule) final;
 
@@ -30,6 +30,8 @@
 #include <Storage/definition.h>
 #include "backend/GameData.h"
 #include "parser/object_storage.h"
+#include "compiler/resource_index.h"
+#include "compiler/texture_pages.h"
 #include "frontend.h"
 
 struct language_adapter {
@@ -50,9 +52,9 @@ struct language_adapter {
   virtual int compile_writeDefraggedEvents(const GameData &game, const std::set<EventGroupKey> &used_events, const ParsedObjectVec &parsed_objects) = 0;
 
   // Resources added to module
-  virtual int module_write_sprites(const GameData &game, FILE *gameModule) = 0;
-  virtual int module_write_sounds(const GameData &game, FILE *gameModule) = 0;
-  virtual int module_write_backgrounds(const GameData &game, FILE *gameModule) = 0;
+  virtual int module_write_sprites(const GameData &game, FILE *gameModule, ResourceIndex &index, const TexturePages &pages) = 0;
+  virtual int module_write_sounds(const GameData &game, FILE *gameModule, ResourceIndex &index) = 0;
+  virtual int module_write_backgrounds(const GameData &game, FILE *gameModule, ResourceIndex &index, const TexturePages &pages) = 0;
   virtual int module_write_paths(const GameData &game, FILE *gameModule) = 0;
   virtual int module_write_fonts(const GameData &game, FILE *gameModule) = 0;
 
@@ -34,12 +34,14 @@
 #include <sstream>
 #include <iostream>
 #include <stdio.h>
+#include <mutex>
 using namespace std;
 
 #include "config.h"
 #include "event_reader/event_parser.h"
 
 extern int global_script_argument_count;
+static std::mutex script_argument_count_mutex; // Code is parsed on several threads
 
 struct scope_ignore {
   map<string,int> ignore;
@@ -346,6 +348,7 @@ void collect_variables(language_adapter *lang, ParsedCode *parsed_code,
         iscr = sscanf(nname.c_str(),"argument%d",&argnum);
         if (iscr == 1)
         { //  not in a script or are but have exceeded arg number
+          std::lock_guard<std::mutex> lock(script_argument_count_mutex);
           if (global_script_argument_count < argnum + 1)
             global_script_argument_count = argnum + 1;
           continue;
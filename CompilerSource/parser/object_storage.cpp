@@ -64,11 +64,11 @@ bool decquad::operator!= (const decquad& x) const {
   return type != x.type or prefix != x.prefix or suffix != x.suffix or value != x.value;
 }
 
-parsed_object::parsed_object(): parent(NULL) {}
+parsed_object::parsed_object(): parallel_step(false), parent(NULL) {}
 parsed_object::parsed_object(string n, int i, string s, string m, string p,
                              bool vis, bool sol, double d,bool pers):
     name(n), id(i), sprite_name(s), mask_name(m), parent_name(p), visible(vis),
-    solid(sol), persistent(pers), depth(d), parent(NULL) {}
+    solid(sol), persistent(pers), parallel_step(false), depth(d), parent(NULL) {}
 
 void ParsedScope::copy_from(const ParsedScope &source,
                             const string &sourcename, const string &destname) {
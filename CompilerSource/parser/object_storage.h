@@ -259,6 +259,7 @@ struct parsed_object : ParsedScope {
   int id;
   string sprite_name, mask_name, parent_name, polygon_name;
   bool visible, solid, persistent;
+  bool parallel_step; ///< Whether this object's instances may run their Step events on several threads.
   double depth;
 
   parsed_object* parent; ///< The parent of this object, or NULL if the object has none.
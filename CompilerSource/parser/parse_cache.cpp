@@ -0,0 +1,233 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "parse_cache.h"
+
+#include <fstream>
+#include <iterator>
+
+ParseHash &ParseHash::add(uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    hash_ ^= (value >> (i * 8)) & 0xFF;
+    hash_ *= 1099511628211ull;
+  }
+  return *this;
+}
+
+ParseHash &ParseHash::add(const std::string &str) {
+  return add(str.data(), str.size());
+}
+
+ParseHash &ParseHash::add(const char *data, size_t size) {
+  add(uint64_t(size));
+  for (size_t i = 0; i < size; ++i) {
+    hash_ ^= (unsigned char) data[i];
+    hash_ *= 1099511628211ull;
+  }
+  return *this;
+}
+
+namespace {
+
+// Bump this whenever the parser's output or the layout below changes.
+const uint64_t kCacheVersion = 1;
+const char kCacheMagic[8] = {'E', 'G', 'M', 'P', 'A', 'R', 'S', 'E'};
+
+struct Writer {
+  std::string &out;
+
+  void num(uint64_t value) {
+    for (int i = 0; i < 8; ++i) out += char((value >> (i * 8)) & 0xFF);
+  }
+  void str(const std::string &s) { num(s.size()); out += s; }
+
+  void dec(const dectrip &d) { str(d.type); str(d.prefix); str(d.suffix); }
+  void dec(const decquad &d) { str(d.type); str(d.prefix); str(d.suffix); str(d.value); }
+  void dec(int i) { num(uint64_t(int64_t(i))); }
+
+  template<typename V> void map(const std::map<string, V> &m) {
+    num(m.size());
+    for (const auto &entry : m) { str(entry.first); dec(entry.second); }
+  }
+
+  void scope(const ParsedScope &s) {
+    map(s.locals); map(s.ambiguous); map(s.globals); map(s.consts);
+    map(s.globallocals); map(s.funcs); map(s.tlines); map(s.dots);
+    num(s.initializers.size());
+    for (const initpair &init : s.initializers) { str(init.first); str(init.second); }
+  }
+
+  void code(const ParsedCode &c) {
+    str(c.code); str(c.synt);
+    num(c.strc);
+    for (unsigned i = 0; i < c.strc; ++i) str(c.strs[i]);
+  }
+};
+
+struct Reader {
+  const std::string &in;
+  size_t pos = 0;
+  bool ok = true;
+
+  uint64_t num() {
+    if (in.size() - pos < 8) { ok = false; return 0; }
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) value |= uint64_t((unsigned char) in[pos++]) << (i * 8);
+    return value;
+  }
+  std::string str() {
+    uint64_t len = num();
+    if (!ok || in.size() - pos < len) { ok = false; return {}; }
+    pos += len;
+    return in.substr(pos - len, len);
+  }
+
+  void dec(dectrip &d) { d.type = str(); d.prefix = str(); d.suffix = str(); }
+  void dec(decquad &d) { d.type = str(); d.prefix = str(); d.suffix = str(); d.value = str(); }
+  void dec(int &i) { i = int(int64_t(num())); }
+
+  template<typename V> void map(std::map<string, V> &m) {
+    for (uint64_t n = num(); ok && n; --n) {
+      std::string name = str();
+      dec(m[name]);
+    }
+  }
+
+  void scope(ParsedScope &s) {
+    map(s.locals); map(s.ambiguous); map(s.globals); map(s.consts);
+    map(s.globallocals); map(s.funcs); map(s.tlines); map(s.dots);
+    for (uint64_t n = num(); ok && n; --n) {
+      std::string name = str();
+      s.initializers.emplace_back(name, str());
+    }
+  }
+
+  void code(ParsedCode &c) {
+    c.code = str(); c.synt = str();
+    c.strc = num();
+    for (unsigned i = 0; ok && i < c.strc; ++i) c.strs[i] = str();
+  }
+};
+
+// Entries start with one of these, so that load can check them.
+const char kScriptEntry = 's', kObjectEntry = 'o';
+
+// Decodes an entry into scratch records, to find out if it is intact before
+// restore relies on it.
+bool entry_intact(const std::string &entry) {
+  Reader r{entry, 1};
+  if (entry.empty()) return false;
+  if (entry[0] == kScriptEntry) {
+    ParsedScript script;
+    r.scope(script.scope);
+    r.code(script.code);
+    if (r.num()) {
+      ParsedCode global_code(nullptr);
+      r.code(global_code);
+    }
+  } else if (entry[0] == kObjectEntry) {
+    ParsedScope scope;
+    uint64_t events = r.num();
+    r.scope(scope);
+    for (; r.ok && events; --events) {
+      ParsedCode code(nullptr);
+      r.code(code);
+    }
+  } else {
+    return false;
+  }
+  return r.ok && r.pos == entry.size();
+}
+
+}  // namespace
+
+void ParseCache::load(const std::filesystem::path &file, Key signature) {
+  signature_ = signature;
+  loaded_.clear();
+  stored_.clear();
+
+  std::ifstream f(file, std::ios_base::binary);
+  if (!f) return;
+  const std::string data{std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()};
+  if (data.compare(0, sizeof(kCacheMagic), kCacheMagic, sizeof(kCacheMagic))) return;
+
+  Reader r{data, sizeof(kCacheMagic)};
+  if (r.num() != kCacheVersion || r.num() != signature || !r.ok) return;
+  for (uint64_t n = r.num(); r.ok && n; --n) {
+    Key key = r.num();
+    std::string entry = r.str();
+    if (r.ok && entry_intact(entry)) loaded_[key] = std::move(entry);
+  }
+}
+
+void ParseCache::save(const std::filesystem::path &file) const {
+  std::string data(kCacheMagic, sizeof(kCacheMagic));
+  Writer w{data};
+  w.num(kCacheVersion);
+  w.num(signature_);
+  w.num(stored_.size());
+  for (const auto &entry : stored_) {
+    w.num(entry.first);
+    w.str(entry.second);
+  }
+  std::ofstream(file, std::ios_base::binary) << data;
+}
+
+// Entries were checked on load, so restoring them cannot fail halfway.
+bool ParseCache::restore(Key key, ParsedScript *script) const {
+  auto it = loaded_.find(key);
+  if (it == loaded_.end() || it->second[0] != kScriptEntry) return false;
+  Reader r{it->second, 1};
+  r.scope(script->scope);
+  r.code(script->code);
+  if (r.num()) {
+    script->global_code = new ParsedCode(nullptr);
+    r.code(*script->global_code);
+  }
+  return r.ok;
+}
+
+bool ParseCache::restore(Key key, parsed_object *object) const {
+  auto it = loaded_.find(key);
+  if (it == loaded_.end() || it->second[0] != kObjectEntry) return false;
+  Reader r{it->second, 1};
+  if (r.num() != object->all_events.size()) return false;
+  r.scope(*object);
+  for (ParsedEvent &event : object->all_events) r.code(event);
+  return r.ok;
+}
+
+void ParseCache::store(Key key, const ParsedScript &script) {
+  std::string &entry = stored_[key];
+  if (!entry.empty()) return;
+  entry += kScriptEntry;
+  Writer w{entry};
+  w.scope(script.scope);
+  w.code(script.code);
+  w.num(script.global_code != nullptr);
+  if (script.global_code) w.code(*script.global_code);
+}
+
+void ParseCache::store(Key key, const parsed_object &object) {
+  std::string &entry = stored_[key];
+  if (!entry.empty()) return;
+  entry += kObjectEntry;
+  Writer w{entry};
+  w.num(object.all_events.size());
+  w.scope(object);
+  for (const ParsedEvent &event : object.all_events) w.code(event);
+}
@@ -0,0 +1,70 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_PARSE_CACHE_H
+#define ENIGMA_PARSE_CACHE_H
+
+#include "object_storage.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+
+// 64-bit FNV-1a over a sequence of fields. Each string is preceded by its
+// length, so that different splits of the same bytes hash differently.
+class ParseHash {
+  uint64_t hash_ = 14695981039346656037ull;
+
+ public:
+  ParseHash &add(uint64_t value);
+  ParseHash &add(const std::string &str);
+  ParseHash &add(const char *data, size_t size);
+  uint64_t get() const { return hash_; }
+};
+
+// Results of the syntax check and primary parse of scripts, timeline moments
+// and objects, kept between builds so that unchanged code is not parsed again.
+//
+// Units are keyed by a hash of their code together with a signature of
+// everything else the parse depends on (script and resource names, settings,
+// the engine's API). The file only holds entries for one signature; changing
+// any of those drops the whole cache. Only entries stored during a build are
+// saved afterward, so the file does not grow with old versions of the code.
+class ParseCache {
+ public:
+  typedef uint64_t Key;
+
+  // Reads the file, keeping its entries only if saved under this signature.
+  void load(const std::filesystem::path &file, Key signature);
+  void save(const std::filesystem::path &file) const;
+
+  // Fill in a freshly made record from the entry for the key, if any. These
+  // do not modify the cache, so they may be called from several threads.
+  bool restore(Key key, ParsedScript *script) const;
+  bool restore(Key key, parsed_object *object) const;
+
+  // Record a parsed unit; these must be called before linking modifies it.
+  void store(Key key, const ParsedScript &script);
+  void store(Key key, const parsed_object &object);
+
+ private:
+  Key signature_ = 0;
+  std::map<Key, std::string> loaded_, stored_;
+};
+
+#endif
@@ -748,7 +748,10 @@ int parser_secondary(CompileState &state, ParsedCode *parsed_code) {
   // Handle switch statements. Badly.
   if (parsed_code) // We need to know this to deal with string hashes
   {
-    static int switch_count = 0;
+    // Labels are local to the function generated for this code, so counting
+    // from zero per piece of code keeps them unique, and keeps the output the
+    // same no matter which thread parsed what first.
+    int switch_count = 0;
     int string_index = 0; // Number of strings before this statement
     for (pt pos = 0; pos < synt.length(); pos++)
     {
@@ -33,4 +33,4 @@ void parser_init();
 string file_parse(string filename,string outname);
 void parser_main(ParsedCode* x, const std::set<std::string>& script_names=std::set<std::string>(), bool isObject=false);
 int parser_secondary(CompileState &state, ParsedCode *pev);
-void print_to_file(string,string,const unsigned int,const varray<string>&,int,ofstream&);
+void print_to_file(string,string,const unsigned int,const varray<string>&,int,std::ostream&);
@@ -30,6 +30,7 @@
 #include <string>
 #include <iostream>
 #include <cstdio>
+#include <memory>
 using namespace std;
 #include "darray.h"
 
@@ -45,15 +46,18 @@ typedef size_t pt; //Use size_t as our pos type; helps on 64bit systems.
 map<string,char> edl_tokens; // Logarithmic lookup, with token.
 typedef map<string,char>::iterator tokiter;
 
-int scope_braceid = 0;
+thread_local int scope_braceid = 0;
 extern string tostring(int);
 
 #include <Storage/definition.h>
-static jdi::definition_scope *current_scope;
+// Code is parsed on several threads at once, so each keeps its own scope for
+// the code it is parsing, rather than one in the shared global scope.
+static thread_local std::unique_ptr<jdi::definition_scope> script_scope;
+static thread_local jdi::definition_scope *current_scope;
 
 int dropscope()
 {
-  if (current_scope != main_context->get_global())
+  if (current_scope != script_scope.get())
   current_scope = current_scope->parent;
   return 0;
 }
@@ -67,7 +71,7 @@ int quickscope()
 int initscope(string name)
 {
   scope_braceid = 0;
-  main_context->get_global()->members[name] = current_scope = new jdi::definition_scope(name,main_context->get_global(),jdi::DEF_NAMESPACE);
+  script_scope.reset(current_scope = new jdi::definition_scope(name,main_context->get_global(),jdi::DEF_NAMESPACE));
   return 0;
 }
 int quicktype(unsigned flags, string name)
@@ -828,7 +832,7 @@ static inline string string_settings_escape(string n)
   return n;
 }
 
-void print_to_file(string code,string synt,const unsigned int strc, const varray<string> &string_in_code,int indentmin_b4,ofstream &of)
+void print_to_file(string code,string synt,const unsigned int strc, const varray<string> &string_in_code,int indentmin_b4,std::ostream &of)
 {
   //FILE* of = fopen("/media/HP_PAVILION/Documents and Settings/HP_Owner/Desktop/parseout.txt","w+b");
   FILE* of_ = fopen("/home/josh/Desktop/parseout.txt","ab");
@@ -43,12 +43,14 @@ using namespace std;
 #include "gcc_interface/gcc_backend.h"
 #include "parse_ide_settings.h"
 #include "compiler/compile_common.h"
+#include "compiler/codegen_file.h"
 #include "settings.h"
+#include "resource_format.h"
 
 inline string fc(const char* fn);
 static void reset_ide_editables()
 {
-  ofstream wto;
+  codegen_ofstream wto;
   string f2comp = fc((codegen_directory/"API_Switchboard.h").u8string().c_str());
   string f2write = license;
     string inc = "/include.h\"\n";
@@ -71,12 +73,12 @@ static void reset_ide_editables()
 
   if (f2comp != f2write + "\n")
   {
-    wto.open((codegen_directory/"API_Switchboard.h").u8string().c_str(),ios_base::out);
+    wto.open(codegen_directory/"API_Switchboard.h");
       wto << f2write << endl;
     wto.close();
   }
 
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/LIBINCLUDE.h").c_str());
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/LIBINCLUDE.h");
     wto << license;
     wto << "/*************************************************************\nOptionally included libraries\n****************************/\n";
     wto << "#define STRINGLIB 1\n#define COLORSLIB 1\n#define STDRAWLIB 1\n#define PRIMTVLIB 1\n#define WINDOWLIB 1\n"
@@ -84,14 +86,16 @@ static void reset_ide_editables()
     wto << "/***************\nEnd optional libs\n ***************/\n";
   wto.close();
 
-  wto.open((codegen_directory/"Preprocessor_Environment_Editable/GAME_SETTINGS.h").c_str(),ios_base::out);
+  wto.open(codegen_directory/"Preprocessor_Environment_Editable/GAME_SETTINGS.h");
     wto << license;
     wto << "#define ASSUMEZERO 0\n";
     wto << "#define PRIMBUFFER 0\n";
     wto << "#define PRIMDEPTH2 6\n";
     wto << "#define AUTOLOCALS 0\n";
     wto << "#define MODE3DVARS 0\n";
+    wto << "#ifndef ENIGMA_DECLARATIONS_ONLY\n";
     wto << "void ABORT_ON_ALL_ERRORS() { }\n";
+    wto << "#endif\n";
     wto << '\n';
   wto.close();
 }
@@ -140,6 +144,16 @@ void parse_ide_settings(const char* eyaml)
   }
   setting::automatic_semicolons   = settree.get("automatic-semicolons").toBool();
   setting::keyword_blacklist = settree.get("keyword-blacklist").toString();
+  setting::resource_codec = settree.exists("resource-codec") && settree.get("resource-codec").toInt() == 1
+      ? enigma::resource_format::CODEC_LZ4 : enigma::resource_format::CODEC_ZLIB;
+  setting::lazy_resources = settree.exists("lazy-resources") && settree.get("lazy-resources").toBool();
+  setting::benchmark_build = settree.exists("benchmark-build") && settree.get("benchmark-build").toBool();
+  setting::profile_level = setting::PROFILE_NONE;
+  if (settree.exists("profile-events")) {
+    const int level = settree.get("profile-events").toInt();
+    if (level == setting::PROFILE_EVENTS || level == setting::PROFILE_SCRIPTS)
+      setting::profile_level = setting::PROFILE_LVL(level);
+  }
 
   // The number of compile jobs
   num_make_jobs = "1";
@@ -30,6 +30,7 @@
 #include "utility.h"
 
 #include "eyaml/eyaml.h"
+#include "resource_format.h"
 
 #include <fstream>
 #include <iostream>
@@ -52,6 +53,10 @@ namespace setting
   bool automatic_semicolons = 0; // Determines whether semicolons should automatically be added or if the user wants strict syntax
   COMPLIANCE_LVL compliance_mode = COMPL_STANDARD;
   std::string keyword_blacklist = "";
+  int resource_codec = enigma::resource_format::CODEC_ZLIB;    // How sprite and background images are packed; a resource_format::Codec
+  bool lazy_resources = 0;   // Determines whether sprites and backgrounds are decoded on first use rather than at startup
+  bool benchmark_build = 0;  // Determines whether the game times its events and counts allocations for benchmark runs
+  PROFILE_LVL profile_level = PROFILE_NONE;
 }
 
 CompilerInfo compilerInfo;
@@ -65,6 +65,13 @@ namespace setting
     COMPL_STANDARD = 65535,    //Standard (enigma) compliance. Default and recommended. High so we can do things like compliance_mode<=8
   };
 
+  //What the event profiler built into the game records.
+  enum PROFILE_LVL {
+    PROFILE_NONE = 0,     //No profiler; the event loop is generated as usual.
+    PROFILE_EVENTS = 1,   //Time each event call by event and object.
+    PROFILE_SCRIPTS = 2,  //Also time each script call.
+  };
+
   //Compatibility / Progess options
   extern bool use_cpp_strings;  // Defines what language strings are inherited from.    0 = GML,               1 = C++
   extern bool use_cpp_escapes;  // Defines what language strings are inherited from.    0 = GML,               1 = C++
@@ -75,6 +82,10 @@ namespace setting
   extern bool automatic_semicolons; // Determines whether semicolons should automatically be added or if the user wants strict syntax
   extern COMPLIANCE_LVL compliance_mode; // How to resolve differences between GM versions.
   extern std::string keyword_blacklist; //Words to blacklist from user scripts, separated by commas.
+  extern int resource_codec;    // How sprite and background images are packed; a resource_format::Codec
+  extern bool lazy_resources;   // Determines whether sprites and backgrounds are decoded on first use rather than at startup
+  extern bool benchmark_build;  // Determines whether the game times its events and counts allocations for benchmark runs
+  extern PROFILE_LVL profile_level; // What the game's event profiler records, if anything.
 }
 
 struct CompilerInfo {
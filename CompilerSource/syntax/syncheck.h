@@ -32,7 +32,7 @@
 
 namespace syncheck
 {
-  extern std::string syerr;
+  extern thread_local std::string syerr;
   int syntaxcheck(std::string code, std::string& newcode);
   void addscr(std::string name);
 }
@@ -32,6 +32,7 @@
 #include <cstdlib>
 #include <vector>
 #include <iostream>
+#include <mutex>
 
 #include "settings.h"
 #include "general/parse_basics_old.h"
@@ -55,6 +56,10 @@ extern string tostring(int);
 
 namespace {
   std::set<std::string> blacklist;
+  std::once_flag blacklist_built;
+  #ifdef WRITE_UNIMPLEMENTED_TXT
+  std::mutex unimplemented_mutex;
+  #endif
 }
 
 namespace syncheck
@@ -170,8 +175,9 @@ namespace syncheck
     }
   };
 
-  string syerr;
-  vector<token> lex;
+  // Per thread, as code is checked on several threads at once.
+  thread_local string syerr;
+  thread_local vector<token> lex;
 
   struct open_parenth_info {
     unsigned ind;
@@ -215,7 +221,7 @@ namespace syncheck
     }
 
     //Build our blacklist.
-    if (blacklist.empty()) {
+    std::call_once(blacklist_built, [] {
       std::stringstream keyword;
       for (std::string::const_iterator it=setting::keyword_blacklist.begin(); it!=setting::keyword_blacklist.end(); it++) {
         char c = *it;
@@ -231,7 +237,7 @@ namespace syncheck
       if (!keyword.str().empty()) {
         blacklist.insert(keyword.str());
       }
-    }
+    });
 
     pt pos = 0;
     unsigned mymacroind = 0;
@@ -621,6 +627,7 @@ namespace syncheck
               syerr += ": use semicolon to separate object ID and variable name.";
             return lex[i].pos;
             #else
+             std::lock_guard<std::mutex> lock(unimplemented_mutex);
              unimplemented_function_list[lex[i].content] = 'U';
             #endif
           }
@@ -665,6 +672,7 @@ namespace syncheck
               return (syerr = "Too few arguments to function `" + lex[i].content + "': provided " + tostring(params) + ", required " + tostring(minarg) + ".", lex[lm].pos);
 
             #else
+                 std::lock_guard<std::mutex> lock(unimplemented_mutex);
                  if (!lex[i].ext->refstack.is_varargs() && (exceeded_at || params > maxarg))
                           unimplemented_function_list[lex[i].content] = 'M'; //M for too many arguments
                  if (params < minarg)
@@ -743,8 +743,6 @@ bool move_bounce_object(int object, bool adv, bool solid_only)
 
 }
 
-typedef std::pair<int,enigma::object_basic*> inode_pair;
-
 namespace enigma_user
 {
 
@@ -767,25 +765,25 @@ void instance_deactivate_region(int rleft, int rtop, int rwidth, int rheight, bo
         if (left <= (rleft+rwidth) && rleft <= right && top <= (rtop+rheight) && rtop <= bottom) {
             if (inside) {
             inst->deactivate();
-            enigma::instance_deactivated_list.insert(inode_pair(inst->id,inst));
+            enigma::instance_deactivated_list.insert(inst->id,inst);
             }
         } else {
             if (!inside) {
                 inst->deactivate();
-                enigma::instance_deactivated_list.insert(inode_pair(inst->id,inst));
+                enigma::instance_deactivated_list.insert(inst->id,inst);
             }
         }
     }
 }
 
 void instance_activate_region(int rleft, int rtop, int rwidth, int rheight, bool inside) {
-    std::map<int,enigma::object_basic*>::iterator iter = enigma::instance_deactivated_list.begin();
-    while (iter != enigma::instance_deactivated_list.end()) {
+    enigma::instance_table<enigma::object_basic*> &deactivated = enigma::instance_deactivated_list;
+    for (int id = deactivated.first(), next; id != -1; id = next) {
+        next = deactivated.next(id);
 
-        enigma::object_collisions* const inst = (enigma::object_collisions*) iter->second;
+        enigma::object_collisions* const inst = (enigma::object_collisions*) deactivated.get(id);
 
         if (inst->sprite_index == -1 && (inst->mask_index == -1)) { //no sprite/mask then no collision
-            ++iter;
             continue;
         }
 
@@ -796,24 +794,17 @@ void instance_activate_region(int rleft, int rtop, int rwidth, int rheight, bool
 
         int left, top, right, bottom;
         get_border(&left, &right, &top, &bottom, box.left(), box.top(), box.right(), box.bottom(), x, y, xscale, yscale, ia);
-
-        bool removed = false;
         if (left <= (rleft+rwidth) && rleft <= right && top <= (rtop+rheight) && rtop <= bottom) {
             if (inside) {
                 inst->activate();
-                enigma::instance_deactivated_list.erase(iter++);
-                removed = true;
+                deactivated.erase(id);
             }
         } else {
             if (!inside) {
                 inst->activate();
-                enigma::instance_deactivated_list.erase(iter++);
-                removed = true;
+                deactivated.erase(id);
             }
         }
-        if (!removed) {
-            ++iter;
-        }
     }
 }
 
@@ -866,7 +857,7 @@ void instance_deactivate_circle(int x, int y, int r, bool inside, bool notme)
             if (inside)
             {
                 inst->deactivate();
-                enigma::instance_deactivated_list.insert(inode_pair(inst->id, inst));
+                enigma::instance_deactivated_list.insert(inst->id,inst);
             }
         }
         else
@@ -874,7 +865,7 @@ void instance_deactivate_circle(int x, int y, int r, bool inside, bool notme)
             if (!inside)
             {
                 inst->deactivate();
-                enigma::instance_deactivated_list.insert(inode_pair(inst->id, inst));
+                enigma::instance_deactivated_list.insert(inst->id,inst);
             }
         }
     }
@@ -883,12 +874,12 @@ void instance_deactivate_circle(int x, int y, int r, bool inside, bool notme)
 
 void instance_activate_circle(int x, int y, int r, bool inside)
 {
-    std::map<int,enigma::object_basic*>::iterator iter = enigma::instance_deactivated_list.begin();
-    while (iter != enigma::instance_deactivated_list.end()) {
-        enigma::object_collisions* const inst = (enigma::object_collisions*) iter->second;
+    enigma::instance_table<enigma::object_basic*> &deactivated = enigma::instance_deactivated_list;
+    for (int id = deactivated.first(), next; id != -1; id = next) {
+        next = deactivated.next(id);
+        enigma::object_collisions* const inst = (enigma::object_collisions*) deactivated.get(id);
 
         if (inst->sprite_index == -1 && (inst->mask_index == -1)) { //no sprite/mask then no collision
-            ++iter;
             continue;
         }
 
@@ -906,14 +897,12 @@ void instance_activate_circle(int x, int y, int r, bool inside)
                                  line_ellipse_intersects(r, r, bottom-y, left-x, right-x) ||
                                  (x >= left && x <= right && y >= top && y <= bottom); // Circle inside bbox.
 
-        bool removed = false;
         if (intersects)
         {
             if (inside)
             {
                 inst->activate();
-                enigma::instance_deactivated_list.erase(iter++);
-                removed = true;
+                deactivated.erase(id);
             }
         }
         else
@@ -921,13 +910,9 @@ void instance_activate_circle(int x, int y, int r, bool inside)
             if (!inside)
             {
                 inst->activate();
-                enigma::instance_deactivated_list.erase(iter++);
-                removed = true;
+                deactivated.erase(id);
             }
         }
-        if (!removed) {
-            ++iter;
-        }
     }
 }
 
@@ -26,9 +26,13 @@
 
 #include "BBOXutil.h"
 #include "BBOXimpl.h"
+#include "Collision_Systems/General/collision_index.h"
 #include <cmath>
 #include <floatcomp.h>
 
+using enigma::collision_index::entry;
+using enigma::collision_index::clamp_coord;
+
 static inline void get_border(int *leftv, int *rightv, int *topv, int *bottomv, int left, int top, int right, int bottom, double x, double y, double xscale, double yscale, double angle)
 {
     if (fzero(angle))
@@ -58,11 +62,58 @@ static inline void get_border(int *leftv, int *rightv, int *topv, int *bottomv,
     }
 }
 
+bool enigma::collision_bounds(const object_collisions* inst, int &left, int &top, int &right, int &bottom)
+{
+    if (inst->sprite_index == -1 && inst->mask_index == -1) // No sprite/mask, no collision
+        return false;
+    const BoundingBox &box = inst->$bbox_relative();
+    get_border(&left, &right, &top, &bottom, box.left(), box.top(), box.right(), box.bottom(),
+               inst->x, inst->y, inst->image_xscale, inst->image_yscale, inst->image_angle);
+    return true;
+}
+
 static inline int min(int x, int y) { return x<y? x : y; }
 static inline double min(double x, double y) { return x<y? x : y; }
 static inline int max(int x, int y) { return x>y? x : y; }
 static inline double max(double x, double y) { return x>y? x : y; }
 
+static bool line_hits_box(int x1, int y1, int x2, int y2, int left, int top, int right, int bottom)
+{
+    double minX = max(min(x1,x2),left);
+    double maxX = min(max(x1,x2),right);
+    if (minX > maxX)
+        return false;
+
+    // Find corresponding min and max Y for min and max X we found before
+    double minY = y1;
+    double maxY = y2;
+    double dx = x2 - x1;
+
+    //do slope check of non vertical lines (dx != 0)
+    if (fnzero(dx))
+    {
+        double a = (y2 - y1) / dx;
+        double b = y1 - a * x1;
+        minY = a * minX + b;
+        maxY = a * maxX + b;
+    }
+
+    if (minY > maxY) //swap
+    {
+        double tmp = maxY;
+        maxY = minY;
+        minY = tmp;
+    }
+
+    // Find the intersection of the segment's and rectangle's y-projections
+    if (maxY > bottom)
+        maxY = bottom;
+    if (minY < top)
+        minY = top;
+
+    return minY <= maxY; // If Y-projections do not intersect return false
+}
+
 enigma::object_collisions* const collide_inst_inst(int object, bool solid_only, bool notme, double x, double y)
 {
     enigma::object_collisions* const inst1 = ((enigma::object_collisions*)enigma::instance_event_iterator->inst);
@@ -79,6 +130,12 @@ enigma::object_collisions* const collide_inst_inst(int object, bool solid_only,
 
     get_border(&left1, &right1, &top1, &bottom1, box.left(), box.top(), box.right(), box.bottom(), x, y, xscale1, yscale1, ia1);
 
+    if (enigma::collision_index::usable(object)) {
+        return enigma::collision_index::find_first(object, left1, top1, right1, bottom1, [&](const entry& e) {
+            return !(notme && e.id == inst1->id) && !(solid_only && !e.inst->solid);
+        });
+    }
+
     for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
     {
         enigma::object_collisions* const inst2 = (enigma::object_collisions*)*it;
@@ -115,6 +172,13 @@ enigma::object_collisions* const collide_inst_rect(int object, bool solid_only,
         y1 = y3;
     }
 
+    if (enigma::collision_index::usable(object)) {
+        const unsigned self = enigma::instance_event_iterator->inst->id;
+        return enigma::collision_index::find_first(object, x1, y1, x2, y2, [&](const entry& e) {
+            return !(notme && e.id == self) && !(solid_only && !e.inst->solid);
+        });
+    }
+
     for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
     {
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
@@ -144,6 +208,14 @@ enigma::object_collisions* const collide_inst_line(int object, bool solid_only,
     if (x1 == x2 && y1 == y2)
         return collide_inst_point(object, solid_only, notme, x1, y1);
 
+    if (enigma::collision_index::usable(object)) {
+        const unsigned self = enigma::instance_event_iterator->inst->id;
+        return enigma::collision_index::find_first(object, min(x1,x2), min(y1,y2), max(x1,x2), max(y1,y2), [&](const entry& e) {
+            return !(notme && e.id == self) && !(solid_only && !e.inst->solid) &&
+                   line_hits_box(x1, y1, x2, y2, e.left, e.top, e.right, e.bottom);
+        });
+    }
+
     for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
     {
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
@@ -161,40 +233,7 @@ enigma::object_collisions* const collide_inst_line(int object, bool solid_only,
         int left, top, right, bottom;
         get_border(&left, &right, &top, &bottom, box.left(), box.top(), box.right(), box.bottom(), x, y, xscale, yscale, ia);
 
-        double minX = max(min(x1,x2),left);
-        double maxX = min(max(x1,x2),right);
-        if (minX > maxX)
-            continue;
-
-        // Find corresponding min and max Y for min and max X we found before
-        double minY = y1;
-        double maxY = y2;
-        double dx = x2 - x1;
-
-        //do slope check of non vertical lines (dx != 0)
-        if (fnzero(dx))
-        {
-            double a = (y2 - y1) / dx;
-            double b = y1 - a * x1;
-            minY = a * minX + b;
-            maxY = a * maxX + b;
-        }
-
-        if (minY > maxY) //swap
-        {
-            double tmp = maxY;
-            maxY = minY;
-            minY = tmp;
-        }
-
-        // Find the intersection of the segment's and rectangle's y-projections
-        if (maxY > bottom)
-            maxY = bottom;
-        if (minY < top)
-            minY = top;
-
-
-        if (minY <= maxY) // If Y-projections do not intersect return false
+        if (line_hits_box(x1, y1, x2, y2, left, top, right, bottom))
             return inst;
     }
     return NULL;
@@ -202,6 +241,13 @@ enigma::object_collisions* const collide_inst_line(int object, bool solid_only,
 
 enigma::object_collisions* const collide_inst_point(int object, bool solid_only, bool notme, int x1, int y1)
 {
+    if (enigma::collision_index::usable(object)) {
+        const unsigned self = enigma::instance_event_iterator->inst->id;
+        return enigma::collision_index::find_first(object, x1, y1, x1, y1, [&](const entry& e) {
+            return !(notme && e.id == self) && !(solid_only && !e.inst->solid);
+        });
+    }
+
     for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
     {
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
@@ -249,6 +295,24 @@ enigma::object_collisions* const collide_inst_ellipse(int object, bool solid_onl
     if (fzero(rx) || fzero(ry))
         return 0;
 
+    if (enigma::collision_index::usable(object)) {
+        const unsigned self = enigma::instance_event_iterator->inst->id;
+        // Pad the ellipse's bounds by a pixel so rounding in the exact test can't be pruned away.
+        const double arx = fabs(rx), ary = fabs(ry);
+        return enigma::collision_index::find_first(object,
+            clamp_coord(floor(x1 - arx) - 1), clamp_coord(floor(y1 - ary) - 1),
+            clamp_coord(ceil(x1 + arx) + 1), clamp_coord(ceil(y1 + ary) + 1), [&](const entry& e) {
+            if ((notme && e.id == self) || (solid_only && !e.inst->solid))
+                return false;
+            const int left = e.left, top = e.top, right = e.right, bottom = e.bottom;
+            return line_ellipse_intersects(rx, ry, left-x1, top-y1, bottom-y1) ||
+                   line_ellipse_intersects(rx, ry, right-x1, top-y1, bottom-y1) ||
+                   line_ellipse_intersects(ry, rx, top-y1, left-x1, right-x1) ||
+                   line_ellipse_intersects(ry, rx, bottom-y1, left-x1, right-x1) ||
+                   (x1 >= left && x1 <= right && y1 >= top && y1 <= bottom); // Ellipse inside bbox.
+        });
+    }
+
     for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
     {
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
@@ -82,4 +82,10 @@ void instance_deactivate_circle(int x, int y, int r, bool inside = true, bool no
 void instance_activate_circle(int x, int y, int r, bool inside = true);
 var instance_get_mtv(int object);
 
+// The broad-phase index prunes the candidates of collision queries by position.
+// It is on by default; turning it off falls back to testing every instance.
+void collision_broadphase_enable(bool enable);
+bool collision_broadphase_enabled();
+void collision_broadphase_set_cell_size(int size);
+
 }
@@ -0,0 +1,276 @@
+////////////////////////////////////
+// Broad-phase spatial index for collision queries, shared by the collision systems.
+// The grid covers the room and is resized when the room size changes; instances
+// outside the room land in its border cells.
+////////////////////////////////////
+
+#include "collision_index.h"
+#include "Collision_Systems/collision_mandatory.h"
+#include "Collision_Systems/General/CSfuncs.h"
+#include "Universal_System/Instances/instance_system.h"
+#include "Universal_System/Instances/callbacks_events.h"
+#include "Universal_System/roomsystem.h"
+
+#include <spatial-hash/spatialHash.h>
+#include <algorithm>
+
+namespace enigma {
+  extern size_t object_idmax;
+
+namespace collision_index {
+
+  std::vector<entry> entries;
+  static std::vector<int> free_slots;
+
+  static SpatialHash grid;
+  // Rooms needing more cells than this get coarser cells instead.
+  static const long long max_cells = 1 << 20;
+
+  static bool enabled = true;
+  static int cell_size = 64;
+  static unsigned sequence = 0;
+  static std::vector<int> results;
+  static std::vector<object_collisions*> ordered;
+
+  // Sizes the grid to the room, keeping the hashed entries.
+  static void fit_room() {
+    const int width = enigma_user::room_width, height = enigma_user::room_height;
+    int size = cell_size;
+    while ((long long)(width / size + 1) * (height / size + 1) > max_cells)
+      size *= 2;
+    if (size != grid.getCellSize() || width != grid.getSceneWidth() || height != grid.getSceneHeight())
+      grid.resize(size, width, height);
+  }
+
+  static void unhash(int slot) {
+    entry& e = entries[slot];
+    if (!e.hashed) return;
+    grid.removeObject(slot);
+    e.hashed = false;
+  }
+
+  // Recomputes the bbox of an entry's instance if anything it depends on
+  // changed, moving it between cells only if its cell range changed.
+  static void rehash(int slot) {
+    entry& e = entries[slot];
+    object_collisions* const inst = e.inst;
+    if (!inst->$collision_moved() && e.hashed)
+      return;
+    if (!collision_bounds(inst, e.left, e.top, e.right, e.bottom)) {
+      unhash(slot);
+      return;
+    }
+    const BBOX box = { e.left, e.top, e.right, e.bottom };
+    grid.updateHash(slot, box);
+    e.hashed = true;
+  }
+
+  static void unhash_all() {
+    grid.clear();
+    for (entry& e : entries)
+      e.hashed = false;
+    for (object_collisions* inst : collision_dirty_instances)
+      if (inst) inst->$collision_dirty = -1;
+    collision_dirty_instances.clear();
+  }
+
+  static void touch_all() {
+    for (entry& e : entries)
+      if (e.inst) collision_touch(e.inst);
+  }
+
+  static void link(object_basic* ob) {
+    object_collisions* const inst = (object_collisions*)ob;
+    int slot;
+    if (free_slots.empty()) {
+      slot = entries.size();
+      entries.push_back(entry());
+    } else {
+      slot = free_slots.back();
+      free_slots.pop_back();
+    }
+    entry& e = entries[slot];
+    e.inst = inst;
+    e.id = inst->id;
+    e.order = sequence++;
+    e.hashed = false;
+    inst->$collision_slot = slot;
+    // Position and sprite are assigned after linking; hash on the next query.
+    collision_touch(inst);
+  }
+
+  static void unlink(object_basic* ob) {
+    object_collisions* const inst = (object_collisions*)ob;
+    const int slot = inst->$collision_slot;
+    if (slot < 0) return;
+    unhash(slot);
+    entries[slot].inst = NULL;
+    free_slots.push_back(slot);
+    inst->$collision_slot = -1;
+  }
+
+  bool usable(int object) {
+    return enabled && (object == enigma_user::all || (object >= 0 && size_t(object) < object_idmax));
+  }
+
+  void sync() {
+    fit_room();
+    if (collision_sweep_pending) {
+      collision_sweep_pending = false;
+      for (size_t slot = 0; slot < entries.size(); ++slot)
+        if (entries[slot].inst) rehash(slot);
+    }
+    if (instance_event_iterator)
+      collision_touch(instance_event_iterator->inst);
+    for (size_t i = 0; i < collision_dirty_instances.size(); ++i) {
+      object_collisions* const inst = collision_dirty_instances[i];
+      if (!inst) continue;
+      inst->$collision_dirty = -1;
+      if (inst->$collision_slot >= 0)
+        rehash(inst->$collision_slot);
+    }
+    collision_dirty_instances.clear();
+  }
+
+  const std::vector<int>& gather(int left, int top, int right, int bottom) {
+    results.clear();
+    const BBOX region = { left, top, right, bottom };
+    grid.getNearby(region, results);
+    return results;
+  }
+
+  const std::vector<object_collisions*>& candidates(int object, int left, int top, int right, int bottom) {
+    sync();
+    const std::vector<int>& slots = gather(left, top, right, bottom);
+    std::vector<int> &members = results; // Filtered in place
+    size_t n = 0;
+    for (int slot : slots)
+      if (is_member(entries[slot], object))
+        members[n++] = slot;
+    members.resize(n);
+    std::sort(members.begin(), members.end(), [object](int a, int b) {
+      return precedes(entries[a], entries[b], object);
+    });
+
+    ordered.clear();
+    for (int slot : members)
+      ordered.push_back(entries[slot].inst);
+    return ordered;
+  }
+
+  candidate_iterator::candidate_iterator(int object, int left, int top, int right, int bottom): list(NULL), pos(0) {
+    if (usable(object))
+      list = &candidates(object, left, top, right, bottom);
+    else
+      scan = fetch_inst_iter_by_int(object);
+  }
+
+  typedef std::vector<std::pair<unsigned, object_collisions*> > candidate_list;
+  // Lists for collision_candidates, kept so that dispatching collision events
+  // doesn't allocate. Dispatchers nest when an event calls event_perform.
+  static std::vector<candidate_list*> candidate_pool;
+
+  static inline unsigned list_order(const entry& e, int object) {
+    return object == enigma_user::all ? e.id : e.order;
+  }
+
+  // Appends the instances of object which the current instance may be
+  // colliding with and which come after key in the object's list, sorted.
+  static void fill_candidates(candidate_list& list, int object, bool after, unsigned key) {
+    const size_t start = list.size();
+    if (!enabled) {
+      // The index is off but still tracks the list order of each instance.
+      for (iterator it = fetch_inst_iter_by_int(object); it; ++it) {
+        const int slot = ((object_collisions*)*it)->$collision_slot;
+        if (slot < 0) continue;
+        const unsigned k = list_order(entries[slot], object);
+        if (!after || k > key)
+          list.push_back(std::make_pair(k, entries[slot].inst));
+      }
+    } else {
+      int left, top, right, bottom;
+      sync();
+      if (!collision_bounds((object_collisions*)instance_event_iterator->inst, left, top, right, bottom))
+        return;
+      for (int slot : gather(left, top, right, bottom)) {
+        const entry& e = entries[slot];
+        const unsigned k = list_order(e, object);
+        if (is_member(e, object) && (!after || k > key))
+          list.push_back(std::make_pair(k, e.inst));
+      }
+    }
+    std::sort(list.begin() + start, list.end());
+  }
+
+} // namespace collision_index
+
+  collision_candidates::collision_candidates(int object): object(object), list(NULL), pos(0) {
+    using namespace collision_index;
+    if (!usable(object) || !instance_event_iterator) {
+      scan = fetch_inst_iter_by_int(object);
+      return;
+    }
+    if (candidate_pool.empty()) {
+      list = new candidate_list();
+    } else {
+      list = candidate_pool.back();
+      candidate_pool.pop_back();
+    }
+    fill_candidates(*list, object, false, 0);
+  }
+
+  collision_candidates::~collision_candidates() {
+    if (!list) return;
+    list->clear();
+    collision_index::candidate_pool.push_back(list);
+  }
+
+  void collision_candidates::refresh() {
+    if (!list || pos >= list->size()) return;
+    // Keep the current instance in front, so that ++ moves past it.
+    const std::pair<unsigned, object_collisions*> current = (*list)[pos];
+    list->clear();
+    list->push_back(current);
+    pos = 0;
+    collision_index::fill_candidates(*list, object, true, current.first);
+  }
+
+  void collision_system_initialize()
+  {
+    register_callback_instance_link(collision_index::link);
+    register_callback_instance_unlink(collision_index::unlink);
+    collision_tracking = collision_index::enabled;
+  }
+
+} // namespace enigma
+
+namespace enigma_user
+{
+
+void collision_broadphase_enable(bool enable)
+{
+  using namespace enigma::collision_index;
+  if (enable == enabled) return;
+  enabled = enable;
+  enigma::collision_tracking = enable;
+  if (enable)
+    touch_all();
+  else
+    unhash_all();
+}
+
+bool collision_broadphase_enabled()
+{
+  return enigma::collision_index::enabled;
+}
+
+void collision_broadphase_set_cell_size(int size)
+{
+  using namespace enigma::collision_index;
+  if (size < 1) size = 1;
+  cell_size = size;
+  // The grid keeps the stored boxes, so resizing needs no rehash.
+  if (enabled) fit_room();
+}
+
+}
@@ -0,0 +1,105 @@
+////////////////////////////////////
+// Broad-phase spatial index for collision queries, shared by the collision systems.
+// Instances are kept in a SpatialHash covering the room, by the bounding box
+// they had when last touched (see collision_touch). Queries gather the cells
+// overlapping the query region instead of walking every instance of the
+// requested object.
+////////////////////////////////////
+
+#ifndef ENIGMA_COLLISION_INDEX_H
+#define ENIGMA_COLLISION_INDEX_H
+
+#include "Universal_System/Object_Tiers/collisions_object.h"
+#include "Universal_System/Instances/instance_iterator.h"
+#include <climits>
+#include <vector>
+
+namespace enigma {
+
+  // Computes the world-space bbox by which the collision system tests an
+  // instance, at its current position. Returns false if the instance cannot
+  // collide with anything. Each collision system using the index defines this.
+  bool collision_bounds(const object_collisions* inst, int &left, int &top, int &right, int &bottom);
+
+namespace collision_index {
+
+  struct entry {
+    object_collisions* inst; // NULL when this slot is free
+    unsigned id;             // Instance id; the order of the instance list
+    unsigned order;          // Activation sequence; the order of the object lists
+    bool hashed;             // Whether the entry is in the grid (can collide)
+    int left, top, right, bottom; // World-space bbox, as computed by collision_bounds
+  };
+
+  extern std::vector<entry> entries;
+
+  // Converts a query bound to an int the index can hash without overflow.
+  inline int clamp_coord(double v) {
+    return v < INT_MIN/2 ? INT_MIN/2 : v > INT_MAX/2 ? INT_MAX/2 : int(v);
+  }
+
+  // Whether queries against the given object can be answered by the index.
+  // This is true when the index is enabled and object is all or an object index.
+  bool usable(int object);
+
+  // Rehashes every queued instance, including the current one, so that the
+  // index agrees with the state of the instances.
+  void sync();
+
+  // Returns the slots of all hashed entries whose bbox overlaps the region.
+  const std::vector<int>& gather(int left, int top, int right, int bottom);
+
+  // Whether entry a comes before b when iterating fetch_inst_iter_by_int(object).
+  inline bool precedes(const entry& a, const entry& b, int object) {
+    return object == enigma_user::all ? a.id < b.id : a.order < b.order;
+  }
+
+  inline bool is_member(const entry& e, int object) {
+    return object == enigma_user::all || e.inst->object_index == object || e.inst->can_cast(object);
+  }
+
+  // Returns the instance of object which a linear scan of the object's list
+  // would find first, among those whose bbox overlaps the region and for which
+  // test(entry) holds. The index must be usable for object.
+  template<typename Test>
+  object_collisions* find_first(int object, int left, int top, int right, int bottom, Test test) {
+    sync();
+    const std::vector<int>& candidates = gather(left, top, right, bottom);
+    const entry* best = NULL;
+    for (int slot : candidates) {
+      const entry& e = entries[slot];
+      if (best && !precedes(e, *best, object)) continue;
+      if (is_member(e, object) && test(e))
+        best = &e;
+    }
+    return best ? best->inst : NULL;
+  }
+
+  // Returns the instances of object whose bbox overlaps the region, in the
+  // order fetch_inst_iter_by_int(object) would visit them. The index must be
+  // usable for object. The list is reused by the next call.
+  const std::vector<object_collisions*>& candidates(int object, int left, int top, int right, int bottom);
+
+  // Iterates the instances of object which may overlap the region: the
+  // candidates from the index if it is usable for object, otherwise every
+  // instance of object. Loops written against fetch_inst_iter_by_int keep
+  // their behavior, as long as they don't query the index themselves.
+  class candidate_iterator {
+    iterator scan;
+    const std::vector<object_collisions*>* list;
+    size_t pos;
+
+   public:
+    candidate_iterator(int object, int left, int top, int right, int bottom);
+    operator bool() { return list ? pos < list->size() : bool(scan); }
+    object_collisions* operator*() const { return list ? (*list)[pos] : (object_collisions*)*scan; }
+    candidate_iterator& operator++() {
+      if (list) ++pos; else ++scan;
+      return *this;
+    }
+  };
+
+} // namespace collision_index
+} // namespace enigma
+
+#endif // ENIGMA_COLLISION_INDEX_H
@@ -52,8 +52,8 @@ namespace enigma
             right = box.right();
             bottom = box.bottom();
         }
-        // If the polygon is not availble, the bbox is computed from the polygon
-        else if (inst->sprite_index != -1)
+        // If the polygon is not availble, the bbox is computed from the sprite or mask
+        else if (inst->sprite_index != -1 || inst->mask_index != -1)
         {
             const enigma::BoundingBox &box = inst->$bbox_relative();
             const double x = inst->x, y = inst->y,
@@ -27,4 +27,8 @@ namespace enigma
   void free_collision_mask(void* mask)
   {
   }
+
+  void collision_system_initialize()
+  {
+  }
 };
@@ -513,8 +513,6 @@ namespace enigma_user
 
 }
 
-typedef std::pair<int,enigma::object_basic*> inode_pair;
-
 namespace enigma_user
 {
 
@@ -542,7 +540,7 @@ namespace enigma_user
             if ((left <= (rleft + rwidth) && rleft <= right && top <= (rtop + rheight) && rtop <= bottom) == inside) 
             {
                 inst->deactivate();
-                enigma::instance_deactivated_list.insert(inode_pair(inst->id,inst));
+                enigma::instance_deactivated_list.insert(inst->id,inst);
             }
         }
     }
@@ -550,15 +548,15 @@ namespace enigma_user
     void instance_activate_region(int rleft, int rtop, int rwidth, int rheight, bool inside) 
     {
         // Iterating over the instances
-        std::map<int,enigma::object_basic*>::iterator iter = enigma::instance_deactivated_list.begin();
-        while (iter != enigma::instance_deactivated_list.end()) 
+        enigma::instance_table<enigma::object_basic*> &deactivated = enigma::instance_deactivated_list;
+        for (int id = deactivated.first(), next; id != -1; id = next) 
         {
-            enigma::object_collisions* const inst = (enigma::object_collisions*) iter->second;
+            next = deactivated.next(id);
+            enigma::object_collisions* const inst = (enigma::object_collisions*) deactivated.get(id);
 
             // no sprite/mask/polygon then no collision
             if (inst->sprite_index == -1 && inst->mask_index == -1 && inst->polygon_index == -1)
             {
-                ++iter;
                 continue;
             }
 
@@ -569,11 +567,7 @@ namespace enigma_user
             if ((left <= (rleft + rwidth) && rleft <= right && top <= (rtop + rheight) && rtop <= bottom) == inside) 
             {
                 inst->activate();
-                enigma::instance_deactivated_list.erase(iter++);
-            } 
-            else 
-            {
-                ++iter;
+                deactivated.erase(id);
             }
         }
     }
@@ -631,7 +625,7 @@ namespace enigma_user
                 if (inside)
                 {
                     inst->deactivate();
-                    enigma::instance_deactivated_list.insert(inode_pair(inst->id,inst));
+                    enigma::instance_deactivated_list.insert(inst->id,inst);
                 }
             }
             else
@@ -639,7 +633,7 @@ namespace enigma_user
                 if (!inside)
                 {
                     inst->deactivate();
-                    enigma::instance_deactivated_list.insert(inode_pair(inst->id,inst));
+                    enigma::instance_deactivated_list.insert(inst->id,inst);
                 }
             }
         }
@@ -648,15 +642,15 @@ namespace enigma_user
     void instance_activate_circle(int x, int y, int r, bool inside)
     {
         // Iterating over the instances
-        std::map<int,enigma::object_basic*>::iterator iter = enigma::instance_deactivated_list.begin();
-        while (iter != enigma::instance_deactivated_list.end()) 
+        enigma::instance_table<enigma::object_basic*> &deactivated = enigma::instance_deactivated_list;
+        for (int id = deactivated.first(), next; id != -1; id = next) 
         {
-            enigma::object_collisions* const inst = (enigma::object_collisions*)iter->second;
+            next = deactivated.next(id);
+            enigma::object_collisions* const inst = (enigma::object_collisions*)deactivated.get(id);
 
             // If no sprite/mask/polygon then no collision
             if (inst->sprite_index == -1 && inst->mask_index == -1 && inst->polygon_index == -1)
             {
-                ++iter;
                 continue;
             }
 
@@ -670,14 +664,12 @@ namespace enigma_user
                                     line_ellipse_intersects(r, r, bottom-y, left-x, right-x) ||
                                     (x >= left && x <= right && y >= top && y <= bottom); // Circle inside bbox.
 
-            bool removed = false;
             if (intersects)
             {
                 if (inside)
                 {
                     inst->activate();
-                    enigma::instance_deactivated_list.erase(iter++);
-                    removed = true;
+                    deactivated.erase(id);
                 }
             }
             else
@@ -685,14 +677,9 @@ namespace enigma_user
                 if (!inside)
                 {
                     inst->activate();
-                    enigma::instance_deactivated_list.erase(iter++);
-                    removed = true;
+                    deactivated.erase(id);
                 }
             }
-            if (!removed) 
-            {
-                ++iter;
-            }
         }
     }
  
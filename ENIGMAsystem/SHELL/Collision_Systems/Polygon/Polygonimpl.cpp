@@ -29,12 +29,23 @@
 #include "Universal_System/Resources/polygon.h"
 #include "Universal_System/Resources/polygon_internal.h"
 #include "../General/collisions_general.h"
+#include "../General/collision_index.h"
 
 #include "Polygonimpl.h"
 #include "polygon_collision_util.h"
 #include <cmath>
 #include <utility>
 
+using enigma::collision_index::clamp_coord;
+
+bool enigma::collision_bounds(const object_collisions* inst, int &left, int &top, int &right, int &bottom)
+{
+    if (inst->sprite_index == -1 && inst->mask_index == -1 && inst->polygon_index == -1) // No sprite/mask/polygon, no collision
+        return false;
+    get_bbox_border(left, top, right, bottom, inst);
+    return true;
+}
+
 enigma::object_collisions* const collide_inst_inst(int object, bool solid_only, bool notme, double x, double y)
 {
     // Obtain the first Object
@@ -50,7 +61,7 @@ enigma::object_collisions* const collide_inst_inst(int object, bool solid_only,
     enigma::get_bbox_border(left1, top1, right1, bottom1, inst1, x, y);
 
     // Iterating over instances in the room to detect collision
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    for (enigma::collision_index::candidate_iterator it(object, left1, top1, right1, bottom1); it; ++it)
     {
         // Selecting the instance
         enigma::object_collisions* const inst2 = (enigma::object_collisions*)*it;
@@ -140,7 +151,7 @@ enigma::object_collisions* const collide_inst_rect(int object, bool solid_only,
 
     // Iterating over instances to find any object that is colliding with
     // this rectangle
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    for (enigma::collision_index::candidate_iterator it(object, x1, y1, x2, y2); it; ++it)
     {
         // Getting the instance
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
@@ -195,7 +206,7 @@ enigma::object_collisions* const collide_inst_line(int object, bool solid_only,
         return collide_inst_point(object, solid_only, prec, notme, x1, y1);
 
     // Iterating over instances 
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    for (enigma::collision_index::candidate_iterator it(object, min(x1,x2), min(y1,y2), max(x1,x2), max(y1,y2)); it; ++it)
     {
         // Retrieving the instance
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
@@ -286,7 +297,7 @@ enigma::object_collisions* const collide_inst_line(int object, bool solid_only,
 enigma::object_collisions* const collide_inst_point(int object, bool solid_only, bool prec, bool notme, int x1, int y1)
 {
     // Iterating over the instances to detect collision
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    for (enigma::collision_index::candidate_iterator it(object, x1, y1, x1, y1); it; ++it)
     {
         // Retrieving the instance
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
@@ -350,7 +361,11 @@ enigma::object_collisions* const collide_inst_ellipse(int object, bool solid_onl
         return 0;
 
     // Iterate over the instances for the collision check
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    // Pad the ellipse's bounds by a pixel so rounding in the exact test can't be pruned away.
+    const double arx = fabs(rx), ary = fabs(ry);
+    for (enigma::collision_index::candidate_iterator it(object,
+            clamp_coord(floor(x1 - arx) - 1), clamp_coord(floor(y1 - ary) - 1),
+            clamp_coord(ceil(x1 + arx) + 1), clamp_coord(ceil(y1 + ary) + 1)); it; ++it)
     {
         // Retrieving the instance
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
@@ -408,7 +423,7 @@ std::vector<enigma::object_collisions*> get_colliding_bbox_instances(int x1, int
     std::vector<enigma::object_collisions*> instances;
 
     // Iterating over instances
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    for (enigma::collision_index::candidate_iterator it(object, x1, y1, x1, y1); it; ++it)
     {
         // Preliminary checks before collisions
         enigma::object_collisions* const inst = (enigma::object_collisions*) *it;
@@ -27,6 +27,7 @@
 #include "Universal_System/math_consts.h"
 
 #include "PRECimpl.h"
+#include "Collision_Systems/General/collision_index.h"
 #include <cmath>
 #include <utility>
 
@@ -59,6 +60,18 @@ static inline void get_border(int *leftv, int *rightv, int *topv, int *bottomv,
     }
 }
 
+using enigma::collision_index::clamp_coord;
+
+bool enigma::collision_bounds(const object_collisions* inst, int &left, int &top, int &right, int &bottom)
+{
+    if (inst->sprite_index == -1 && inst->mask_index == -1) // No sprite/mask, no collision
+        return false;
+    const BoundingBox &box = inst->$bbox_relative();
+    get_border(&left, &right, &top, &bottom, box.left(), box.top(), box.right(), box.bottom(),
+               inst->x, inst->y, inst->image_xscale, inst->image_yscale, inst->image_angle);
+    return true;
+}
+
 template<typename T> static inline T min(T x, T y) { return x<y? x : y; }
 template<typename T> static inline T max(T x, T y) { return x>y? x : y; }
 
@@ -293,7 +306,7 @@ enigma::object_collisions* const collide_inst_inst(int object, bool solid_only,
 
     get_border(&left1, &right1, &top1, &bottom1, box.left(), box.top(), box.right(), box.bottom(), x, y, xscale1, yscale1, ia1);
 
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    for (enigma::collision_index::candidate_iterator it(object, left1, top1, right1, bottom1); it; ++it)
     {
         enigma::object_collisions* const inst2 = (enigma::object_collisions*)*it;
         if (notme && inst2->id == inst1->id)
@@ -404,7 +417,7 @@ enigma::object_collisions* const collide_inst_rect(int object, bool solid_only,
     if (y1 > y2)
         std::swap(y1, y2);
 
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    for (enigma::collision_index::candidate_iterator it(object, x1, y1, x2, y2); it; ++it)
     {
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
         if (notme && inst->id == enigma::instance_event_iterator->inst->id)
@@ -479,7 +492,7 @@ enigma::object_collisions* const collide_inst_line(int object, bool solid_only,
     if (x1 == x2 && y1 == y2)
         return collide_inst_point(object, solid_only, prec, notme, x1, y1);
 
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    for (enigma::collision_index::candidate_iterator it(object, min(x1,x2), min(y1,y2), max(x1,x2), max(y1,y2)); it; ++it)
     {
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
         if (notme && inst->id == enigma::instance_event_iterator->inst->id)
@@ -584,7 +597,7 @@ enigma::object_collisions* const collide_inst_line(int object, bool solid_only,
 
 enigma::object_collisions* const collide_inst_point(int object, bool solid_only, bool prec, bool notme, int x1, int y1)
 {
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    for (enigma::collision_index::candidate_iterator it(object, x1, y1, x1, y1); it; ++it)
     {
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
         if (notme && inst->id == enigma::instance_event_iterator->inst->id)
@@ -677,7 +690,11 @@ enigma::object_collisions* const collide_inst_ellipse(int object, bool solid_onl
     if (rx == 0 || ry == 0)
         return 0;
 
-    for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
+    // Pad the ellipse's bounds by a pixel so rounding in the exact test can't be pruned away.
+    const double arx = fabs(rx), ary = fabs(ry);
+    for (enigma::collision_index::candidate_iterator it(object,
+            clamp_coord(floor(x1 - arx) - 1), clamp_coord(floor(y1 - ary) - 1),
+            clamp_coord(ceil(x1 + arx) + 1), clamp_coord(ceil(y1 + ary) + 1)); it; ++it)
     {
         enigma::object_collisions* const inst = (enigma::object_collisions*)*it;
         if (notme && inst->id == enigma::instance_event_iterator->inst->id)
@@ -36,6 +36,11 @@ namespace enigma
   // It is used to clean up on game termination.
   void free_collision_mask(void* mask);
 
+  // This function is called once at startup, before the first room is loaded.
+  // Collision systems which keep a spatial index of instances hook into the
+  // instance system here; others do nothing.
+  void collision_system_initialize();
+
   #ifdef ENIGMA_COLLISIONS_OBJECT_H
     // This function will be invoked each collision event to obtain a pointer to any
     // instance being collided with. It is expected to return NULL for no collision, or
@@ -43,3 +48,40 @@ namespace enigma
     object_basic *place_meeting_inst(cs_scalar x, cs_scalar y, int object);
   #endif
 }
+
+#if defined(ENIGMA_COLLISIONS_OBJECT_H) && !defined(ENIGMA_COLLISION_CANDIDATES_H)
+#define ENIGMA_COLLISION_CANDIDATES_H
+
+#include "Universal_System/Instances/instance_iterator.h"
+#include <utility>
+#include <vector>
+
+namespace enigma
+{
+  // The collision event dispatcher walks this instead of fetch_inst_iter_by_int to
+  // find the instances of an object the current instance may be colliding with.
+  // It visits them in the same order, but the collision system may skip those it
+  // can rule out by bounding box. Call refresh() after dispatching an event, which
+  // may have moved, created or destroyed instances.
+  class collision_candidates {
+    typedef std::vector<std::pair<unsigned, object_collisions*> > list_t; // (list order, instance)
+    int object;
+    iterator scan;   // Used when the collision system can't narrow the search
+    list_t *list;    // Pooled; NULL when scanning
+    size_t pos;
+
+   public:
+    explicit collision_candidates(int object);
+    ~collision_candidates();
+    void refresh();
+
+    operator bool() { return list ? pos < list->size() : bool(scan); }
+    object_basic* operator*() const { return list ? (*list)[pos].second : *scan; }
+    collision_candidates& operator++() {
+      if (list) ++pos; else ++scan;
+      return *this;
+    }
+  };
+}
+
+#endif // ENIGMA_COLLISION_CANDIDATES_H
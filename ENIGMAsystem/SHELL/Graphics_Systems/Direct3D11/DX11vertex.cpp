@@ -308,6 +308,10 @@ void graphics_prepare_default_shader() {
 #define set_primitive_mode(primitive) m_deviceContext->IASetPrimitiveTopology(primitive_types[primitive]);
 #endif
 
+color_t graphics_pack_vertex_color(int color, double alpha) {
+  return (CLAMP_ALPHA(alpha) << 24) | (COL_GET_R(color) << 16) | (COL_GET_G(color) << 8) | COL_GET_B(color);
+}
+
 } // namespace enigma
 
 namespace enigma_user {
@@ -317,8 +321,7 @@ void vertex_argb(int buffer, unsigned argb) {
 }
 
 void vertex_color(int buffer, int color, double alpha) {
-  enigma::color_t finalcol = (CLAMP_ALPHA(alpha) << 24) | (COL_GET_R(color) << 16) | (COL_GET_G(color) << 8) | COL_GET_B(color);
-  enigma::vertexBuffers[buffer]->vertices.push_back(finalcol);
+  enigma::vertexBuffers[buffer]->vertices.push_back(enigma::graphics_pack_vertex_color(color, alpha));
 }
 
 void vertex_submit_offset(int buffer, int primitive, unsigned offset, unsigned start, unsigned count) {
@@ -195,6 +195,10 @@ inline void graphics_apply_vertex_format(int format, size_t &stride) {
   d3ddev->SetVertexDeclaration(vertexDeclaration);
 }
 
+color_t graphics_pack_vertex_color(int color, double alpha) {
+  return (CLAMP_ALPHA(alpha) << 24) | (COL_GET_R(color) << 16) | (COL_GET_G(color) << 8) | COL_GET_B(color);
+}
+
 } // namespace enigma
 
 namespace enigma_user {
@@ -204,8 +208,7 @@ void vertex_argb(int buffer, unsigned argb) {
 }
 
 void vertex_color(int buffer, int color, double alpha) {
-  enigma::color_t finalcol = (CLAMP_ALPHA(alpha) << 24) | (COL_GET_R(color) << 16) | (COL_GET_G(color) << 8) | COL_GET_B(color);
-  enigma::vertexBuffers[buffer]->vertices.push_back(finalcol);
+  enigma::vertexBuffers[buffer]->vertices.push_back(enigma::graphics_pack_vertex_color(color, alpha));
 }
 
 void vertex_submit_offset(int buffer, int primitive, unsigned offset, unsigned start, unsigned count) {
@@ -28,7 +28,7 @@ int blendMode[2]={enigma_user::bm_src_alpha,enigma_user::bm_inv_src_alpha};
 namespace enigma_user {
 
 void draw_set_blend_mode(int mode) {
-  enigma::draw_set_state_dirty();
+  enigma::draw_set_blend_state_dirty();
   const static int dest_modes[] = {bm_inv_src_alpha,bm_one,bm_inv_src_color,bm_inv_src_color};
 
   enigma::blendMode[0] = (mode == bm_subtract) ? bm_zero : bm_src_alpha;
@@ -36,7 +36,7 @@ void draw_set_blend_mode(int mode) {
 }
 
 void draw_set_blend_mode_ext(int src, int dest) {
-  enigma::draw_set_state_dirty();
+  enigma::draw_set_blend_state_dirty();
   enigma::blendMode[0] = src;
   enigma::blendMode[1] = dest;
 }
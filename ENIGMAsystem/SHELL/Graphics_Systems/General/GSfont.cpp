@@ -68,6 +68,16 @@ static uint32_t getUnicodeCharacter(const string str, size_t& pos) {
   return character;
 }
 
+// Glyphs are drawn as quads in the draw color, corners as for draw_batch_quad.
+static inline void draw_glyph(int texture,
+                              gs_scalar x1, gs_scalar y1, gs_scalar x2, gs_scalar y2,
+                              gs_scalar x3, gs_scalar y3, gs_scalar x4, gs_scalar y4,
+                              gs_scalar tx1, gs_scalar ty1, gs_scalar tx2, gs_scalar ty2) {
+  const int color = enigma_user::draw_get_color();
+  enigma::draw_batch_quad(texture, x1,y1, x2,y2, x3,y3, x4,y4, tx1,ty1, tx2,ty2,
+                          color,color,color,color, enigma_user::draw_get_alpha());
+}
+
 namespace enigma_user {
 
 void draw_set_halign(unsigned align){
@@ -351,12 +361,12 @@ void draw_text(gs_scalar x, gs_scalar y, variant vstr)
           if (character == ' ' or g.empty()) {
             xx += slen;
           } else {
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture(xx + g.x,  yy + g.y, g.tx, g.ty);
-            draw_vertex_texture(xx + g.x2, yy + g.y, g.tx2, g.ty);
-            draw_vertex_texture(xx + g.x,  yy + g.y2, g.tx,  g.ty2);
-            draw_vertex_texture(xx + g.x2, yy + g.y2, g.tx2, g.ty2);
-            draw_primitive_end();
+            draw_glyph(fnt.texture,
+              xx + g.x, yy + g.y,
+              xx + g.x2, yy + g.y,
+              xx + g.x2, yy + g.y2,
+              xx + g.x, yy + g.y2,
+              g.tx,g.ty, g.tx2,g.ty2);
             xx += gs_scalar(g.xs);
           }
         }
@@ -378,12 +388,12 @@ void draw_text(gs_scalar x, gs_scalar y, variant vstr)
           if (character == ' ' or g.empty()) {
             xx += slen;
           } else {
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture(xx + g.x,  yy + g.y, g.tx, g.ty);
-            draw_vertex_texture(xx + g.x2, yy + g.y, g.tx2, g.ty);
-            draw_vertex_texture(xx + g.x,  yy + g.y2, g.tx,  g.ty2);
-            draw_vertex_texture(xx + g.x2, yy + g.y2, g.tx2, g.ty2);
-            draw_primitive_end();
+            draw_glyph(fnt.texture,
+              xx + g.x, yy + g.y,
+              xx + g.x2, yy + g.y,
+              xx + g.x2, yy + g.y2,
+              xx + g.x, yy + g.y2,
+              g.tx,g.ty, g.tx2,g.ty2);
             xx += gs_scalar(g.xs);
           }
         }
@@ -479,12 +489,12 @@ void draw_text_skewed(gs_scalar x, gs_scalar y, variant vstr, gs_scalar top, gs_
         if (character == ' ' or g.empty()) {
           xx += slen;
         } else {
-          draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-          draw_vertex_texture(xx + g.x + top,     yy + g.y + top, g.tx, g.ty);
-          draw_vertex_texture(xx + g.x2 + top,    yy + g.y + top, g.tx2, g.ty);
-          draw_vertex_texture(xx + g.x + bottom,  yy + g.y2 + bottom, g.tx,  g.ty2);
-          draw_vertex_texture(xx + g.x2 + bottom, yy + g.y2 + bottom, g.tx2, g.ty2);
-          draw_primitive_end();
+          draw_glyph(fnt.texture,
+            xx + g.x + top, yy + g.y + top,
+            xx + g.x2 + top, yy + g.y + top,
+            xx + g.x2 + bottom, yy + g.y2 + bottom,
+            xx + g.x + bottom, yy + g.y2 + bottom,
+            g.tx,g.ty, g.tx2,g.ty2);
 
           xx += gs_scalar(g.xs);
         }
@@ -506,12 +516,12 @@ void draw_text_skewed(gs_scalar x, gs_scalar y, variant vstr, gs_scalar top, gs_
         if (character == ' ' or g.empty()) {
           xx += slen;
         } else {
-          draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-          draw_vertex_texture(xx + g.x + top,     yy + g.y + top, g.tx, g.ty);
-          draw_vertex_texture(xx + g.x2 + top,    yy + g.y + top, g.tx2, g.ty);
-          draw_vertex_texture(xx + g.x + bottom,  yy + g.y2 + bottom, g.tx,  g.ty2);
-          draw_vertex_texture(xx + g.x2 + bottom, yy + g.y2 + bottom, g.tx2, g.ty2);
-          draw_primitive_end();
+          draw_glyph(fnt.texture,
+            xx + g.x + top, yy + g.y + top,
+            xx + g.x2 + top, yy + g.y + top,
+            xx + g.x2 + bottom, yy + g.y2 + bottom,
+            xx + g.x + bottom, yy + g.y2 + bottom,
+            g.tx,g.ty, g.tx2,g.ty2);
           xx += gs_scalar(g.xs);
         }
       }
@@ -551,12 +561,12 @@ void draw_text_ext(gs_scalar x, gs_scalar y, variant vstr, gs_scalar sep, gs_sca
           if (width+tw >= w && w != -1)
           xx = x, yy += (sep==-1 ? fnt.height : sep), width = 0, tw = 0;
         } else {
-          draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-          draw_vertex_texture(xx + g.x,  yy + g.y, g.tx, g.ty);
-          draw_vertex_texture(xx + g.x2, yy + g.y, g.tx2, g.ty);
-          draw_vertex_texture(xx + g.x,  yy + g.y2, g.tx,  g.ty2);
-          draw_vertex_texture(xx + g.x2, yy + g.y2, g.tx2, g.ty2);
-          draw_primitive_end();
+          draw_glyph(fnt.texture,
+            xx + g.x, yy + g.y,
+            xx + g.x2, yy + g.y,
+            xx + g.x2, yy + g.y2,
+            xx + g.x, yy + g.y2,
+            g.tx,g.ty, g.tx2,g.ty2);
           xx += gs_scalar(g.xs);
         }
       }
@@ -586,12 +596,12 @@ void draw_text_ext(gs_scalar x, gs_scalar y, variant vstr, gs_scalar sep, gs_sca
           if (width+tw >= w && w != -1)
             line += 1, xx = halign == fa_center ? x-gs_scalar(string_width_ext_line(str,w,line)/2) : x-gs_scalar(string_width_ext_line(str,w,line)), yy += (sep==-1 ? fnt.height : sep), width = 0, tw = 0;
         } else {
-          draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-          draw_vertex_texture(xx + g.x,  yy + g.y, g.tx, g.ty);
-          draw_vertex_texture(xx + g.x2, yy + g.y, g.tx2, g.ty);
-          draw_vertex_texture(xx + g.x,  yy + g.y2, g.tx,  g.ty2);
-          draw_vertex_texture(xx + g.x2, yy + g.y2, g.tx2, g.ty2);
-          draw_primitive_end();
+          draw_glyph(fnt.texture,
+            xx + g.x, yy + g.y,
+            xx + g.x2, yy + g.y,
+            xx + g.x2, yy + g.y2,
+            xx + g.x, yy + g.y2,
+            g.tx,g.ty, g.tx2,g.ty2);
           xx += gs_scalar(g.xs);
           width += g.xs;
         }
@@ -639,12 +649,12 @@ void draw_text_transformed(gs_scalar x, gs_scalar y, variant vstr, gs_scalar xsc
             const gs_scalar lx = xx + g.y * svy;
             const gs_scalar ly = yy + g.y * cvy;
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture(lx, ly, g.tx, g.ty);
-            draw_vertex_texture(lx + w * cvx, ly - w * svx, g.tx2, g.ty);
-            draw_vertex_texture(xx + g.y2 * svy,  yy + g.y2 * cvy, g.tx,  g.ty2);
-            draw_vertex_texture(xx + w * cvx + g.y2 * svy, yy - w * svx + g.y2 * cvy, g.tx2, g.ty2);
-            draw_primitive_end();
+            draw_glyph(fnt.texture,
+              lx, ly,
+              lx + w * cvx, ly - w * svx,
+              xx + w * cvx + g.y2 * svy, yy - w * svx + g.y2 * cvy,
+              xx + g.y2 * svy, yy + g.y2 * cvy,
+              g.tx,g.ty, g.tx2,g.ty2);
 
             xx += gs_scalar(g.xs) * cvx;
             yy -= gs_scalar(g.xs) * svx;
@@ -683,12 +693,12 @@ void draw_text_transformed(gs_scalar x, gs_scalar y, variant vstr, gs_scalar xsc
             const gs_scalar lx = xx + g.y * svy;
             const gs_scalar ly = yy + g.y * cvy;
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture(lx, ly, g.tx, g.ty);
-            draw_vertex_texture(lx + w * cvx, ly - w * svx, g.tx2, g.ty);
-            draw_vertex_texture(xx + g.y2 * svy,  yy + g.y2 * cvy, g.tx,  g.ty2);
-            draw_vertex_texture(xx + w * cvx + g.y2 * svy, yy - w * svx + g.y2 * cvy, g.tx2, g.ty2);
-            draw_primitive_end();
+            draw_glyph(fnt.texture,
+              lx, ly,
+              lx + w * cvx, ly - w * svx,
+              xx + w * cvx + g.y2 * svy, yy - w * svx + g.y2 * cvy,
+              xx + g.y2 * svy, yy + g.y2 * cvy,
+              g.tx,g.ty, g.tx2,g.ty2);
 
             xx += gs_scalar(g.xs) * cvx;
             yy -= gs_scalar(g.xs) * svx;
@@ -752,12 +762,12 @@ void draw_text_ext_transformed(gs_scalar x, gs_scalar y, variant vstr, gs_scalar
             const gs_scalar lx = xx + g.y * svy;
             const gs_scalar ly = yy + g.y * cvy;
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture(lx, ly, g.tx,  g.ty);
-            draw_vertex_texture(lx + wi * cvx, ly - wi * svx, g.tx2, g.ty);
-            draw_vertex_texture(xx + g.y2 * svy,  yy + g.y2 * cvy, g.tx,  g.ty2);
-            draw_vertex_texture(xx + wi * cvx + g.y2 * svy, yy - wi * svx + g.y2 * cvy, g.tx2, g.ty2);
-            draw_primitive_end();
+            draw_glyph(fnt.texture,
+              lx, ly,
+              lx + wi * cvx, ly - wi * svx,
+              xx + wi * cvx + g.y2 * svy, yy - wi * svx + g.y2 * cvy,
+              xx + g.y2 * svy, yy + g.y2 * cvy,
+              g.tx,g.ty, g.tx2,g.ty2);
 
             xx += gs_scalar(g.xs) * cvx;
             yy -= gs_scalar(g.xs) * svx;
@@ -817,12 +827,12 @@ void draw_text_ext_transformed(gs_scalar x, gs_scalar y, variant vstr, gs_scalar
               const gs_scalar lx = xx + g.y * svy;
               const gs_scalar ly = yy + g.y * cvy;
 
-              draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-              draw_vertex_texture(lx, ly, g.tx,  g.ty);
-              draw_vertex_texture(lx + wi * cvx, ly - wi * svx, g.tx2, g.ty);
-              draw_vertex_texture(xx + g.y2 * svy,  yy + g.y2 * cvy, g.tx,  g.ty2);
-              draw_vertex_texture(xx + wi * cvx + g.y2 * svy, yy - wi * svx + g.y2 * cvy, g.tx2, g.ty2);
-              draw_primitive_end();
+              draw_glyph(fnt.texture,
+                lx, ly,
+                lx + wi * cvx, ly - wi * svx,
+                xx + wi * cvx + g.y2 * svy, yy - wi * svx + g.y2 * cvy,
+                xx + g.y2 * svy, yy + g.y2 * cvy,
+                g.tx,g.ty, g.tx2,g.ty2);
 
               xx += gs_scalar(g.xs) * cvx;
               yy -= gs_scalar(g.xs) * svx;
@@ -878,12 +888,12 @@ void draw_text_transformed_color(gs_scalar x, gs_scalar y, variant vstr, gs_scal
             hcol3 = merge_color(c4,c3,(gs_scalar)(width)/tmpsize);
             hcol4 = merge_color(c4,c3,(gs_scalar)(width+g.xs)/tmpsize);
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture_color(lx, ly, g.tx,  g.ty, hcol1, a);
-            draw_vertex_texture_color(lx + w * cvx, ly - w * svx, g.tx2, g.ty, hcol2, a);
-            draw_vertex_texture_color(xx + g.y2 * svy,  yy + g.y2 * cvy, g.tx, g.ty2, hcol4, a);
-            draw_vertex_texture_color(xx + w * cvx + g.y2 * svy, yy - w * svx + g.y2 * cvy, g.tx2, g.ty2, hcol3, a);
-            draw_primitive_end();
+            enigma::draw_batch_quad(fnt.texture,
+              lx, ly,
+              lx + w * cvx, ly - w * svx,
+              xx + w * cvx + g.y2 * svy, yy - w * svx + g.y2 * cvy,
+              xx + g.y2 * svy, yy + g.y2 * cvy,
+              g.tx,g.ty, g.tx2,g.ty2, hcol1,hcol2,hcol3,hcol4, a);
 
             xx += gs_scalar(g.xs) * cvx;
             yy -= gs_scalar(g.xs) * svx;
@@ -927,12 +937,12 @@ void draw_text_transformed_color(gs_scalar x, gs_scalar y, variant vstr, gs_scal
             hcol3 = merge_color(c4,c3,(gs_scalar)(width)/tmpsize);
             hcol4 = merge_color(c4,c3,(gs_scalar)(width+g.xs)/tmpsize);
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture_color(lx, ly, g.tx,  g.ty, hcol1, a);
-            draw_vertex_texture_color(lx + w * cvx, ly - w * svx, g.tx2, g.ty, hcol2, a);
-            draw_vertex_texture_color(xx + g.y2 * svy,  yy + g.y2 * cvy, g.tx, g.ty2, hcol4, a);
-            draw_vertex_texture_color(xx + w * cvx + g.y2 * svy, yy - w * svx + g.y2 * cvy, g.tx2, g.ty2, hcol3, a);
-            draw_primitive_end();
+            enigma::draw_batch_quad(fnt.texture,
+              lx, ly,
+              lx + w * cvx, ly - w * svx,
+              xx + w * cvx + g.y2 * svy, yy - w * svx + g.y2 * cvy,
+              xx + g.y2 * svy, yy + g.y2 * cvy,
+              g.tx,g.ty, g.tx2,g.ty2, hcol1,hcol2,hcol3,hcol4, a);
 
             xx += gs_scalar(g.xs) * cvx;
             yy -= gs_scalar(g.xs) * svx;
@@ -1000,12 +1010,12 @@ void draw_text_ext_transformed_color(gs_scalar x, gs_scalar y, variant vstr, gs_
             hcol3 = merge_color(c4,c3,(gs_scalar)(width)/tmpsize);
             hcol4 = merge_color(c4,c3,(gs_scalar)(width+g.xs)/tmpsize);
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture_color(lx, ly, g.tx,  g.ty, hcol1, a);
-            draw_vertex_texture_color(lx + wi * cvx, ly - wi * svx, g.tx2, g.ty, hcol2, a);
-            draw_vertex_texture_color(xx + g.y2 * svy,  yy + g.y2 * cvy, g.tx,  g.ty2, hcol4, a);
-            draw_vertex_texture_color(xx + wi * cvx + g.y2 * svy, yy - wi * svx + g.y2 * cvy, g.tx2, g.ty2, hcol3, a);
-            draw_primitive_end();
+            enigma::draw_batch_quad(fnt.texture,
+              lx, ly,
+              lx + wi * cvx, ly - wi * svx,
+              xx + wi * cvx + g.y2 * svy, yy - wi * svx + g.y2 * cvy,
+              xx + g.y2 * svy, yy + g.y2 * cvy,
+              g.tx,g.ty, g.tx2,g.ty2, hcol1,hcol2,hcol3,hcol4, a);
 
 
             xx += gs_scalar(g.xs) * cvx;
@@ -1068,12 +1078,12 @@ void draw_text_ext_transformed_color(gs_scalar x, gs_scalar y, variant vstr, gs_
             hcol3 = merge_color(c4,c3,(gs_scalar)(width)/tmpsize);
             hcol4 = merge_color(c4,c3,(gs_scalar)(width+g.xs)/tmpsize);
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture_color(lx, ly, g.tx,  g.ty, hcol1, a);
-            draw_vertex_texture_color(lx + wi * cvx, ly - wi * svx, g.tx2, g.ty, hcol2, a);
-            draw_vertex_texture_color(xx + g.y2 * svy,  yy + g.y2 * cvy, g.tx,  g.ty2, hcol4, a);
-            draw_vertex_texture_color(xx + wi * cvx + g.y2 * svy, yy - wi * svx + g.y2 * cvy, g.tx2, g.ty2, hcol3, a);
-            draw_primitive_end();
+            enigma::draw_batch_quad(fnt.texture,
+              lx, ly,
+              lx + wi * cvx, ly - wi * svx,
+              xx + wi * cvx + g.y2 * svy, yy - wi * svx + g.y2 * cvy,
+              xx + g.y2 * svy, yy + g.y2 * cvy,
+              g.tx,g.ty, g.tx2,g.ty2, hcol1,hcol2,hcol3,hcol4, a);
 
             xx += gs_scalar(g.xs) * cvx;
             yy -= gs_scalar(g.xs) * svx;
@@ -1117,12 +1127,12 @@ void draw_text_color(gs_scalar x, gs_scalar y,variant vstr,int c1,int c2,int c3,
             hcol3 = merge_color(c4,c3,tx1);
             hcol4 = merge_color(c4,c3,tx2);
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture_color(xx + g.x,  yy + g.y, g.tx, g.ty, hcol1, a);
-            draw_vertex_texture_color(xx + g.x2, yy + g.y, g.tx2, g.ty, hcol2, a);
-            draw_vertex_texture_color(xx + g.x,  yy + g.y2, g.tx,  g.ty2, hcol4, a);
-            draw_vertex_texture_color(xx + g.x2, yy + g.y2, g.tx2, g.ty2, hcol3, a);
-            draw_primitive_end();
+            enigma::draw_batch_quad(fnt.texture,
+              xx + g.x, yy + g.y,
+              xx + g.x2, yy + g.y,
+              xx + g.x2, yy + g.y2,
+              xx + g.x, yy + g.y2,
+              g.tx,g.ty, g.tx2,g.ty2, hcol1,hcol2,hcol3,hcol4, a);
 
             xx += gs_scalar(g.xs);
           }
@@ -1150,12 +1160,12 @@ void draw_text_color(gs_scalar x, gs_scalar y,variant vstr,int c1,int c2,int c3,
             hcol3 = merge_color(c4,c3,tx1);
             hcol4 = merge_color(c4,c3,tx2);
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture_color(xx + g.x,  yy + g.y, g.tx, g.ty, hcol1, a);
-            draw_vertex_texture_color(xx + g.x2, yy + g.y, g.tx2, g.ty, hcol2, a);
-            draw_vertex_texture_color(xx + g.x,  yy + g.y2, g.tx,  g.ty2, hcol4, a);
-            draw_vertex_texture_color(xx + g.x2, yy + g.y2, g.tx2, g.ty2, hcol3, a);
-            draw_primitive_end();
+            enigma::draw_batch_quad(fnt.texture,
+              xx + g.x, yy + g.y,
+              xx + g.x2, yy + g.y,
+              xx + g.x2, yy + g.y2,
+              xx + g.x, yy + g.y2,
+              g.tx,g.ty, g.tx2,g.ty2, hcol1,hcol2,hcol3,hcol4, a);
 
             xx += gs_scalar(g.xs);
           }
@@ -1205,12 +1215,12 @@ void draw_text_ext_color(gs_scalar x, gs_scalar y,variant vstr,gs_scalar sep, gs
             hcol3 = merge_color(c4,c3,(gs_scalar)(width)/sw);
             hcol4 = merge_color(c4,c3,(gs_scalar)(width+g.xs)/sw);
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture_color(xx + g.x,  yy + g.y, g.tx, g.ty, hcol1, a);
-            draw_vertex_texture_color(xx + g.x2, yy + g.y, g.tx2, g.ty, hcol2, a);
-            draw_vertex_texture_color(xx + g.x,  yy + g.y2, g.tx,  g.ty2, hcol4, a);
-            draw_vertex_texture_color(xx + g.x2, yy + g.y2, g.tx2, g.ty2, hcol3, a);
-            draw_primitive_end();
+            enigma::draw_batch_quad(fnt.texture,
+              xx + g.x, yy + g.y,
+              xx + g.x2, yy + g.y,
+              xx + g.x2, yy + g.y2,
+              xx + g.x, yy + g.y2,
+              g.tx,g.ty, g.tx2,g.ty2, hcol1,hcol2,hcol3,hcol4, a);
 
             xx += gs_scalar(g.xs);
             width = xx-x;
@@ -1246,12 +1256,12 @@ void draw_text_ext_color(gs_scalar x, gs_scalar y,variant vstr,gs_scalar sep, gs
             hcol3 = merge_color(c4,c3,(gs_scalar)(width)/sw);
             hcol4 = merge_color(c4,c3,(gs_scalar)(width+g.xs)/sw);
 
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture_color(xx + g.x,  yy + g.y, g.tx, g.ty, hcol1, a);
-            draw_vertex_texture_color(xx + g.x2, yy + g.y, g.tx2, g.ty, hcol2, a);
-            draw_vertex_texture_color(xx + g.x,  yy + g.y2, g.tx,  g.ty2, hcol4, a);
-            draw_vertex_texture_color(xx + g.x2, yy + g.y2, g.tx2, g.ty2, hcol3, a);
-            draw_primitive_end();
+            enigma::draw_batch_quad(fnt.texture,
+              xx + g.x, yy + g.y,
+              xx + g.x2, yy + g.y,
+              xx + g.x2, yy + g.y2,
+              xx + g.x, yy + g.y2,
+              g.tx,g.ty, g.tx2,g.ty2, hcol1,hcol2,hcol3,hcol4, a);
 
             xx += gs_scalar(g.xs);
             width = xx-tmpx;
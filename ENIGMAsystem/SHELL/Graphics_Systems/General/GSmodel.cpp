@@ -202,8 +202,8 @@ void d3d_model_draw(int id, gs_scalar x, gs_scalar y, gs_scalar z) {
 
   // we have to create a special translation here so that it occurs
   // before any of the user's transformations took place
-  enigma::world = glm::translate(enigma::world, glm::vec3(x, y, z));
   enigma::draw_set_state_dirty();
+  enigma::world = glm::translate(enigma::world, glm::vec3(x, y, z));
 
   d3d_model_draw(id);
 
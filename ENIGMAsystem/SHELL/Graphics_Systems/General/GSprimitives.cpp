@@ -19,7 +19,12 @@
 #include "GSprimitives.h"
 #include "GSstdraw.h"
 #include "GSmodel.h"
+#include "GSvertex.h"
+#include "GSvertex_impl.h"
 #include "GStextures.h"
+#include "GSblend.h"
+
+#include <algorithm>
 
 #ifdef DEBUG_MODE
 #include "Widget_Systems/widgets_mandatory.h"
@@ -31,6 +36,8 @@ namespace {
 int draw_batch_mode = enigma_user::batch_flush_deferred;
 // whether a batch has been started but not flushed yet
 bool draw_batch_dirty = false;
+// whether the batch that was started is of quads rather than primitives
+bool draw_batch_quads = false;
 // lazy create the batch stream that we use for combining primitives
 int draw_get_batch_stream() {
   static int draw_batch_stream = -1;
@@ -38,9 +45,77 @@ int draw_get_batch_stream() {
     draw_batch_stream = enigma_user::d3d_model_create(enigma_user::model_stream, true);
   return draw_batch_stream;
 }
+
+// most quads one batch can hold, as many as 16-bit indices can address
+const unsigned quad_batch_capacity = 65536 / 4;
+// vertex elements per quad: 4 vertices of position, texture coordinate and color
+const unsigned quad_elements = 4 * (2 + 2 + 1);
+
+// Sprites are batched apart from the stream model, as quads with a fixed
+// vertex layout written straight into the vertex buffer. They are drawn as
+// triangle lists through an index buffer that is built once and shared by
+// every batch, so there is no format to guess and no strips to stitch.
+struct QuadBatch {
+  int vertex_buffer = -1, index_buffer = -1, format = -1;
+  unsigned quads = 0; // quads in the batch
+  int color = -1; double alpha = -1; // the last color given and how it was packed
+  enigma::VertexElement packed_color;
+
+  void create() {
+    using namespace enigma_user;
+    vertex_format_begin();
+    vertex_format_add_position();
+    vertex_format_add_textcoord();
+    vertex_format_add_color();
+    format = vertex_format_end();
+
+    vertex_buffer = vertex_create_buffer();
+    enigma::vertexBuffers[vertex_buffer]->vertices.reserve(quad_batch_capacity * quad_elements);
+
+    index_buffer = index_create_buffer();
+    index_begin(index_buffer, index_type_ushort);
+    std::vector<uint16_t>& indices = enigma::indexBuffers[index_buffer]->indices;
+    indices.reserve(quad_batch_capacity * 6);
+    // same triangles, with the same winding, as the strip top-left, top-right, bottom-left, bottom-right
+    for (unsigned i = 0; i < quad_batch_capacity * 4; i += 4) {
+      indices.push_back(i);     indices.push_back(i + 1); indices.push_back(i + 2);
+      indices.push_back(i + 2); indices.push_back(i + 1); indices.push_back(i + 3);
+    }
+    index_end(index_buffer);
+    index_freeze(index_buffer);
+  }
+
+  // the backend packs the color, as GL and Direct3D order the channels differently
+  enigma::VertexElement pack_color(int col, double a) {
+    if (col != color || a != alpha) {
+      packed_color = enigma::graphics_pack_vertex_color(col, a);
+      color = col, alpha = a;
+    }
+    return packed_color;
+  }
+
+  void draw() {
+    enigma_user::vertex_end(vertex_buffer);
+    enigma_user::index_submit_range(index_buffer, vertex_buffer, enigma_user::pr_trianglelist, 0, quads * 6);
+  }
+};
+
+QuadBatch &draw_get_quad_batch() {
+  static QuadBatch batch;
+  if (!enigma_user::vertex_exists(batch.vertex_buffer)) batch.create();
+  return batch;
+}
+
 // helper function for beginning a deferred batch to determine when texture swap occurs
 // one goal of the function is to ensure the render states are current when a batch begins
-void draw_batch_begin_deferred(int texId) {
+void draw_batch_begin_deferred(int texId, bool quads = false) {
+  // anything but a quad ends the run of quads a sorted layer may reorder
+  if (!quads) enigma::draw_layer_flush();
+  // quads and primitives are batched in different buffers, so whichever
+  // is waiting has to be drawn first for the two to overlap in order
+  if (draw_batch_dirty && draw_batch_quads != quads) {
+    enigma_user::draw_batch_flush(draw_batch_mode);
+  }
   // if we want to use a different texture, set it now
   // this marks the state as dirty only if the texture is different
   if (enigma_user::texture_get() != texId) {
@@ -53,10 +128,177 @@ void draw_batch_begin_deferred(int texId) {
     enigma_user::draw_state_flush();
   }
   draw_batch_dirty = true;
+  draw_batch_quads = quads;
+}
+
+void draw_batch_quad_data(int texId, const enigma::VertexElement* quad) {
+  draw_batch_begin_deferred(texId, true);
+  QuadBatch& batch = draw_get_quad_batch();
+  if (!batch.quads) enigma_user::vertex_begin(batch.vertex_buffer, batch.format);
+
+  std::vector<enigma::VertexElement>& vertices = enigma::vertexBuffers[batch.vertex_buffer]->vertices;
+  const size_t size = vertices.size();
+  vertices.resize(size + quad_elements);
+  std::copy(quad, quad + quad_elements, &vertices[size]);
+
+  if (++batch.quads == quad_batch_capacity) {
+    enigma_user::draw_batch_flush(draw_batch_mode);
+  }
+  enigma_user::draw_batch_flush(enigma_user::batch_flush_immediate);
+}
+
+// A depth layer can be recorded instead of drawn as it goes, and then drawn
+// with quads of the same texture and blend mode brought together. A quad is
+// only moved ahead of the quads recorded before it when it overlaps none of
+// them, so the picture does not change. Any other draw or change of state
+// draws what was recorded first, as do shader changes, which the backends
+// apply at once.
+bool layer_sorting = false; // whether the user asked for depth layers to be sorted
+bool layer_recording = false; // whether quads are being recorded instead of batched
+unsigned flushes_saved_this_frame = 0, flushes_saved_last_frame = 0;
+
+// how many runs back a quad may look for one it can join
+const size_t layer_sort_window = 64;
+
+struct SortedQuad {
+  int texture, blend_src, blend_dest;
+  gs_scalar left, top, right, bottom;
+  enigma::VertexElement data[quad_elements];
+
+  bool same_state(const SortedQuad& other) const {
+    return texture == other.texture && blend_src == other.blend_src && blend_dest == other.blend_dest;
+  }
+};
+
+// quads of one state that will be drawn together, and the box around them
+struct SortedRun {
+  const SortedQuad* first;
+  gs_scalar left, top, right, bottom;
+  unsigned count;
+
+  bool overlaps(const SortedQuad& quad) const {
+    return quad.left < right && left < quad.right && quad.top < bottom && top < quad.bottom;
+  }
+};
+
+std::vector<SortedQuad> layer_quads;
+std::vector<SortedRun> layer_runs;
+std::vector<unsigned> layer_quad_runs, layer_order;
+
+void draw_layer_record(int texId, const enigma::VertexElement* quad) {
+  SortedQuad& sq = layer_quads.emplace_back();
+  sq.texture = texId;
+  sq.blend_src = enigma::blendMode[0];
+  sq.blend_dest = enigma::blendMode[1];
+  std::copy(quad, quad + quad_elements, sq.data);
+  sq.left = sq.right = quad[0].f;
+  sq.top = sq.bottom = quad[1].f;
+  for (unsigned i = 5; i < quad_elements; i += 5) {
+    sq.left = std::min(sq.left, quad[i].f), sq.right = std::max(sq.right, quad[i].f);
+    sq.top = std::min(sq.top, quad[i + 1].f), sq.bottom = std::max(sq.bottom, quad[i + 1].f);
+  }
+}
+
+void draw_layer_replay() {
+  const size_t count = layer_quads.size();
+  layer_runs.clear();
+  layer_quad_runs.resize(count);
+
+  unsigned flushes_before = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const SortedQuad& quad = layer_quads[i];
+    if (i && !quad.same_state(layer_quads[i - 1])) ++flushes_before;
+
+    size_t run = layer_runs.size();
+    for (size_t r = layer_runs.size(); r-- > 0 && layer_runs.size() - r <= layer_sort_window;) {
+      if (layer_runs[r].first->same_state(quad)) { run = r; break; }
+      if (layer_runs[r].overlaps(quad)) break;
+    }
+    if (run == layer_runs.size()) {
+      layer_runs.push_back({&quad, quad.left, quad.top, quad.right, quad.bottom, 0});
+    } else {
+      SortedRun& sr = layer_runs[run];
+      sr.left = std::min(sr.left, quad.left), sr.right = std::max(sr.right, quad.right);
+      sr.top = std::min(sr.top, quad.top), sr.bottom = std::max(sr.bottom, quad.bottom);
+    }
+    layer_runs[run].count++;
+    layer_quad_runs[i] = run;
+  }
+
+  // order the quads by run, keeping the recorded order within each run
+  unsigned offset = 0;
+  for (SortedRun& run : layer_runs) {
+    const unsigned run_count = run.count;
+    run.count = offset;
+    offset += run_count;
+  }
+  layer_order.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    layer_order[layer_runs[layer_quad_runs[i]].count++] = i;
+  }
+
+  const int blend_src = enigma::blendMode[0], blend_dest = enigma::blendMode[1];
+  for (unsigned i : layer_order) {
+    const SortedQuad& quad = layer_quads[i];
+    if (enigma::blendMode[0] != quad.blend_src || enigma::blendMode[1] != quad.blend_dest)
+      enigma_user::draw_set_blend_mode_ext(quad.blend_src, quad.blend_dest);
+    draw_batch_quad_data(quad.texture, quad.data);
+  }
+  if (enigma::blendMode[0] != blend_src || enigma::blendMode[1] != blend_dest)
+    enigma_user::draw_set_blend_mode_ext(blend_src, blend_dest);
+
+  flushes_saved_this_frame += flushes_before - (layer_runs.size() - 1);
+  layer_quads.clear();
 }
 
 } // anonymous namespace
 
+namespace enigma {
+
+void draw_batch_quad(int texId,
+                     gs_scalar x1, gs_scalar y1, gs_scalar x2, gs_scalar y2,
+                     gs_scalar x3, gs_scalar y3, gs_scalar x4, gs_scalar y4,
+                     gs_scalar tx1, gs_scalar ty1, gs_scalar tx2, gs_scalar ty2,
+                     int c1, int c2, int c3, int c4, double alpha)
+{
+  QuadBatch& batch = draw_get_quad_batch();
+  VertexElement quad[quad_elements];
+  // top-left, top-right, bottom-left, bottom-right as for a triangle strip
+  quad[0].f = x1;  quad[1].f = y1;  quad[2].f = tx1;  quad[3].f = ty1;  quad[4] = batch.pack_color(c1, alpha);
+  quad[5].f = x2;  quad[6].f = y2;  quad[7].f = tx2;  quad[8].f = ty1;  quad[9] = batch.pack_color(c2, alpha);
+  quad[10].f = x4; quad[11].f = y4; quad[12].f = tx1; quad[13].f = ty2; quad[14] = batch.pack_color(c4, alpha);
+  quad[15].f = x3; quad[16].f = y3; quad[17].f = tx2; quad[18].f = ty2; quad[19] = batch.pack_color(c3, alpha);
+
+  if (layer_recording) {
+    draw_layer_record(texId, quad);
+  } else {
+    draw_batch_quad_data(texId, quad);
+  }
+}
+
+void draw_layer_begin() {
+  layer_recording = layer_sorting && draw_batch_mode == enigma_user::batch_flush_deferred;
+}
+
+void draw_layer_end() {
+  draw_layer_flush();
+  layer_recording = false;
+}
+
+void draw_layer_flush() {
+  if (!layer_recording || layer_quads.empty()) return;
+  layer_recording = false;
+  draw_layer_replay();
+  layer_recording = true;
+}
+
+void draw_layer_next_frame() {
+  flushes_saved_last_frame = flushes_saved_this_frame;
+  flushes_saved_this_frame = 0;
+}
+
+} // namespace enigma
+
 namespace enigma_user
 {
 
@@ -78,6 +320,9 @@ unsigned draw_primitive_count(int kind, unsigned vertex_count) {
 void draw_batch_flush(int kind) {
   static bool flushing = false;
 
+  // whatever needs the batch drawn needs the sorted layer drawn too
+  enigma::draw_layer_flush();
+
   // return if the kind of flush being requested
   // is not the mode of flushing we have enabled
   if (draw_batch_mode != kind) return;
@@ -98,10 +343,18 @@ void draw_batch_flush(int kind) {
     // the next batch or vertex submit to flush the new state
     bool wasStateDirty = enigma::draw_get_state_dirty();
     enigma::draw_set_state_dirty(false);
-    d3d_model_draw(draw_get_batch_stream());
+    if (draw_batch_quads) {
+      draw_get_quad_batch().draw();
+    } else {
+      d3d_model_draw(draw_get_batch_stream());
+    }
     enigma::draw_set_state_dirty(wasStateDirty);
   }
-  d3d_model_clear(draw_get_batch_stream());
+  if (draw_batch_quads) {
+    draw_get_quad_batch().quads = 0;
+  } else {
+    d3d_model_clear(draw_get_batch_stream());
+  }
 
   flushing = false;
   draw_batch_dirty = false;
@@ -122,6 +375,18 @@ int draw_get_batch_mode() {
   return draw_batch_mode;
 }
 
+void draw_set_layer_sorting(bool enable) {
+  layer_sorting = enable;
+}
+
+bool draw_get_layer_sorting() {
+  return layer_sorting;
+}
+
+unsigned draw_get_flushes_saved() {
+  return flushes_saved_last_frame;
+}
+
 void draw_primitive_begin(int kind, int format)
 {
   draw_batch_begin_deferred(-1);
@@ -20,6 +20,27 @@
 
 #include "Universal_System/scalar.h"
 
+namespace enigma
+{
+  // Adds a textured quad to the sprite batch. Corners go top-left, top-right,
+  // bottom-right, bottom-left, each with its own color; (tx1,ty1) and (tx2,ty2)
+  // are the texture coordinates of the top-left and bottom-right corners.
+  void draw_batch_quad(int texId,
+                       gs_scalar x1, gs_scalar y1, gs_scalar x2, gs_scalar y2,
+                       gs_scalar x3, gs_scalar y3, gs_scalar x4, gs_scalar y4,
+                       gs_scalar tx1, gs_scalar ty1, gs_scalar tx2, gs_scalar ty2,
+                       int c1, int c2, int c3, int c4, double alpha);
+
+  // Record the quads drawn for one depth layer, when the user has enabled
+  // sorting, and draw them grouped by texture and blend mode at the end.
+  void draw_layer_begin();
+  void draw_layer_end();
+  // Draws what the layer recorded so far; called before any other draw or
+  // state change, which the recorded quads must not be moved past.
+  void draw_layer_flush();
+  void draw_layer_next_frame();
+}
+
 namespace enigma_user
 {
   enum {
@@ -41,6 +62,12 @@ namespace enigma_user
   void draw_set_batch_mode(int mode);
   int draw_get_batch_mode();
   void draw_batch_flush(int kind = draw_get_batch_mode());
+  // Sorting draws sprites and text of each depth layer grouped by texture and
+  // blend mode, where they do not overlap, so the batch is flushed less often.
+  void draw_set_layer_sorting(bool enable);
+  bool draw_get_layer_sorting();
+  // Flushes that sorting saved during the last screen_redraw.
+  unsigned draw_get_flushes_saved();
   unsigned draw_primitive_count(int kind, unsigned vertex_count);
   void draw_primitive_begin(int kind, int format = -1);
   void draw_primitive_begin_texture(int kind, int texId, int format = -1);
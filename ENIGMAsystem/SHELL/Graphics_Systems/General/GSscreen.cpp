@@ -176,14 +176,17 @@ static inline int draw_tiles()
         enigma_user::index_submit_range(enigma::tile_index_buffer, enigma::tile_vertex_buffer, enigma_user::pr_trianglelist, t[0], t[1], t[2]);
       }
     }
+    enigma::draw_layer_begin();
     enigma::inst_iter* push_it = enigma::instance_event_iterator;
     //loop instances
     for (enigma::instance_event_iterator = dit->second.draw_events->next; enigma::instance_event_iterator != NULL; enigma::instance_event_iterator = enigma::instance_event_iterator->next) {
       enigma::object_graphics* inst = ((object_graphics*)enigma::instance_event_iterator->inst);
       if (inst->myevent_draw_subcheck())
         inst->myevent_draw();
-      if (enigma::room_switching_id != -1)
+      if (enigma::room_switching_id != -1) {
+        enigma::draw_layer_end();
         return 1;
+      }
     }
     enigma::instance_event_iterator = push_it;
     //particles
@@ -194,6 +197,7 @@ static inline int draw_tiles()
       dit--;
       (enigma::particles_impl->draw_particlesystems)(high, low);
     }
+    enigma::draw_layer_end();
   }
   return 0;
 }
@@ -337,6 +341,7 @@ void screen_refresh() {
 void screen_redraw()
 {
   enigma::scene_begin();
+  enigma::draw_layer_next_frame();
 
   if (!view_enabled)
   {
@@ -55,12 +55,7 @@ void draw_sprite_pos_raw(const Sprite& spr2d, int subimg, gs_scalar x1, gs_scala
     tx = texRect.x, tw = texRect.w,
     ty = texRect.y, th = texRect.h;
 
-  draw_primitive_begin_texture(pr_trianglestrip, spr2d.GetTexture(usi));
-  draw_vertex_texture_color(x1,y1, tx,    ty,    color,alpha);
-  draw_vertex_texture_color(x2,y2, tx+tw, ty,    color,alpha);
-  draw_vertex_texture_color(x4,y4, tx,    ty+th, color,alpha);
-  draw_vertex_texture_color(x3,y3, tx+tw, ty+th, color,alpha);
-  draw_primitive_end();
+  draw_batch_quad(spr2d.GetTexture(usi), x1,y1, x2,y2, x3,y3, x4,y4, tx,ty, tx+tw,ty+th, color,color,color,color, alpha);
 }
 
 void draw_sprite_pos_part_raw(const Sprite& spr2d, int subimg,
@@ -79,12 +74,7 @@ void draw_sprite_pos_part_raw(const Sprite& spr2d, int subimg,
     tx1 = tbx + px / tbw, tx2 = tx1 + pw / tbw,
     ty1 = tby + py / tbh, ty2 = ty1 + ph / tbh;
 
-  draw_primitive_begin_texture(pr_trianglestrip, spr2d.GetTexture(usi));
-  draw_vertex_texture_color(x1,y1, tx1,ty1, color,alpha);
-  draw_vertex_texture_color(x2,y2, tx2,ty1, color,alpha);
-  draw_vertex_texture_color(x4,y4, tx1,ty2, color,alpha);
-  draw_vertex_texture_color(x3,y3, tx2,ty2, color,alpha);
-  draw_primitive_end();
+  draw_batch_quad(spr2d.GetTexture(usi), x1,y1, x2,y2, x3,y3, x4,y4, tx1,ty1, tx2,ty2, color,color,color,color, alpha);
 }
 
 }
@@ -156,12 +146,13 @@ void draw_sprite_general(int spr, int subimg, gs_scalar left, gs_scalar top, gs_
     tx1 = tbx + left / tbw, tx2 = tx1 + width / tbw,
     ty1 = tby + top / tbh, ty2 = ty1 + height / tbh;
   // VD: EGM's color blending is for some reason softer and I can't figure out why
-  draw_primitive_begin_texture(pr_trianglestrip, spr2d.GetTexture(usi));
-  draw_vertex_texture_color(x + rotx(x1, y1, rx, ry), y + roty(x1, y1, rx, ry), tx1,ty1, c1,alpha);
-  draw_vertex_texture_color(x + rotx(x2, y1, rx, ry), y + roty(x2, y1, rx, ry), tx2,ty1, c2,alpha);
-  draw_vertex_texture_color(x + rotx(x1, y2, rx, ry), y + roty(x1, y2, rx, ry), tx1,ty2, c4,alpha);
-  draw_vertex_texture_color(x + rotx(x2, y2, rx, ry), y + roty(x2, y2, rx, ry), tx2,ty2, c3,alpha);
-  draw_primitive_end();
+  enigma::draw_batch_quad(spr2d.GetTexture(usi),
+    x + rotx(x1, y1, rx, ry), y + roty(x1, y1, rx, ry),
+    x + rotx(x2, y1, rx, ry), y + roty(x2, y1, rx, ry),
+    x + rotx(x2, y2, rx, ry), y + roty(x2, y2, rx, ry),
+    x + rotx(x1, y2, rx, ry), y + roty(x1, y2, rx, ry),
+    tx1,ty1, tx2,ty2, c1,c2,c3,c4, alpha
+  );
 }
 
 void draw_sprite_stretched(int spr, int subimg, gs_scalar x, gs_scalar y, gs_scalar width, gs_scalar height, int color, gs_scalar alpha)
@@ -191,12 +182,9 @@ void draw_sprite_part_offset(int spr, int subimg, gs_scalar left, gs_scalar top,
     tbx1 = texRect.x+left/tbw, tbx2 = texRect.x+tbx1 + width/tbw,
     tby1 = texRect.y+top/tbh,  tby2 = texRect.y+tby1 + height/tbh;
 
-  draw_primitive_begin_texture(pr_trianglestrip, spr2d.GetTexture(usi));
-  draw_vertex_texture_color(xvert1,yvert1,tbx1,tby1,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx2,tby1,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx1,tby2,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx2,tby2,color,alpha);
-  draw_primitive_end();
+  enigma::draw_batch_quad(spr2d.GetTexture(usi),
+    xvert1,yvert1, xvert2,yvert1, xvert2,yvert2, xvert1,yvert2,
+    tbx1,tby1, tbx2,tby2, color,color,color,color, alpha);
 }
 
 void d3d_draw_sprite(int spr,int subimg, gs_scalar x, gs_scalar y, gs_scalar z)
@@ -243,92 +231,36 @@ void draw_sprite_padded(int spr, int subimg, gs_scalar left, gs_scalar top, gs_s
   const gs_scalar tbw = spr2d.width/(gs_scalar)texRect.w, tbh = spr2d.height/(gs_scalar)texRect.h;
   const gs_scalar tbl = left/tbw, tbt = top/tbh, tbr = right/tbw, tbb = bottom/tbh, tbmw = midtw/tbw, tbmh = midth/tbh;
 
-  //Draw top-left corner
-  gs_scalar xvert1 = x1, xvert2 = xvert1 + left,
-            yvert1 = y1, yvert2 = yvert1 + top;
-
-  draw_primitive_begin_texture(pr_trianglestrip, spr2d.GetTexture(usi));
-  draw_vertex_texture_color(xvert1,yvert1,tbx,tby,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx+tbl,tby,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx,tby+tbt,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx+tbl,tby+tbt,color,alpha);
-
-  //Draw left side
-  xvert1 = x1, xvert2 = xvert1 + left,
-  yvert1 = y1 + top, yvert2 = yvert1 + midh;
-
-  draw_vertex_texture_color(xvert1,yvert1,tbx,tby+tbt,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx+tbl,tby+tbt,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx,tby+tbt+tbmh,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx+tbl,tby+tbt+tbmh,color,alpha);
-
-  //Draw bottom-left corner
-  xvert1 = x1, xvert2 = xvert1 + left,
-  yvert1 = y1 + top + midh, yvert2 = yvert1 + bottom;
-
-  draw_vertex_texture_color(xvert1,yvert1,tbx,tby+tbt+tbmh,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx+tbl,tby+tbt+tbmh,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx,tby+tbt+tbmh+tbb,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx+tbl,tby+tbt+tbmh+tbb,color,alpha);
-  draw_primitive_end();
-
-  //Draw top
-  xvert1 = x1 + left, xvert2 = xvert1 + midw,
-  yvert1 = y1, yvert2 = yvert1 + top;
-
-  draw_primitive_begin_texture(pr_trianglestrip, spr2d.GetTexture(usi));
-  draw_vertex_texture_color(xvert1,yvert1,tbx+tbl,tby,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx+tbl+tbmw,tby,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx+tbl,tby+tbt,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx+tbl+tbmw,tby+tbt,color,alpha);
-
-  //Draw middle
-  xvert1 = x1 + left, xvert2 = xvert1 + midw,
-  yvert1 = y1 + top, yvert2 = yvert1 + midh;
-
-  draw_vertex_texture_color(xvert1,yvert1,tbx+tbl,tby+tbt,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx+tbl+tbmw,tby+tbt,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx+tbl,tby+tbt+tbmh,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx+tbl+tbmw,tby+tbt+tbmh,color,alpha);
-
-  //Draw bottom
-  xvert1 = x1 + left, xvert2 = xvert1 + midw,
-  yvert1 = y1 + midh + top, yvert2 = yvert1 + bottom;
-
-  draw_vertex_texture_color(xvert1,yvert1,tbx+tbl,tby+tbt+tbmh,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx+tbl+tbmw,tby+tbt+tbmh,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx+tbl,tby+tbt+tbmh+tbb,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx+tbl+tbmw,tby+tbt+tbmh+tbb,color,alpha);
-  draw_primitive_end();
-
-  //Draw top-right corner
-  xvert1 = x1 + midw + left, xvert2 = xvert1 + right,
-  yvert1 = y1, yvert2 = yvert1 + top;
-
-  draw_primitive_begin_texture(pr_trianglestrip, spr2d.GetTexture(usi));
-  draw_vertex_texture_color(xvert1,yvert1,tbx+tbl+tbmw,tby,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx+tbl+tbmw+tbr,tby,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx+tbl+tbmw,tby+tbt,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx+tbl+tbmw+tbr,tby+tbt,color,alpha);
-
-  //Draw right side
-  xvert1 = x1 + midw + left, xvert2 = xvert1 + right,
-  yvert1 = y1 + top, yvert2 = yvert1 + midh;
-
-  draw_vertex_texture_color(xvert1,yvert1,tbx+tbl+tbmw,tby+tbt,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx+tbl+tbmw+tbr,tby+tbt,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx+tbl+tbmw,tby+tbt+tbmh,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx+tbl+tbmw+tbr,tby+tbt+tbmh,color,alpha);
-
-  //Draw bottom-right corner
-  xvert1 = x1 + midw + left, xvert2 = xvert1 + right,
-  yvert1 = y1 + top + midh, yvert2 = yvert1 + bottom;
-
-  draw_vertex_texture_color(xvert1,yvert1,tbx+tbl+tbmw,tby+tbt+tbmh,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert1,tbx+tbl+tbmw+tbr,tby+tbt+tbmh,color,alpha);
-  draw_vertex_texture_color(xvert1,yvert2,tbx+tbl+tbmw,tby+tbt+tbmh+tbb,color,alpha);
-  draw_vertex_texture_color(xvert2,yvert2,tbx+tbl+tbmw+tbr,tby+tbt+tbmh+tbb,color,alpha);
-  draw_primitive_end();
+  const int tex = spr2d.GetTexture(usi);
+  auto draw_part = [&](gs_scalar xvert1, gs_scalar yvert1, gs_scalar xvert2, gs_scalar yvert2,
+                       gs_scalar tbx1, gs_scalar tby1, gs_scalar tbx2, gs_scalar tby2) {
+    enigma::draw_batch_quad(tex, xvert1,yvert1, xvert2,yvert1, xvert2,yvert2, xvert1,yvert2,
+                            tbx1,tby1, tbx2,tby2, color,color,color,color, alpha);
+  };
+
+  //Draw top-left corner, left side and bottom-left corner
+  draw_part(x1, y1, x1 + left, y1 + top,
+            tbx, tby, tbx+tbl, tby+tbt);
+  draw_part(x1, y1 + top, x1 + left, y1 + top + midh,
+            tbx, tby+tbt, tbx+tbl, tby+tbt+tbmh);
+  draw_part(x1, y1 + top + midh, x1 + left, y1 + top + midh + bottom,
+            tbx, tby+tbt+tbmh, tbx+tbl, tby+tbt+tbmh+tbb);
+
+  //Draw top, middle and bottom
+  draw_part(x1 + left, y1, x1 + left + midw, y1 + top,
+            tbx+tbl, tby, tbx+tbl+tbmw, tby+tbt);
+  draw_part(x1 + left, y1 + top, x1 + left + midw, y1 + top + midh,
+            tbx+tbl, tby+tbt, tbx+tbl+tbmw, tby+tbt+tbmh);
+  draw_part(x1 + left, y1 + midh + top, x1 + left + midw, y1 + midh + top + bottom,
+            tbx+tbl, tby+tbt+tbmh, tbx+tbl+tbmw, tby+tbt+tbmh+tbb);
+
+  //Draw top-right corner, right side and bottom-right corner
+  draw_part(x1 + midw + left, y1, x1 + midw + left + right, y1 + top,
+            tbx+tbl+tbmw, tby, tbx+tbl+tbmw+tbr, tby+tbt);
+  draw_part(x1 + midw + left, y1 + top, x1 + midw + left + right, y1 + top + midh,
+            tbx+tbl+tbmw, tby+tbt, tbx+tbl+tbmw+tbr, tby+tbt+tbmh);
+  draw_part(x1 + midw + left, y1 + top + midh, x1 + midw + left + right, y1 + top + midh + bottom,
+            tbx+tbl+tbmw, tby+tbt+tbmh, tbx+tbl+tbmw+tbr, tby+tbt+tbmh+tbb);
 }
 
 }
@@ -369,12 +301,9 @@ void draw_sprite_tiled(int spr, int subimg, gs_scalar x, gs_scalar y, int color,
     yvert1 = -y; yvert2 = yvert1 + spr2d.height;
     for (int c=0; c<vertil; ++c)
     {
-      draw_primitive_begin_texture(pr_trianglestrip, spr2d.GetTexture(usi));
-      draw_vertex_texture_color(xvert1,yvert1,tx,ty,color,alpha);
-      draw_vertex_texture_color(xvert2,yvert1,tx+tw,ty,color,alpha);
-      draw_vertex_texture_color(xvert1,yvert2,tx,ty+th,color,alpha);
-      draw_vertex_texture_color(xvert2,yvert2,tx+tw,ty+th,color,alpha);
-      draw_primitive_end();
+      enigma::draw_batch_quad(spr2d.GetTexture(usi),
+        xvert1,yvert1, xvert2,yvert1, xvert2,yvert2, xvert1,yvert2,
+        tx,ty, tx+tw,ty+th, color,color,color,color, alpha);
       yvert1 = yvert2;
       yvert2 += spr2d.height;
     }
@@ -409,12 +338,9 @@ void draw_sprite_tiled_ext(int spr, int subimg, gs_scalar x, gs_scalar y, gs_sca
     yvert1 = -y; yvert2 = yvert1 + height_scaled;
     for (int c=0; c<vertil; ++c)
     {
-      draw_primitive_begin_texture(pr_trianglestrip, spr2d.GetTexture(usi));
-      draw_vertex_texture_color(xvert1,yvert1,tx,ty,color,alpha);
-      draw_vertex_texture_color(xvert2,yvert1,tx+tw,ty,color,alpha);
-      draw_vertex_texture_color(xvert1,yvert2,tx,ty+th,color,alpha);
-      draw_vertex_texture_color(xvert2,yvert2,tx+tw,ty+th,color,alpha);
-      draw_primitive_end();
+      enigma::draw_batch_quad(spr2d.GetTexture(usi),
+        xvert1,yvert1, xvert2,yvert1, xvert2,yvert2, xvert1,yvert2,
+        tx,ty, tx+tw,ty+th, color,color,color,color, alpha);
       yvert1 = yvert2;
       yvert2 += height_scaled;
     }
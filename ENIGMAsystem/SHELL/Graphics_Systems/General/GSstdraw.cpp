@@ -43,7 +43,13 @@ float circleprecision=24, drawPointSize=1.0f, drawLineWidth=1.0f;
 int drawFillMode=enigma_user::rs_solid, lineStippleScale=1;
 
 // handler for when a generic rendering state has changed
-void draw_set_state_dirty(bool dirty) { drawStateDirty = dirty; }
+void draw_set_state_dirty(bool dirty) {
+  // states are changed after this is called, so what a sorted layer
+  // recorded can still be drawn with the states it was recorded with
+  if (dirty) draw_layer_flush();
+  drawStateDirty = dirty;
+}
+void draw_set_blend_state_dirty() { drawStateDirty = true; }
 bool draw_get_state_dirty() { return drawStateDirty; }
 
 } // namespace enigma
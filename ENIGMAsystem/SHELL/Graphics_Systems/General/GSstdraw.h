@@ -32,6 +32,9 @@ extern float drawPointSize, drawLineWidth;
 extern int drawFillMode, lineStippleScale;
 
 void draw_set_state_dirty(bool dirty=true);
+// for the blend mode, which a sorted depth layer records with each quad
+// rather than drawing what it recorded first
+void draw_set_blend_state_dirty();
 bool draw_get_state_dirty();
 
 void graphics_state_flush();
@@ -95,10 +95,14 @@ union VertexElement {
   color_t d;
   gs_scalar f;
 
+  VertexElement() {} // left uninitialized so buffers can be resized and then written in place
   VertexElement(gs_scalar v): f(v) {}
   VertexElement(color_t v): d(v) {}
 };
 
+// packs a color and alpha the way vertex_color does, in the channel order of the backend
+color_t graphics_pack_vertex_color(int color, double alpha);
+
 struct VertexBuffer {
   vector<VertexElement> vertices; // interleaved vertex elements
   bool frozen; // whether vertex_freeze has been called
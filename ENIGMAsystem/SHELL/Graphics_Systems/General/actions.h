@@ -147,8 +147,8 @@ inline void action_draw_sprite(const int sprite, const gs_scalar x, const gs_sca
         draw_sprite(sprite,subimage,x,y);
 }
 
-void action_draw_health(const gs_scalar x1, const gs_scalar y1, const gs_scalar x2, const gs_scalar y2, const int backColor, const int barColor);
-void action_draw_health(const gs_scalar x1, const gs_scalar y1, const gs_scalar x2, const gs_scalar y2, const int backColor, const int barColor) {
+inline void action_draw_health(const gs_scalar x1, const gs_scalar y1, const gs_scalar x2, const gs_scalar y2, const int backColor, const int barColor);
+inline void action_draw_health(const gs_scalar x1, const gs_scalar y1, const gs_scalar x2, const gs_scalar y2, const int backColor, const int barColor) {
   static const int back_colors[] = {
     c_black, c_black, c_gray, c_silver, c_white, c_maroon,
     c_green, c_olive, c_navy, c_purple, c_teal, c_red,
@@ -23,6 +23,7 @@
 #include "Universal_System/Resources/backgrounds_internal.h"
 #include "Universal_System/Resources/fonts_internal.h"
 #include "Universal_System/Resources/sprites_internal.h"
+#include "Universal_System/Resources/texture_pages.h"
 
 #include "Universal_System/nlpo2.h"
 #include "Graphics_Systems/graphics_mandatory.h"
@@ -146,9 +147,13 @@ namespace enigma {
         case 0: { //Copy textures for all sprite subimages
           enigma::Sprite& sspr = enigma::sprites.get(textures[i].id);
           for (size_t s = 0; s < sspr.SubimageCount(); s++){
-            enigma::graphics_copy_texture(sspr.GetTexture(s), enigma::texture_atlas_array[ta].texture, metrics[counter].x, metrics[counter].y);
-            if (free_textures == true){
-              enigma::graphics_delete_texture(sspr.GetTexture(s));
+            // graphics_copy_texture copies the whole texture, so take subimages off their pages first
+            int texture = sspr.GetTexture(s);
+            enigma::TexRect bounds = sspr.GetTextureRect(s);
+            const bool detached = enigma::texture_page_detach(texture, bounds);
+            enigma::graphics_copy_texture(texture, enigma::texture_atlas_array[ta].texture, metrics[counter].x, metrics[counter].y);
+            if (free_textures == true || detached){
+              enigma::graphics_delete_texture(texture);
             }
             sspr.SetTexture(s,
               enigma::texture_atlas_array[ta].texture,
@@ -163,8 +168,9 @@ namespace enigma {
         } break;
         case 1: { //Copy textures for all the backgrounds
           enigma::Background& bkg = enigma::backgrounds.get(textures[i].id);
+          const bool detached = enigma::texture_page_detach(bkg.textureID, bkg.textureBounds);
           enigma::graphics_copy_texture(bkg.textureID, enigma::texture_atlas_array[ta].texture, metrics[counter].x, metrics[counter].y);
-          if (free_textures == true){
+          if (free_textures == true || detached){
             enigma::graphics_delete_texture(bkg.textureID);
           }
           bkg.textureID = enigma::texture_atlas_array[ta].texture;
@@ -253,9 +259,12 @@ namespace enigma_user {
   void texture_atlas_add_sprite_position(int ta, int sprid, int subimg, int x, int y, bool free_texture){
     ///TODO: NEEDS ERROR CHECKING
     enigma::Sprite& sspr = enigma::sprites.get(sprid);
-    enigma::graphics_copy_texture(sspr.GetTexture(subimg), enigma::texture_atlas_array[ta].texture, x, y);
-    if (free_texture == true){
-      enigma::graphics_delete_texture(sspr.GetTexture(subimg));
+    int texture = sspr.GetTexture(subimg);
+    enigma::TexRect bounds = sspr.GetTextureRect(subimg);
+    const bool detached = enigma::texture_page_detach(texture, bounds);
+    enigma::graphics_copy_texture(texture, enigma::texture_atlas_array[ta].texture, x, y);
+    if (free_texture == true || detached){
+      enigma::graphics_delete_texture(texture);
     }
     
     sspr.SetTexture(subimg,
@@ -20,6 +20,7 @@
 #include "Graphics_Systems/General/GStextures.h"
 #include "Graphics_Systems/General/GStiles.h"
 #include "Graphics_Systems/General/GSvertex.h"
+#include "Graphics_Systems/General/GSvertex_impl.h"
 #include "Graphics_Systems/General/GSsurface.h"
 #include "Graphics_Systems/General/GSstdraw.h"
 #include "Graphics_Systems/General/GSsprite.h"
@@ -70,6 +71,7 @@ namespace enigma
 
 	void graphics_delete_vertex_buffer_peer(int buffer) {}
 	void graphics_delete_index_buffer_peer(int buffer) {}
+	color_t graphics_pack_vertex_color(int color, double alpha) { return 0; }
 	void graphics_replace_texture_alpha_from_texture(int, int) {}
 	int graphics_duplicate_texture(int, bool) { return -1; }
 
@@ -381,6 +381,8 @@ void main()
       }
     }
     shaderprograms[prog_id].attribute_count = attribute_count+attribute_count_arr;
+    // the arrays were disabled behind the vertex submit's back
+    graphics_reset_attribute_state();
   }
   void getDefaultUniforms(int prog_id){
     shaderprograms[prog_id].uni_viewMatrix = enigma_user::glsl_get_uniform_location(prog_id, "transform_matrix[0]");
@@ -570,6 +572,7 @@ bool glsl_program_link(int id)
   GLint linked;
   glGetProgramiv(enigma::shaderprograms[id].shaderprogram, GL_LINK_STATUS, &linked);
 
+  enigma::graphics_reset_program_bindings(id);
 	if (linked){
     enigma::getUniforms(id);
     enigma::getAttributes(id);
@@ -641,6 +644,7 @@ void glsl_program_default_reset(){
 
 void glsl_program_free(int id)
 {
+  enigma::graphics_reset_program_bindings(id);
   enigma::shaderprograms.destroy(id);
 }
 
@@ -956,36 +960,37 @@ int glsl_get_attribute_location(int program, string name) {
 }
 
 void glsl_attribute_enable_all(bool enable){
+  // vertex submits don't keep the enabled flags up to date, so always apply
+  enigma_user::draw_batch_flush(enigma_user::batch_flush_deferred);
+  enigma::graphics_reset_attribute_state();
   for ( auto &it : enigma::shaderprograms[enigma::bound_shader].attributes ){
-    if (enable != it.second.enabled){
-      enigma_user::draw_batch_flush(enigma_user::batch_flush_deferred);
-      if (enable == true){
-        glEnableVertexAttribArray( it.second.location );
-      }else{
-        glDisableVertexAttribArray( it.second.location );
-      }
-      it.second.enabled = enable;
+    if (enable == true){
+      glEnableVertexAttribArray( it.second.location );
+    }else{
+      glDisableVertexAttribArray( it.second.location );
     }
+    it.second.enabled = enable;
   }
 }
 
 void glsl_attribute_enable(int location, bool enable){
   get_attribute(it,location);
-  if (enable != it->second.enabled){
-    enigma_user::draw_batch_flush(enigma_user::batch_flush_deferred);
-    if (enable == true){
-      glEnableVertexAttribArray(location);
-    }else{
-      glDisableVertexAttribArray(location);
-    }
-    it->second.enabled = enable;
+  // vertex submits don't keep the enabled flags up to date, so always apply
+  enigma_user::draw_batch_flush(enigma_user::batch_flush_deferred);
+  enigma::graphics_reset_attribute_state();
+  if (enable == true){
+    glEnableVertexAttribArray(location);
+  }else{
+    glDisableVertexAttribArray(location);
   }
+  it->second.enabled = enable;
 }
 
 void glsl_attribute_set(int location, int size, int type, bool normalize, int stride, unsigned offset){
   get_attribute(it,location);
   //if (/*it->second.enabled == true*/ (it->second.vao != enigma::bound_vbo || it->second.datatype != type || it->second.datasize != size || it->second.normalize != normalize || it->second.stride != stride || it->second.offset != offset)){
     enigma_user::draw_batch_flush(enigma_user::batch_flush_deferred);
+    enigma::graphics_reset_attribute_state();
     glVertexAttribPointer(location, size, type, normalize, stride, (const GLvoid*)(intptr_t)offset);
     it->second.datatype = type;
     it->second.datasize = size;
@@ -1034,33 +1039,34 @@ namespace enigma
   }
 
   void glsl_attribute_enable_all_internal(bool enable){
+    // vertex submits don't keep the enabled flags up to date, so always apply
+    graphics_reset_attribute_state();
     for ( auto &it : enigma::shaderprograms[enigma::bound_shader].attributes ){
-      if (enable != it.second.enabled){
-        if (enable == true){
-          glEnableVertexAttribArray( it.second.location );
-        }else{
-          glDisableVertexAttribArray( it.second.location );
-        }
-        it.second.enabled = enable;
+      if (enable == true){
+        glEnableVertexAttribArray( it.second.location );
+      }else{
+        glDisableVertexAttribArray( it.second.location );
       }
+      it.second.enabled = enable;
     }
   }
 
   void glsl_attribute_enable_internal(int location, bool enable){
     get_attribute(it,location);
-    if (enable != it->second.enabled){
-      if (enable == true){
-        glEnableVertexAttribArray(location);
-      }else{
-        glDisableVertexAttribArray(location);
-      }
-      it->second.enabled = enable;
+    // vertex submits don't keep the enabled flags up to date, so always apply
+    graphics_reset_attribute_state();
+    if (enable == true){
+      glEnableVertexAttribArray(location);
+    }else{
+      glDisableVertexAttribArray(location);
     }
+    it->second.enabled = enable;
   }
 
   void glsl_attribute_set_internal(int location, int size, int type, bool normalize, int stride, unsigned offset){
     get_attribute(it,location);
     //if (/*it->second.enabled == true*/ (it->second.vao != enigma::bound_vbo || it->second.datatype != type || it->second.datasize != size || it->second.normalize != normalize || it->second.stride != stride || it->second.offset != offset)){
+      graphics_reset_attribute_state();
       glVertexAttribPointer(location, size, type, normalize, stride, (const GLvoid*)(intptr_t)offset);
       it->second.datatype = type;
       it->second.datasize = size;
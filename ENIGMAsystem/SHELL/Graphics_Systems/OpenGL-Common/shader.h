@@ -56,6 +56,11 @@ namespace enigma
   void glsl_attribute_enable_internal(int location, bool enable);
   void glsl_attribute_set_internal(int location, int size, int type, bool normalize, int stride, unsigned offset);
 
+  // Drop what the vertex submit path cached about a program's attributes and
+  // uniforms, or about the attribute arrays, after they change behind its back.
+  void graphics_reset_program_bindings(int program);
+  void graphics_reset_attribute_state();
+
   void cleanup_shaders();
 }
 
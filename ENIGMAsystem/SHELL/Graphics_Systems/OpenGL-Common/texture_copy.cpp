@@ -3,7 +3,7 @@
 namespace enigma {
 
 unsigned char* graphics_copy_texture_pixels(int texture, unsigned* fullwidth, unsigned* fullheight) {
-  glBindTexture(GL_TEXTURE_2D, get_texture_peer(texture));
+  bind_texture_peer(GL_TEXTURE_2D, get_texture_peer(texture));
   *fullwidth = textures[texture]->fullwidth;
   *fullheight = textures[texture]->fullheight;
   unsigned char* ret = new unsigned char[((*fullwidth)*(*fullheight)*4)];
@@ -30,6 +30,9 @@
 
 namespace enigma {
 
+GLuint bound_texture_peers[8] = { GLuint(-1), GLuint(-1), GLuint(-1), GLuint(-1),
+                                  GLuint(-1), GLuint(-1), GLuint(-1), GLuint(-1) };
+
 GLuint get_texture_peer(int texid) {
   return (size_t(texid) >= textures.size() || texid < 0)
       ? 0 : static_cast<GLTexture*>(textures[texid].get())->peer;
@@ -51,7 +54,7 @@ int graphics_create_texture_custom(const RawImage& img, bool mipmap, unsigned* f
   
   GLuint texture;
   glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
+  bind_texture_peer(GL_TEXTURE_2D, texture);
 
   if (pad) {
     RawImage padded = image_pad(img, *fullwidth, *fullheight);
@@ -65,7 +68,7 @@ int graphics_create_texture_custom(const RawImage& img, bool mipmap, unsigned* f
     //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 3);
     glGenerateMipmap(GL_TEXTURE_2D);
   }
-  glBindTexture(GL_TEXTURE_2D, 0);
+  bind_texture_peer(GL_TEXTURE_2D, 0);
 
   const int id = textures.size();
   textures.push_back(std::make_unique<GLTexture>(texture));
@@ -81,6 +84,9 @@ void graphics_delete_texture(int texid) {
   if (texid >= 0) {
     const GLuint peer = get_texture_peer(texid);
     glDeleteTextures(1, &peer);
+    // GL unbinds it everywhere, and may hand the name out again
+    for (GLuint& bound : bound_texture_peers)
+      if (bound == peer) bound = -1;
   }
 }
 
@@ -35,6 +35,17 @@ struct GLTexture : Texture {
 
 GLuint get_texture_peer(int texid);
 
+// The texture bound on each sampler stage, as last bound by the sampler flush,
+// or -1 when it isn't known. Deleting a texture forgets it here.
+extern GLuint bound_texture_peers[8];
+
+// Binds a texture on unit 0, which is left active outside the sampler flush,
+// to create, update or read it. The flush rebinds that stage's texture after.
+inline void bind_texture_peer(GLenum target, GLuint peer) {
+  glBindTexture(target, peer);
+  bound_texture_peers[0] = GLuint(-1);
+}
+
 int graphics_create_texture_custom(const RawImage& img, bool mipmap, unsigned* fullwidth, unsigned* fullheight, GLint internalFormat, GLenum format, GLenum type);
 
 } // namespace enigma
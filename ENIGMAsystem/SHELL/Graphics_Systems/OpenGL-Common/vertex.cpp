@@ -20,6 +20,7 @@
 #include "profiler.h"
 #include "shader.h"
 #include "GLSLshader.h"
+#include "textures_impl.h"
 
 #include "OpenGLHeaders.h"
 #include "Graphics_Systems/General/GSvertex_impl.h"
@@ -27,8 +28,12 @@
 #include "Graphics_Systems/General/GScolors.h"
 #include "Graphics_Systems/General/GScolor_macros.h"
 #include "Graphics_Systems/General/GSstdraw.h"
+#include "Graphics_Systems/General/GStextures.h"
 
 #include <map>
+#include <vector>
+#include <cstring>
+#include <cstdint>
 
 using std::map;
 
@@ -39,21 +44,195 @@ namespace {
 
 GLenum primitive_types[] = { 0, GL_POINTS, GL_LINES, GL_LINE_STRIP, GL_TRIANGLES, GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN };
 
-map<int, GLuint> vertexBufferPeers;
-map<int, GLuint> indexBufferPeers;
+// Native buffer objects, indexed by buffer id. Stream vertex buffers that fit
+// are written to the stream ring instead, and remember where they were put.
+struct BufferPeer {
+  GLuint peer = 0;
+  bool streamed = false; // whether the current contents live in the stream ring
+  GLintptr ring_offset = 0;
+  unsigned ring_epoch = 0;
+};
+
+std::vector<BufferPeer> vertexBufferPeers;
+std::vector<GLuint> indexBufferPeers;
+
+template<typename T> T& peer_slot(std::vector<T>& peers, int buffer) {
+  if (size_t(buffer) >= peers.size()) peers.resize(buffer + 1);
+  return peers[buffer];
+}
+
+// One large buffer object that stream vertex data is suballocated from, so
+// that updating a stream buffer does not respecify a buffer object each time.
+// It needs GL_ARB_buffer_storage: the buffer is mapped once and written
+// directly, and each quarter of it is fenced before it is written again.
+// Without it stream buffers keep their own peer, because orphaning a shared
+// buffer and writing it with glBufferSubData was slower than glBufferData.
+// GLES builds don't have GLEW, so they always take that path for now, and
+// building with ENIGMA_GL_NO_STREAM_RING defined makes every build take it.
+#if defined(GLEW_ARB_buffer_storage) && !defined(ENIGMA_GL_NO_STREAM_RING)
+#define ENIGMA_GL_STREAM_RING
+#endif
+
+class StreamRing {
+ public:
+  static const GLsizeiptr size = 8 << 20, segments = 4, segment_size = size / segments;
+
+  GLuint peer = 0;
+  // Bumped whenever data written before may be overwritten.
+  unsigned epoch = 1;
+
+  // Copies the data into the ring and returns its offset in the buffer, which
+  // is left bound to GL_ARRAY_BUFFER, or -1 if it can't be streamed.
+  GLintptr write(const void* data, GLsizeiptr length) {
+    if (length > segment_size || !(mapped || create())) return -1;
+    bind_array_buffer(peer);
+    if (!length) return head;
+
+    if (head + length > size) head = 0;
+    const GLintptr offset = head;
+    head = (head + length + 15) & ~GLsizeiptr(15);
+
+    const GLsizeiptr segment = (offset + length - 1) / segment_size;
+    if (segment != current_segment) enter_segment(segment);
+    std::memcpy(mapped + offset, data, length);
+    return offset;
+  }
+
+ private:
+  char* mapped = nullptr;
+  bool tried = false;
+  GLsizeiptr head = 0, current_segment = 0;
+  #ifdef ENIGMA_GL_STREAM_RING
+  GLsync fences[segments] = {};
+  #endif
+
+  bool create() {
+    if (tried) return false;
+    tried = true;
+    #ifdef ENIGMA_GL_STREAM_RING
+    if (!GLEW_ARB_buffer_storage) return false;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &peer);
+    bind_array_buffer(peer);
+    glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+    mapped = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+    if (mapped) return true;
+    glDeleteBuffers(1, &peer);
+    enigma::bound_vbo = -1;
+    peer = 0;
+    #endif
+    return false;
+  }
+
+  // Fences the segment being left so it is not written again until the GPU is
+  // done with it, then waits for the one being entered.
+  void enter_segment(GLsizeiptr segment) {
+    #ifdef ENIGMA_GL_STREAM_RING
+    fences[current_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (GLsync fence = fences[segment]) {
+      while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+      glDeleteSync(fence);
+      fences[segment] = 0;
+    }
+    #endif
+    current_segment = segment;
+    epoch++;
+  }
+};
+
+StreamRing streamRing;
+
+// Attribute locations at or past this are never fed by a vertex format.
+const int max_attributes = 64;
+
+// What a vertex format feeds in one shader program.
+struct FormatBinding {
+  struct Attribute {
+    GLint location;
+    GLint elements;
+    GLenum type;
+    unsigned offset; // from the start of the vertex
+  };
+
+  bool resolved = false;
+  bool useTextCoords = false, useColors = false;
+  GLsizei stride = 0;
+  uint64_t enabled = 0; // mask of the locations in attributes
+  std::vector<Attribute> attributes;
+};
+
+// The built-in uniforms of a shader program along with its format bindings,
+// indexed by vertex format id. Uniforms are kept as pointers into the
+// program's uniform table, which stays put until the program is relinked.
+struct ProgramBindings {
+  bool resolved = false;
+  enigma::Uniform *texSampler = nullptr, *color = nullptr, *textureEnable = nullptr, *colorEnable = nullptr;
+  std::vector<FormatBinding> formats;
+};
+
+std::vector<ProgramBindings> programBindings;
+
+// The attribute array state, which the vertex array object holds for every
+// program, as last set by graphics_apply_vertex_format.
+struct AttributePointer {
+  GLuint buffer = 0;
+  GLint elements = 0;
+  GLenum type = 0;
+  GLsizei stride = 0;
+  unsigned offset = 0;
+
+  bool operator==(const AttributePointer& other) const {
+    return buffer == other.buffer && elements == other.elements && type == other.type &&
+           stride == other.stride && offset == other.offset;
+  }
+};
+
+AttributePointer attributePointers[max_attributes];
+uint64_t enabledAttributes = 0;
+bool attributesKnown = false;
+GLint attributeLimit = 0;
+
+enigma::Uniform* find_uniform(enigma::ShaderProgram& program, GLint location) {
+  auto it = program.uniforms.find(location);
+  return (location < 0 || it == program.uniforms.end() || it->second.data.empty()) ? nullptr : &it->second;
+}
+
+void set_uniform(enigma::Uniform* uniform, int v0) {
+  if (!uniform || uniform->data[0].i == v0) return;
+  glUniform1i(uniform->location, v0);
+  uniform->data[0].i = v0;
+}
+
+void set_uniform(enigma::Uniform* uniform, float v0, float v1, float v2, float v3) {
+  if (!uniform || uniform->data.size() < 4) return;
+  if (uniform->data[0].f == v0 && uniform->data[1].f == v1 && uniform->data[2].f == v2 && uniform->data[3].f == v3) return;
+  glUniform4f(uniform->location, v0, v1, v2, v3);
+  uniform->data[0].f = v0, uniform->data[1].f = v1, uniform->data[2].f = v2, uniform->data[3].f = v3;
+}
 
 } // anonymous namespace
 
 namespace enigma {
 
 void graphics_delete_vertex_buffer_peer(int buffer) {
-  glDeleteBuffers(1, &vertexBufferPeers[buffer]);
-  vertexBufferPeers.erase(buffer);
+  if (size_t(buffer) >= vertexBufferPeers.size()) return;
+  BufferPeer& peer = vertexBufferPeers[buffer];
+  if (peer.peer) {
+    // GL hands the name out again, so pointers into this buffer must not match a new one
+    for (AttributePointer& pointer : attributePointers)
+      if (pointer.buffer == peer.peer) pointer = AttributePointer();
+    glDeleteBuffers(1, &peer.peer);
+  }
+  if (bound_vbo == peer.peer) bound_vbo = -1;
+  peer = BufferPeer();
 }
 
 void graphics_delete_index_buffer_peer(int buffer) {
-  glDeleteBuffers(1, &indexBufferPeers[buffer]);
-  indexBufferPeers.erase(buffer);
+  if (size_t(buffer) >= indexBufferPeers.size()) return;
+  GLuint& peer = indexBufferPeers[buffer];
+  if (peer) glDeleteBuffers(1, &peer);
+  if (bound_vboi == peer) bound_vboi = -1;
+  peer = 0;
 }
 
 static inline int graphics_find_attribute_location(std::string name, int usageIndex) {
@@ -67,70 +246,81 @@ static inline int graphics_find_attribute_location(std::string name, int usageIn
   return location;
 }
 
-void graphics_prepare_buffer(const int buffer, const bool isIndex) {
-  const bool dirty = isIndex ? indexBuffers[buffer]->dirty : vertexBuffers[buffer]->dirty;
-  const bool frozen = isIndex ? indexBuffers[buffer]->frozen : vertexBuffers[buffer]->frozen;
-  const bool dynamic = isIndex ? indexBuffers[buffer]->dynamic : vertexBuffers[buffer]->dynamic;
-  GLuint bufferPeer;
-  auto it = isIndex ? indexBufferPeers.find(buffer) : vertexBufferPeers.find(buffer);
-  const GLenum target = isIndex ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
-
-  // if the contents of the buffer are dirty then we need to update
-  // our native buffer object "peer"
-  if (!dirty) {
-    if (isIndex) {
-      bind_element_buffer(it->second);
-    } else {
-      bind_array_buffer(it->second);
+// Binds the native buffer for a vertex buffer, uploading its contents first if
+// they changed, and returns the byte offset its vertices start at.
+static size_t graphics_prepare_vertex_buffer(const int buffer) {
+  VertexBuffer* vertexBuffer = vertexBuffers[buffer].get();
+  BufferPeer& peer = peer_slot(vertexBufferPeers, buffer);
+
+  // stream buffers keep their data on the CPU side while they are in the ring,
+  // so they can be written again if the ring has moved on since
+  if (!vertexBuffer->dirty && !(peer.streamed && peer.ring_epoch != streamRing.epoch)) {
+    if (peer.streamed) {
+      bind_array_buffer(streamRing.peer);
+      return peer.ring_offset;
     }
-    return;
+    bind_array_buffer(peer.peer);
+    return 0;
   }
 
-  size_t size = isIndex ? enigma_user::index_get_buffer_size(buffer) : enigma_user::vertex_get_buffer_size(buffer);
+  const size_t size = vertexBuffer->vertices.size() * sizeof(VertexElement);
+  const GLvoid *data = (const GLvoid *)vertexBuffer->vertices.data();
+
+  if (!vertexBuffer->frozen) {
+    const GLintptr offset = streamRing.write(data, size);
+    if (offset >= 0) {
+      peer.streamed = true;
+      peer.ring_offset = offset;
+      peer.ring_epoch = streamRing.epoch;
+      vertexBuffer->dirty = false;
+      return offset;
+    }
+  }
 
   // if we haven't created a native "peer" for this buffer yet,
   // then we need to do so now
-  if (it == (isIndex ? indexBufferPeers.end() : vertexBufferPeers.end())) {
-    glGenBuffers(1, &bufferPeer);
-    if (isIndex) {
-      indexBufferPeers[buffer] = bufferPeer;
-    } else {
-      vertexBufferPeers[buffer] = bufferPeer;
-    }
-  } else {
-    bufferPeer = it->second;
-  }
+  if (!peer.peer) glGenBuffers(1, &peer.peer);
+  peer.streamed = false;
+  bind_array_buffer(peer.peer);
+
+  GLenum usage = vertexBuffer->frozen ? (vertexBuffer->dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) : GL_STREAM_DRAW;
+  glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+  vertexBuffer->clearData();
+  return 0;
+}
 
-  if (isIndex) {
-    bind_element_buffer(bufferPeer);
-  } else {
-    bind_array_buffer(bufferPeer);
+static void graphics_prepare_index_buffer(const int buffer) {
+  IndexBuffer* indexBuffer = indexBuffers[buffer].get();
+  GLuint& peer = peer_slot(indexBufferPeers, buffer);
+
+  // if the contents of the buffer are dirty then we need to update
+  // our native buffer object "peer"
+  if (!indexBuffer->dirty) {
+    bind_element_buffer(peer);
+    return;
   }
 
-  const GLvoid *data = isIndex ? (const GLvoid *)&indexBuffers[buffer]->indices[0] : (const GLvoid *)&vertexBuffers[buffer]->vertices[0];
-  GLenum usage = frozen ? (dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) : GL_STREAM_DRAW;
-  glBufferData(target, size, data, usage);
+  if (!peer) glGenBuffers(1, &peer);
+  bind_element_buffer(peer);
 
-  if (isIndex) {
-    indexBuffers[buffer]->clearData();
-  } else {
-    vertexBuffers[buffer]->clearData();
-  }
+  const size_t size = enigma_user::index_get_buffer_size(buffer);
+  GLenum usage = indexBuffer->frozen ? (indexBuffer->dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) : GL_STREAM_DRAW;
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, (const GLvoid *)indexBuffer->indices.data(), usage);
+  indexBuffer->clearData();
 }
 
-void graphics_apply_vertex_format(int format, size_t offset) {
+// Looks up what a vertex format feeds in the bound program. This does the
+// string and map work, so it is only done the first time the pair is used.
+static void graphics_resolve_vertex_format(FormatBinding& binding, int format) {
   using namespace enigma_user;
 
   const auto& vertexFormat = vertexFormats[format];
+  binding = FormatBinding();
+  binding.resolved = true;
+  binding.stride = vertex_format_get_stride_size(format);
 
-  //Bind texture
-  glsl_uniformi_internal(shaderprograms[bound_shader].uni_texSampler, 0);
-
-  glsl_attribute_enable_all_internal(false); //Disable all attributes
-
-  bool useTextCoords = false, useColors = false;
   map<int,int> useCount;
-  const size_t stride = enigma_user::vertex_format_get_stride_size(format);
+  size_t offset = 0;
   for (size_t i = 0; i < vertexFormat->flags.size(); ++i) {
     const pair<int, int> flag = vertexFormat->flags[i];
 
@@ -145,8 +335,8 @@ void graphics_apply_vertex_format(int format, size_t offset) {
       case vertex_type_ubyte4: elements = 4; size = 1; type = GL_UNSIGNED_BYTE; break;
     }
 
-    if (flag.second == vertex_usage_color) useColors = true;
-    if (flag.second == vertex_usage_textcoord) useTextCoords = true;
+    if (flag.second == vertex_usage_color) binding.useColors = true;
+    if (flag.second == vertex_usage_textcoord) binding.useTextCoords = true;
 
     // NOTE: This is not what GMS1.4 does, it uses glBindAttribLocation
     // so that in_Color0 is an alias of in_Color which glBindAttribLocation allows
@@ -168,30 +358,84 @@ void graphics_apply_vertex_format(int format, size_t offset) {
         location = graphics_find_attribute_location("in_Colour", usageIndex);
       }
 
-      if (location != -1) {
-        glsl_attribute_enable_internal(location, true);
-        glsl_attribute_set_internal(location, elements, type, (type == GL_UNSIGNED_BYTE), stride, offset);
+      if (location >= 0 && location < max_attributes) {
+        binding.attributes.push_back({location, GLint(elements), type, unsigned(offset)});
+        binding.enabled |= uint64_t(1) << location;
       }
     }
 
     offset += size * sizeof(enigma::VertexElement);
   }
+}
 
-  glsl_uniformf_internal(shaderprograms[bound_shader].uni_color,
-                         (float)currentcolor[0]/255.0f,
-                         (float)currentcolor[1]/255.0f,
-                         (float)currentcolor[2]/255.0f,
-                         (float)currentcolor[3]/255.0f);
+void graphics_reset_program_bindings(int program) {
+  if (size_t(program) < programBindings.size()) programBindings[program] = ProgramBindings();
+}
 
-  if (useTextCoords) {
-    GLint boundTex;
-    glActiveTexture(GL_TEXTURE0);
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTex);
-    glsl_uniformi_internal(shaderprograms[bound_shader].uni_textureEnable, boundTex != 0);
-  } else {
-    glsl_uniformi_internal(shaderprograms[bound_shader].uni_textureEnable, 0);
+void graphics_reset_attribute_state() {
+  attributesKnown = false;
+}
+
+void graphics_apply_vertex_format(int format, size_t offset) {
+  if (size_t(bound_shader) >= programBindings.size()) programBindings.resize(bound_shader + 1);
+  ProgramBindings& program = programBindings[bound_shader];
+  if (!program.resolved) {
+    ShaderProgram& prog = shaderprograms[bound_shader];
+    program.resolved = true;
+    program.texSampler = find_uniform(prog, prog.uni_texSampler);
+    program.color = find_uniform(prog, prog.uni_color);
+    program.textureEnable = find_uniform(prog, prog.uni_textureEnable);
+    program.colorEnable = find_uniform(prog, prog.uni_colorEnable);
+  }
+  if (size_t(format) >= program.formats.size()) program.formats.resize(format + 1);
+  FormatBinding& binding = program.formats[format];
+  if (!binding.resolved) graphics_resolve_vertex_format(binding, format);
+
+  //Bind texture
+  set_uniform(program.texSampler, 0);
+
+  // only the attribute arrays that differ from the last submit are changed
+  uint64_t toggled = binding.enabled ^ enabledAttributes;
+  if (!attributesKnown) {
+    if (!attributeLimit) glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &attributeLimit);
+    toggled = attributeLimit < max_attributes ? (uint64_t(1) << attributeLimit) - 1 : ~uint64_t(0);
+    for (AttributePointer& pointer : attributePointers) pointer = AttributePointer();
+    attributesKnown = true;
+  }
+  for (int location = 0; toggled; ++location, toggled >>= 1) {
+    if (!(toggled & 1)) continue;
+    if (binding.enabled & (uint64_t(1) << location)) {
+      glEnableVertexAttribArray(location);
+    } else {
+      glDisableVertexAttribArray(location);
+    }
+  }
+  enabledAttributes = binding.enabled;
+
+  for (const auto& attribute : binding.attributes) {
+    const AttributePointer pointer = {
+      bound_vbo, attribute.elements, attribute.type, binding.stride, unsigned(offset + attribute.offset)
+    };
+    AttributePointer& current = attributePointers[attribute.location];
+    if (current == pointer) continue;
+    glVertexAttribPointer(attribute.location, pointer.elements, pointer.type, pointer.type == GL_UNSIGNED_BYTE,
+                          pointer.stride, (const GLvoid*)(intptr_t)pointer.offset);
+    current = pointer;
   }
-  glsl_uniformi_internal(shaderprograms[bound_shader].uni_colorEnable, useColors);
+
+  set_uniform(program.color,
+              (float)currentcolor[0]/255.0f,
+              (float)currentcolor[1]/255.0f,
+              (float)currentcolor[2]/255.0f,
+              (float)currentcolor[3]/255.0f);
+
+  // the texture on the first stage is the one draw_state_flush just bound
+  set_uniform(program.textureEnable, binding.useTextCoords && get_texture_peer(samplers[0].texture) != 0);
+  set_uniform(program.colorEnable, binding.useColors);
+}
+
+color_t graphics_pack_vertex_color(int color, double alpha) {
+  return color + (CLAMP_ALPHA(alpha) << 24);
 }
 
 } // namespace enigma
@@ -204,8 +448,7 @@ void vertex_argb(int buffer, unsigned argb) {
 }
 
 void vertex_color(int buffer, int color, double alpha) {
-  enigma::color_t finalcol = color + (CLAMP_ALPHA(alpha) << 24);
-  enigma::vertexBuffers[buffer]->vertices.push_back(finalcol);
+  enigma::vertexBuffers[buffer]->vertices.push_back(enigma::graphics_pack_vertex_color(color, alpha));
 }
 
 void vertex_submit_offset(int buffer, int primitive, unsigned offset, unsigned start, unsigned count) {
@@ -218,7 +461,7 @@ void vertex_submit_offset(int buffer, int primitive, unsigned offset, unsigned s
   ++vbd.drawcalls;
   #endif
 
-  enigma::graphics_prepare_buffer(buffer, false);
+  offset += enigma::graphics_prepare_vertex_buffer(buffer);
   enigma::graphics_apply_vertex_format(vertexBuffer->format, offset);
 
 	glDrawArrays(primitive_types[primitive], start, count);
@@ -235,9 +478,9 @@ void index_submit_range(int buffer, int vertex, int primitive, unsigned start, u
   ++vbd.drawcalls;
   #endif
 
-  enigma::graphics_prepare_buffer(vertex, false);
-  enigma::graphics_prepare_buffer(buffer, true);
-  enigma::graphics_apply_vertex_format(vertexBuffer->format, 0);
+  const size_t offset = enigma::graphics_prepare_vertex_buffer(vertex);
+  enigma::graphics_prepare_index_buffer(buffer);
+  enigma::graphics_apply_vertex_format(vertexBuffer->format, offset);
 
   GLenum indexType = GL_UNSIGNED_SHORT;
   if (indexBuffer->type == index_type_uint) {
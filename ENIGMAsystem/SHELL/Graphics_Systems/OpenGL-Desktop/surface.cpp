@@ -107,7 +107,7 @@ int surface_create_msaa(int width, int height, int samples)
 
   int texture = enigma::graphics_create_texture(enigma::RawImage(nullptr, w, h), false);
   glGenFramebuffers(1, &fbo);
-  glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, enigma::get_texture_peer(texture));
+  enigma::bind_texture_peer(GL_TEXTURE_2D_MULTISAMPLE, enigma::get_texture_peer(texture));
 
   glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, GL_BGRA, w, h, false);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
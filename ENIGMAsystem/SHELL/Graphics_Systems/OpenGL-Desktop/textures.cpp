@@ -23,7 +23,7 @@
 namespace enigma{
 
 void graphics_push_texture_pixels(int texture, int width, int height, unsigned char* pxdata) {
-  glBindTexture(GL_TEXTURE_2D, get_texture_peer(texture));
+  bind_texture_peer(GL_TEXTURE_2D, get_texture_peer(texture));
 
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, pxdata);
 }
@@ -34,7 +34,7 @@ int graphics_create_texture(const RawImage& img, bool mipmap, unsigned* fullwidt
 }
 
 void graphics_push_texture_pixels(int texture, int x, int y, int width, int height, unsigned char* pxdata) {
-  glBindTexture(GL_TEXTURE_2D, get_texture_peer(texture));
+  bind_texture_peer(GL_TEXTURE_2D, get_texture_peer(texture));
 
   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_BGRA, GL_UNSIGNED_BYTE, pxdata);
 }
@@ -48,7 +48,7 @@ void texture_set_priority(int texid, double prio)
   draw_batch_flush(batch_flush_deferred);
   // Deprecated in ENIGMA and GM: Studio, all textures are automatically preloaded.
   // This will give a deprecation message only if called on newer contexts (e.g, GL3+).
-  glBindTexture(GL_TEXTURE_2D, enigma::get_texture_peer(texid));
+  enigma::bind_texture_peer(GL_TEXTURE_2D, enigma::get_texture_peer(texid));
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_PRIORITY, prio);
 }
 
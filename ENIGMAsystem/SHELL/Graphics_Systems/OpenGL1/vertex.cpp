@@ -243,6 +243,10 @@ void graphics_reset_client_state(const ClientState &state) {
   }
 }
 
+color_t graphics_pack_vertex_color(int color, double alpha) {
+  return color + (CLAMP_ALPHA(alpha) << 24);
+}
+
 } // namespace enigma
 
 namespace enigma_user {
@@ -253,8 +257,7 @@ void vertex_argb(int buffer, unsigned argb) {
 }
 
 void vertex_color(int buffer, int color, double alpha) {
-  enigma::color_t finalcol = color + (CLAMP_ALPHA(alpha) << 24);
-  enigma::vertexBuffers[buffer]->vertices.push_back(finalcol);
+  enigma::vertexBuffers[buffer]->vertices.push_back(enigma::graphics_pack_vertex_color(color, alpha));
 }
 
 void vertex_submit_offset(int buffer, int primitive, unsigned offset, unsigned start, unsigned count) {
@@ -10,30 +10,47 @@ namespace enigma {
 void graphics_state_flush_samplers() {
   static bool samplers_generated = false;
   static GLuint sampler_ids[8];
+  static Sampler applied[8];
+  static bool applied_known[8] = {};
   if (!samplers_generated) {
     glGenSamplers(8, sampler_ids);
+    for (size_t i = 0; i < 8; i++) glBindSampler(i, sampler_ids[i]);
     samplers_generated = true;
   }
 
+  // only what changed since the last flush is bound or set
+  size_t active_unit = 0;
   for (size_t i = 0; i < 8; i++) {
     const auto sampler = samplers[i];
 
     const GLuint gt = get_texture_peer(sampler.texture);
-    glActiveTexture(GL_TEXTURE0 + i);
-    glBindTexture(GL_TEXTURE_2D, gt);
+    if (bound_texture_peers[i] != gt) {
+      if (active_unit != i) glActiveTexture(GL_TEXTURE0 + (active_unit = i));
+      glBindTexture(GL_TEXTURE_2D, gt);
+      bound_texture_peers[i] = gt;
+    }
 
     if (gt == 0) continue; // texture doesn't exist skip updating the sampler
 
     const GLuint sampler_id = sampler_ids[i];
-    glBindSampler(i, sampler_id);
-
-    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_R, sampler.wrapu?GL_REPEAT:GL_CLAMP_TO_EDGE);
-    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, sampler.wrapv?GL_REPEAT:GL_CLAMP_TO_EDGE);
-    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, sampler.wrapw?GL_REPEAT:GL_CLAMP_TO_EDGE);
-    // Default to interpolation disabled, for some reason textures do that by default but not samplers.
-    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, sampler.interpolate?GL_LINEAR:GL_NEAREST);
-    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, sampler.interpolate?GL_LINEAR:GL_NEAREST);
+    Sampler& prev = applied[i];
+    const bool known = applied_known[i];
+    if (!known || prev.wrapu != sampler.wrapu || prev.wrapv != sampler.wrapv || prev.wrapw != sampler.wrapw) {
+      glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_R, sampler.wrapu?GL_REPEAT:GL_CLAMP_TO_EDGE);
+      glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, sampler.wrapv?GL_REPEAT:GL_CLAMP_TO_EDGE);
+      glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, sampler.wrapw?GL_REPEAT:GL_CLAMP_TO_EDGE);
+    }
+    if (!known || prev.interpolate != sampler.interpolate) {
+      // Default to interpolation disabled, for some reason textures do that by default but not samplers.
+      glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, sampler.interpolate?GL_LINEAR:GL_NEAREST);
+      glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, sampler.interpolate?GL_LINEAR:GL_NEAREST);
+    }
+    prev = sampler;
+    applied_known[i] = true;
   }
+
+  // the rest of the backend binds textures on unit 0 (see bind_texture_peer)
+  if (active_unit != 0) glActiveTexture(GL_TEXTURE0);
 }
 
 void graphics_state_flush_extra() {
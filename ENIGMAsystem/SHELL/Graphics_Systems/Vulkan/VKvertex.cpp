@@ -46,6 +46,10 @@ void graphics_delete_index_buffer_peer(int buffer) {
 
 }
 
+color_t graphics_pack_vertex_color(int color, double alpha) {
+  return 0;
+}
+
 } // namespace enigma
 
 namespace enigma_user {
@@ -6,11 +6,14 @@
 #include "Widget_Systems/widgets_mandatory.h"
 #include "Universal_System/roomsystem.h"
 #include "Universal_System/mathnc.h" // enigma_user::clamp
+#include "Universal_System/benchmark.h"
 
 #include "Universal_System/Extensions/Steamworks/steamworks.h"
 
+#include <algorithm> // std::min, std::max, std::fill
+#include <cstdlib> // std::abs
 #include <chrono> // std::chrono::microseconds
-#include <thread> // sleep_for
+#include <thread> // sleep_for, yield
 
 namespace enigma {
 
@@ -35,6 +38,8 @@ std::chrono::steady_clock::time_point timer_offset_slowing;
 std::chrono::steady_clock::time_point timer_current;
 unsigned long current_time_mcs = 0;
 bool game_window_focused = true;
+int frame_pacing_mode = enigma_user::fp_sleep;
+long frame_pacing_spin_mcs = 1000;
 
 void platform_focus_gained() {
   game_window_focused = true;
@@ -109,6 +114,30 @@ void offset_modulus_one_second() {
   timer_offset_slowing = timer_offset;
 }
 
+const long jitter_bucket_mcs = 250;
+unsigned long jitter_histogram[enigma_user::frame_jitter_buckets] = {};
+long jitter_worst_mcs = 0;
+double jitter_total_mcs = 0;
+bool jitter_started = false;
+std::chrono::steady_clock::time_point jitter_last_frame;
+
+// Buckets how far the time since the previous frame strayed from the frame period.
+void record_frame_jitter(long period_mcs) {
+  const auto last_frame = jitter_last_frame;
+  jitter_last_frame = timer_current;
+  if (!jitter_started) {
+    jitter_started = true;
+    return;
+  }
+  const long frame_mcs = std::chrono::duration_cast<std::chrono::microseconds>(timer_current - last_frame).count();
+
+  const long deviation = std::abs(frame_mcs - period_mcs);
+  const int bucket = std::min(deviation / jitter_bucket_mcs, long(enigma_user::frame_jitter_buckets - 1));
+  jitter_histogram[bucket]++;
+  jitter_worst_mcs = std::max(jitter_worst_mcs, deviation);
+  jitter_total_mcs += deviation;
+}
+
 long last_mcs = 0;
 long spent_mcs = 0;
 long remaining_mcs = 0;
@@ -149,11 +178,26 @@ int updateTimer() {
       remaining_mcs = 1000000 - spent_mcs;
       needed_mcs = long((1.0 - 1.0 * frames_count / current_room_speed) * 1e6);
     }
-    if (remaining_mcs > needed_mcs) {
-      const long sleeping_time = std::min((remaining_mcs - needed_mcs) / 5, long(999999));
-      std::this_thread::sleep_for(std::chrono::microseconds(std::max(long(1), sleeping_time)));
-      return -1;
+    // Benchmarks run as fast as the game can go.
+    if (remaining_mcs > needed_mcs && !benchmark_running) {
+      if (frame_pacing_mode != enigma_user::fp_hybrid) {
+        const long sleeping_time = std::min((remaining_mcs - needed_mcs) / 5, long(999999));
+        std::this_thread::sleep_for(std::chrono::microseconds(std::max(long(1), sleeping_time)));
+        return -1;
+      }
+      // Sleep until shortly before the frame is due, then yield until the deadline itself.
+      // The scheduler routinely oversleeps by a millisecond or more, so only the spin
+      // margin is spent awake; the frame then runs without another trip through the loop.
+      const long waiting_time = remaining_mcs - needed_mcs;
+      const auto deadline = timer_current + std::chrono::microseconds(waiting_time);
+      if (waiting_time > frame_pacing_spin_mcs)
+        std::this_thread::sleep_for(std::chrono::microseconds(waiting_time - frame_pacing_spin_mcs));
+      while (std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+
+      update_current_time();
+      spent_mcs = enigma::get_current_offset_slowing_difference_mcs();
     }
+    record_frame_jitter(1000000 / current_room_speed);
   }
 
   //TODO: The placement of this code is inconsistent with XLIB because events are handled before, ask Josh.
@@ -211,11 +255,20 @@ int enigma_main(int argc, char** argv) {
 
   // Call ENIGMA system initializers; sprites, audio, and what have you
   initialize_everything();
+  benchmark_start();
 
+  std::string current_caption;
   while (!game_isending) {
 
-    if (!((std::string)enigma_user::room_caption).empty())
-      enigma_user::window_set_caption(enigma_user::room_caption);
+    // Only push the caption to the window when it changes; a string-typed caption is
+    // compared in place so the common case does not copy it every pass.
+    const variant &caption = enigma_user::room_caption;
+    if (caption.type == enigma_user::ty_string ? caption.sval() != current_caption
+                                  : (std::string)caption != current_caption) {
+      current_caption = (std::string)caption;
+      if (!current_caption.empty())
+        enigma_user::window_set_caption(current_caption);
+    }
     update_mouse_variables();
 
     if (updateTimer() != 0) continue;
@@ -231,9 +284,11 @@ int enigma_main(int argc, char** argv) {
 
     ENIGMA_events();
     handleInput();
+    if (benchmark_running) benchmark_step();
   }
 
   game_ending();
+  benchmark_report();
   DisableDrawing(nullptr);
   destroyWindow();
   return game_return;
@@ -279,4 +334,45 @@ void game_end() {
 
 void action_end_game() { return game_end(); }
 
+void frame_pacing_set_mode(int mode, int spin_mcs) {
+  enigma::frame_pacing_mode = mode;
+  enigma::frame_pacing_spin_mcs = std::max(0, spin_mcs);
+}
+
+int frame_pacing_get_mode() { return enigma::frame_pacing_mode; }
+
+unsigned long frame_jitter_count(int bucket) {
+  if (bucket < 0 || bucket >= frame_jitter_buckets) return 0;
+  return enigma::jitter_histogram[bucket];
+}
+
+long frame_jitter_bucket_width() { return enigma::jitter_bucket_mcs; }
+
+long frame_jitter_max() { return enigma::jitter_worst_mcs; }
+
+double frame_jitter_mean() {
+  unsigned long samples = 0;
+  for (unsigned long count : enigma::jitter_histogram) samples += count;
+  return samples ? enigma::jitter_total_mcs / samples : 0;
+}
+
+long frame_jitter_percentile(double percent) {
+  unsigned long samples = 0;
+  for (unsigned long count : enigma::jitter_histogram) samples += count;
+  if (!samples) return 0;
+  const double wanted = enigma_user::clamp(percent, 0, 100) / 100 * samples;
+  unsigned long seen = 0;
+  for (int i = 0; i < frame_jitter_buckets; i++) {
+    seen += enigma::jitter_histogram[i];
+    if (seen >= wanted) return std::min((i + 1) * enigma::jitter_bucket_mcs, enigma::jitter_worst_mcs);
+  }
+  return enigma::jitter_worst_mcs;
+}
+
+void frame_jitter_reset() {
+  std::fill(std::begin(enigma::jitter_histogram), std::end(enigma::jitter_histogram), 0);
+  enigma::jitter_worst_mcs = 0;
+  enigma::jitter_total_mcs = 0;
+}
+
 }  //namespace enigma_user
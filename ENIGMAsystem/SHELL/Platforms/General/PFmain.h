@@ -77,6 +77,13 @@ void fireEventsFromQueue();
 
 namespace enigma_user {
 
+enum {
+  fp_sleep,  // Sleep a fraction of the remaining frame budget per pass of the main loop.
+  fp_hybrid  // Sleep to just short of the frame deadline, then yield until it passes.
+};
+
+enum { frame_jitter_buckets = 32 };
+
 extern std::string working_directory;
 extern std::string program_directory;
 extern std::string temp_directory;
@@ -98,6 +105,21 @@ void game_end();
 void game_end(int ret);
 void action_end_game();
 
+// Selects how the main loop waits out the rest of a frame; spin_mcs is how long before
+// the deadline fp_hybrid stops sleeping and starts yielding.
+void frame_pacing_set_mode(int mode, int spin_mcs = 1000);
+int frame_pacing_get_mode();
+
+// Frame-time jitter is the distance, in microseconds, between the measured time of a
+// frame and the room speed's frame period. It is bucketed by frame_jitter_bucket_width;
+// the last bucket also counts every frame beyond the histogram's range.
+unsigned long frame_jitter_count(int bucket);
+long frame_jitter_bucket_width();
+long frame_jitter_max();
+double frame_jitter_mean();
+long frame_jitter_percentile(double percent);
+void frame_jitter_reset();
+
 // Data type could be unsigned for the paramter since the collection is size_t, however this would make the function not behave as GM.
 // show_message(parameter_string(-1)); in GM8.1 will show an empty string, if this function cast the parameter to unsigned that won't be the behavior.
 std::string parameter_string(int x);
@@ -33,6 +33,10 @@ int fputc_wrapper(int character, FILE_t* context);
 int feof_wrapper(FILE_t* context);
 int64_t ftell_wrapper(FILE_t* context);
 size_t fwrite_wrapper(const void *ptr, size_t size, size_t count, FILE_t* context);
+// Maps the whole file read-only and stores its length in size. Returns nullptr
+// where files cannot be mapped, in which case the caller should read instead.
+const void* fmap_wrapper(FILE_t* context, size_t* size);
+void funmap_wrapper(const void* data, size_t size);
 
 #include <string>
 
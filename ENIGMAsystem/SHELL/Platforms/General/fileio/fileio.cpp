@@ -1,5 +1,14 @@
 #include "Platforms/General/fileio.h"
 
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#  include <io.h>
+#else
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
 size_t fread_wrapper(void* ptr, size_t size, size_t maxnum, FILE_t* context) { 
   return fread(ptr, size, maxnum, context);
 }
@@ -43,3 +52,33 @@ int64_t ftell_wrapper(FILE_t* context) {
 size_t fwrite_wrapper(const void *ptr, size_t size, size_t count, FILE_t* context) {
   return fwrite(ptr, size, count, context);
 }
+
+const void* fmap_wrapper(FILE_t* context, size_t* size) {
+#ifdef _WIN32
+  HANDLE file = (HANDLE) _get_osfhandle(_fileno(context));
+  LARGE_INTEGER length;
+  if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &length) || !length.QuadPart) return nullptr;
+  HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) return nullptr;
+  const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);  // The view keeps the mapping alive.
+  if (!data) return nullptr;
+  *size = length.QuadPart;
+  return data;
+#else
+  struct stat st;
+  if (fstat(fileno(context), &st) || st.st_size <= 0) return nullptr;
+  void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fileno(context), 0);
+  if (data == MAP_FAILED) return nullptr;
+  *size = st.st_size;
+  return data;
+#endif
+}
+
+void funmap_wrapper(const void* data, size_t size) {
+#ifdef _WIN32
+  UnmapViewOfFile(data);
+#else
+  munmap(const_cast<void*>(data), size);
+#endif
+}
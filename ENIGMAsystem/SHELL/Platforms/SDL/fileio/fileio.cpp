@@ -50,3 +50,9 @@ int64_t ftell_wrapper(FILE_t* context) {
 size_t fwrite_wrapper(const void *ptr, size_t size, size_t count, FILE_t* context) {
   return SDL_RWwrite(context, ptr, size, count);
 }
+
+const void* fmap_wrapper(FILE_t*, size_t*) {
+  return nullptr;  // Assets may live inside the package; read them instead.
+}
+
+void funmap_wrapper(const void*, size_t) {}
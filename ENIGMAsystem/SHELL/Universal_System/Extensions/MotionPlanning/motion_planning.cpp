@@ -28,7 +28,7 @@
 #include <string>
 #include <vector>
 #include <cmath>
-#include <map>
+#include <algorithm>
 using namespace std;
 
 //#include "Graphics_Systems/OpenGL/OpenGLHeaders.h" //For drawing straight lines
@@ -38,6 +38,8 @@ using namespace std;
 #include "motion_planning.h"
 #include "Collision_Systems/General/CSfuncs.h"
 #include "Universal_System/scalar.h"
+#include "Universal_System/var4.h"
+#include "Universal_System/worker_pool.h"
 
 namespace enigma {
 	extern size_t grid_idmax;
@@ -82,34 +84,8 @@ void mp_grid_copy(unsigned id, unsigned srcid)
     grid->left = sgrid->left;
     grid->top = sgrid->top;
     for (unsigned int i = 0; i < sgrid->hcells*sgrid->vcells; i++)
-    {
-        enigma::node node(floor(i / sgrid->vcells),i % sgrid->vcells,0,0,0,sgrid->nodearray[i].cost);
-        grid->nodearray.push_back(node);
-    }
-
-    for (unsigned int i = 0; i < grid->hcells; i++){
-        for (unsigned int c = 0; c < grid->vcells; c++){
-        if (i>0){
-            grid->nodearray[i*grid->vcells+c].neighbor_nodes.push_back(&grid->nodearray[(i-1)*grid->vcells+c]); //left
-            if (c>0)
-                grid->nodearray[i*grid->vcells+c].neighbor_nodes.push_back(&grid->nodearray[(i-1)*grid->vcells+c-1]); //top-left
-            if (c<grid->vcells-1)
-                grid->nodearray[i*grid->vcells+c].neighbor_nodes.push_back(&grid->nodearray[(i-1)*grid->vcells+c+1]); //bottom-left
-        }
-        if (c>0)
-            grid->nodearray[i*grid->vcells+c].neighbor_nodes.push_back(&grid->nodearray[i*grid->vcells+c-1]); //top
-        if (i<grid->hcells-1){
-            grid->nodearray[i*grid->vcells+c].neighbor_nodes.push_back(&grid->nodearray[(i+1)*grid->vcells+c]); //right
-            if (c>0)
-                grid->nodearray[i*grid->vcells+c].neighbor_nodes.push_back(&grid->nodearray[(i+1)*grid->vcells+c-1]); //top-right
-            if (c<grid->vcells-1)
-                grid->nodearray[i*grid->vcells+c].neighbor_nodes.push_back(&grid->nodearray[(i+1)*grid->vcells+c+1]); //bottom-bottom
-        }
-        if (c<grid->vcells-1)
-            grid->nodearray[i*grid->vcells+c].neighbor_nodes.push_back(&grid->nodearray[i*grid->vcells+c+1]); //bottom
-
-        }
-    }
+        grid->nodearray.push_back(enigma::node(i / sgrid->vcells, i % sgrid->vcells, sgrid->nodearray[i].cost));
+    grid->costs_changed();
 }
 
 void mp_grid_clear_all(unsigned id, unsigned cost)
@@ -117,12 +93,14 @@ void mp_grid_clear_all(unsigned id, unsigned cost)
     for (vector<enigma::node>::iterator it = enigma::gridstructarray[id]->nodearray.begin(); it!=enigma::gridstructarray[id]->nodearray.end(); ++it)
         (*it).cost = cost;
     enigma::gridstructarray[id]->threshold = cost;
+    enigma::gridstructarray[id]->costs_changed();
 }
 
 void mp_grid_clear_cell(unsigned id,int h,int v, unsigned cost)
 {
     enigma::gridstructarray[id]->nodearray[h*enigma::gridstructarray[id]->vcells+v].cost = cost;
     if (enigma::gridstructarray[id]->threshold<cost){enigma::gridstructarray[id]->threshold=cost;}
+    enigma::gridstructarray[id]->costs_changed();
 }
 
 void mp_grid_add_rectangle(unsigned id,double x1,double y1,double x2,double y2, unsigned cost)
@@ -141,6 +119,7 @@ void mp_grid_add_rectangle(unsigned id,double x1,double y1,double x2,double y2,
     }
     if (cost>max_cost){max_cost=cost;}
     if (grid->threshold<max_cost){grid->threshold=max_cost;}
+    grid->costs_changed();
 }
 
 void mp_grid_add_instances(unsigned id,int obj,bool prec,unsigned cost)
@@ -158,6 +137,7 @@ void mp_grid_add_instances(unsigned id,int obj,bool prec,unsigned cost)
     }
     if (cost>max_cost){max_cost=cost;}
     if (grid->threshold<max_cost){grid->threshold=max_cost;}
+    grid->costs_changed();
 }
 
 void mp_grid_reset_threshold(unsigned id)
@@ -167,6 +147,7 @@ void mp_grid_reset_threshold(unsigned id)
     for (vector<enigma::node>::iterator it = grid->nodearray.begin(); it!=grid->nodearray.end(); ++it)
         if ((*it).cost>max_cost){max_cost=(*it).cost;}
     grid->threshold=max_cost;
+    grid->costs_changed();
 }
 
 void mp_grid_clear_rectangle(unsigned id,double x1,double y1,double x2,double y2, unsigned cost)
@@ -180,6 +161,7 @@ void mp_grid_add_cell(unsigned id,int h,int v, unsigned cost)
     enigma::gridstructarray[id]->nodearray[h*enigma::gridstructarray[id]->vcells+v].cost = cost;
     if (cost>max_cost){max_cost=cost;}
     if (enigma::gridstructarray[id]->threshold<max_cost){enigma::gridstructarray[id]->threshold=max_cost;}
+    enigma::gridstructarray[id]->costs_changed();
 }
 
 unsigned mp_grid_get_cell(unsigned id,int h,int v)
@@ -195,6 +177,7 @@ unsigned mp_grid_get_threshold(unsigned id)
 void mp_grid_set_threshold(unsigned id, unsigned value)
 {
     enigma::gridstructarray[id]->threshold = value;
+    enigma::gridstructarray[id]->costs_changed();
 }
 
 double mp_grid_get_speed_modifier(unsigned id)
@@ -207,52 +190,115 @@ void mp_grid_set_speed_modifier(unsigned id, double value)
     enigma::gridstructarray[id]->speed_modifier = value;
 }
 
-bool mp_grid_path(unsigned id,unsigned pathid,double xstart,double ystart,double xgoal,double ygoal,bool allowdiag)
+}
+
+namespace enigma
 {
-    enigma::grid *gr = enigma::gridstructarray[id];
-    int vc = int(enigma::gridstructarray[id]->vcells),
-    xs = floor((xstart-gr->left)/int(gr->cellwidth)), ys = floor((ystart-gr->top)/int(gr->cellheight)),
-    xg = floor((xgoal-gr->left)/int(gr->cellwidth)), yg = floor((ygoal-gr->top)/int(gr->cellheight));
-    if (xs<0 or xg<0) return false;
-    if (xs>int(gr->hcells)-1 or xg>int(gr->hcells)-1) return false;
-    if (ys<0 or yg<0) return false;
-    if (ys>int(gr->vcells)-1 or yg>int(gr->vcells)-1) return false;
-    
-    bool status = true; //status to check if we can reach the destination
-    multimap<unsigned,enigma::node*> nodelist = enigma::find_path(id, &gr->nodearray[xs*vc+ys], &gr->nodearray[xg*vc+yg], allowdiag, status);
-    enigma::path *path = enigma::pathstructarray[pathid];
-    path->pointarray.clear();
-
-    //push the very first point
-    enigma::path_point point(xstart,ystart,gr->speed_modifier/double(gr->nodearray[xs*vc+ys].cost));
-    path->pointarray.push_back(point);
-    multimap<unsigned,enigma::node*>::reverse_iterator it;
-    for (it=nodelist.rbegin(); it != nodelist.rend(); it++)
+    // Finds the cells of a grid holding the start and goal of a path, or returns false if either is outside it.
+    static bool path_cells(const grid *gr, double xstart, double ystart, double xgoal, double ygoal, unsigned &start, unsigned &goal)
     {
-            point = enigma::path_point(gr->left+((*it).second->x+0.5)*gr->cellwidth,gr->top+((*it).second->y+0.5)*gr->cellheight,gr->speed_modifier/double((*it).second->cost));
-            path->pointarray.push_back(point);
+        int vc = int(gr->vcells),
+        xs = floor((xstart-gr->left)/int(gr->cellwidth)), ys = floor((ystart-gr->top)/int(gr->cellheight)),
+        xg = floor((xgoal-gr->left)/int(gr->cellwidth)), yg = floor((ygoal-gr->top)/int(gr->cellheight));
+        if (xs<0 or xg<0) return false;
+        if (xs>int(gr->hcells)-1 or xg>int(gr->hcells)-1) return false;
+        if (ys<0 or yg<0) return false;
+        if (ys>int(gr->vcells)-1 or yg>int(gr->vcells)-1) return false;
+        start = xs*vc+ys;
+        goal = xg*vc+yg;
+        return true;
     }
 
-    //push the very last point if we can reach the destination
-    if (status == true){
-        point = enigma::path_point(xgoal,ygoal,gr->speed_modifier/double(gr->nodearray[xg*vc+yg].cost));
-        path->pointarray.push_back(point);
-    } else if (path->pointarray.size()==1) {
-        point = enigma::path_point(path->pointarray.back().x,path->pointarray.back().y,gr->speed_modifier/double(gr->nodearray[xg*vc+yg].cost));
+    // Fills a path resource with the result of find_path.
+    static void write_path(const grid *gr, unsigned pathid, double xstart, double ystart, double xgoal, double ygoal,
+                           unsigned start, unsigned goal, const vector<unsigned> &cells, bool status)
+    {
+        path *path = pathstructarray[pathid];
+        path->pointarray.clear();
+        path->pointarray.reserve(cells.size() + 2);
+
+        //push the very first point
+        path_point point(xstart,ystart,gr->speed_modifier/double(gr->nodearray[start].cost));
         path->pointarray.push_back(point);
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            const node &n = gr->nodearray[cells[i]];
+            point = path_point(gr->left+(n.x+0.5)*gr->cellwidth,gr->top+(n.y+0.5)*gr->cellheight,gr->speed_modifier/double(n.cost));
+            path->pointarray.push_back(point);
+        }
+
+        //push the very last point if we can reach the destination
+        if (status == true){
+            point = path_point(xgoal,ygoal,gr->speed_modifier/double(gr->nodearray[goal].cost));
+            path->pointarray.push_back(point);
+        } else if (path->pointarray.size()==1) {
+            point = path_point(path->pointarray.back().x,path->pointarray.back().y,gr->speed_modifier/double(gr->nodearray[goal].cost));
+            path->pointarray.push_back(point);
+        }
+        path_recalculate(pathid);
     }
-    enigma::path_recalculate(pathid);
+}
+
+namespace enigma_user
+{
+
+bool mp_grid_path(unsigned id,unsigned pathid,double xstart,double ystart,double xgoal,double ygoal,bool allowdiag)
+{
+    static enigma::path_search search;
+    static vector<unsigned> cells;
+    enigma::grid *gr = enigma::gridstructarray[id];
+    unsigned start, goal;
+    if (!enigma::path_cells(gr, xstart, ystart, xgoal, ygoal, start, goal)) return false;
+
+    bool status = enigma::find_path(*gr, start, goal, allowdiag, search, cells); //status to check if we can reach the destination
+    enigma::write_path(gr, pathid, xstart, ystart, xgoal, ygoal, start, goal, cells, status);
     return true;
 }
 
+int mp_grid_path_batch(unsigned id, const var &paths, const var &xstart, const var &ystart, const var &xgoal, const var &ygoal, bool allowdiag)
+{
+    enigma::grid *gr = enigma::gridstructarray[id];
+    const size_t count = std::max(paths.array_len(), 1);
+    struct request {
+        unsigned start, goal;
+        bool valid, status;
+        vector<unsigned> cells;
+    };
+    vector<request> requests(count);
+    for (size_t i = 0; i < count; i++)
+        requests[i].valid = enigma::path_cells(gr, xstart[i], ystart[i], xgoal[i], ygoal[i], requests[i].start, requests[i].goal);
+
+    // Searches only read the grid, so requests are shared out across the
+    // worker pool a few at a time, each thread keeping a workspace of its own.
+    // Batches of eight or fewer stay on this thread. Paths are written afterward, here.
+    const size_t per_job = 8;
+    gr->min_cost();
+    enigma::run_parallel_jobs((count + per_job - 1) / per_job, [&](size_t job) {
+        static thread_local enigma::path_search search;
+        const size_t end = std::min(count, (job + 1) * per_job);
+        for (size_t i = job * per_job; i < end; i++) {
+            request &r = requests[i];
+            if (r.valid) r.status = enigma::find_path(*gr, r.start, r.goal, allowdiag, search, r.cells);
+        }
+    });
+
+    int found = 0;
+    for (size_t i = 0; i < count; i++) {
+        const request &r = requests[i];
+        if (!r.valid) continue;
+        enigma::write_path(gr, paths[i], xstart[i], ystart[i], xgoal[i], ygoal[i], r.start, r.goal, r.cells, r.status);
+        found++;
+    }
+    return found;
+}
+
+
 }
 
 #include "Graphics_Systems/General/GSfont.h"
 #include "Graphics_Systems/General/GSprimitives.h"
 #include "Graphics_Systems/General/GScolors.h"
 
-#include "Universal_System/var4.h"
-
 namespace enigma_user
 {
 
@@ -262,19 +308,22 @@ void mp_grid_draw_neighbours(unsigned int id, unsigned int h, unsigned int v, un
     if (h>grid->hcells-1) return;
     if (v>grid->vcells-1) return;
     draw_primitive_begin(8);
-    unsigned int vc = enigma::gridstructarray[id]->vcells;
-    for (vector<enigma::node*>::iterator it = enigma::gridstructarray[id]->nodearray[h*vc+v].neighbor_nodes.begin(); it!=enigma::gridstructarray[id]->nodearray[h*vc+v].neighbor_nodes.end(); ++it){
-        draw_vertex_color(grid->left+(*it)->x*grid->cellwidth,grid->top+(*it)->y*grid->cellheight,0x0000FF,(mode==0?0.5:1.0));
-        draw_vertex_color(grid->left+((*it)->x+1)*grid->cellwidth,grid->top+(*it)->y*grid->cellheight,0x0000FF,(mode==0?0.5:1.0));
-        draw_vertex_color(grid->left+((*it)->x+1)*grid->cellwidth,grid->top+((*it)->y+1)*grid->cellheight,0x0000FF,(mode==0?0.5:1.0));
-        draw_vertex_color(grid->left+(*it)->x*grid->cellwidth,grid->top+((*it)->y+1)*grid->cellheight,0x0000FF,(mode==0?0.5:1.0));
+    unsigned around[8];
+    const unsigned count = grid->neighbors(h*grid->vcells+v, around);
+    for (unsigned k = 0; k < count; ++k){
+        const enigma::node *it = &grid->nodearray[around[k]];
+        draw_vertex_color(grid->left+it->x*grid->cellwidth,grid->top+it->y*grid->cellheight,0x0000FF,(mode==0?0.5:1.0));
+        draw_vertex_color(grid->left+(it->x+1)*grid->cellwidth,grid->top+it->y*grid->cellheight,0x0000FF,(mode==0?0.5:1.0));
+        draw_vertex_color(grid->left+(it->x+1)*grid->cellwidth,grid->top+(it->y+1)*grid->cellheight,0x0000FF,(mode==0?0.5:1.0));
+        draw_vertex_color(grid->left+it->x*grid->cellwidth,grid->top+(it->y+1)*grid->cellheight,0x0000FF,(mode==0?0.5:1.0));
     }
     draw_primitive_end();
     if (mode==1){
         int tc = draw_get_color();
         draw_set_color_rgba(255,255,255,1);
-        for (vector<enigma::node*>::iterator it = enigma::gridstructarray[id]->nodearray[h*vc+v].neighbor_nodes.begin(); it!=enigma::gridstructarray[id]->nodearray[h*vc+v].neighbor_nodes.end(); ++it){
-            draw_text(((*it)->x+0.5)*grid->cellwidth,((*it)->y+0.5)*grid->cellheight,(*it)->x*grid->vcells+(*it)->y);
+        for (unsigned k = 0; k < count; ++k){
+            const enigma::node *it = &grid->nodearray[around[k]];
+            draw_text((it->x+0.5)*grid->cellwidth,(it->y+0.5)*grid->cellheight,it->x*grid->vcells+it->y);
         }
         draw_set_color(tc);
     }
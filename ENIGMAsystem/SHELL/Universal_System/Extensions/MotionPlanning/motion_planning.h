@@ -25,6 +25,8 @@
 **                                                                              **
 \********************************************************************************/
 
+#include "Universal_System/var4.h"
+
 namespace enigma_user {
 unsigned mp_grid_create(int left,int top,int hcells,int vcells,int cellwidth,int cellheight, double speed_modifier = 1);
 void mp_grid_destroy(unsigned id);
@@ -34,6 +36,9 @@ unsigned mp_grid_get_cell(unsigned id,int h,int v);
 void mp_grid_draw(unsigned id, unsigned mode = 0, unsigned color_mode = 0);
 void mp_grid_draw_neighbours(unsigned int id, unsigned int h, unsigned int v, unsigned int mode = 0);
 bool mp_grid_path(unsigned id,unsigned path,double xstart,double ystart,double xgoal,double ygoal,bool allowdiag);
+// Like mp_grid_path for each index of the arrays, searching on several threads.
+// Returns the number of paths set, skipping those starting or ending off the grid.
+int mp_grid_path_batch(unsigned id, const var &paths, const var &xstart, const var &ystart, const var &xgoal, const var &ygoal, bool allowdiag);
 void mp_grid_clear_all(unsigned id, unsigned cost = 1);
 void mp_grid_clear_cell(unsigned id,int h,int v, unsigned cost = 1);
 void mp_grid_clear_rectangle(unsigned id,double x1,double y1,double x2,double y2, unsigned cost = 1);
@@ -27,16 +27,10 @@
 \********************************************************************************/
 
 #include <vector>
-#include <map>
-#include <list>
 #include "motion_planning_struct.h"
 #include <cmath>
-#include <algorithm>
 #include <cstdlib>
-//#include <iostream>
-using std::multimap;
-using std::pair;
-using std::list;
+#include <algorithm>
 
 namespace enigma
 {
@@ -47,47 +41,49 @@ namespace enigma
 namespace enigma
 {
     grid::grid(unsigned int idp,int leftp,int topp,unsigned int hcellsp,unsigned int vcellsp,unsigned int cellwidthp,unsigned int cellheightp,unsigned thresholdp,double speed_modifierp):
-        id(idp), left(leftp), top(topp), hcells(hcellsp), vcells(vcellsp), cellwidth(cellwidthp), cellheight(cellheightp), threshold(thresholdp), speed_modifier(speed_modifierp), nodearray()
+        id(idp), left(leftp), top(topp), hcells(hcellsp), vcells(vcellsp), cellwidth(cellwidthp), cellheight(cellheightp), threshold(thresholdp), speed_modifier(speed_modifierp), nodearray(),
+        cached_min_cost(0), min_cost_known(false)
     {
         gridstructarray[id] = this;
-        gridstructarray[id]->nodearray.reserve(hcells*vcells);
+        nodearray.reserve(hcells*vcells);
         for (unsigned int i = 0; i < hcells*vcells; i++)
-        {
-            node nnode(floor(i / vcells),i % vcells,0,0,0,1);
-            gridstructarray[id]->nodearray.push_back(nnode);
-        }
-
-        grid *gr = gridstructarray[id];
-
-        for (unsigned int i = 0; i < hcells; i++){
-            for (unsigned int c = 0; c < vcells; c++){
-            if (i>0){
-                gr->nodearray[i*vcells+c].neighbor_nodes.push_back(&gr->nodearray[(i-1)*vcells+c]); //left
-                if (c>0)
-                    gr->nodearray[i*vcells+c].neighbor_nodes.push_back(&gr->nodearray[(i-1)*vcells+c-1]); //top-left
-                if (c<vcells-1)
-                    gr->nodearray[i*vcells+c].neighbor_nodes.push_back(&gr->nodearray[(i-1)*vcells+c+1]); //bottom-left
-            }
-            if (c>0)
-                gr->nodearray[i*vcells+c].neighbor_nodes.push_back(&gr->nodearray[i*vcells+c-1]); //top
-            if (i<hcells-1){
-                gr->nodearray[i*vcells+c].neighbor_nodes.push_back(&gr->nodearray[(i+1)*vcells+c]); //right
-                if (c>0)
-                    gr->nodearray[i*vcells+c].neighbor_nodes.push_back(&gr->nodearray[(i+1)*vcells+c-1]); //top-right
-                if (c<vcells-1)
-                    gr->nodearray[i*vcells+c].neighbor_nodes.push_back(&gr->nodearray[(i+1)*vcells+c+1]); //bottom-bottom
-            }
-            if (c<vcells-1)
-                gr->nodearray[i*vcells+c].neighbor_nodes.push_back(&gr->nodearray[i*vcells+c+1]); //bottom
-
-            }
-        }
+            nodearray.push_back(node(i / vcells, i % vcells, 1));
 
         if (enigma::grid_idmax < id+1)
           enigma::grid_idmax = id+1;
     }
     grid::~grid() { gridstructarray[id] = NULL; }
 
+    unsigned grid::neighbors(unsigned cell, unsigned out[8]) const
+    {
+        const unsigned i = cell / vcells, c = cell % vcells;
+        unsigned n = 0;
+        if (i>0){
+            out[n++] = cell - vcells; //left
+            if (c>0) out[n++] = cell - vcells - 1; //top-left
+            if (c<vcells-1) out[n++] = cell - vcells + 1; //bottom-left
+        }
+        if (c>0) out[n++] = cell - 1; //top
+        if (i<hcells-1){
+            out[n++] = cell + vcells; //right
+            if (c>0) out[n++] = cell + vcells - 1; //top-right
+            if (c<vcells-1) out[n++] = cell + vcells + 1; //bottom-right
+        }
+        if (c<vcells-1) out[n++] = cell + 1; //bottom
+        return n;
+    }
+
+    unsigned grid::min_cost() const
+    {
+        if (!min_cost_known) {
+            cached_min_cost = threshold;
+            for (const node &n : nodearray)
+                if (n.cost < cached_min_cost) cached_min_cost = n.cost;
+            min_cost_known = true;
+        }
+        return cached_min_cost;
+    }
+
     void gridstructarray_reallocate()
     {
         enigma::grid** gridold = gridstructarray;
@@ -97,137 +93,130 @@ namespace enigma
     }
 
     //Helper functions
-    static inline unsigned find_heuristic(const node* n0, const node* n1, bool allow_diag) //Distance from n0 to n1
+    // Steps from n0 to n1, ignoring costs: Chebyshev distance with diagonals, Manhattan without.
+    static inline unsigned find_distance(const node &n0, const node &n1, bool allow_diag)
     {
-        if (!allow_diag){
-            return fabs((int)n0->x-(int)n1->x) + fabs((int)n0->y-(int)n1->y);
-        } else {
-            return fmax(fabs((int)n0->x-(int)n1->x) , fabs((int)n0->y-(int)n1->y));
-        }
+        const unsigned dx = abs(int(n0.x) - int(n1.x)), dy = abs(int(n0.y) - int(n1.y));
+        return allow_diag ? std::max(dx, dy) : dx + dy;
     }
 
-    static inline int find_priority(multimap<unsigned,node*> &m, node* value){
-        multimap<unsigned,node*>::iterator it;
-        for (it = m.begin(); it != m.end(); it++)
-            if (it->second == value) return (int)it->first;
-        return -1;
+    // A lower bound on the cost from n0 to n1, so the first path found is the
+    // cheapest. Every step enters a cell costing at least min_cost, and a
+    // diagonal one adds ceil(cost/2.5) on top. No step lowers the bound by more
+    // than it costs, so a closed cell never needs reopening.
+    static inline unsigned find_heuristic(const node &n0, const node &n1, bool allow_diag, unsigned min_cost)
+    {
+        const unsigned dx = abs(int(n0.x) - int(n1.x)), dy = abs(int(n0.y) - int(n1.y));
+        if (!allow_diag)
+            return (dx + dy) * min_cost;
+        const unsigned diagonal = std::min(dx, dy), straight = std::max(dx, dy) - diagonal;
+        return diagonal * (min_cost + unsigned(ceil(min_cost/2.5))) + straight * min_cost;
     }
 
-    static inline bool check_corners(unsigned id, node* n0, node* n1) //There must be a better way to do this
+    static inline bool open_after(const path_search::open_entry &a, const path_search::open_entry &b)
     {
-        for (vector<enigma::node*>::iterator it0 = n0->neighbor_nodes.begin(); it0!=n0->neighbor_nodes.end(); ++it0)
-        {
-            for (vector<enigma::node*>::iterator it1 = n1->neighbor_nodes.begin(); it1!=n1->neighbor_nodes.end(); ++it1)
-            {
-                if ((*it0)==(*it1) && (*it0)->cost >= gridstructarray[id]->threshold)
-                return true;
-            }
-        }
-        return false;
+        return a.F > b.F || (a.F == b.F && a.H > b.H);
     }
 
-    multimap<unsigned,node*> find_path(unsigned id, node* n0, node* n1, bool allow_diag, bool &status)
+    // Starts a new search over the given number of cells, returning its generation.
+    static unsigned begin_search(path_search &search, size_t cell_count)
     {
-        node* current;
-        for (unsigned int i = 0; i < gridstructarray[id]->hcells*gridstructarray[id]->vcells; i++)
-        {
-            gridstructarray[id]->nodearray[i].F=0;
-            gridstructarray[id]->nodearray[i].G=0;
-            gridstructarray[id]->nodearray[i].H=0;
-            gridstructarray[id]->nodearray[i].came_from=NULL;
+        if (search.cells.size() != cell_count || ++search.generation >= 0x7FFFFFFF) {
+            search.cells.assign(cell_count, path_search::cell_state());
+            search.generation = 1;
         }
+        search.open.clear();
+        return search.generation;
+    }
 
-        node* start = n0;
-        node* destination = n1;
-        multimap<unsigned,node*> OPEN;
-        list<node*> CLOSED;
-        multimap<unsigned,node*> mm_ret;
-
-        if (start == destination)
-            return mm_ret;
-        start->H = find_heuristic(start,destination,allow_diag);
-        start->F = start->H;
-        OPEN.insert(pair<unsigned,node*>(start->F,start));
-
-        while (find(CLOSED.begin(), CLOSED.end(), destination) == CLOSED.end() && !OPEN.empty())
-        //loop until destination is in the closed list or the open multimap is empty
+    bool find_path(const grid &gr, unsigned start, unsigned goal, bool allow_diag, path_search &search, vector<unsigned> &path)
+    {
+        path.clear();
+        if (start == goal)
+            return true;
+
+        const unsigned generation = begin_search(search, gr.nodearray.size());
+        const unsigned open = generation * 2, closed = open + 1;
+        const node &destination = gr.nodearray[goal];
+        const unsigned min_cost = gr.min_cost();
+        vector<path_search::cell_state> &cells = search.cells;
+        vector<path_search::open_entry> &OPEN = search.open;
+
+        path_search::cell_state &first = cells[start];
+        first.G = 0;
+        first.H = find_heuristic(gr.nodearray[start], destination, allow_diag, min_cost);
+        first.came_from = start;
+        first.stamp = open;
+        path_search::open_entry entry = { first.H, first.H, start };
+        OPEN.push_back(entry);
+
+        bool reached = false;
+        // Free cells can leave H at zero everywhere, so closeness is counted in steps.
+        unsigned nearest = start, nearest_distance = find_distance(gr.nodearray[start], destination, allow_diag);
+        unsigned around[8];
+        while (!OPEN.empty())
         {
-            //this is basically ds_priority_delete_min
-            {
-              multimap<unsigned,node*>::iterator it = OPEN.begin(), it_check;
-              it_check = it++;
-              while (it != OPEN.end())
-              {
-                  if ((*it).first < (*it_check).first) {it_check = it;}
-                  it++;
-              }
-              current = (*it_check).second;
-              OPEN.erase(it_check);
+            std::pop_heap(OPEN.begin(), OPEN.end(), open_after);
+            const unsigned current = OPEN.back().cell;
+            OPEN.pop_back();
+            path_search::cell_state &cur = cells[current];
+            if (cur.stamp == closed)
+                continue; // Queued again with a lower G, and already handled then
+            cur.stamp = closed;
+            const unsigned distance = find_distance(gr.nodearray[current], destination, allow_diag);
+            if (distance < nearest_distance)
+                nearest = current, nearest_distance = distance;
+            if (current == goal) {
+                reached = true;
+                break;
             }
 
-            CLOSED.push_front(current);
-            for (vector<enigma::node*>::iterator it = current->neighbor_nodes.begin(); it!=current->neighbor_nodes.end(); ++it)
-            { //go trough all the neighbors (should be faster then 8 if cycles like in the init)
-                if (!allow_diag && (*it)->x != current->x && (*it)->y != current->y)
+            const node &cn = gr.nodearray[current];
+            const unsigned count = gr.neighbors(current, around);
+            for (unsigned k = 0; k < count; ++k)
+            {
+                const unsigned next = around[k];
+                const node &nn = gr.nodearray[next];
+                path_search::cell_state &ns = cells[next];
+                if (ns.stamp == closed || nn.cost >= gr.threshold)
                     continue;
+                const bool diagonal = nn.x != cn.x && nn.y != cn.y;
+                if (diagonal) {
+                    // No cutting corners past blocked cells
+                    if (!allow_diag
+                        || gr.nodearray[cn.x*gr.vcells + nn.y].cost >= gr.threshold
+                        || gr.nodearray[nn.x*gr.vcells + cn.y].cost >= gr.threshold)
+                        continue;
+                }
 
-                bool cutting = false;
-                if (allow_diag == true  && (*it)->x != current->x && (*it)->y != current->y)
-                        cutting = check_corners(id, current, (*it));
-
-                if (find(CLOSED.begin(), CLOSED.end(), (*it)) == CLOSED.end() && (*it)->cost<gridstructarray[id]->threshold && cutting == false){
-                    if (find_priority(OPEN,(*it)) == -1){ //if the node isn't on the open list
-                        (*it)->came_from = current;
-                        (*it)->G = current->G + (*it)->cost;
-                        if ((*it)->x != current->x && (*it)->y != current->y)
-                            (*it)->G += ceil((*it)->cost/2.5); //if it is diagonal increase the move cost
-                        (*it)->H = find_heuristic(*it,destination,allow_diag);
-                        (*it)->F = (*it)->G + (*it)->H;
-                        OPEN.insert(pair<unsigned,node*>((*it)->F,(*it)));
-
-                    }else{ //if the node is already on the open list we just have to see if it is a better path
-                        unsigned temp_G = current->G + (*it)->cost;
-                        if (temp_G < (*it)->G) {
-                            (*it)->came_from = current;
-                            (*it)->G = current->G + (*it)->cost;
-                            if ((*it)->x != current->x && (*it)->y != current->y)
-                                (*it)->G += ceil((*it)->cost/2.5);
-                            (*it)->H = find_heuristic(*it,destination,allow_diag);
-                            (*it)->F = (*it)->G + (*it)->H;
-                        }
-                    }
+                unsigned G = cur.G + nn.cost;
+                if (diagonal)
+                    G += ceil(nn.cost/2.5); //if it is diagonal increase the move cost
+                if (ns.stamp != open) {
+                    ns.H = find_heuristic(nn, destination, allow_diag, min_cost);
+                    ns.stamp = open;
+                } else if (G >= ns.G) {
+                    continue;
                 }
+                // Either newly opened or a better path; an entry left in the
+                // heap for an older path is skipped once the cell is closed.
+                ns.G = G;
+                ns.came_from = current;
+                entry.F = G + ns.H;
+                entry.H = ns.H;
+                entry.cell = next;
+                OPEN.push_back(entry);
+                std::push_heap(OPEN.begin(), OPEN.end(), open_after);
             }
         }
-        node *last, *nearest;
-        unsigned i = 0;
-        status = true;
-        if (find(CLOSED.begin(), CLOSED.end(), destination) == CLOSED.end())
-        {   //this is for if the destionation can't be found if
-            status = false;
-            nearest = start;
-
-            list<node*>::iterator it;
-            for (it=CLOSED.begin(); it != CLOSED.end(); it++){
-                (*it)->H = find_heuristic(*it,destination,allow_diag);
-                if ((*it)->H < nearest->H)
-                    nearest = *it;
-            }
-            destination = nearest;
-            if (start == destination)
-                return mm_ret;
-        }
-
-        //mm_ret.insert(pair<unsigned,node*>(i,destination));
-        last = destination;
-        while (last->came_from != start){
-            i += 1;
-            mm_ret.insert(pair<unsigned,node*>(i,last->came_from));
-            last = last->came_from;
-        }
 
-        //delete CLOSED;
-        //delete OPEN;
-        return mm_ret; //return the multimap containing a list of all the nodes that are in the path.
+        //if the destination can't be reached, head for the closest cell we could reach
+        const unsigned last = reached ? goal : nearest;
+        if (last == start)
+            return reached;
+        for (unsigned cell = cells[last].came_from; cell != start; cell = cells[cell].came_from)
+            path.push_back(cell);
+        std::reverse(path.begin(), path.end());
+        return reached;
     }
 }
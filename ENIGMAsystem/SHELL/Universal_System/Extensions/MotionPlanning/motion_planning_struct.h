@@ -39,22 +39,17 @@
 #endif
 
 #include <vector>
-#include <map>
 #include <cstddef>
 
 
 using std::vector;
-using std::multimap;
 
 namespace enigma
 {
   struct node
   {
-    unsigned x, y, F, H, G, cost;
-    node* came_from;
-    vector<node*> neighbor_nodes;
-    node(unsigned X = 0, unsigned Y = 0, unsigned f = 0, unsigned h = 0, unsigned g = 0, unsigned Cost = 0, node* CameFrom = NULL):
-      x(X), y(Y), F(f), H(h), G(g), cost(Cost), came_from(CameFrom) {}
+    unsigned x, y, cost;
+    node(unsigned X = 0, unsigned Y = 0, unsigned Cost = 1): x(X), y(Y), cost(Cost) {}
   };
   struct grid
   {
@@ -63,11 +58,46 @@ namespace enigma
     unsigned int hcells, vcells, cellwidth, cellheight;
     unsigned threshold;
     double speed_modifier;
-    vector<node> nodearray;
+    vector<node> nodearray; // Cell (h, v) is at h*vcells + v
     grid(unsigned int id,int left,int top,unsigned int hcells,unsigned int vcells,unsigned int cellwidth,unsigned int cellheight, unsigned int threshold, double speed_modifier);
     ~grid();
+    // Writes the indices of the cells around the given one to out, returning how many there are.
+    unsigned neighbors(unsigned cell, unsigned out[8]) const;
+    // The lowest cost of any cell below the threshold, which scales the search
+    // heuristic. Worked out when first asked for after costs_changed(), so call
+    // it once before searching the grid from several threads.
+    unsigned min_cost() const;
+    // Must follow any change to the cell costs or the threshold.
+    void costs_changed() { min_cost_known = false; }
+
+   private:
+    mutable unsigned cached_min_cost;
+    mutable bool min_cost_known;
   };
   extern grid** gridstructarray;
   void gridstructarray_reallocate();
-  multimap<unsigned,node*> find_path(unsigned id, node* n0, node* n1, bool allow_diag, bool &status);
+
+  // State of one path search, kept between searches so that a search allocates
+  // nothing once it has seen a grid of the same size. Cells are stamped with the
+  // number of the search that opened or closed them instead of being reset.
+  // Searches on separate workspaces may run at once on different threads.
+  struct path_search
+  {
+    struct cell_state {
+      unsigned G, H, came_from;
+      unsigned stamp; // 2*generation when open, 2*generation + 1 when closed
+    };
+    struct open_entry {
+      unsigned F, H, cell;
+    };
+    vector<cell_state> cells;
+    vector<open_entry> open; // Binary heap, least F (then H) on top
+    unsigned generation;
+    path_search(): generation(0) {}
+  };
+
+  // Finds a path from cell start to cell goal, returning whether goal can be
+  // reached. The cells between the two are written to path, start side first.
+  // If goal can't be reached, the path leads toward the closest reachable cell.
+  bool find_path(const grid &gr, unsigned start, unsigned goal, bool allow_diag, path_search &search, vector<unsigned> &path);
 }
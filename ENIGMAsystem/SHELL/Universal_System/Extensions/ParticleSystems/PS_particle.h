@@ -45,6 +45,9 @@ namespace enigma_user {
   // Update and draw.
   void part_system_automatic_update(int id, bool automatic);
   void part_system_automatic_draw(int id, bool automatic);
+  // Stores the particles of the system as arrays of floats, updated in one pass
+  // and on several threads when there are many. Draw order is unchanged.
+  void part_system_soa(int id, bool enable);
   void part_system_update(int id);
   void part_system_drawit(int id);
   // Particles.
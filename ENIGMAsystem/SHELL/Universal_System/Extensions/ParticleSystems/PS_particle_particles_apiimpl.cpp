@@ -63,27 +63,14 @@ namespace enigma_user {
   {
     particle_system* p_s = enigma::get_particlesystem(id);
     if (p_s != NULL) {
-      for (std::vector<enigma::particle_instance>::iterator it = p_s->pi_list.begin(); it != p_s->pi_list.end(); it++)
-      {
-        particle_type* pt = it->pt;
-
-        // Death handling.
-        pt->particle_count--;
-        if (pt->particle_count <= 0 && !pt->alive) {
-          // Particle type is no longer used, delete it.
-          int pid = pt->id;
-          delete pt;
-          enigma::pt_manager.id_to_particletype.erase(pid);
-        }
-      }
-      p_s->pi_list.clear();
+      p_s->clear_particles();
     }
   }
   int part_particles_count(int id)
   {
     particle_system* p_s = enigma::get_particlesystem(id);
     if (p_s != NULL) {
-      return p_s->pi_list.size();
+      return p_s->particle_count();
     }
     return 0;
   }
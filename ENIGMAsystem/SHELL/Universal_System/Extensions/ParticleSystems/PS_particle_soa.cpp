@@ -0,0 +1,529 @@
+/** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+// Update of particle systems stored as arrays of fields (part_system_soa).
+// It does what particle_system::update_particlesystem does, but in one pass
+// over the particles: each run of consecutive particles of the same type is
+// stepped with that type's parameters read once, in loops over plain float
+// arrays which the compiler can vectorize, and large systems are split across
+// the worker pool. Whatever touches shared state (particle type bookkeeping, creating
+// particles) is done afterward, on the calling thread, in particle order.
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <floatcomp.h>
+
+#include "PS_particle_soa.h"
+#include "PS_particle_system.h"
+#include "PS_particle_type.h"
+#include "Universal_System/math_consts.h"
+#include "Universal_System/worker_pool.h"
+
+namespace enigma
+{
+  void particle_soa::push_back(const particle_instance& pi)
+  {
+    pt.push_back(pi.pt);
+    x.push_back(pi.x);
+    y.push_back(pi.y);
+    speed.push_back(pi.speed);
+    dir_cos.push_back(cos(pi.direction*M_PI/180.0));
+    dir_sin.push_back(sin(pi.direction*M_PI/180.0));
+    size.push_back(pi.size);
+    angle.push_back(pi.angle);
+    size_wiggle_offset.push_back(pi.size_wiggle_offset);
+    ang_wiggle_offset.push_back(pi.ang_wiggle_offset);
+    speed_wiggle_offset.push_back(pi.speed_wiggle_offset);
+    dir_wiggle_offset.push_back(pi.dir_wiggle_offset);
+    life_current.push_back(pi.life_current);
+    life_start.push_back(pi.life_start);
+    color.push_back(pi.color);
+    alpha.push_back(pi.alpha);
+    sprite_subimageindex_initial.push_back(pi.sprite_subimageindex_initial);
+    removed.push_back(0);
+  }
+
+  particle_instance particle_soa::get(size_t i) const
+  {
+    particle_instance pi;
+    pi.pt = pt[i];
+    pi.sprite_subimageindex_initial = sprite_subimageindex_initial[i];
+    pi.size = size[i];
+    pi.size_wiggle_offset = size_wiggle_offset[i];
+    pi.angle = angle[i];
+    pi.ang_wiggle_offset = ang_wiggle_offset[i];
+    pi.color = color[i];
+    pi.alpha = alpha[i];
+    pi.life_current = life_current[i];
+    pi.life_start = life_start[i];
+    pi.x = x[i];
+    pi.y = y[i];
+    pi.speed = speed[i];
+    pi.direction = atan2f(dir_sin[i], dir_cos[i])*float(180.0/M_PI);
+    pi.speed_wiggle_offset = speed_wiggle_offset[i];
+    pi.dir_wiggle_offset = dir_wiggle_offset[i];
+    return pi;
+  }
+
+  template<typename T> static inline void compact_field(std::vector<T>& field, const std::vector<unsigned char>& removed)
+  {
+    size_t j = 0;
+    for (size_t i = 0; i < field.size(); i++)
+      if (!removed[i]) field[j++] = field[i];
+    field.resize(j);
+  }
+
+  void particle_soa::compact()
+  {
+    compact_field(pt, removed);
+    compact_field(x, removed); compact_field(y, removed);
+    compact_field(speed, removed);
+    compact_field(dir_cos, removed); compact_field(dir_sin, removed);
+    compact_field(size, removed); compact_field(angle, removed);
+    compact_field(size_wiggle_offset, removed); compact_field(ang_wiggle_offset, removed);
+    compact_field(speed_wiggle_offset, removed); compact_field(dir_wiggle_offset, removed);
+    compact_field(life_current, removed); compact_field(life_start, removed);
+    compact_field(color, removed); compact_field(alpha, removed);
+    compact_field(sprite_subimageindex_initial, removed);
+    removed.assign(pt.size(), 0);
+  }
+
+  void particle_soa::clear()
+  {
+    pt.clear();
+    x.clear(); y.clear();
+    speed.clear();
+    dir_cos.clear(); dir_sin.clear();
+    size.clear(); angle.clear();
+    size_wiggle_offset.clear(); ang_wiggle_offset.clear();
+    speed_wiggle_offset.clear(); dir_wiggle_offset.clear();
+    life_current.clear(); life_start.clear();
+    color.clear(); alpha.clear();
+    sprite_subimageindex_initial.clear();
+    removed.clear();
+  }
+
+  namespace
+  {
+    enum removal { kept = 0, died, changed, destroyed };
+
+    // Large systems are handed to the worker pool in slices of this many particles.
+    const size_t particles_per_job = 16384;
+
+    struct changer_step {
+      particle_changer* changer;
+      particle_type *from, *to;
+    };
+
+    struct step_context {
+      particle_soa* p;
+      float wiggle;
+      std::vector<changer_step> changers;
+      std::vector<particle_attractor*> attractors;
+      std::vector<particle_destroyer*> destroyers;
+      std::vector<particle_deflector*> deflectors;
+      std::vector<particle_type*> change_to; // Per particle, if a changer got it
+    };
+
+    inline float wiggle_result(float wiggle_offset, float wiggle)
+    {
+      float result_wiggle = wiggle + wiggle_offset;
+      result_wiggle = result_wiggle > 1.0f ? result_wiggle - 1.0f : result_wiggle;
+      return result_wiggle < 0.5f ? -1.0f + 4.0f*result_wiggle : 3.0f - 4.0f*result_wiggle;
+    }
+
+    inline int mix_colors(int color1, int color2, float part)
+    {
+      return make_color_rgb(int((1-part)*color_get_red(color1) + part*color_get_red(color2)),
+                            int((1-part)*color_get_green(color1) + part*color_get_green(color2)),
+                            int((1-part)*color_get_blue(color1) + part*color_get_blue(color2)));
+    }
+
+    inline int mix_alphas(int alpha1, int alpha2, float part)
+    {
+      const int alpha = int((1-part)*alpha1 + part*alpha2);
+      return alpha < 0 ? 0 : alpha > 255 ? 255 : alpha;
+    }
+
+    inline float direction_of(const particle_soa& p, size_t i)
+    {
+      return atan2f(p.dir_sin[i], p.dir_cos[i])*float(180.0/M_PI);
+    }
+
+    // Life, shape, color, blending and motion of particles [begin, end), all of type pt.
+    void step_run(step_context& c, particle_type* pt, size_t begin, size_t end)
+    {
+      particle_soa& p = *c.p;
+      int* const life = p.life_current.data();
+      unsigned char* const removed = p.removed.data();
+      float* const x = p.x.data();
+      float* const y = p.y.data();
+      float* const speed = p.speed.data();
+      float* const dir_cos = p.dir_cos.data();
+      float* const dir_sin = p.dir_sin.data();
+
+      for (size_t i = begin; i < end; i++) {
+        life[i]--;
+        removed[i] = life[i] <= 0 ? died : kept;
+      }
+
+      if (pt->alive) {
+        // Shape.
+        const float size_incr = pt->size_incr, ang_incr = pt->ang_incr;
+        float* const size = p.size.data();
+        float* const angle = p.angle.data();
+        for (size_t i = begin; i < end; i++)
+          size[i] = std::max(size[i] + size_incr, 0.0f);
+        if (ang_incr != 0)
+          for (size_t i = begin; i < end; i++)
+            angle[i] = fmodf(angle[i] + ang_incr, 360.0f);
+
+        // Color and blending.
+        const int* const life_start = p.life_start.data();
+        int* const color = p.color.data();
+        int* const alpha = p.alpha.data();
+        if (pt->c_mode == two_color) {
+          for (size_t i = begin; i < end; i++)
+            color[i] = mix_colors(pt->color1, pt->color2, 1.0f - float(life[i])/life_start[i]);
+        } else if (pt->c_mode == three_color) {
+          for (size_t i = begin; i < end; i++) {
+            const float part = 1.0f - float(life[i])/life_start[i];
+            color[i] = part <= 0.5f ? mix_colors(pt->color1, pt->color2, 2.0f*part)
+                                    : mix_colors(pt->color2, pt->color3, 2.0f*(part - 0.5f));
+          }
+        }
+        const int alpha1 = pt->alpha1, alpha2 = pt->alpha2, alpha3 = pt->alpha3;
+        if (pt->a_mode == two_alpha) {
+          for (size_t i = begin; i < end; i++)
+            alpha[i] = mix_alphas(alpha1, alpha2, 1.0f - float(life[i])/life_start[i]);
+        } else if (pt->a_mode == three_alpha) {
+          for (size_t i = begin; i < end; i++) {
+            const float part = 1.0f - float(life[i])/life_start[i];
+            alpha[i] = part <= 0.5f ? mix_alphas(alpha1, alpha2, 2.0f*part)
+                                    : mix_alphas(alpha2, alpha3, 2.0f*(part - 0.5f));
+          }
+        }
+
+        // Speed and direction. Turning rotates the direction vector, which is
+        // normalized again to keep rounding from adding up.
+        const float speed_incr = pt->speed_incr;
+        const float turn_cos = cos(pt->dir_incr*M_PI/180.0), turn_sin = sin(pt->dir_incr*M_PI/180.0);
+        const float grav_x = pt->grav_amount*cos(pt->grav_dir*M_PI/180.0),
+                    grav_y = pt->grav_amount*sin(pt->grav_dir*M_PI/180.0);
+        if (pt->dir_incr != 0) {
+          for (size_t i = begin; i < end; i++) {
+            const float c = dir_cos[i]*turn_cos - dir_sin[i]*turn_sin;
+            const float s = dir_sin[i]*turn_cos + dir_cos[i]*turn_sin;
+            const float norm = 1.0f/sqrtf(c*c + s*s);
+            dir_cos[i] = c*norm;
+            dir_sin[i] = s*norm;
+          }
+        }
+        if (speed_incr != 0) {
+          for (size_t i = begin; i < end; i++) {
+            const float s = speed[i] + speed_incr;
+            const float flip = s < 0 ? -1.0f : 1.0f; // Negative speed turns the particle around.
+            speed[i] = s*flip;
+            dir_cos[i] *= flip;
+            dir_sin[i] *= flip;
+          }
+        }
+        if (grav_x != 0 || grav_y != 0) {
+          for (size_t i = begin; i < end; i++) {
+            const float vx = speed[i]*dir_cos[i] + grav_x;
+            const float vy = speed[i]*dir_sin[i] + grav_y;
+            const float s = sqrtf(vx*vx + vy*vy);
+            speed[i] = s;
+            if (s > 1e-8f) {
+              dir_cos[i] = vx/s;
+              dir_sin[i] = vy/s;
+            }
+          }
+        }
+
+        // Move, with wiggling.
+        const float speed_wiggle = pt->speed_wiggle, dir_wiggle = pt->dir_wiggle, wiggle = c.wiggle;
+        if (dir_wiggle != 0) {
+          for (size_t i = begin; i < end; i++) {
+            const float s = speed[i] + speed_wiggle*wiggle_result(p.speed_wiggle_offset[i], wiggle);
+            const float d = (direction_of(p, i) + dir_wiggle*wiggle_result(p.dir_wiggle_offset[i], wiggle))*float(M_PI/180.0);
+            const float moves = removed[i] == kept; // Particles which died stay where they died.
+            x[i] += moves*s*cosf(d);
+            y[i] -= moves*s*sinf(d);
+          }
+          return;
+        }
+        if (speed_wiggle != 0) {
+          const float* const speed_wiggle_offset = p.speed_wiggle_offset.data();
+          for (size_t i = begin; i < end; i++) {
+            const float s = speed[i] + speed_wiggle*wiggle_result(speed_wiggle_offset[i], wiggle);
+            const float moves = removed[i] == kept;
+            x[i] += moves*s*dir_cos[i];
+            y[i] -= moves*s*dir_sin[i];
+          }
+          return;
+        }
+      }
+
+      // Move.
+      for (size_t i = begin; i < end; i++) {
+        const float moves = removed[i] == kept;
+        x[i] += moves*speed[i]*dir_cos[i];
+        y[i] -= moves*speed[i]*dir_sin[i];
+      }
+    }
+
+    // Changers, attractors, destroyers and deflectors, for particles [begin, end) of type pt.
+    void apply_fields(step_context& c, particle_type* pt, size_t begin, size_t end)
+    {
+      particle_soa& p = *c.p;
+      for (size_t i = begin; i < end; i++)
+      {
+        if (p.removed[i]) continue;
+        for (size_t k = 0; k < c.changers.size(); k++) {
+          if (c.changers[k].from == pt && c.changers[k].changer->is_inside(p.x[i], p.y[i])) {
+            p.removed[i] = changed;
+            c.change_to[i] = c.changers[k].to;
+            break;
+          }
+        }
+        if (p.removed[i]) continue;
+
+        for (size_t k = 0; k < c.attractors.size(); k++) {
+          const particle_attractor* p_a = c.attractors[k];
+          // If the particle is not inside the attractor range of influence,
+          // or is at the attractor's exact position, skip to next attractor.
+          const float dx = p.x[i] - p_a->x;
+          const float dy = p.y[i] - p_a->y;
+          const float distance = sqrtf(dx*dx + dy*dy);
+          const float relative_distance = distance/std::max(1.0, p_a->dist_effect);
+          if (relative_distance > 1.0f || (fzero(dx) && fzero(dy))) {
+            continue;
+          }
+          // Toward the attractor, y up.
+          const float toward_x = -dx/distance, toward_y = dy/distance;
+          float force;
+          switch (p_a->force_kind) {
+          case ps_fo_linear : force = (1.0f - relative_distance)*p_a->force_strength; break;
+          case ps_fo_quadratic : force = (1.0f - relative_distance)*(1.0f - relative_distance)*p_a->force_strength; break;
+          case ps_fo_constant :
+          default : force = p_a->force_strength; break;
+          }
+          if (p_a->additive) {
+            const float vx = p.speed[i]*p.dir_cos[i] + force*toward_x;
+            const float vy = p.speed[i]*p.dir_sin[i] + force*toward_y;
+            const float speed = sqrtf(vx*vx + vy*vy);
+            p.speed[i] = speed;
+            if (!(fzero(vx) && fzero(vy))) {
+              p.dir_cos[i] = vx/speed;
+              p.dir_sin[i] = vy/speed;
+            }
+          }
+          else {
+            p.x[i] += force*toward_x;
+            p.y[i] -= force*toward_y;
+          }
+        }
+
+        for (size_t k = 0; k < c.destroyers.size(); k++) {
+          if (c.destroyers[k]->is_inside(p.x[i], p.y[i])) {
+            p.removed[i] = destroyed;
+            break;
+          }
+        }
+        if (p.removed[i]) continue;
+
+        for (size_t k = 0; k < c.deflectors.size(); k++) {
+          particle_deflector* p_df = c.deflectors[k];
+          if (!p_df->is_inside(p.x[i], p.y[i])) continue;
+          // Direction changing.
+          switch (p_df->deflection_kind) {
+          case ps_de_horizontal : p.dir_cos[i] = -p.dir_cos[i]; break;
+          case ps_de_vertical : p.dir_sin[i] = -p.dir_sin[i]; break;
+          default : break;
+          }
+          // Friction handling.
+          const float new_speed = std::max(0.0f, p.speed[i] - float(p_df->friction));
+          const float friction_effect = p.speed[i] - new_speed;
+          p.speed[i] = new_speed;
+          // Move one step.
+          p.x[i] += friction_effect*p.dir_cos[i];
+          p.y[i] -= friction_effect*p.dir_sin[i];
+        }
+      }
+    }
+
+    void step_range(step_context& c, size_t begin, size_t end, bool fields_only)
+    {
+      const std::vector<particle_type*>& pts = c.p->pt;
+      for (size_t i = begin; i < end; ) {
+        particle_type* const pt = pts[i];
+        size_t run_end = i + 1;
+        while (run_end < end && pts[run_end] == pt) run_end++;
+        if (!fields_only) step_run(c, pt, i, run_end);
+        apply_fields(c, pt, i, run_end);
+        i = run_end;
+      }
+    }
+
+    void step_parallel(step_context& c, size_t count)
+    {
+      const size_t jobs = count/particles_per_job;
+      if (jobs <= 1) {
+        step_range(c, 0, count, false);
+        return;
+      }
+      // Each job takes a contiguous slice; slices only write their own particles.
+      const size_t slice = (count + jobs - 1)/jobs;
+      enigma::run_parallel_jobs(jobs, [&c, count, slice](size_t job) {
+        const size_t begin = job*slice;
+        step_range(c, begin, std::min(count, begin + slice), false);
+      });
+    }
+
+    void release_particle(particle_type* pt)
+    {
+      pt->particle_count--;
+      if (pt->particle_count <= 0 && !pt->alive) {
+        // Particle type is no longer used, delete it.
+        int pid = pt->id;
+        delete pt;
+        pt_manager.id_to_particletype.erase(pid);
+      }
+    }
+
+    struct generation
+    {
+      double x, y;
+      int number;
+      particle_type* pt;
+    };
+
+    // Finds the types spawned by step and death, remembering the last lookup,
+    // as neighboring particles are usually of the same type.
+    struct spawn_lookup
+    {
+      particle_type* from;
+      particle_type *step, *death;
+      spawn_lookup(): from(NULL), step(NULL), death(NULL) {}
+      void find(particle_type* pt) {
+        if (pt == from) return;
+        from = pt;
+        step = pt->step_on ? get_particletype(pt->step_particle_id) : NULL;
+        death = pt->death_on ? get_particletype(pt->death_particle_id) : NULL;
+      }
+    };
+
+    // Handles the particles the kernel marked as removed, then drops them.
+    // Particles spawned by death, step and changers are added to spawn.
+    void finish_step(step_context& c, size_t begin, std::vector<generation>* spawn)
+    {
+      particle_soa& p = *c.p;
+      std::vector<generation> deaths, steps, changes;
+      spawn_lookup lookup;
+      bool any_removed = false;
+      for (size_t i = begin; i < p.count(); i++)
+      {
+        particle_type* const pt = p.pt[i];
+        const unsigned char removed = p.removed[i];
+        if (spawn && pt->alive && (removed == died || removed == kept)) {
+          lookup.find(pt);
+          generation gen = { p.x[i], p.y[i], 0, NULL };
+          if (removed == died && lookup.death) {
+            gen.number = pt->death_number;
+            gen.pt = lookup.death;
+            deaths.push_back(gen);
+          }
+          else if (removed == kept && lookup.step) {
+            gen.number = pt->step_number;
+            gen.pt = lookup.step;
+            steps.push_back(gen);
+          }
+        }
+        if (removed == kept) continue;
+        if (removed == changed && spawn) {
+          generation gen = { p.x[i], p.y[i], 1, c.change_to[i] };
+          changes.push_back(gen);
+        }
+        any_removed = true;
+        if (pt == lookup.from) lookup.from = NULL; // May be deleted.
+        release_particle(pt);
+      }
+      if (any_removed) p.compact();
+      if (spawn) {
+        spawn->insert(spawn->end(), deaths.begin(), deaths.end());
+        spawn->insert(spawn->end(), steps.begin(), steps.end());
+        spawn->insert(spawn->end(), changes.begin(), changes.end());
+      }
+    }
+  }
+
+  void particle_system::update_particlesystem_soa()
+  {
+    step_context c;
+    c.p = &soa_list;
+    c.wiggle = wiggle;
+    for (std::map<int,particle_changer*>::iterator it = id_to_changer.begin(); it != id_to_changer.end(); it++) {
+      changer_step ch = { (*it).second, get_particletype((*it).second->parttypeid1), get_particletype((*it).second->parttypeid2) };
+      if (ch.from && ch.to) c.changers.push_back(ch);
+    }
+    for (std::map<int,particle_attractor*>::iterator it = id_to_attractor.begin(); it != id_to_attractor.end(); it++)
+      c.attractors.push_back((*it).second);
+    for (std::map<int,particle_destroyer*>::iterator it = id_to_destroyer.begin(); it != id_to_destroyer.end(); it++)
+      c.destroyers.push_back((*it).second);
+    for (std::map<int,particle_deflector*>::iterator it = id_to_deflector.begin(); it != id_to_deflector.end(); it++)
+      c.deflectors.push_back((*it).second);
+
+    const size_t count = soa_list.count();
+    soa_list.removed.assign(count, kept);
+    if (!c.changers.empty()) c.change_to.resize(count);
+    step_parallel(c, count);
+
+    std::vector<generation> spawn;
+    finish_step(c, 0, &spawn);
+
+    // Particles created from here on only meet attractors, destroyers and
+    // deflectors this step.
+    const size_t first_new = soa_list.count();
+    for (std::vector<generation>::iterator it = spawn.begin(); it != spawn.end(); it++)
+    {
+      int number = (*it).number;
+      number = number >= 0 ? number : (rand() % (-number) < 1 ? 1 : 0); // Create particle with probability -1/number.
+      create_particles((*it).x, (*it).y, (*it).pt, number);
+    }
+    // Emitters.
+    for (std::map<int,particle_emitter*>::iterator it = id_to_emitter.begin(); it != id_to_emitter.end(); it++)
+    {
+      particle_emitter* p_e = (*it).second;
+      particle_type* p_t = get_particletype(p_e->particle_type_id);
+      if (p_t == NULL || !p_t->alive) continue;
+      const int number = p_e->get_step_number();
+      for (int i = 1; i <= number; i++)
+      {
+        int x, y;
+        p_e->get_point(x, y);
+        create_particles(x, y, p_t, 1);
+      }
+    }
+
+    if (soa_list.count() > first_new && (c.attractors.size() || c.destroyers.size() || c.deflectors.size())) {
+      c.changers.clear();
+      step_range(c, first_new, soa_list.count(), true);
+      finish_step(c, first_new, NULL);
+    }
+  }
+}
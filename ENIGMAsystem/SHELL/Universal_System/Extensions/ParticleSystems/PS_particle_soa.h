@@ -0,0 +1,53 @@
+/** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_PS_PARTICLESOA
+#define ENIGMA_PS_PARTICLESOA
+
+#include "PS_particle_instance.h"
+#include <vector>
+#include <cstddef>
+
+namespace enigma
+{
+  // Particles stored as one array per field, in single precision, for systems
+  // updated with part_system_soa enabled. Each step runs over the arrays once,
+  // in place of the separate passes over particle_instance structs.
+  struct particle_soa
+  {
+    std::vector<particle_type*> pt;
+    std::vector<float> x, y;
+    std::vector<float> speed;
+    // Direction as a unit vector (y up), so that moving and turning need no
+    // trigonometry. The angle is only worked out for drawing.
+    std::vector<float> dir_cos, dir_sin;
+    std::vector<float> size, angle;
+    std::vector<float> size_wiggle_offset, ang_wiggle_offset, speed_wiggle_offset, dir_wiggle_offset;
+    std::vector<int> life_current, life_start;
+    std::vector<int> color, alpha;
+    std::vector<int> sprite_subimageindex_initial;
+    std::vector<unsigned char> removed; // Scratch for update: why the particle goes away, if it does.
+
+    size_t count() const { return pt.size(); }
+    bool empty() const { return pt.empty(); }
+    void push_back(const particle_instance& pi);
+    particle_instance get(size_t i) const;
+    void clear();
+    // Moves the particles not marked as removed to the front, keeping their order.
+    void compact();
+  };
+}
+
+#endif // ENIGMA_PS_PARTICLESOA
@@ -91,6 +91,52 @@ namespace enigma
     id_to_changer = std::map<int,particle_changer*>();
     changer_max_id = 0;
     hidden = false;
+    soa = false;
+    soa_list.clear();
+  }
+
+  int particle_system::particle_count() const
+  {
+    return soa ? soa_list.count() : pi_list.size();
+  }
+
+  void particle_system::clear_particles()
+  {
+    std::vector<particle_type*> types;
+    if (soa) types.swap(soa_list.pt);
+    else for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != pi_list.end(); it++) types.push_back(it->pt);
+    for (std::vector<particle_type*>::iterator it = types.begin(); it != types.end(); it++)
+    {
+      particle_type* pt = *it;
+
+      // Death handling.
+      pt->particle_count--;
+      if (pt->particle_count <= 0 && !pt->alive) {
+        // Particle type is no longer used, delete it.
+        int pid = pt->id;
+        delete pt;
+        enigma::pt_manager.id_to_particletype.erase(pid);
+      }
+    }
+    pi_list.clear();
+    soa_list.clear();
+  }
+
+  void particle_system::set_soa(bool enable)
+  {
+    if (enable == soa) return;
+    soa = enable;
+    if (soa) {
+      for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != pi_list.end(); it++)
+        soa_list.push_back(*it);
+      std::vector<particle_instance>().swap(pi_list);
+    }
+    else {
+      for (size_t i = 0; i < soa_list.count(); i++)
+        pi_list.push_back(soa_list.get(i));
+      soa_list = particle_soa();
+      std::vector<particle_instance>().swap(draw_list);
+    }
   }
 
   static inline bool is_dead_from_old_age(particle_instance& pi) {
@@ -107,6 +153,11 @@ namespace enigma
     // Increase subimage_index.
     subimage_index++;
 
+    if (soa) {
+      update_particlesystem_soa();
+      return;
+    }
+
     std::vector<generation_info> particles_to_generate;
     // Handle life and death.
     {
@@ -481,6 +532,13 @@ namespace enigma
   }
   void particle_system::draw_particlesystem()
   {
+    if (soa) {
+      draw_list.resize(soa_list.count());
+      for (size_t i = 0; i < soa_list.count(); i++)
+        draw_list[i] = soa_list.get(i);
+      particle_bridge::draw_particles(draw_list, oldtonew, wiggle, subimage_index, x_offset, y_offset);
+      return;
+    }
     particle_bridge::draw_particles(pi_list, oldtonew, wiggle, subimage_index, x_offset, y_offset);
   }
   void particle_system::create_particles(double x, double y, particle_type* pt, int number, bool use_color, int given_color)
@@ -575,7 +633,8 @@ namespace enigma
       pi.direction = pt->dir_min + (pt->dir_max-pt->dir_min)*1.0*rand()/(RAND_MAX-1);
       pi.speed_wiggle_offset = 1.0*rand()/(RAND_MAX-1);
       pi.dir_wiggle_offset = 1.0*rand()/(RAND_MAX-1);
-      pi_list.push_back(pi);
+      if (soa) soa_list.push_back(pi);
+      else pi_list.push_back(pi);
     }
   }
   int particle_system::create_emitter()
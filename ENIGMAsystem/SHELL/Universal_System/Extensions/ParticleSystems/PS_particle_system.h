@@ -34,6 +34,7 @@
 #include "PS_particle_deflector.h"
 #include "PS_particle_changer.h"
 #include "PS_particle_instance.h"
+#include "PS_particle_soa.h"
 #include "PS_particle_enums.h"
 #include "Graphics_Systems/General/GScolors.h"
 #include <list>
@@ -72,6 +73,14 @@ namespace enigma
     void update_particlesystem();
     void draw_particlesystem();
     void create_particles(double x, double y, particle_type* pt, int number, bool use_color=false, int given_color=c_white);
+    int particle_count() const;
+    void clear_particles();
+    // Structure-of-arrays storage, holding the particles instead of pi_list when enabled.
+    bool soa;
+    particle_soa soa_list;
+    std::vector<particle_instance> draw_list; // Filled from soa_list for the drawing bridge.
+    void set_soa(bool enable);
+    void update_particlesystem_soa();
     // Emitters.
     std::map<int,particle_emitter*> id_to_emitter;
     int emitter_max_id;
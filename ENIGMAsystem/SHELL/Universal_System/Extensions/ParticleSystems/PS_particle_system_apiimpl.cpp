@@ -141,6 +141,13 @@ namespace enigma_user {
       }
     }
   }
+  void part_system_soa(int id, bool enable)
+  {
+    particle_system* p_s = enigma::get_particlesystem(id);
+    if (p_s != NULL) {
+      p_s->set_soa(enable);
+    }
+  }
   void part_system_update(int id)
   {
     particle_system* p_s = enigma::get_particlesystem(id);
@@ -27,48 +27,47 @@
 
 #include "pathstruct.h"
 #include "Universal_System/Resources/resinit.h"
-#include "Platforms/General/fileio.h"
 
 #include <cstring>
 
 namespace enigma
 {
-  void exe_loadpaths(FILE_t *exe)
+  void exe_loadpaths(ResourceReader &exe)
   {
     unsigned pathid, pointcount;
     bool smooth, closed;
     int x, y, speed, nullhere, precision;
 
-    if (!fread_wrapper(&nullhere,4,1,exe)) return;
+    if (!exe.read(&nullhere,4)) return;
     if (memcmp(&nullhere, "PTH ", sizeof(int)) != 0)
       return;
 
     // Determine how many paths we have
     int pathcount;
-    if (!fread_wrapper(&pathcount,4,1,exe)) return;
+    if (!exe.read(&pathcount,4)) return;
 
     // Fetch the highest ID we will be using
     int path_highid, buf;
-    if (!fread_wrapper(&path_highid,4,1,exe)) return;
+    if (!exe.read(&path_highid,4)) return;
     paths_init();
 
     for (int i = 0; i < pathcount; i++)
     {
-      if (!fread_wrapper(&pathid, 4,1,exe)) return;
-      if (!fread_wrapper(&buf, 4,1,exe)) return;
+      if (!exe.read(&pathid,4)) return;
+      if (!exe.read(&buf,4)) return;
       smooth = buf; //to fix int to bool issues
-      if (!fread_wrapper(&buf, 4,1,exe)) return;
+      if (!exe.read(&buf,4)) return;
       closed = buf;
-      if (!fread_wrapper(&precision, 4,1,exe)) return;
+      if (!exe.read(&precision,4)) return;
 
-      if (!fread_wrapper(&pointcount,4,1,exe)) return;
+      if (!exe.read(&pointcount,4)) return;
 
       new path(pathid, smooth, closed, precision, pointcount);
       for (unsigned ii=0;ii<pointcount;ii++)
       {
-        if (!fread_wrapper(&x, 4,1,exe)) return;
-        if (!fread_wrapper(&y, 4,1,exe)) return;
-        if (!fread_wrapper(&speed, 4,1,exe)) return;
+        if (!exe.read(&x,4)) return;
+        if (!exe.read(&y,4)) return;
+        if (!exe.read(&speed,4)) return;
         path_add_point(pathid, x, y, speed/100);
       }
       path_recalculate(pathid);
@@ -38,6 +38,8 @@ GM Global variables
 #endif
 
 namespace enigma_user {
+// Units of game code other than SHELLmain only see these declared.
+#ifndef ENIGMA_DECLARATIONS_ONLY
 std::string caption_score = "Score:", caption_lives = "Lives:", caption_health = "Health:";
 bool argument_relative = false;
 double health = 100;
@@ -57,6 +59,20 @@ int transition_steps = 80;
 bool automatic_redraw = true;
 int gamemaker_version = 0;
 int cursor_sprite = -1;
+#else
+extern std::string caption_score, caption_lives, caption_health;
+extern bool argument_relative;
+extern double health;
+extern std::deque<int> instance_id;
+extern double score;
+extern bool secure_mode;
+extern bool show_score, show_lives, show_health;
+extern int transition_kind;
+extern int transition_steps;
+extern bool automatic_redraw;
+extern int gamemaker_version;
+extern int cursor_sprite;
+#endif
 extern int room_first, room_last;
 }  // namespace enigma_user
 
@@ -23,12 +23,16 @@ namespace enigma {
 
   // Before collision event.
 
+  void collision_touch_all();
+
   list<callback_t> before_collision_callbacks;
   void perform_callbacks_before_collision_event() {
     list<callback_t>::iterator it_end = before_collision_callbacks.end();
     for (list<callback_t>::iterator it = before_collision_callbacks.begin(); it != it_end; it++) {
       (*it)();
     }
+    // These move instances (physics) without going through the collision index's touch points.
+    if (!before_collision_callbacks.empty()) collision_touch_all();
   }
   void register_callback_before_collision_event(callback_t callback) {
     before_collision_callbacks.push_back(callback);
@@ -58,5 +62,31 @@ namespace enigma {
   void register_callback_clean_up_roomend(callback_t callback) {
     clean_up_roomend_callbacks.push_back(callback);
   }
+
+  // Instance (de)activation.
+  struct object_basic;
+  typedef void (*instance_callback_t)(object_basic*);
+
+  list<instance_callback_t> instance_link_callbacks;
+  void perform_callbacks_instance_link(object_basic* inst) {
+    list<instance_callback_t>::iterator it_end = instance_link_callbacks.end();
+    for (list<instance_callback_t>::iterator it = instance_link_callbacks.begin(); it != it_end; it++) {
+      (*it)(inst);
+    }
+  }
+  void register_callback_instance_link(instance_callback_t callback) {
+    instance_link_callbacks.push_back(callback);
+  }
+
+  list<instance_callback_t> instance_unlink_callbacks;
+  void perform_callbacks_instance_unlink(object_basic* inst) {
+    list<instance_callback_t>::iterator it_end = instance_unlink_callbacks.end();
+    for (list<instance_callback_t>::iterator it = instance_unlink_callbacks.begin(); it != it_end; it++) {
+      (*it)(inst);
+    }
+  }
+  void register_callback_instance_unlink(instance_callback_t callback) {
+    instance_unlink_callbacks.push_back(callback);
+  }
 }
 
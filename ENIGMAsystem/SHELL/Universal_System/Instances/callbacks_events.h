@@ -30,6 +30,13 @@ namespace enigma {
   // Clean up room-end.
   void perform_callbacks_clean_up_roomend();
   void register_callback_clean_up_roomend(void (*callback)());
+
+  // Instance (de)activation, after linking into / before unlinking from the instance list.
+  struct object_basic;
+  void perform_callbacks_instance_link(object_basic* inst);
+  void register_callback_instance_link(void (*callback)(object_basic*));
+  void perform_callbacks_instance_unlink(object_basic* inst);
+  void register_callback_instance_unlink(void (*callback)(object_basic*));
 }
 
 #endif // ENIGMA_CALLBACKS_EVENTS_H
@@ -31,6 +31,7 @@
 #include "Widget_Systems/widgets_mandatory.h"
 #include "instance_system.h"
 #include "instance.h"
+#include "parallel_step.h"
 
 #include <map>
 #include <string>
@@ -51,8 +52,6 @@ namespace enigma
   int destroycalls = 0, createcalls = 0;
 }
 
-typedef std::pair<int,enigma::object_basic*> inode_pair;
-
 namespace enigma_user
 {
 
@@ -61,48 +60,65 @@ void instance_deactivate_all(bool notme) {
         if (notme && (*it)->id == enigma::instance_event_iterator->inst->id) continue;
 
         (*it)->deactivate();
-        enigma::instance_deactivated_list.insert(inode_pair((*it)->id,*it));
+        enigma::instance_deactivated_list.insert((*it)->id,*it);
     }
 }
 
 void instance_activate_all() {
-
-    std::map<int,enigma::object_basic*>::iterator iter = enigma::instance_deactivated_list.begin();
-    while (iter != enigma::instance_deactivated_list.end()) {
-        iter->second->activate();
-        enigma::instance_deactivated_list.erase(iter++);
+    enigma::instance_table<enigma::object_basic*> &deactivated = enigma::instance_deactivated_list;
+    for (int id = deactivated.first(); id != -1; ) {
+        const int next = deactivated.next(id);
+        deactivated.get(id)->activate();
+        deactivated.erase(id);
+        id = next;
     }
 }
 
 void instance_deactivate_object(int obj) {
     for (enigma::iterator it = enigma::fetch_inst_iter_by_int(obj); it; ++it) {
         (*it)->deactivate();
-        enigma::instance_deactivated_list.insert(inode_pair((*it)->id,*it));
+        enigma::instance_deactivated_list.insert((*it)->id,*it);
     }
 }
 
 void instance_activate_object(int obj) {
-    std::map<int,enigma::object_basic*>::iterator iter = enigma::instance_deactivated_list.begin();
-    while (iter != enigma::instance_deactivated_list.end()) {
-        enigma::object_basic* const inst = iter->second;
-        if (obj == all || (obj < 100000 ? (inst->object_index==obj || inst->can_cast(obj)) : inst->id == unsigned(obj))) {
+    enigma::instance_table<enigma::object_basic*> &deactivated = enigma::instance_deactivated_list;
+    if (obj >= 100000) {
+        // An instance id; no need to search the list.
+        if (enigma::object_basic* const inst = deactivated.get(obj)) {
             inst->activate();
-            enigma::instance_deactivated_list.erase(iter++);
+            deactivated.erase(obj);
         }
-        else {
-            iter++;
+        return;
+    }
+    for (int id = deactivated.first(); id != -1; ) {
+        const int next = deactivated.next(id);
+        enigma::object_basic* const inst = deactivated.get(id);
+        if (obj == all || inst->object_index==obj || inst->can_cast(obj)) {
+            inst->activate();
+            deactivated.erase(id);
         }
+        id = next;
     }
 }
 
 void instance_destroy(int id, bool dest_ev)
 {
+  if (enigma::parallel_step_worker) {
+    // Applied as this instance, so that self and other still mean what they did here.
+    enigma::object_basic* const self = enigma::parallel_step_worker->self;
+    enigma::parallel_step_defer([=]() {
+      enigma::temp_event_scope scope(self);
+      instance_destroy(id, dest_ev);
+    });
+    return;
+  }
   for (enigma::iterator it = enigma::fetch_inst_iter_by_int(id); it; ++it) {
     enigma::object_basic* who = (*it);
-    if (enigma::cleanups.find(who) == enigma::cleanups.end()) {
+    if (!who->$destroyed) {
       if (dest_ev)
           who->myevent_destroy();
-      if (enigma::cleanups.find(who) == enigma::cleanups.end())
+      if (!who->$destroyed)
           who->unlink();
     }
   }
@@ -110,12 +126,20 @@ void instance_destroy(int id, bool dest_ev)
 
 void instance_destroy()
 {
+  if (enigma::parallel_step_worker) {
+    enigma::object_basic* const a = enigma::parallel_step_worker->self;
+    enigma::parallel_step_defer([a]() {
+      enigma::temp_event_scope scope(a);
+      instance_destroy();
+    });
+    return;
+  }
   enigma::object_basic* const a = enigma::instance_event_iterator->inst;
-  if (enigma::cleanups.find(a) == enigma::cleanups.end()) {
+  if (!a->$destroyed) {
     enigma::instance_event_iterator->inst->myevent_destroy();
-    if (enigma::cleanups.find(a) == enigma::cleanups.end())
+    if (!a->$destroyed)
         enigma::instance_event_iterator->inst->unlink();
-    if (enigma::cleanups.find(a) == enigma::cleanups.end())
+    if (!a->$destroyed)
     DEBUG_MESSAGE("FUCK! FUCK! FUCK! FUCK! FUCK! FUCK! FUCK! FUCK! FUCK! FUCK! FUCK! FUCK! FUCK!\nFFFFFFFFFFFFFFFFFFFFFUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUCK!\nFUCK! " + pointer2string(a) + " ISN'T ON THE GOD DAMNED MOTHER FUCKING STACK!", MESSAGE_TYPE::M_ERROR);
     if (a != (enigma::object_basic*)enigma::instance_event_iterator->inst)
     DEBUG_MESSAGE("FUCKING DAMN IT! THE ITERATOR CHANGED FROM POINTING TO " + pointer2string((void*)a) + " TO POINTING TO " + pointer2string((void*)(enigma::object_basic*)enigma::instance_event_iterator->inst), MESSAGE_TYPE::M_ERROR);
@@ -61,6 +61,12 @@ enigma::instance_t instance_furthest(int x,int y,int obj,bool notme = false);
 void instance_change(int obj, bool perf = false);
 void instance_copy(bool perf = true); // this is supposed to return an iterator
 inline void action_change_object(int obj, bool perf);
+// Allocations made for instances and their list nodes during the last frame:
+// all of them, those a pool served, and those which had to go to the heap
+// (pools growing, or instances no pool could take). The last two add up to the first.
+int instance_allocations();
+int instance_pooled_allocations();
+int instance_heap_allocations();
 
 } //namespace enigma_user
 
@@ -90,6 +90,15 @@ namespace enigma_user
 {
   enigma::instance_t instance_create(int x,int y,int object)
   {
+    if (enigma::parallel_step_worker) {
+      const int idn = enigma::parallel_step_reserve_id();
+      enigma::object_basic* const self = enigma::parallel_step_worker->self;
+      enigma::parallel_step_defer([=]() {
+        enigma::temp_event_scope scope(self);
+        if (enigma::object_basic* ob = enigma::instance_create_id(x, y, object, idn)) ob->myevent_create();
+      });
+      return idn;
+    }
       int idn = enigma::maxid++;
     enigma::object_basic* ob;
       switch((int)object)
@@ -107,6 +116,18 @@ namespace enigma_user
   }
 
   enigma::instance_t instance_create_depth(int x, int y, int depth, int object) {
+    if (enigma::parallel_step_worker) {
+      const int idn = enigma::parallel_step_reserve_id();
+      enigma::object_basic* const self = enigma::parallel_step_worker->self;
+      enigma::parallel_step_defer([=]() {
+        enigma::temp_event_scope scope(self);
+        if (enigma::object_basic* ob = enigma::instance_create_id(x, y, object, idn)) {
+          ((enigma::object_graphics*) ob)->depth = depth;
+          ob->myevent_create();
+        }
+      });
+      return idn;
+    }
     int idn = enigma::maxid++;
     enigma::object_basic* ob;
     switch((int)object) {
@@ -27,9 +27,12 @@ namespace enigma {
 class iterator {
   enigma::inst_iter temp_iter;
   enigma::inst_iter* it;
+  iterator *reg_prev, *reg_next;  // Links in the registry of live iterators
 
   void addme();
+  void removeme();
   void copy(const iterator& other);
+  friend void update_iterators_for_destroy(const inst_iter*);
 
  public:
   operator bool();
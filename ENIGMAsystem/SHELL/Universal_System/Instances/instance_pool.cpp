@@ -0,0 +1,126 @@
+/** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "instance_pool.h"
+#include "instance_system_base.h"
+#include "instance.h"
+
+#include <new>
+
+namespace enigma {
+
+  allocation_counters allocations_this_frame = { 0, 0 }, allocations_last_frame = { 0, 0 };
+
+  void allocation_counters_next_frame() {
+    allocations_last_frame = allocations_this_frame;
+    allocations_this_frame.pooled = allocations_this_frame.heap = 0;
+  }
+
+  static const size_t block_align = alignof(std::max_align_t);
+  static const size_t first_slab = 64, max_slab = 4096;
+
+  block_pool::block_pool(size_t size):
+      block_size((size + block_align - 1) / block_align * block_align), next_slab(first_slab),
+      free_list(NULL), slab_pos(NULL), slab_end(NULL) {}
+
+  block_pool::~block_pool() {
+    for (size_t i = 0; i < slabs.size(); ++i)
+      ::operator delete(slabs[i]);
+  }
+
+  void *block_pool::alloc() {
+    if (free_list) {
+      allocations_this_frame.pooled++;
+      void *block = free_list;
+      free_list = *(void**)block;
+      return block;
+    }
+    if (slab_pos == slab_end) {
+      allocations_this_frame.heap++;
+      slab_pos = (char*)::operator new(next_slab * block_size);
+      slab_end = slab_pos + next_slab * block_size;
+      slabs.push_back(slab_pos);
+      if (next_slab < max_slab) next_slab *= 2;
+    } else {
+      allocations_this_frame.pooled++;
+    }
+    void *block = slab_pos;
+    slab_pos += block_size;
+    return block;
+  }
+
+  void block_pool::release(void *block) {
+    *(void**)block = free_list;
+    free_list = block;
+  }
+
+  // Anything not the size the pool was made for goes to the heap.
+  static void *heap_alloc(size_t size) {
+    allocations_this_frame.heap++;
+    return ::operator new(size);
+  }
+
+  // Never destroyed, as nodes may still be deleted during static destruction.
+  static block_pool &iter_pool() {
+    static block_pool *pool = new block_pool(sizeof(inst_iter));
+    return *pool;
+  }
+
+  void *inst_iter_alloc(size_t size) {
+    return size == sizeof(inst_iter) ? iter_pool().alloc() : heap_alloc(size);
+  }
+  void inst_iter_free(void *block, size_t size) {
+    if (!block) return;
+    if (size == sizeof(inst_iter)) iter_pool().release(block);
+    else ::operator delete(block);
+  }
+
+  static std::vector<block_pool*> object_pools;
+
+  void *instance_alloc(int object_index, size_t size) {
+    if (object_index < 0) return heap_alloc(size);
+    if (size_t(object_index) >= object_pools.size())
+      object_pools.resize(object_index + 1, NULL);
+    block_pool *&pool = object_pools[object_index];
+    if (!pool) pool = new block_pool(size);
+    return size <= pool->size() ? pool->alloc() : heap_alloc(size);
+  }
+  void instance_free(int object_index, void *block, size_t size) {
+    if (!block) return;
+    block_pool *pool = object_index >= 0 && size_t(object_index) < object_pools.size() ? object_pools[object_index] : NULL;
+    if (pool && size <= pool->size()) pool->release(block);
+    else ::operator delete(block);
+  }
+
+  void *inst_iter::operator new(size_t size) { return inst_iter_alloc(size); }
+  void inst_iter::operator delete(void *block, size_t size) { inst_iter_free(block, size); }
+
+} // namespace enigma
+
+namespace enigma_user {
+
+int instance_allocations() {
+  return enigma::allocations_last_frame.pooled + enigma::allocations_last_frame.heap;
+}
+
+int instance_pooled_allocations() {
+  return enigma::allocations_last_frame.pooled;
+}
+
+int instance_heap_allocations() {
+  return enigma::allocations_last_frame.heap;
+}
+
+}
@@ -0,0 +1,68 @@
+/** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+// Slab allocation for the instance system. Instances and the list nodes
+// linking them into the instance, object and event lists are created and
+// destroyed in bursts (bullets, particles as objects), so they are carved
+// from slabs and recycled through free lists instead of going to the heap
+// one at a time. Slabs are kept for the life of the game.
+
+#ifndef ENIGMA_INSTANCE_POOL_H
+#define ENIGMA_INSTANCE_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+namespace enigma {
+
+// Hands out blocks of one size from slabs, each slab twice the size of the
+// last up to a limit. Freed blocks are reused before a new slab is made.
+class block_pool {
+  size_t block_size;
+  size_t next_slab;       // Blocks in the next slab
+  void *free_list;        // Freed blocks, linked through their first word
+  char *slab_pos, *slab_end; // Unused part of the newest slab
+  std::vector<char*> slabs;
+
+ public:
+  block_pool(size_t size);
+  ~block_pool();
+  size_t size() const { return block_size; }
+  void *alloc();
+  void release(void *block);
+};
+
+// Every allocation is counted once, as one or the other.
+struct allocation_counters {
+  unsigned pooled; // Served from a pool's free list or the unused part of its newest slab
+  unsigned heap;   // Went to the heap: a block from a new slab, or one no pool could take
+};
+// Counted since the last dispose_destroyed_instances(), and for the whole
+// frame before that.
+extern allocation_counters allocations_this_frame, allocations_last_frame;
+void allocation_counters_next_frame();
+
+// Storage for the nodes of the instance, object and event lists.
+void *inst_iter_alloc(size_t size);
+void inst_iter_free(void *block, size_t size);
+
+// Storage for instances, with one pool per object, as instances of the same
+// object are the same size. Used by the generated OBJ_ classes.
+void *instance_alloc(int object_index, size_t size);
+void instance_free(int object_index, void *block, size_t size);
+
+} // namespace enigma
+
+#endif // ENIGMA_INSTANCE_POOL_H
@@ -29,6 +29,8 @@
 
 #include "instance_system.h"
 #include "instance_system_frontend.h"
+#include "callbacks_events.h"
+#include "instance_pool.h"
 
 using namespace std;
 
@@ -51,14 +53,25 @@ namespace enigma
   /*------ New iterator system -----------------------------------------------*\
   \*--------------------------------------------------------------------------*/
 
-  set<iterator*> central_iterator_cache;
-  typedef set<iterator*>::iterator central_iterator_cache_iterator;
+  // Every live iterator, so that unlinking an instance can fix up those
+  // parked next to it. The list is intrusive, so that constructing an
+  // iterator costs a few pointer writes instead of a tree node allocation.
+  static iterator *iterator_registry = NULL;
 
   object_basic* iterator::operator*()  const { return it->inst; }
   object_basic* iterator::operator->() const { return it->inst; }
 
   void iterator::addme() {
-    central_iterator_cache.insert(this);
+    reg_prev = NULL;
+    reg_next = iterator_registry;
+    if (reg_next) reg_next->reg_prev = this;
+    iterator_registry = this;
+  }
+
+  void iterator::removeme() {
+    if (reg_prev) reg_prev->reg_next = reg_next;
+    else iterator_registry = reg_next;
+    if (reg_next) reg_next->reg_prev = reg_prev;
   }
 
   void iterator::copy(const iterator& other) {
@@ -138,15 +151,13 @@ namespace enigma
   }
 
   iterator:: ~iterator() {
-    central_iterator_cache.erase(this);
+    removeme();
   }
 
   void update_iterators_for_destroy(const inst_iter* dd)
   {
-    for (central_iterator_cache_iterator it = central_iterator_cache.begin();
-         it != central_iterator_cache.end(); ++it) {
-      (*it)->handle_unlink(dd);
-    }
+    for (iterator *it = iterator_registry; it; it = it->reg_next)
+      it->handle_unlink(dd);
   }
 
 
@@ -196,10 +207,9 @@ namespace enigma
   objectid_base *objects;
 
   // This is the all-inclusive, centralized list of instances.
-  map<int,inst_iter*> instance_list;
-  map<int,object_basic*> instance_deactivated_list;
-  typedef map<int,inst_iter*>::iterator iliter;
-  typedef pair<int,inst_iter*> inode_pair;
+  // Both are indexed directly by id; see instance_table.h.
+  instance_table<inst_iter*> instance_list;
+  instance_table<object_basic*> instance_deactivated_list;
 
 
 
@@ -208,13 +218,14 @@ namespace enigma
   // We also need an iterator for only global.
   inst_iter ENIGMA_global_instance_iterator(ENIGMA_global_instance,0,0);
 
-  // This is basically a garbage collection list for when instances are destroyed
-  set<object_basic*> cleanups; // We'll use set, to prevent stupidity
+  // This is basically a garbage collection list for when instances are destroyed.
+  // Instances are flagged $destroyed when queued, so each is queued once.
+  vector<object_basic*> cleanups;
 
   // It's a good idea to centralize an event iterator so error reporting can tell where it is.
   inst_iter dummy_event_iterator(NULL,NULL,NULL); // For create events and such
-  inst_iter *instance_event_iterator = &dummy_event_iterator; // Not bad for efficiency, either.
-  object_basic *instance_other = NULL;
+  thread_local inst_iter *instance_event_iterator = &dummy_event_iterator; // Not bad for efficiency, either.
+  thread_local object_basic *instance_other = NULL;
 
   temp_event_scope::temp_event_scope(object_basic* ninst)
       : oiter(instance_event_iterator),
@@ -224,6 +235,7 @@ namespace enigma
     instance_other = ninst;
   }
   temp_event_scope::~temp_event_scope() {
+    collision_touch(niter.inst);
     instance_event_iterator = oiter;
     instance_other = prev_other;
   }
@@ -232,8 +244,7 @@ namespace enigma
   // Retrieve the first instance on the complete list.
   iterator instance_list_first()
   {
-    iliter a = instance_list.begin();
-    return a != instance_list.end() ? a->second : NULL;
+    return instance_list.empty() ? NULL : instance_list.get(instance_list.first());
   }
 
   extern size_t object_idmax;
@@ -256,13 +267,13 @@ namespace enigma
     if (x < 100000)
       return size_t(x) < object_idmax ? objects[x].next ? objects[x].next->inst : NULL : NULL;
 
-    iliter a = instance_list.find(x);
-    return a != instance_list.end() ? a->second->inst : NULL;
+    inst_iter *a = instance_list.get(x);
+    return a ? a->inst : NULL;
   }
   object_basic* fetch_instance_by_id(int x)
   {
-    iliter a = instance_list.find(x);
-    return a != instance_list.end() ? a->second->inst : NULL;
+    inst_iter *a = instance_list.get(x);
+    return a ? a->inst : NULL;
   }
 
   iterator fetch_inst_iter_by_int(int x)
@@ -284,16 +295,16 @@ namespace enigma
       return objects[x].next;
 
     // ID-based lookup
-    iliter a = instance_list.find(x);
-    return a != instance_list.end() ? iterator(a->second->inst) : iterator();
+    inst_iter *a = instance_list.get(x);
+    return a ? iterator(a->inst) : iterator();
   }
   iterator fetch_inst_iter_by_id(int x)
   {
     if (x < 100000)
       return iterator();
 
-    iliter a = instance_list.find(x);
-    return a != instance_list.end() ? iterator(a->second->inst) : iterator();
+    inst_iter *a = instance_list.get(x);
+    return a ? iterator(a->inst) : iterator();
   }
 
   iterator fetch_roominst_iter_by_id(int x)
@@ -302,9 +313,8 @@ namespace enigma
       return iterator();
 
     //Check if it's a deactivated instance first.
-    std::map<int,enigma::object_basic*>::iterator rIt = enigma::instance_deactivated_list.find(x);
-    if (rIt!=enigma::instance_deactivated_list.end()) {
-      return iterator(rIt->second);
+    if (object_basic *inst = instance_deactivated_list.get(x)) {
+      return iterator(inst);
     }
 
     //Else, it's still live (or was null). Use normal dispatch.
@@ -313,9 +323,15 @@ namespace enigma
 
   // Implementation for frontend
   // (Wrapper struct to lower compile time)
+  static block_pool &wrapper_pool() {
+    static block_pool *pool = new block_pool(sizeof(int));
+    return *pool;
+  }
   typedef struct winstance_list_iterator {
-    instance_list_iterator w;
-    winstance_list_iterator(instance_list_iterator n): w(n) {}
+    int id;
+    winstance_list_iterator(int n): id(n) {}
+    static void *operator new(size_t) { return wrapper_pool().alloc(); }
+    static void operator delete(void *block) { if (block) wrapper_pool().release(block); }
   } *pinstance_list_iterator;
   void winstance_list_iterator_delete(pinstance_list_iterator whop) {
     delete whop;
@@ -324,29 +340,21 @@ namespace enigma
   //Link in an instance
   pinstance_list_iterator link_instance(object_basic* who)
   {
-    inst_iter *ins = new inst_iter(who);
     enigma_user::instance_id.push_back(who->id);
-    pair<iliter,bool> it = instance_list.insert(inode_pair(who->id,ins));
-    if (!it.second) {
+    inst_iter *ins = new inst_iter(who);
+    if (!instance_list.insert(who->id,ins)) {
       delete ins;
-      return new winstance_list_iterator(it.first);
-    }
-    if (it.first != instance_list.begin())
-    {
-      iliter ib = it.first; ib--; // Find the previous iterator
-      ins->prev = ib->second; // Link this to previous instance
-      ib->second->next = ins; // Link previous instance to this
+      return new winstance_list_iterator(who->id);
     }
-    else ins->prev = NULL; // Found nothing.
 
-    iliter in = it.first; in++; // Find next iterator
-    if (in != instance_list.end())
-    {
-      ins->next = in->second, // Link this to next instance
-      in->second->prev = ins; // Link next to this
-    }
-    else ins->next = NULL;
-    return new winstance_list_iterator(it.first);
+    // The table keeps ids in order; link with the neighbouring instances.
+    const int prev = instance_list.prev(who->id), next = instance_list.next(who->id);
+    ins->prev = prev != -1 ? instance_list.get(prev) : NULL;
+    ins->next = next != -1 ? instance_list.get(next) : NULL;
+    if (ins->prev) ins->prev->next = ins;
+    if (ins->next) ins->next->prev = ins;
+    perform_callbacks_instance_link(who);
+    return new winstance_list_iterator(who->id);
   }
   inst_iter *link_obj_instance(object_basic* who, int oid)
   {
@@ -356,29 +364,31 @@ namespace enigma
 
   void instance_iter_queue_for_destroy(object_basic* inst)
   {
-    enigma::cleanups.insert(inst);
+    if (!inst->$destroyed) {
+      inst->$destroyed = true;
+      enigma::cleanups.push_back(inst);
+    }
     enigma_user::instance_count--;
   }
   void dispose_destroyed_instances()
   {
-    for (set<object_basic*>::iterator i = cleanups.begin(); i != cleanups.end(); i++)
-      delete (*i);
+    for (size_t i = 0; i < cleanups.size(); i++)
+      delete cleanups[i];
     cleanups.clear();
+    allocation_counters_next_frame();
   }
-  void unlink_main(instance_list_iterator who)
+  void unlink_main(int id)
   {
-    inst_iter *a = who->second;
+    inst_iter *a = instance_list.get(id);
+    if (!a) return;
+    perform_callbacks_instance_unlink(a->inst);
     if (a->prev) a->prev->next = a->next;
     if (a->next) a->next->prev = a->prev;
-    instance_list.erase(who);
+    instance_list.erase(id);
     update_iterators_for_destroy(a);
   }
   void unlink_main(pinstance_list_iterator whop)
   {
-    inst_iter *a = whop->w->second;
-    if (a->prev) a->prev->next = a->next;
-    if (a->next) a->next->prev = a->prev;
-    instance_list.erase(whop->w);
-    update_iterators_for_destroy(a);
+    unlink_main(whop->id);
   }
 }
@@ -26,17 +26,18 @@
 #include "Universal_System/Object_Tiers/object.h"
 #include "Universal_System/reflexive_types.h"
 #include "Universal_System/var4.h"
+#include "instance_table.h"
 
 #include <map>
 #include <set>
+#include <vector>
 
 namespace enigma {
 
-typedef std::map<int, inst_iter*>::iterator instance_list_iterator;
-extern std::map<int, inst_iter*> instance_list;
-extern std::map<int, object_basic*> instance_deactivated_list;
-extern std::set<object_basic*> cleanups;
-void unlink_main(instance_list_iterator who);
+extern instance_table<inst_iter*> instance_list;
+extern instance_table<object_basic*> instance_deactivated_list;
+extern std::vector<object_basic*> cleanups;
+void unlink_main(int id);
 
 }  //namespace enigma
 
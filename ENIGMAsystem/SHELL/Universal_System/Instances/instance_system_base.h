@@ -34,6 +34,9 @@ namespace enigma
     //std::deque<inst_iter*>::iterator instance_id_index;
     inst_iter(object_basic* i,inst_iter *n,inst_iter *p);
     inst_iter();
+    // Nodes come from a pool; see instance_pool.h.
+    static void *operator new(size_t size);
+    static void operator delete(void *block, size_t size);
   };
 
   class temp_event_scope
@@ -76,8 +79,13 @@ namespace enigma
   extern objectid_base *objects;
   extern object_basic *ENIGMA_global_instance;
   extern inst_iter dummy_event_iterator;
-  extern inst_iter *instance_event_iterator;
-  extern object_basic *instance_other;
+  // Thread local, so that parallel Step events each have their own.
+  extern thread_local inst_iter *instance_event_iterator;
+  extern thread_local object_basic *instance_other;
+
+  // Queues an instance for rehashing by the collision system's spatial index.
+  void collision_touch(object_basic* inst);
+  void collision_touch_all();
 
   // Stack pusher for iterators in use by with() statements and the like.
   struct iterator_level {
@@ -91,6 +99,7 @@ namespace enigma
     iterator_level(inst_iter* push_to):
         iterator_level(push_to, instance_event_iterator->inst) {}
     ~iterator_level() {
+      if (instance_event_iterator) collision_touch(instance_event_iterator->inst);
       instance_event_iterator = stored_it;
       instance_other = stored_other;
     }
@@ -0,0 +1,154 @@
+/** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_INSTANCE_TABLE_H
+#define ENIGMA_INSTANCE_TABLE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace enigma {
+
+// Table of values keyed by instance id, which also keeps its entries in id
+// order. Ids index pages of slots directly, so lookup, insertion and removal
+// are constant time, except inserting an id below the largest one present,
+// which has to search back for the entry preceding it. Instance ids are
+// handed out in increasing order, so that is rare outside of room loading.
+// Ids must be non-negative; instance ids always are.
+template<typename T> class instance_table {
+  static const int page_bits = 10;
+  static const int page_size = 1 << page_bits;
+
+  struct slot {
+    T value;
+    int prev, next; // Neighbouring ids in the table, or -1
+    bool used;
+  };
+  struct page {
+    slot slots[page_size];
+    int count;
+  };
+
+  std::vector<page*> pages; // Allocated when first used, kept until destruction
+  int head, tail;
+  size_t count;
+
+  slot *find_slot(int id) const {
+    if (id < 0 || size_t(id >> page_bits) >= pages.size()) return NULL;
+    page *p = pages[id >> page_bits];
+    if (!p) return NULL;
+    slot *s = p->slots + (id & (page_size - 1));
+    return s->used ? s : NULL;
+  }
+
+  // Returns the largest id in the table below the given one, or -1.
+  int find_prev(int id) const {
+    if (tail < id) return tail;
+    for (int pg = id >> page_bits, i = (id & (page_size - 1)) - 1; pg >= 0; --pg, i = page_size - 1) {
+      const page *p = pages[pg];
+      if (!p || !p->count) continue;
+      for (; i >= 0; --i)
+        if (p->slots[i].used) return (pg << page_bits) + i;
+    }
+    return -1;
+  }
+
+ public:
+  instance_table(): head(-1), tail(-1), count(0) {}
+  ~instance_table() {
+    for (size_t i = 0; i < pages.size(); ++i)
+      delete pages[i];
+  }
+
+  // Returns a pointer to the value stored for the id, or NULL.
+  T *find(int id) {
+    slot *s = find_slot(id);
+    return s ? &s->value : NULL;
+  }
+  // Returns the value stored for the id, or T() if there is none.
+  T get(int id) const {
+    slot *s = find_slot(id);
+    return s ? s->value : T();
+  }
+  bool contains(int id) const { return find_slot(id); }
+
+  // Adds the id with the given value. Returns false, leaving the table
+  // unchanged, if the id is already present or negative.
+  bool insert(int id, const T &value) {
+    if (id < 0 || find_slot(id)) return false;
+    const size_t pg = id >> page_bits;
+    if (pg >= pages.size()) pages.resize(pg + 1, NULL);
+    if (!pages[pg]) pages[pg] = new page();
+
+    slot &s = pages[pg]->slots[id & (page_size - 1)];
+    s.value = value;
+    s.used = true;
+    s.prev = find_prev(id);
+    s.next = s.prev == -1 ? head : find_slot(s.prev)->next;
+    if (s.prev == -1) head = id; else find_slot(s.prev)->next = id;
+    if (s.next == -1) tail = id; else find_slot(s.next)->prev = id;
+    pages[pg]->count++;
+    count++;
+    return true;
+  }
+
+  // Removes the id. Returns whether it was present.
+  bool erase(int id) {
+    slot *s = find_slot(id);
+    if (!s) return false;
+    if (s->prev == -1) head = s->next; else find_slot(s->prev)->next = s->next;
+    if (s->next == -1) tail = s->prev; else find_slot(s->next)->prev = s->prev;
+    s->used = false;
+    s->value = T();
+    pages[id >> page_bits]->count--;
+    count--;
+    return true;
+  }
+
+  // Removes every id, keeping the pages for reuse.
+  void clear() {
+    for (int id = head; id != -1; ) {
+      slot *s = find_slot(id);
+      const int next = s->next;
+      s->used = false;
+      s->value = T();
+      id = next;
+    }
+    for (size_t i = 0; i < pages.size(); ++i)
+      if (pages[i]) pages[i]->count = 0;
+    head = tail = -1;
+    count = 0;
+  }
+
+  size_t size() const { return count; }
+  bool empty() const { return !count; }
+
+  // Iteration in id order: first() and last() give the smallest and largest
+  // id, next() and prev() the neighbours of an id in the table; -1 when
+  // there is none. Erasing the current id during iteration is allowed as
+  // long as its successor was fetched first.
+  int first() const { return head; }
+  int last()  const { return tail; }
+  int next(int id) const { return find_slot(id)->next; }
+  int prev(int id) const { return find_slot(id)->prev; }
+
+ private:
+  instance_table(const instance_table&);
+  instance_table &operator=(const instance_table&);
+};
+
+} // namespace enigma
+
+#endif // ENIGMA_INSTANCE_TABLE_H
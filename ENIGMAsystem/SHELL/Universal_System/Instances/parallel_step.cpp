@@ -0,0 +1,114 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "parallel_step.h"
+#include "instance_system_base.h"
+
+#include "Universal_System/profiler.h"
+#include "Universal_System/worker_pool.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace enigma {
+
+thread_local parallel_step_context *parallel_step_worker = nullptr;
+extern int maxid;
+
+namespace {
+
+// Instances are shared out this many at a time.
+const size_t kChunkSize = 64;
+
+std::vector<bool> parallel_objects;
+std::vector<object_basic*> claimed;
+// One queue per chunk, so commands are applied in the order of the instances
+// that queued them, however the chunks were shared out.
+std::vector<std::vector<std::function<void()>>> chunk_commands;
+std::mutex id_mutex;
+
+// Steps the instances in one chunk, on whichever thread took it. The main
+// thread takes chunks too, so its iterator is put back after.
+void run_chunk(void (*event)(object_basic*), size_t c) {
+  inst_iter it(nullptr, nullptr, nullptr);
+  inst_iter *const saved_iterator = instance_event_iterator;
+  object_basic *const saved_other = instance_other;
+  instance_event_iterator = &it;
+  parallel_step_context context{nullptr, &chunk_commands[c]};
+  parallel_step_worker = &context;
+  const size_t end = std::min(claimed.size(), (c + 1) * kChunkSize);
+  for (size_t i = c * kChunkSize; i < end; i++) {
+    if (claimed[i]->$destroyed) continue;
+    it.inst = instance_other = context.self = claimed[i];
+    event(claimed[i]);
+  }
+  parallel_step_worker = nullptr;
+  instance_event_iterator = saved_iterator;
+  instance_other = saved_other;
+}
+
+}  // namespace
+
+void parallel_step_set_object(int object_index) {
+  if (size_t(object_index) >= parallel_objects.size()) parallel_objects.resize(object_index + 1);
+  parallel_objects[object_index] = true;
+}
+
+void parallel_step_begin() {
+  claimed.clear();
+}
+
+bool parallel_step_claim(object_basic *inst) {
+  if (size_t(inst->object_index) >= parallel_objects.size() || !parallel_objects[inst->object_index])
+    return false;
+  claimed.push_back(inst);
+  return true;
+}
+
+void parallel_step_run(void (*event)(object_basic *inst)) {
+  if (claimed.empty()) return;
+  const size_t chunks = (claimed.size() + kChunkSize - 1) / kChunkSize;
+  if (chunk_commands.size() < chunks) chunk_commands.resize(chunks);
+
+  // The profiler's tables are not shared safely between threads, so scripts
+  // called from these events go untimed; the batch as a whole is still timed.
+  const bool profiling = profiler_enabled;
+  profiler_enabled = false;
+  run_parallel_jobs(chunks, [event](size_t c) { run_chunk(event, c); });
+  profiler_enabled = profiling;
+
+  for (object_basic *inst : claimed)
+    if (!inst->$destroyed) collision_touch(inst);
+  claimed.clear();
+  for (size_t c = 0; c < chunks; c++) {
+    for (std::function<void()> &command : chunk_commands[c]) command();
+    chunk_commands[c].clear();
+  }
+}
+
+void parallel_step_defer(std::function<void()> command) {
+  if (parallel_step_worker) parallel_step_worker->commands->push_back(std::move(command));
+  else command();
+}
+
+int parallel_step_reserve_id() {
+  std::lock_guard<std::mutex> lock(id_mutex);
+  return maxid++;
+}
+
+}  // namespace enigma
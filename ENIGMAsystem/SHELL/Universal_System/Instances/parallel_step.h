@@ -0,0 +1,78 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+// Parallel Step. The generated event loop runs every other instance's Step as
+// usual, setting aside the instances of objects marked "parallel step", then
+// runs their Step events across a pool of threads once the loop is done.
+// Instances destroyed before their turn are skipped.
+//
+// Marking an object is a promise about its Step event, and the scripts it
+// calls. The promise is not checked:
+//  - It writes only its own locals, and reads nothing that another parallel
+//    Step writes. That rules out collision functions, which read the other
+//    instances. The collision index is updated on the main thread afterward.
+//  - It doesn't use with(). Leaving one touches the collision index.
+//  - With COMPACT_VARIANT, it doesn't make, copy or drop string variables.
+//    Their table is not synchronized. DEBUG_MODE builds stop the game if it does.
+//
+// Some engine state is handled for it:
+//  - Each thread has its own instance_event_iterator and instance_other, which
+//    point at the instance being stepped, as in any Step event.
+//  - instance_create and instance_destroy queue commands, which the main thread
+//    runs once every instance has stepped, in the order the instances were
+//    listed. A created instance's id is reserved at once and returned.
+//  - An asset waiting on a lazy load is loaded on the main thread afterward,
+//    and reads as destroyed until then.
+//  - The profiler is paused. The batch is timed as one call.
+
+#ifndef ENIGMA_PARALLEL_STEP_H
+#define ENIGMA_PARALLEL_STEP_H
+
+#include <functional>
+#include <vector>
+
+namespace enigma {
+
+struct object_basic;
+
+// What a thread running parallel Step events knows about the one it is on.
+struct parallel_step_context {
+  object_basic *self;
+  std::vector<std::function<void()>> *commands;
+};
+
+// The context of the event this thread is running, or NULL on any thread not
+// running parallel Step events.
+extern thread_local parallel_step_context *parallel_step_worker;
+
+// Marks an object for parallel Step; called from the generated event_system_initialize.
+void parallel_step_set_object(int object_index);
+// Forgets the instances set aside by a Step that was cut short by a room change.
+void parallel_step_begin();
+// Sets the instance aside if its object is marked, returning whether it did.
+bool parallel_step_claim(object_basic *inst);
+// Runs the event for each instance set aside, then applies their queued commands.
+void parallel_step_run(void (*event)(object_basic *inst));
+
+// Queues a command to run on the main thread once the parallel Step is over.
+void parallel_step_defer(std::function<void()> command);
+// Hands out an instance id for an instance whose creation is being deferred.
+int parallel_step_reserve_id();
+
+}  // namespace enigma
+
+#endif  // ENIGMA_PARALLEL_STEP_H
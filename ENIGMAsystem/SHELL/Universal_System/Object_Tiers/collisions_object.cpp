@@ -126,17 +126,61 @@ namespace enigma
          return (mask_index >= 0 ? sprite_get_bbox(mask_index) : sprite_get_bbox(sprite_index));
     }
 
-    object_collisions::object_collisions(): object_transform() { 
+    bool collision_tracking = false;
+    std::vector<object_collisions*> collision_dirty_instances;
+
+    void collision_touch(object_basic* inst)
+    {
+        if (!collision_tracking || !inst) return;
+        object_collisions* const ci = (object_collisions*)inst;
+        if (ci->$collision_slot < 0 || ci->$collision_dirty >= 0) return;
+        ci->$collision_dirty = collision_dirty_instances.size();
+        collision_dirty_instances.push_back(ci);
+    }
+
+    bool collision_sweep_pending = false;
+
+    void collision_touch_all()
+    {
+        if (collision_tracking) collision_sweep_pending = true;
+    }
+
+    bool object_collisions::$collision_moved()
+    {
+        collision_placement now;
+        now.x = x, now.y = y;
+        now.xscale = image_xscale, now.yscale = image_yscale, now.angle = image_angle;
+        now.sprite_index = sprite_index, now.mask_index = mask_index, now.polygon_index = polygon_index;
+        now.polygon_xscale = polygon_xscale, now.polygon_yscale = polygon_yscale, now.polygon_angle = polygon_angle;
+        // The sprite's own bbox can change too, with sprite_collision_mask.
+        now.box = (sprite_index != -1 || mask_index != -1) ? $bbox_relative() : BoundingBox();
+
+        const collision_placement& was = $collision_placement;
+        const bool moved = now.x != was.x || now.y != was.y
+            || now.xscale != was.xscale || now.yscale != was.yscale || now.angle != was.angle
+            || now.sprite_index != was.sprite_index || now.mask_index != was.mask_index
+            || now.polygon_index != was.polygon_index || now.polygon_xscale != was.polygon_xscale
+            || now.polygon_yscale != was.polygon_yscale || now.polygon_angle != was.polygon_angle
+            || now.box.x != was.box.x || now.box.y != was.box.y || now.box.w != was.box.w || now.box.h != was.box.h;
+        $collision_placement = now;
+        return moved;
+    }
+
+    object_collisions::object_collisions(): object_transform(), $collision_slot(-1), $collision_dirty(-1), $collision_placement() {
         polygon_index = -1;
         polygon_xscale = polygon_yscale = 1;
         polygon_angle = 0;
     }
 
-    object_collisions::object_collisions(unsigned _id,int _objid): object_transform(_id,_objid) {
+    object_collisions::object_collisions(unsigned _id,int _objid): object_transform(_id,_objid), $collision_slot(-1), $collision_dirty(-1), $collision_placement() {
         polygon_index = -1;
         polygon_xscale = polygon_yscale = 1;
         polygon_angle = 0;
     }
 
-    object_collisions::~object_collisions() {}
+    object_collisions::~object_collisions() {
+        // Don't leave a dangling pointer in the rehash queue.
+        if ($collision_dirty >= 0)
+            collision_dirty_instances[$collision_dirty] = NULL;
+    }
 }
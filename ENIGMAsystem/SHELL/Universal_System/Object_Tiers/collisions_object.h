@@ -37,6 +37,8 @@
 #include "transform_object.h"
 #include "Universal_System/Resources/sprites_internal.h" //bbox_rect
 
+#include <vector>
+
 namespace enigma
 {
   struct object_collisions: object_transform
@@ -65,12 +67,44 @@ namespace enigma
         #define bbox_top    $bbox_top()
         #define bbox_bottom $bbox_bottom()
       #endif
-      
+
+    // Broad-phase bookkeeping, owned by the collision system's spatial index
+      int $collision_slot;  // Entry in the spatial index, or -1 if not indexed
+      int $collision_dirty; // Position in collision_dirty_instances, or -1 if not queued
+      // Everything the bbox is computed from, as of the last $collision_moved() call.
+      struct collision_placement {
+        cs_scalar x, y;
+        gs_scalar xscale, yscale, angle;
+        int sprite_index, mask_index, polygon_index;
+        gs_scalar polygon_xscale, polygon_yscale, polygon_angle;
+        BoundingBox box;
+      } $collision_placement;
+      // Whether the bbox may have changed since the last call; records the current placement.
+      bool $collision_moved();
+
     //Constructors
       object_collisions();
       object_collisions(unsigned, int);
       virtual ~object_collisions();
   };
+
+  // Set by a collision system that keeps a spatial index of instances; while
+  // false, collision_touch is a no-op.
+  extern bool collision_tracking;
+  // Instances whose position, sprite, mask, scale or angle may have changed
+  // since the spatial index last looked at them. Entries may be NULL.
+  extern std::vector<object_collisions*> collision_dirty_instances;
+
+  // Queues an instance to be rehashed before the next collision query. This is
+  // called for the current instance after each event, on leaving a with()
+  // body or event scope, and on dot-access (other.x) of an instance.
+  void collision_touch(object_basic* inst);
+  // Set by collision_touch_all; the next query checks every indexed instance.
+  extern bool collision_sweep_pending;
+  // Has the next collision query check every instance for movement, catching
+  // changes made outside the touch points above. This is called at the start
+  // of each frame and after the engine moves instances on its own (physics).
+  void collision_touch_all();
 } //namespace enigma
 
 #endif //ENIGMA_COLLISIONS_OBJECT_H
@@ -43,9 +43,8 @@ namespace enigma
     #ifdef DEBUG_MODE
       using enigma_user::show_error;
       static inline int DEBUG_ID_CHECK(int id, int objind) {
-        std::map<int, inst_iter*>::iterator it = instance_list.find(id);
-        if (it != instance_list.end()) {
-          DEBUG_MESSAGE("Two instances were given the same ID! Object `" + enigma_user::object_get_name(it->second->inst->object_index)
+        if (inst_iter *it = instance_list.get(id)) {
+          DEBUG_MESSAGE("Two instances were given the same ID! Object `" + enigma_user::object_get_name(it->inst->object_index)
                      + "' and new object `" + enigma_user::object_get_name(objind)
                      + "' both have ID " + toString(id)
                      + "': A new ID has been assigned so the game can continue, but references by this ID may fail."
@@ -73,8 +72,8 @@ namespace enigma
     variant object_basic::myevent_roomend()   { return 0; }
     variant object_basic::myevent_destroy()   { return 0; }
 
-    object_basic::object_basic(): id(-4), object_index(-4) {}
-    object_basic::object_basic(int uid, int uoid): id(DEBUG_ID_CHECK(uid, uoid)), object_index(uoid) {}
+    object_basic::object_basic(): id(-4), object_index(-4), $destroyed(false) {}
+    object_basic::object_basic(int uid, int uoid): id(DEBUG_ID_CHECK(uid, uoid)), object_index(uoid), $destroyed(false) {}
     object_basic::~object_basic() {}
     bool object_basic::can_cast(int obj) const { return false; }
 
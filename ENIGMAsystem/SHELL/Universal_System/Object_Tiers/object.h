@@ -62,6 +62,7 @@ namespace enigma
     {
       const unsigned id;
       const int object_index;
+      bool $destroyed; // Queued for deletion; see instance_iter_queue_for_destroy
 
       virtual void unlink();
       virtual void deactivate();
@@ -18,6 +18,8 @@
 #ifndef E_ASSET_ARRAY
 #define E_ASSET_ARRAY
 
+#include "Universal_System/Instances/parallel_step.h"
+
 #include <vector>
 #include <string>
 #include <utility>
@@ -101,6 +103,10 @@ template<typename T> class OffsetVector<T, 0> {
 };
 
 // Asset storage container designed for dense cache-efficient resource processing.
+// Assets may be deferred: they exist, but are only loaded once first fetched
+// or explicitly loaded, by a loader that assigns them. Loaders may create
+// textures, so get, operator[] and duplicate can do GPU work, and they only
+// load on the main thread; see load.
 template<typename T, int LEFT = 0>
 class AssetArray {
  public:
@@ -131,6 +137,7 @@ class AssetArray {
   }
 
   int assign(int id, T&& asset) {
+    if (pending(id)) pending_[id] = false;
     if (exists(id)) assets_[id].destroy();
     else {
       #ifdef DEBUG_MODE
@@ -147,12 +154,14 @@ class AssetArray {
 
   T& get(int id) {
     static T sentinel;
+    load(id);
     CHECK_ID(id,sentinel);
     return assets_[id];
   }
   
   const T& get(int id) const {
     static T sentinel;
+    load(id);
     CHECK_ID(id,sentinel);
     return assets_[id];
   }
@@ -161,17 +170,20 @@ class AssetArray {
   // only used in rare cases where you
   // already know the asset exists
   T& operator[](int id) {
+    load(id);
     return assets_[id];
   }
 
   int replace(int id, T&& asset) {
     CHECK_ID(id, -1);
+    if (pending(id)) pending_[id] = false;
     assets_[id].destroy();
     assets_[id] = std::move(asset);
     return id;
   }
 
   int duplicate(int id) {
+    load(id);
     CHECK_ID(id, -1);
     T asset = assets_[id];
     return add(std::move(asset));
@@ -179,12 +191,13 @@ class AssetArray {
 
   void destroy(int id) {
     CHECK_ID_V(id);
+    if (pending(id)) pending_[id] = false;
     auto& asset = assets_[id];
     asset.destroy();
   }
 
   size_t size() const { return assets_.size(); }
-  bool exists(int id) const { return (id >= 0 && size_t(id) < size() && !assets_[id].isDestroyed()); }
+  bool exists(int id) const { return (id >= 0 && size_t(id) < size() && (pending(id) || !assets_[id].isDestroyed())); }
 
   T* data() { return assets_.data(); }
 
@@ -192,8 +205,41 @@ class AssetArray {
     assets_.resize(count);
   }
 
+  void set_loader(void (*loader)(int id)) { loader_ = loader; }
+
+  // Marks the asset as existing, to be loaded when first needed.
+  void defer(int id) {
+    if (size_t(id) >= size()) assets_.resize(size_t(id) + 1);
+    if (size_t(id) >= pending_.size()) pending_.resize(size_t(id) + 1);
+    assets_[id].destroy();  // Should loading fail, it stays that way.
+    pending_[id] = true;
+  }
+
+  bool pending(int id) const { return size_t(id) < pending_.size() && pending_[id]; }
+
+  // Loads the asset now if it was deferred. A parallel Step worker can't
+  // make textures, so there the load is left to the main thread once the
+  // Step is over, and until then the asset reads as destroyed.
+  void load(int id) const {
+    if (!pending(id)) return;
+    if (parallel_step_worker) {
+      parallel_step_defer([this, id]() {
+        #ifdef DEBUG_MODE
+        if (pending(id))
+          DEBUG_MESSAGE((std::string)T::getAssetTypeName() + " asset " + std::to_string(id) + " was first used in a parallel Step event, which can't load it.", MESSAGE_TYPE::M_WARNING);
+        #endif
+        load(id);
+      });
+      return;
+    }
+    pending_[id] = false;
+    loader_(id);
+  }
+
  private:
   OffsetVector<T, LEFT> assets_;
+  mutable std::vector<bool> pending_;
+  void (*loader_)(int id) = nullptr;
 };
 
 } // namespace enigma
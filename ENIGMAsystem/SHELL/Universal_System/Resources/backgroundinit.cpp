@@ -19,84 +19,154 @@
 #include "backgrounds_internal.h"
 #include "libEGMstd.h"
 #include "resinit.h"
-#include "Universal_System/zlib.h"
 #include "Universal_System/image_formats.h"
 #include "Universal_System/nlpo2.h"
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Widget_Systems/widgets_mandatory.h"
 #include "Platforms/platforms_mandatory.h"
-#include "Platforms/General/fileio.h"
+#include "resource_block.h"
+#include "texture_pages.h"
 
 #include <cstring>
+#include <vector>
 
 namespace enigma
 {
-  void exe_loadbackgrounds(FILE_t *exe)
+  namespace {
+    struct BackgroundData {
+      unsigned bkgid, width, height, useAsTileset, tileWidth, tileHeight, hOffset, vOffset, hSep, vSep;
+      int page;  // -1 for backgrounds with their own texture
+      unsigned x, y;
+      const unsigned char* packed;
+      unsigned size;
+      int codec, unpacked;
+      unsigned char* pixels;
+      bool decoded;
+    };
+
+    // Reads the backgrounds that follow, stopping at the first that is cut off.
+    void read_backgrounds(ResourceReader &exe, int bkgcount, std::vector<BackgroundData> &bkgs)
+    {
+      unsigned transparent,smoothEdges,preload;
+      for (int i = 0; i < bkgcount; i++)
+      {
+        BackgroundData bd = {};
+        if (!exe.read(&bd.bkgid, 4)) return;
+        if (!exe.read(&bd.width, 4)) return;
+        if (!exe.read(&bd.height,4)) return;
+        if (!exe.read(&transparent,4)) return;
+        if (!exe.read(&smoothEdges,4)) return;
+        if (!exe.read(&preload,4)) return;
+        if (!exe.read(&bd.useAsTileset,4)) return;
+        if (!exe.read(&bd.tileWidth,4)) return;
+        if (!exe.read(&bd.tileHeight,4)) return;
+        if (!exe.read(&bd.hOffset,4)) return;
+        if (!exe.read(&bd.vOffset,4)) return;
+        if (!exe.read(&bd.hSep,4)) return;
+        if (!exe.read(&bd.vSep,4)) return;
+
+        bd.unpacked = bd.width*bd.height*4;
+
+        if (!exe.read(&bd.page,4)) return;
+        if (bd.page >= 0) {
+          if (!exe.read(&bd.x,4) || !exe.read(&bd.y,4)) return;
+          bkgs.push_back(bd);
+          continue;
+        }
+        if (!exe.read(&bd.codec,4)) return;
+        if (!exe.read(&bd.size,4)) return;
+        if (!(bd.packed = exe.take(bd.size))) {
+          DEBUG_MESSAGE("Failed to load background: Data is truncated before exe end. Read " + enigma_user::toString(exe.remaining()) + " out of expected " + enigma_user::toString(bd.size), MESSAGE_TYPE::M_ERROR);
+          return;
+        }
+        bkgs.push_back(bd);
+      }
+    }
+  }
+
+  namespace {
+    // Inflates the backgrounds across the worker pool, then makes their
+    // textures and assigns them on this thread.
+    void build_backgrounds(std::vector<BackgroundData> &bkgs)
+    {
+      run_resource_jobs(bkgs.size(), [&bkgs](size_t i) {
+        BackgroundData& bd = bkgs[i];
+        if (bd.page >= 0) return;
+        bd.pixels = new unsigned char[bd.unpacked+1];
+        bd.decoded = resource_decode(bd.codec, bd.packed, bd.size, bd.pixels, bd.unpacked);
+      });
+
+      for (BackgroundData& bd : bkgs)
+      {
+        if (bd.page >= 0)
+        {
+          if (size_t(bd.page) >= texture_pages.size() || texture_pages[bd.page].texture < 0)
+          {
+            DEBUG_MESSAGE("Background load error: Texture page missing", MESSAGE_TYPE::M_ERROR);
+            continue;
+          }
+          const TexturePage& tp = texture_pages[bd.page];
+          Background bkg(bd.width, bd.height, tp.width, tp.height, tp.texture, bd.useAsTileset, bd.tileWidth, bd.tileHeight, bd.hOffset, bd.vOffset, bd.hSep, bd.vSep);
+          bkg.textureBounds = texture_page_rect(bd.page, bd.x, bd.y, bd.width, bd.height);
+          backgrounds.assign(bd.bkgid, std::move(bkg));
+          continue;
+        }
+        if (!bd.decoded)
+        {
+          DEBUG_MESSAGE("Background load error: Background does not match expected size", MESSAGE_TYPE::M_ERROR);
+          delete[] bd.pixels;
+          continue;
+        }
+
+        unsigned fw, fh;
+        int texID = graphics_create_texture(RawImage(bd.pixels, bd.width, bd.height), false, &fw, &fh);
+        Background bkg(bd.width, bd.height, fw, fh, texID, bd.useAsTileset, bd.tileWidth, bd.tileHeight, bd.hOffset, bd.vOffset, bd.hSep, bd.vSep);
+        backgrounds.assign(bd.bkgid, std::move(bkg));
+      }
+    }
+  }
+
+  void exe_loadbackgrounds(ResourceReader &exe)
   {
     int nullhere;
-    unsigned bkgid, width, height,transparent,smoothEdges,preload,useAsTileset,tileWidth,tileHeight,hOffset,vOffset,hSep,vSep;
 
-    if (!fread_wrapper(&nullhere, 4, 1, exe)) return;
+    if (!exe.read(&nullhere, 4)) return;
     if (memcmp(&nullhere, "BKG ", sizeof(int)) != 0) return;
 
     // Determine how many backgrounds we have
     int bkgcount;
-    if (!fread_wrapper(&bkgcount,4,1,exe))
+    if (!exe.read(&bkgcount,4))
       return;
 
     // Fetch the highest ID we will be using
     int bkg_highid;
-    if (!fread_wrapper(&bkg_highid,4,1,exe))
+    if (!exe.read(&bkg_highid,4))
       return;
     
     if (bkgcount == 0) return;
     backgrounds.resize(bkg_highid+1);
 
-    for (int i = 0; i < bkgcount; i++)
-    {
-      int unpacked;
-      if (!fread_wrapper(&bkgid, 4,1,exe)) return;
-      if (!fread_wrapper(&width, 4,1,exe)) return;
-      if (!fread_wrapper(&height,4,1,exe)) return;
-      if (!fread_wrapper(&transparent,4,1,exe)) return;
-      if (!fread_wrapper(&smoothEdges,4,1,exe)) return;
-      if (!fread_wrapper(&preload,4,1,exe)) return;
-      if (!fread_wrapper(&useAsTileset,4,1,exe)) return;
-      if (!fread_wrapper(&tileWidth,4,1,exe)) return;
-      if (!fread_wrapper(&tileHeight,4,1,exe)) return;
-      if (!fread_wrapper(&hOffset,4,1,exe)) return;
-      if (!fread_wrapper(&vOffset,4,1,exe)) return;
-      if (!fread_wrapper(&hSep,4,1,exe)) return;
-      if (!fread_wrapper(&vSep,4,1,exe)) return;
-
-      unpacked = width*height*4;
-
-      unsigned int size;
-      if (!fread_wrapper(&size,4,1,exe)){};
-      
-      unsigned char* cpixels=new unsigned char[size+1];
-      if (!cpixels)
-      {
-        DEBUG_MESSAGE("Failed to load background: Cannot allocate enough memory " + enigma_user::toString(unpacked), MESSAGE_TYPE::M_ERROR);
-        break;
-      }
-      unsigned int sz2=fread_wrapper(cpixels,1,size,exe);
-      if (size!=sz2) {
-        DEBUG_MESSAGE("Failed to load background: Data is truncated before exe end. Read " + enigma_user::toString(sz2) + " out of expected " + enigma_user::toString(size), MESSAGE_TYPE::M_ERROR);
-        return;
-      }
-      unsigned char* pixels=new unsigned char[unpacked+1];
-      if (zlib_decompress(cpixels,size,unpacked,pixels) != unpacked)
-      {
-        DEBUG_MESSAGE("Background load error: Background does not match expected size", MESSAGE_TYPE::M_ERROR);
-        continue;
-      }
-      delete[] cpixels;
+    // Inflate them all at once; only the textures have to be made on this thread.
+    std::vector<BackgroundData> bkgs;
+    read_backgrounds(exe, bkgcount, bkgs);
 
-      unsigned fw, fh;
-      int texID = graphics_create_texture(RawImage(pixels, width, height), false, &fw, &fh);
-      Background bkg(width, height, fw, fh, texID, useAsTileset, tileWidth, tileHeight, hOffset, vOffset, hSep, vSep);
-      backgrounds.assign(bkgid, std::move(bkg));
+    if (game_resource_index.flags() & resource_format::INDEX_LAZY) {
+      backgrounds.set_loader([](int id) { load_backgrounds({id}); });
+      for (const BackgroundData& bd : bkgs) backgrounds.defer(bd.bkgid);
+      return;
+    }
+    build_backgrounds(bkgs);
+  }
+
+  void load_backgrounds(const std::vector<int> &ids)
+  {
+    std::vector<BackgroundData> bkgs;
+    for (int id : ids) {
+      const ResourceRecord* record = game_resource_index.find(resource_format::kind("BKG "), id);
+      if (!record) continue;
+      ResourceReader exe = game_resources.reader(record->offset, record->size);
+      read_backgrounds(exe, 1, bkgs);
     }
+    build_backgrounds(bkgs);
   }
 } //namespace enigma
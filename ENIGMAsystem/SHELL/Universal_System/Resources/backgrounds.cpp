@@ -18,6 +18,7 @@
 **/
 
 #include "backgrounds_internal.h"
+#include "texture_pages.h"
 #include "Universal_System/image_formats.h"
 #include "Universal_System/nlpo2.h"
 #include "Graphics_Systems/General/GScolor_macros.h"
@@ -95,7 +96,7 @@ void background_save(int back, std::string fname) {
   
   unsigned w, h;
   unsigned char* rgbdata =
-      enigma::graphics_copy_texture_pixels(bkg.textureID, &w, &h);
+      enigma::texture_page_copy_pixels(bkg.textureID, bkg.textureBounds, &w, &h);
 
   enigma::image_save(fname, rgbdata, bkg.width, bkg.height, w, h, false);
 
@@ -121,9 +122,15 @@ bool background_exists(int back) {
   return backgrounds.exists(back);
 }
 
+void background_prefetch(int back) {
+  backgrounds.load(back);
+}
+
 // FIXME: free_texture unused
 void background_set_alpha_from_background(int back, int copy_background, bool free_texture) {
-  enigma::graphics_replace_texture_alpha_from_texture(backgrounds.get(back).textureID, backgrounds.get(copy_background).textureID);
+  enigma::Background& bkg = backgrounds.get(back);
+  const enigma::Background& copy = backgrounds.get(copy_background);
+  enigma::texture_page_replace_alpha(bkg.textureID, bkg.textureBounds, copy.textureID, copy.textureBounds);
 }
 
 int background_get_texture(int back) {
@@ -10,6 +10,7 @@ void background_delete(int back, bool free_texture = true);
 int background_duplicate(int back);
 void background_assign(int back, int copy_background, bool free_texture = true);
 bool background_exists(int back);
+void background_prefetch(int back);  // Loads the background now if the game defers it
 void background_set_alpha_from_background(int back, int copy_background, bool free_texture = true);
 int background_get_texture(int backId);
 int background_get_width(int backId);
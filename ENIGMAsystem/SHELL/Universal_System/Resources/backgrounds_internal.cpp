@@ -1,4 +1,5 @@
 #include "backgrounds_internal.h"
+#include "texture_pages.h"
 #include "Graphics_Systems/graphics_mandatory.h"
 
 namespace enigma {
@@ -9,13 +10,13 @@ Background::Background(const Background& b, bool duplicateTexture) {
   width = b.width;
   height = b.height;
   
-  if (duplicateTexture && b.textureID != -1) {
+  textureID = b.textureID;
+  textureBounds = b.textureBounds;
+  // A copy of an image on a page gets a texture of just that image.
+  if (duplicateTexture && textureID != -1 && !texture_page_detach(textureID, textureBounds)) {
     textureID = enigma::graphics_duplicate_texture(b.textureID);
-  } else {
-    textureID = b.textureID;
   }
   
-  textureBounds = b.textureBounds;
   isTileset = b.isTileset;
   tileWidth = b.tileWidth;
   tileHeight = b.tileHeight;
@@ -26,7 +27,7 @@ Background::Background(const Background& b, bool duplicateTexture) {
 }
 
 void Background::FreeTexture() {
-  enigma::graphics_delete_texture(textureID);
+  if (!texture_is_page(textureID)) enigma::graphics_delete_texture(textureID);
   textureID = -1;
 }
 
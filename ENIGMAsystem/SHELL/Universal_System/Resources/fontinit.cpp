@@ -26,22 +26,21 @@
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Platforms/platforms_mandatory.h"
 #include "Widget_Systems/widgets_mandatory.h"
-#include "Platforms/General/fileio.h"
 
 #include <cstring>
 #include <string>
 
 namespace enigma {
 
-void exe_loadfonts(FILE_t* exe) {
+void exe_loadfonts(ResourceReader& exe) {
   int nullhere, fntid;
   unsigned fontcount, twid, thgt, gwid, ghgt;
   float advance, baseline, origin, gtx, gty, gtx2, gty2;
 
-  if (!fread_wrapper(&nullhere, 4, 1, exe)) return;
+  if (!exe.read(&nullhere, 4)) return;
   if (memcmp(&nullhere, "FNT ", sizeof(int)) != 0) return;
 
-  if (!fread_wrapper(&fontcount, 4, 1, exe)) return;
+  if (!exe.read(&fontcount, 4)) return;
   if ((int)fontcount != rawfontcount) {
     DEBUG_MESSAGE("Resource data does not match up with game metrics. Unable to improvise.", MESSAGE_TYPE::M_ERROR);
     return;
@@ -51,9 +50,9 @@ void exe_loadfonts(FILE_t* exe) {
 
   for (int rf = 0; rf < rawfontcount; rf++) {
     // int unpacked;
-    if (!fread_wrapper(&fntid, 4, 1, exe)) return;
-    if (!fread_wrapper(&twid, 4, 1, exe)) return;
-    if (!fread_wrapper(&thgt, 4, 1, exe)) return;
+    if (!exe.read(&fntid, 4)) return;
+    if (!exe.read(&twid, 4)) return;
+    if (!exe.read(&thgt, 4)) return;
 
     SpriteFont font;
 
@@ -66,15 +65,14 @@ void exe_loadfonts(FILE_t* exe) {
     font.height = 0;
 
     const unsigned int size = twid * thgt;
-    unsigned char* mono = new unsigned char[size];
-    if (!fread_wrapper(&mono[0], sizeof(char), size, exe)) return;
-    
-    unsigned char* pixels = mono_to_rgba(mono, twid, thgt);
-    delete[] mono;
+    const unsigned char* mono = exe.take(size);
+    if (!mono) return;
 
-    if (!fread_wrapper(&nullhere, 4, 1, exe)) return;
+    unsigned char* pixels = mono_to_rgba(const_cast<unsigned char*>(mono), twid, thgt);
+
+    if (!exe.read(&nullhere, 4)) return;
     if (memcmp(&nullhere, "done", sizeof(int)) != 0) {
-      DEBUG_MESSAGE(std::string("Unexpected end; eof: ") + ((feof_wrapper(exe) == 0) ? "true" : "false"), MESSAGE_TYPE::M_ERROR);
+      DEBUG_MESSAGE(std::string("Unexpected end; eof: ") + (exe.remaining() ? "false" : "true"), MESSAGE_TYPE::M_ERROR);
       return;
     }
 
@@ -83,21 +81,21 @@ void exe_loadfonts(FILE_t* exe) {
       fontglyphrange fgr;
 
       unsigned strt, cnt;
-      if (!fread_wrapper(&strt, 4, 1, exe)) return;
-      if (!fread_wrapper(&cnt, 4, 1, exe)) return;
+      if (!exe.read(&strt, 4)) return;
+      if (!exe.read(&cnt, 4)) return;
 
       fgr.glyphstart = strt;
 
       for (unsigned gi = 0; gi < cnt; gi++) {
-        if (!fread_wrapper(&advance, 4, 1, exe)) return;
-        if (!fread_wrapper(&baseline, 4, 1, exe)) return;
-        if (!fread_wrapper(&origin, 4, 1, exe)) return;
-        if (!fread_wrapper(&gwid, 4, 1, exe)) return;
-        if (!fread_wrapper(&ghgt, 4, 1, exe)) return;
-        if (!fread_wrapper(&gtx, 4, 1, exe)) return;
-        if (!fread_wrapper(&gty, 4, 1, exe)) return;
-        if (!fread_wrapper(&gtx2, 4, 1, exe)) return;
-        if (!fread_wrapper(&gty2, 4, 1, exe)) return;
+        if (!exe.read(&advance, 4)) return;
+        if (!exe.read(&baseline, 4)) return;
+        if (!exe.read(&origin, 4)) return;
+        if (!exe.read(&gwid, 4)) return;
+        if (!exe.read(&ghgt, 4)) return;
+        if (!exe.read(&gtx, 4)) return;
+        if (!exe.read(&gty, 4)) return;
+        if (!exe.read(&gtx2, 4)) return;
+        if (!exe.read(&gty2, 4)) return;
         fontglyph fg;
 
         fg.x = round(origin);
@@ -128,7 +126,7 @@ void exe_loadfonts(FILE_t* exe) {
 
     sprite_fonts[fntid] = std::move(font);
 
-    if (!fread_wrapper(&nullhere, 4, 1, exe)) return;
+    if (!exe.read(&nullhere, 4)) return;
     if (memcmp(&nullhere, "endf", sizeof(int)) != 0) return;
   }
 }
@@ -18,6 +18,7 @@
 **/
 
 #include "sprites_internal.h"
+#include "texture_pages.h"
 #include "fonts_internal.h"
 #include "rectpacker/rectpack.h"
 #include "Universal_System/image_formats.h"
@@ -79,12 +80,12 @@ namespace enigma
       {
         fontglyph fg;
         unsigned fw, fh;
-        unsigned char* data = graphics_copy_texture_pixels(sspr.GetTexture(i), &fw, &fh);
+        unsigned char* data = texture_page_copy_pixels(sspr.GetTexture(i), sspr.GetTextureRect(i), &fw, &fh);
         //NOTE: Following line replaced gtw = int((double)sspr.width / sspr.texturewarray[i]);
         //this was to fix non-power of two subimages
         //NTOE2: The commented out code was actually wrong - the width was divided by y instead of x. That is why it only worked with power of two.
-        gtw = int((double)sspr.width / sspr.GetTextureRect(i).w);
-        //gtw = fw;
+        //NOTE3: fw is the row width of data, which for a subimage on a texture page is not the page's width.
+        gtw = fw;
         glyphdata[i] = data;
 
         // Here we calculate the bbox
@@ -17,6 +17,7 @@
 **/
 
 #include "resinit.h"
+#include "texture_pages.h"
 #include "sprites_internal.h"
 #include "backgrounds_internal.h"
 #include "Universal_System/roomsystem.h"
@@ -28,9 +29,12 @@
 #include "Audio_Systems/audio_mandatory.h"
 #include "Widget_Systems/widgets_mandatory.h"
 #include "Graphics_Systems/graphics_mandatory.h"
+#include "Collision_Systems/collision_mandatory.h"
 #include "Platforms/General/fileio.h"
 
+#include <chrono>
 #include <ctime>
+#include <string>
 
 namespace enigma_user
 {
@@ -47,6 +51,21 @@ namespace enigma
   extern int game_settings_initialize();
   extern void extensions_initialize();
 
+  namespace {
+    // Logs the time each stage of resource loading took.
+    class StartupTimer {
+      std::chrono::steady_clock::time_point last_ = std::chrono::steady_clock::now();
+
+     public:
+      void lap(const char* stage) {
+        const auto now = std::chrono::steady_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(now - last_).count();
+        DEBUG_MESSAGE(std::string(stage) + " in " + std::to_string(ms) + "ms", MESSAGE_TYPE::M_INFO);
+        last_ = now;
+      }
+    };
+  }
+
   //This is like main(), only cross-api
   int initialize_everything()
   {
@@ -65,6 +84,7 @@ namespace enigma
     #endif
 
     event_system_initialize();
+    collision_system_initialize();
     timeline_system_initialize();
     input_initialize();
     widget_system_initialize();
@@ -85,33 +105,49 @@ namespace enigma
           break;
         }
       }
-      int nullhere;
-      // Read the magic number so we know we're looking at our own data
-      fseek_wrapper(resfile,-8,SEEK_END);
-      char str_quad[4];
-      if (!fread_wrapper(str_quad,4,1,resfile) or str_quad[0] != 'r' or str_quad[1] != 'e' or str_quad[2] != 's' or str_quad[3] != '0') {
+
+      StartupTimer timer;
+      const bool found = game_resources.open(resfile);
+      fclose_wrapper(resfile);
+      if (!found) {
         DEBUG_MESSAGE("No resource data in exe", MESSAGE_TYPE::M_ERROR);
         break;
       }
+      timer.lap("Mapped resource data");
 
-      // Get where our resources are located in the module
-      int pos;
-      if (!fread_wrapper(&pos,4,1,resfile)) break;
+      if (const size_t index = game_resources.index_offset()) {
+        const size_t size = game_resources.reader().remaining();
+        if (!game_resource_index.read(game_resources.reader(index, size - index)))
+          DEBUG_MESSAGE("Resource index is corrupt; loading everything now", MESSAGE_TYPE::M_WARNING);
+      }
 
-      // Go to the start of the resource data
-      fseek_wrapper(resfile,pos,SEEK_SET);
-      if (!fread_wrapper(&nullhere,4,1,resfile)) break;
+      ResourceReader exe = game_resources.reader();
+      int nullhere;
+      if (!exe.read(&nullhere,4)) break;
       if(nullhere) break;
 
-      enigma::exe_loadsprs(resfile);
-      enigma::exe_loadsounds(resfile);
-      enigma::exe_loadbackgrounds(resfile);
-      enigma::exe_loadfonts(resfile);
+      enigma::exe_loadtexpages(exe);
+      timer.lap("Loaded texture pages");
+      enigma::exe_loadsprs(exe);
+      timer.lap("Loaded sprites");
+      enigma::exe_loadsounds(exe);
+      timer.lap("Loaded sounds");
+      enigma::exe_loadbackgrounds(exe);
+      timer.lap("Loaded backgrounds");
+      enigma::exe_loadfonts(exe);
+      timer.lap("Loaded fonts");
       #ifdef PATH_EXT_SET
-      enigma::exe_loadpaths(resfile);
+      enigma::exe_loadpaths(exe);
+      timer.lap("Loaded paths");
       #endif
 
-      fclose_wrapper(resfile);
+      texture_pages_release();
+
+      // Deferred sprites and backgrounds are read from the data later on.
+      if (!(game_resource_index.flags() & resource_format::INDEX_LAZY)) {
+        texture_pages_drop_packed();
+        game_resources.close();
+      }
     } while (false);
 
     //Load object struct
@@ -142,4 +178,18 @@ namespace enigma
 
     return 0;
   }
+
+  void resources_prefetch_room(int room)
+  {
+    std::vector<int> sprs, bkgs;
+    for (const auto& asset : game_resource_index.room_assets(room)) {
+      if (asset.first == resource_format::kind("SPR ")) {
+        if (sprites.pending(asset.second)) sprs.push_back(asset.second);
+      } else if (asset.first == resource_format::kind("BKG ")) {
+        if (backgrounds.pending(asset.second)) bkgs.push_back(asset.second);
+      }
+    }
+    if (!sprs.empty()) load_sprites(sprs);
+    if (!bkgs.empty()) load_backgrounds(bkgs);
+  }
 } //namespace enigma
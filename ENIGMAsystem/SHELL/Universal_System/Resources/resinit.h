@@ -32,16 +32,26 @@
 #ifndef ENIGMA_RESINIT_H
 #define ENIGMA_RESINIT_H
 
-#include "Platforms/General/fileio.h"
+#include "resource_block.h"
+
+#include <vector>
 
 namespace enigma 
 {
 
-void exe_loadsprs(FILE_t* exe);
-void exe_loadsounds(FILE_t* exe);
-void exe_loadbackgrounds(FILE_t* exe);
-void exe_loadfonts(FILE_t* exe);
-void exe_loadpaths(FILE_t* exe);
+void exe_loadtexpages(ResourceReader& exe);
+void exe_loadsprs(ResourceReader& exe);
+void exe_loadsounds(ResourceReader& exe);
+void exe_loadbackgrounds(ResourceReader& exe);
+void exe_loadfonts(ResourceReader& exe);
+void exe_loadpaths(ResourceReader& exe);
+
+// Load the given sprites and backgrounds from the indexed resource data now,
+// inflating them in parallel. Used when the game defers them.
+void load_sprites(const std::vector<int>& ids);
+void load_backgrounds(const std::vector<int>& ids);
+// Loads what the room uses of the deferred sprites and backgrounds.
+void resources_prefetch_room(int room);
 
 } //namespace enigma
 
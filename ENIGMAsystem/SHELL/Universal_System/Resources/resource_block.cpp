@@ -0,0 +1,133 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "resource_block.h"
+#include "Universal_System/zlib.h"
+#include "lz4/lz4block.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace enigma {
+
+ResourceBlock::~ResourceBlock() {
+  close();
+}
+
+void ResourceBlock::close() {
+  if (map_) funmap_wrapper(map_, map_size_);
+  map_ = nullptr;
+  buffer_ = std::vector<unsigned char>();
+  data_ = nullptr;
+  size_ = index_offset_ = 0;
+}
+
+bool ResourceBlock::open(FILE_t* file) {
+  // The data ends with where the index is, the magic number and where the data starts.
+  char str_quad[4];
+  int index, pos;
+  if (fseek_wrapper(file, -12, SEEK_END) < 0) return false;
+  const int64_t end = ftell_wrapper(file);
+  if (!fread_wrapper(&index, 4, 1, file)) return false;
+  if (!fread_wrapper(str_quad, 4, 1, file) or memcmp(str_quad, "res0", 4) != 0) return false;
+  if (!fread_wrapper(&pos, 4, 1, file) or pos < 0 or pos > end) return false;
+  size_ = end - pos;
+  index_offset_ = index > 0 && size_t(index) < size_ ? index : 0;
+
+  size_t length;
+  if ((map_ = fmap_wrapper(file, &length))) {
+    map_size_ = length;
+    if (size_t(end) > length) return false;
+    data_ = static_cast<const unsigned char*>(map_) + pos;
+    return true;
+  }
+
+  buffer_.resize(size_);
+  fseek_wrapper(file, pos, SEEK_SET);
+  if (fread_wrapper(buffer_.data(), 1, size_, file) != size_) return false;
+  data_ = buffer_.data();
+  return true;
+}
+
+bool ResourceIndex::read(ResourceReader exe) {
+  int magic, count;
+  if (!exe.read(&magic, 4) or magic != resource_format::kind("IDX ")) return false;
+  if (!exe.read(&flags_, 4) or !exe.read(&count, 4)) return false;
+  for (int i = 0; i < count; i++) {
+    int kind, id;
+    ResourceRecord record;
+    if (!exe.read(&kind, 4) or !exe.read(&id, 4)) return false;
+    if (!exe.read(&record.offset, 4) or !exe.read(&record.size, 4) or !exe.read(&record.codec, 4)) return false;
+    records_[key(kind, id)] = record;
+  }
+  if (!exe.read(&count, 4)) return false;
+  for (int i = 0; i < count; i++) {
+    int room, assets;
+    if (!exe.read(&room, 4) or !exe.read(&assets, 4)) return false;
+    std::vector<std::pair<int, int>>& list = rooms_[room];
+    for (int a = 0; a < assets; a++) {
+      int kind, id;
+      if (!exe.read(&kind, 4) or !exe.read(&id, 4)) return false;
+      list.push_back(std::make_pair(kind, id));
+    }
+  }
+  return true;
+}
+
+const ResourceRecord* ResourceIndex::find(int kind, int id) const {
+  auto it = records_.find(key(kind, id));
+  return it == records_.end() ? nullptr : &it->second;
+}
+
+const std::vector<std::pair<int, int>>& ResourceIndex::room_assets(int room) const {
+  static const std::vector<std::pair<int, int>> none;
+  auto it = rooms_.find(room);
+  return it == rooms_.end() ? none : it->second;
+}
+
+ResourceBlock game_resources;
+ResourceIndex game_resource_index;
+
+bool resource_decode(int codec, const unsigned char* src, size_t size, unsigned char* dst, size_t unpacked) {
+  switch (codec) {
+    case resource_format::CODEC_RAW:
+      if (size != unpacked) return false;
+      memcpy(dst, src, size);
+      return true;
+    case resource_format::CODEC_ZLIB:
+      return zlib_decompress(const_cast<unsigned char*>(src), size, unpacked, dst) == int(unpacked);
+    case resource_format::CODEC_LZ4:
+      return lz4::decompress(src, size, dst, unpacked) == long(unpacked);
+  }
+  return false;
+}
+
+void run_resource_jobs(size_t count, const std::function<void(size_t)>& job) {
+  const size_t threads = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count);
+  std::atomic<size_t> next(0);
+  auto work = [&]() {
+    for (size_t i; (i = next++) < count; ) job(i);
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; ++t) workers.push_back(std::thread(work));
+  work();
+  for (std::thread& worker : workers) worker.join();
+}
+
+} //namespace enigma
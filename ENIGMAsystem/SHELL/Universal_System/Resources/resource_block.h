@@ -0,0 +1,135 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifdef INCLUDED_FROM_SHELLMAIN
+#  error This file includes non-ENIGMA STL headers and should not be included from SHELLmain.
+#endif
+
+#ifndef ENIGMA_RESOURCE_BLOCK_H
+#define ENIGMA_RESOURCE_BLOCK_H
+
+#include "Platforms/General/fileio.h"
+#include "resource_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace enigma {
+
+// Reads the fields of the resource data in order. Data read with take() stays
+// valid for as long as the block it came from.
+class ResourceReader {
+ public:
+  ResourceReader(const unsigned char* data, size_t size): pos_(data), end_(data + size) {}
+
+  // Copies out the next size bytes; false if fewer remain.
+  bool read(void* dest, size_t size) {
+    const unsigned char* src = take(size);
+    if (!src) return false;
+    memcpy(dest, src, size);
+    return true;
+  }
+
+  // Skips the next size bytes and returns where they are, or nullptr if fewer remain.
+  const unsigned char* take(size_t size) {
+    if (size_t(end_ - pos_) < size) return nullptr;
+    pos_ += size;
+    return pos_ - size;
+  }
+
+  size_t remaining() const { return end_ - pos_; }
+
+ private:
+  const unsigned char* pos_;
+  const unsigned char* end_;
+};
+
+// The resource data appended to the game, found through the "res0" trailer;
+// see shared/resource_format.h. The file is mapped into memory where the
+// platform allows; otherwise the block is read in whole.
+class ResourceBlock {
+ public:
+  ResourceBlock() {}
+  ResourceBlock(const ResourceBlock&) = delete;
+  ~ResourceBlock();
+
+  // False if the file holds no resource data. The file may be closed after.
+  bool open(FILE_t* file);
+  void close();
+  ResourceReader reader() const { return ResourceReader(data_, size_); }
+  // Reads the given span of the data, or nothing if it is out of bounds.
+  ResourceReader reader(size_t offset, size_t size) const {
+    if (offset > size_ or size > size_ - offset) return ResourceReader(data_, 0);
+    return ResourceReader(data_ + offset, size);
+  }
+  // Where the index starts, or 0 if there is none.
+  size_t index_offset() const { return index_offset_; }
+
+ private:
+  const void* map_ = nullptr;
+  size_t map_size_ = 0;
+  std::vector<unsigned char> buffer_;
+  const unsigned char* data_ = nullptr;
+  size_t size_ = 0;
+  size_t index_offset_ = 0;
+};
+
+// Where the record of an asset is in the resource data.
+struct ResourceRecord {
+  int offset, size, codec;
+};
+
+// The index that follows the resource data, with the assets each room uses.
+class ResourceIndex {
+ public:
+  bool read(ResourceReader exe);
+  int flags() const { return flags_; }
+  // Returns nullptr for assets that are not indexed.
+  const ResourceRecord* find(int kind, int id) const;
+  // The kind and id of every asset the room uses; empty for unknown rooms.
+  const std::vector<std::pair<int, int>>& room_assets(int room) const;
+
+ private:
+  static uint64_t key(int kind, int id) { return uint64_t(uint32_t(kind)) << 32 | uint32_t(id); }
+
+  int flags_ = 0;
+  std::unordered_map<uint64_t, ResourceRecord> records_;
+  std::unordered_map<int, std::vector<std::pair<int, int>>> rooms_;
+};
+
+// The data and index of the game, kept for the assets that are loaded on
+// demand when the index asks for it.
+extern ResourceBlock game_resources;
+extern ResourceIndex game_resource_index;
+
+// Unpacks size bytes packed with the given codec (see resource_format::Codec)
+// straight into dst. False unless that makes exactly unpacked bytes.
+bool resource_decode(int codec, const unsigned char* src, size_t size, unsigned char* dst, size_t unpacked);
+
+// Calls job(0) through job(count - 1) across a pool of worker threads and
+// waits for them. Jobs must not use the graphics or audio systems or report
+// errors themselves; leave that to the calling thread.
+void run_resource_jobs(size_t count, const std::function<void(size_t)>& job);
+
+} //namespace enigma
+
+#endif //ENIGMA_RESOURCE_BLOCK_H
@@ -21,7 +21,7 @@
 #include "libEGMstd.h"
 #include "resinit.h"
 #include "Universal_System/zlib.h"
-#include "Platforms/General/fileio.h"
+#include "resource_block.h"
 
 #include <cstring>
 
@@ -36,36 +36,36 @@ namespace enigma
 
   }
 
-  void exe_loadsounds(FILE_t *exe)
+  void exe_loadsounds(ResourceReader &exe)
   {
     int nullhere;
 
-    if (!fread_wrapper(&nullhere,4,1,exe)) return;
+    if (!exe.read(&nullhere,4)) return;
     if (memcmp(&nullhere, "SND ", sizeof(int)) != 0)
       return;
 
     // Determine how many sprites we have
     int sndcount;
-    if (!fread_wrapper(&sndcount,4,1,exe)) return;
+    if (!exe.read(&sndcount,4)) return;
 
     // Fetch the highest ID we will be using
     int snd_highid;
-    if (!fread_wrapper(&snd_highid,4,1,exe)) return;
+    if (!exe.read(&snd_highid,4)) return;
 
     for (int i = 0; i < sndcount; i++)
     {
       int id;
-      if (!fread_wrapper(&id,1,4,exe)) return;
+      if (!exe.read(&id,4)) return;
 
       unsigned size;
-      if (!fread_wrapper(&size,1,4,exe)) return;
+      if (!exe.read(&size,4)) return;
 
-      char* fdata = new char[size];
-      if (!fread_wrapper(fdata,1,size,exe)) return;
+      // The audio systems copy what they keep, so the data is decoded in place.
+      const unsigned char* fdata = exe.take(size);
+      if (!fdata) return;
 
-      int e = sound_add_from_buffer(id,fdata,size);
+      int e = sound_add_from_buffer(id,const_cast<unsigned char*>(fdata),size);
       if (e) DEBUG_MESSAGE("Failed to load sound " + std::to_string(i) + " error " + std::to_string(e), MESSAGE_TYPE::M_ERROR);
-      delete[] fdata;
     }
   }
 }
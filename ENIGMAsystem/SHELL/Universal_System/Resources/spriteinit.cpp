@@ -18,122 +18,222 @@
 #include "libEGMstd.h"
 #include "resinit.h"
 #include "sprites_internal.h"
-#include "Universal_System/zlib.h"
-#include "Platforms/General/fileio.h"
+#include "resource_block.h"
+#include "texture_pages.h"
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Platforms/platforms_mandatory.h"
 #include "Widget_Systems/widgets_mandatory.h"
 
 #include <cstring>
 #include <string>
+#include <vector>
 
 using enigma_user::toString;
 
 namespace enigma
 {
-  void exe_loadsprs(FILE_t *exe)
+  namespace {
+    struct SubimageData {
+      int page;  // -1 for subimages with their own texture
+      unsigned x, y;
+      const unsigned char* packed;
+      unsigned size;
+      int codec, unpacked;
+      unsigned char* pixels;
+      bool decoded;
+    };
+
+    struct SpriteData {
+      unsigned sprid, width, height, bbt, bbb, bbl, bbr;
+      int xorig, yorig;
+      collision_type coll_type;
+      size_t first, count;
+    };
+
+    // Reads the sprites that follow, stopping at the first that is cut off.
+    void read_sprites(ResourceReader &exe, int sprcount, std::vector<SpriteData> &sprs, std::vector<SubimageData> &subimgs)
+    {
+      int nullhere;
+      unsigned bbm, shape;
+      int codec;
+      for (int i = 0; i < sprcount; i++)
+      {
+        SpriteData sd;
+        if (!exe.read(&sd.sprid, 4)) return;
+        if (!exe.read(&sd.width, 4)) return;
+        if (!exe.read(&sd.height,4)) return;
+        if (!exe.read(&sd.xorig, 4)) return;
+        if (!exe.read(&sd.yorig, 4)) return;
+        if (!exe.read(&sd.bbt, 4)) return;
+        if (!exe.read(&sd.bbb, 4)) return;
+        if (!exe.read(&sd.bbl, 4)) return;
+        if (!exe.read(&sd.bbr, 4)) return;
+        if (!exe.read(&bbm, 4)) return;
+        if (!exe.read(&shape, 4)) return;
+
+        switch (shape)
+        {
+          case ct_precise: sd.coll_type = ct_precise; break;
+          case ct_bbox: sd.coll_type = ct_bbox; break;
+          case ct_ellipse: sd.coll_type = ct_ellipse; break;
+          case ct_diamond: sd.coll_type = ct_diamond; break;
+          case ct_polygon: sd.coll_type = ct_bbox; break; //FIXME: Change to ct_polygon once polygons are supported.
+          case ct_circle: sd.coll_type = ct_circle; break;
+          default: sd.coll_type = ct_bbox; break;
+        };
+
+        int subimages;
+        if (!exe.read(&codec,4)) return;
+        if (!exe.read(&subimages,4)) return;
+
+        sd.first = subimgs.size();
+        for (int ii=0;ii<subimages;ii++)
+        {
+          SubimageData sub = {};
+          sub.codec = codec;
+          if (!exe.read(&sub.page,4)) return;
+          if (sub.page >= 0) {
+            if (!exe.read(&sub.x,4) || !exe.read(&sub.y,4)) return;
+            subimgs.push_back(sub);
+            if (!exe.read(&nullhere,4)) return;
+            if (nullhere)
+            {
+              DEBUG_MESSAGE("Sprite load error: Null terminator expected", MESSAGE_TYPE::M_ERROR);
+              break;
+            }
+            continue;
+          }
+          if (!exe.read(&sub.unpacked,4)) return;
+          if (!exe.read(&sub.size,4)) return;
+          if (!(sub.packed = exe.take(sub.size))) {
+            DEBUG_MESSAGE("Failed to load sprite: Data is truncated before exe end. Read "+toString(exe.remaining())+
+                                    " out of expected "+toString(sub.size), MESSAGE_TYPE::M_ERROR);
+            return;
+          }
+          subimgs.push_back(sub);
+
+          if (!exe.read(&nullhere,4)) return;
+
+          if (nullhere)
+          {
+            DEBUG_MESSAGE("Sprite load error: Null terminator expected", MESSAGE_TYPE::M_ERROR);
+            break;
+          }
+        }
+        sd.count = subimgs.size() - sd.first;
+        sprs.push_back(sd);
+      }
+    }
+  }
+
+  namespace {
+    // Inflates the subimages across the worker pool, then makes their
+    // textures and assigns the sprites on this thread.
+    void build_sprites(const std::vector<SpriteData> &sprs, std::vector<SubimageData> &subimgs)
+    {
+      run_resource_jobs(subimgs.size(), [&subimgs](size_t i) {
+        SubimageData& sub = subimgs[i];
+        if (sub.page >= 0) return;
+        sub.pixels = new unsigned char[sub.unpacked+1];
+        sub.decoded = resource_decode(sub.codec, sub.packed, sub.size, sub.pixels, sub.unpacked);
+      });
+
+      for (const SpriteData& sd : sprs)
+      {
+        Sprite spr(sd.width, sd.height, sd.xorig, sd.yorig);
+        spr.SetBBox(sd.bbl, sd.bbt, sd.bbr-sd.bbl, sd.bbb-sd.bbt);
+
+        for (size_t ii = sd.first; ii < sd.first + sd.count; ii++)
+        {
+          SubimageData& sub = subimgs[ii];
+          if (sub.page >= 0)
+          {
+            if (size_t(sub.page) >= texture_pages.size() || texture_pages[sub.page].texture < 0)
+            {
+              DEBUG_MESSAGE("Sprite load error: Texture page missing", MESSAGE_TYPE::M_ERROR);
+              continue;
+            }
+            unsigned char* collision_data = 0;
+            if (sd.coll_type == ct_precise)
+              collision_data = texture_page_pixels(sub.page, sub.x, sub.y, sd.width, sd.height);
+            spr.AddSubimage(texture_pages[sub.page].texture, texture_page_rect(sub.page, sub.x, sub.y, sd.width, sd.height),
+                            sd.coll_type, collision_data);
+            delete[] collision_data;
+            continue;
+          }
+          if (!sub.decoded)
+          {
+            DEBUG_MESSAGE("Sprite load error: Sprite does not match expected size", MESSAGE_TYPE::M_ERROR);
+            delete[] sub.pixels;
+            continue;
+          }
+
+          unsigned char* collision_data = 0;
+          switch (sd.coll_type)
+          {
+            case ct_precise: collision_data = sub.pixels; break;
+            case ct_circle:
+            case ct_ellipse:
+            case ct_diamond:
+            case ct_bbox: collision_data = 0; break;
+            case ct_polygon: collision_data = 0; break; //FIXME: Support vertex data.
+            default: collision_data = 0; break;
+          };
+
+          spr.AddSubimage(RawImage(sub.pixels, sd.width, sd.height), sd.coll_type, collision_data);
+        }
+
+        sprites.assign(sd.sprid, std::move(spr));
+      }
+    }
+  }
+
+  void exe_loadsprs(ResourceReader &exe)
   {
     int nullhere;
-    unsigned sprid, width, height, bbt, bbb, bbl, bbr, bbm, shape;
-    int xorig, yorig;
 
-    if (!fread_wrapper(&nullhere,4,1,exe)) return;
+    if (!exe.read(&nullhere,4)) return;
     if (memcmp(&nullhere, "SPR ", sizeof(int)) != 0)
       return;
 
     // Determine how many sprites we have
     int sprcount;
-    if (!fread_wrapper(&sprcount,4,1,exe)) return;
+    if (!exe.read(&sprcount,4)) return;
 
     // Fetch the highest ID we will be using
     int spr_highid;
-    if (!fread_wrapper(&spr_highid,4,1,exe)) return;
+    if (!exe.read(&spr_highid,4)) return;
 
     if (sprcount == 0) return;
     sprites.resize(spr_highid+1);
 
-    for (int i = 0; i < sprcount; i++)
-    {
-      if (!fread_wrapper(&sprid, 4,1,exe)) return;
-      if (!fread_wrapper(&width, 4,1,exe)) return;
-      if (!fread_wrapper(&height,4,1,exe)) return;
-      if (!fread_wrapper(&xorig, 4,1,exe)) return;
-      if (!fread_wrapper(&yorig, 4,1,exe)) return;
-      if (!fread_wrapper(&bbt, 4,1,exe)) return;
-      if (!fread_wrapper(&bbb, 4,1,exe)) return;
-      if (!fread_wrapper(&bbl, 4,1,exe)) return;
-      if (!fread_wrapper(&bbr, 4,1,exe)) return;
-      if (!fread_wrapper(&bbm, 4,1,exe)) return;
-      if (!fread_wrapper(&shape, 4,1,exe)) return;
+    // Find every subimage first so they can all be inflated at once; only
+    // the textures have to be made on this thread.
+    std::vector<SpriteData> sprs;
+    std::vector<SubimageData> subimgs;
+    read_sprites(exe, sprcount, sprs, subimgs);
+    subimgs.resize(sprs.empty() ? 0 : sprs.back().first + sprs.back().count);
 
-      collision_type coll_type;
-      switch (shape)
-      {
-        case ct_precise: coll_type = ct_precise; break;
-        case ct_bbox: coll_type = ct_bbox; break;
-        case ct_ellipse: coll_type = ct_ellipse; break;
-        case ct_diamond: coll_type = ct_diamond; break;
-        case ct_polygon: coll_type = ct_bbox; break; //FIXME: Change to ct_polygon once polygons are supported.
-        case ct_circle: coll_type = ct_circle; break;
-        default: coll_type = ct_bbox; break;
-      };
-
-      int subimages;
-      if (!fread_wrapper(&subimages,4,1,exe)) return; //co//ut << "Subimages: " << subimages << endl;
-
-      Sprite spr(width, height, xorig, yorig);
-      spr.SetBBox(bbl, bbt, bbr-bbl, bbb-bbt);
-      
-      for (int ii=0;ii<subimages;ii++)
-      {
-        int unpacked;
-        if (!fread_wrapper(&unpacked,4,1,exe)) return;
-        unsigned int size;
-        if (!fread_wrapper(&size,4,1,exe)) return; //co//ut << "Alloc size: " << size << endl;
-        unsigned char* cpixels=new unsigned char[size+1];
-        if (!cpixels)
-        {  //FIXME: Uncomment these when tostring is available
-          DEBUG_MESSAGE("Failed to load sprite: Cannot allocate enough memory "+ toString(unpacked), MESSAGE_TYPE::M_ERROR);
-          break;
-        }
-        unsigned int sz2=fread_wrapper(cpixels,1,size,exe);
-        if (size!=sz2) {
-          DEBUG_MESSAGE("Failed to load sprite: Data is truncated before exe end. Read "+toString(sz2)+
-                                  " out of expected "+toString(size), MESSAGE_TYPE::M_ERROR);
-          return;
-        }
-        unsigned char* pixels=new unsigned char[unpacked+1];
-        if (zlib_decompress(cpixels,size,unpacked,pixels) != unpacked)
-        {
-          DEBUG_MESSAGE("Sprite load error: Sprite does not match expected size", MESSAGE_TYPE::M_ERROR);
-          continue;
-        }
-        delete[] cpixels;
-
-        unsigned char* collision_data = 0;
-        switch (coll_type)
-        {
-          case ct_precise: collision_data = pixels; break;
-          case ct_circle:
-          case ct_ellipse:
-          case ct_diamond:
-          case ct_bbox: collision_data = 0; break;
-          case ct_polygon: collision_data = 0; break; //FIXME: Support vertex data.
-          default: collision_data = 0; break;
-        };
-
-        spr.AddSubimage(RawImage(pixels, width, height), coll_type, collision_data);
-        
-        if (!fread_wrapper(&nullhere,4,1,exe)) return;
+    if (game_resource_index.flags() & resource_format::INDEX_LAZY) {
+      sprites.set_loader([](int id) { load_sprites({id}); });
+      for (const SpriteData& sd : sprs) sprites.defer(sd.sprid);
+      return;
+    }
+    build_sprites(sprs, subimgs);
+  }
 
-        if (nullhere)
-        {
-          DEBUG_MESSAGE("Sprite load error: Null terminator expected", MESSAGE_TYPE::M_ERROR);
-          break;
-        }
-      }
-      
-      sprites.assign(sprid, std::move(spr));
+  void load_sprites(const std::vector<int> &ids)
+  {
+    std::vector<SpriteData> sprs;
+    std::vector<SubimageData> subimgs;
+    for (int id : ids) {
+      const ResourceRecord* record = game_resource_index.find(resource_format::kind("SPR "), id);
+      if (!record) continue;
+      ResourceReader exe = game_resources.reader(record->offset, record->size);
+      read_sprites(exe, 1, sprs, subimgs);
+      subimgs.resize(sprs.empty() ? 0 : sprs.back().first + sprs.back().count);
     }
+    build_sprites(sprs, subimgs);
+    texture_pages_release();
   }
 }
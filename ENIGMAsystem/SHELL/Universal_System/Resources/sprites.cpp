@@ -18,6 +18,7 @@
 **/
 
 #include "sprites_internal.h"
+#include "texture_pages.h"
 #include "Universal_System/image_formats.h"
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Graphics_Systems/General/GStextures.h"
@@ -165,6 +166,10 @@ bool sprite_exists(int spr) {
   return sprites.exists(spr);
 }
 
+void sprite_prefetch(int spr) {
+  sprites.load(spr);
+}
+
 void sprite_delete(int ind, bool free_texture) {
   if (free_texture) sprites.get(ind).FreeTextures();
   sprites.destroy(ind);
@@ -208,8 +213,13 @@ void sprite_set_alpha_from_sprite(int ind, int copy_sprite, bool free_texture) {
   const Sprite& spr_copy = sprites.get(copy_sprite);
   
   // FIXME: this will break when we add functionality for removing subimages
-  for (size_t i = 0; i < spr.SubimageCount(); i++)
-    enigma::graphics_replace_texture_alpha_from_texture(spr.GetTexture(i), spr_copy.GetTexture(i % spr_copy.SubimageCount()));
+  for (size_t i = 0; i < spr.SubimageCount(); i++) {
+    const size_t copy = i % spr_copy.SubimageCount();
+    int texture = spr.GetTexture(i);
+    enigma::TexRect bounds = spr.GetTextureRect(i);
+    enigma::texture_page_replace_alpha(texture, bounds, spr_copy.GetTexture(copy), spr_copy.GetTextureRect(copy));
+    spr.SetTexture(i, texture, bounds);
+  }
 }
 
 
@@ -257,7 +267,7 @@ void sprite_save(int ind, unsigned subimg, std::string fname) {
   
   unsigned w, h;
   unsigned char* rgbdata =
-      enigma::graphics_copy_texture_pixels(spr.GetSubimage(subimg).textureID, &w, &h);
+      enigma::texture_page_copy_pixels(spr.GetTexture(subimg), spr.GetTextureRect(subimg), &w, &h);
 
   enigma::image_save(fname, rgbdata, spr.width, spr.height, w, h, false);
 
@@ -56,6 +56,7 @@ bool sprite_replace(int ind, std::string fname, int imgnumb, bool precise, bool
 bool sprite_replace(int ind, std::string fname, int imgnumb, bool transparent, bool smooth, int x_offset, int y_offset,
                     bool free_texture = true, bool mipmap = false);  //GM7+ compatible
 bool sprite_exists(int spr);
+void sprite_prefetch(int spr);  // Loads the sprite now if the game defers it
 void sprite_save(int ind, unsigned subimg, std::string fname);
 //void sprite_save_strip(int ind, std::string fname); //FIXME: We don't support this yet
 void sprite_delete(int ind, bool free_texture = true);
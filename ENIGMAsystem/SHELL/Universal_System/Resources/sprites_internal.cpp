@@ -4,6 +4,7 @@
 #include "Universal_System/Instances/instance_system.h"
 #include "Universal_System/Object_Tiers/graphics_object.h"
 #include "sprites_internal.h"
+#include "texture_pages.h"
 
 namespace enigma {
 
@@ -12,18 +13,18 @@ AssetArray<Sprite> sprites;
 Subimage::Subimage(const Subimage &s, bool duplicateTexture) {
   // FIXME: instead of duplicating the texture we should probably use a ref counter
   // especially when using an atlas
-  if (duplicateTexture && s.textureID != -1) {
+  textureID = s.textureID;
+  textureBounds = s.textureBounds;
+  // A copy of an image on a page gets a texture of just that image.
+  if (duplicateTexture && textureID != -1 && !texture_page_detach(textureID, textureBounds)) {
     textureID = graphics_duplicate_texture(s.textureID);
-  } else {
-    textureID = s.textureID;
   }
-  textureBounds = s.textureBounds;
   collisionType = s.collisionType;
   collisionData  = s.collisionData;
 }
 
 void Subimage::FreeTexture() {
-  enigma::graphics_delete_texture(textureID);
+  if (!texture_is_page(textureID)) enigma::graphics_delete_texture(textureID);
   textureID = -1;
 }
 
@@ -88,7 +89,7 @@ RawImage sprite_get_raw(int ind, unsigned subimg) {
   if (!sprites.exists(ind)) return img;
   const Sprite& spr = sprites.get(ind);
   if (subimg >= spr.SubimageCount()) return img;
-  img.pxdata = graphics_copy_texture_pixels(spr.GetTexture(subimg), &img.w, &img.h);
+  img.pxdata = texture_page_copy_pixels(spr.GetTexture(subimg), spr.GetTextureRect(subimg), &img.w, &img.h);
   return img;
 }
 
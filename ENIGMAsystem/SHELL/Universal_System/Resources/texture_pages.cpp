@@ -0,0 +1,149 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "texture_pages.h"
+#include "resinit.h"
+#include "Graphics_Systems/graphics_mandatory.h"
+#include "Widget_Systems/widgets_mandatory.h"
+
+#include <cstring>
+#include <memory>
+
+namespace enigma {
+
+std::vector<TexturePage> texture_pages;
+
+namespace {
+  // The unpacked pixels of each page, while sprites and backgrounds are made.
+  std::vector<std::unique_ptr<unsigned char[]>> page_pixels;
+
+  unsigned char* unpack_page(int page) {
+    if (page < 0 || size_t(page) >= texture_pages.size()) return nullptr;
+    if (page_pixels.size() < texture_pages.size()) page_pixels.resize(texture_pages.size());
+    if (!page_pixels[page]) {
+      const TexturePage& tp = texture_pages[page];
+      if (!tp.packed) return nullptr;
+      const size_t unpacked = size_t(tp.width) * tp.height * 4;
+      std::unique_ptr<unsigned char[]> pixels(new unsigned char[unpacked]);
+      if (!resource_decode(tp.codec, tp.packed, tp.size, pixels.get(), unpacked)) return nullptr;
+      page_pixels[page] = std::move(pixels);
+    }
+    return page_pixels[page].get();
+  }
+}
+
+void exe_loadtexpages(ResourceReader &exe)
+{
+  int nullhere;
+  if (!exe.read(&nullhere, 4)) return;
+  if (memcmp(&nullhere, "TXP ", sizeof(int)) != 0) return;
+
+  int count;
+  if (!exe.read(&count, 4)) return;
+  for (int i = 0; i < count; i++) {
+    TexturePage tp = {};
+    if (!exe.read(&tp.width, 4) || !exe.read(&tp.height, 4)) return;
+    if (!exe.read(&tp.codec, 4) || !exe.read(&tp.size, 4)) return;
+    if (!(tp.packed = exe.take(tp.size))) {
+      DEBUG_MESSAGE("Failed to load texture page: Data is truncated before exe end", MESSAGE_TYPE::M_ERROR);
+      return;
+    }
+    texture_pages.push_back(tp);
+  }
+
+  page_pixels.resize(texture_pages.size());
+  std::vector<char> decoded(texture_pages.size());
+  run_resource_jobs(texture_pages.size(), [&decoded](size_t i) {
+    decoded[i] = unpack_page(i) != nullptr;
+  });
+
+  for (size_t i = 0; i < texture_pages.size(); i++) {
+    TexturePage& tp = texture_pages[i];
+    if (!decoded[i]) {
+      DEBUG_MESSAGE("Texture page load error: Page does not match expected size", MESSAGE_TYPE::M_ERROR);
+      tp.texture = -1;
+      continue;
+    }
+    // The pixels stay with the page for collision masks, so the image must not free them.
+    RawImage img(page_pixels[i].get(), tp.width, tp.height);
+    tp.texture = graphics_create_texture(img, false);
+    img.pxdata = nullptr;
+  }
+}
+
+TexRect texture_page_rect(int page, unsigned x, unsigned y, unsigned w, unsigned h) {
+  const TexturePage& tp = texture_pages[page];
+  return TexRect((gs_scalar) x / tp.width, (gs_scalar) y / tp.height, (gs_scalar) w / tp.width, (gs_scalar) h / tp.height);
+}
+
+unsigned char* texture_page_pixels(int page, unsigned x, unsigned y, unsigned w, unsigned h) {
+  const unsigned char* pixels = unpack_page(page);
+  if (!pixels) return nullptr;
+  const TexturePage& tp = texture_pages[page];
+  if (x + w > tp.width || y + h > tp.height) return nullptr;
+  unsigned char* region = new unsigned char[w * h * 4];
+  for (unsigned row = 0; row < h; row++)
+    memcpy(region + row * w * 4, pixels + ((y + row) * tp.width + x) * 4, w * 4);
+  return region;
+}
+
+void texture_pages_release() {
+  page_pixels.clear();
+}
+
+void texture_pages_drop_packed() {
+  for (TexturePage& tp : texture_pages) tp.packed = nullptr;
+}
+
+static const TexturePage* find_page(int texture) {
+  if (texture < 0) return nullptr;
+  for (const TexturePage& tp : texture_pages)
+    if (tp.texture == texture) return &tp;
+  return nullptr;
+}
+
+bool texture_is_page(int texture) {
+  return find_page(texture) != nullptr;
+}
+
+unsigned char* texture_page_copy_pixels(int texture, const TexRect& bounds, unsigned* fullwidth, unsigned* fullheight) {
+  const TexturePage* tp = find_page(texture);
+  if (!tp) return graphics_copy_texture_pixels(texture, fullwidth, fullheight);
+  const int x = int(bounds.x * tp->width + 0.5), y = int(bounds.y * tp->height + 0.5);
+  *fullwidth = unsigned(bounds.w * tp->width + 0.5);
+  *fullheight = unsigned(bounds.h * tp->height + 0.5);
+  return graphics_copy_texture_pixels(texture, x, y, *fullwidth, *fullheight);
+}
+
+bool texture_page_detach(int& texture, TexRect& bounds) {
+  if (!texture_is_page(texture)) return false;
+  unsigned w, h, fullwidth, fullheight;
+  RawImage img(texture_page_copy_pixels(texture, bounds, &w, &h), w, h);
+  texture = graphics_create_texture(img, false, &fullwidth, &fullheight);
+  bounds = TexRect(0, 0, (gs_scalar) w / fullwidth, (gs_scalar) h / fullheight);
+  return true;
+}
+
+void texture_page_replace_alpha(int& texture, TexRect& bounds, int copy_texture, TexRect copy_bounds) {
+  texture_page_detach(texture, bounds);
+  // The copy is only read, so one made off its page is thrown away after.
+  const bool temporary = texture_page_detach(copy_texture, copy_bounds);
+  graphics_replace_texture_alpha_from_texture(texture, copy_texture);
+  if (temporary) graphics_delete_texture(copy_texture);
+}
+
+}  //namespace enigma
@@ -0,0 +1,71 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifdef INCLUDED_FROM_SHELLMAIN
+#  error This file includes non-ENIGMA STL headers and should not be included from SHELLmain.
+#endif
+
+#ifndef ENIGMA_TEXTURE_PAGES_H
+#define ENIGMA_TEXTURE_PAGES_H
+
+#include "Universal_System/scalar.h"
+
+#include <vector>
+
+namespace enigma {
+
+// A texture the compiler packed several sprite subimages and backgrounds into.
+// The textures of the pages belong to them, not to what is drawn from them.
+struct TexturePage {
+  int texture;
+  unsigned width, height;
+  // The packed pixels, kept in game_resources for images loaded later on;
+  // nullptr once that is closed.
+  const unsigned char* packed;
+  unsigned size;
+  int codec;
+};
+
+extern std::vector<TexturePage> texture_pages;
+
+// The bounds of the w by h image at x, y on the page.
+TexRect texture_page_rect(int page, unsigned x, unsigned y, unsigned w, unsigned h);
+// Copies out the w by h image at x, y on the page, such as to make a
+// collision mask from; nullptr if the page cannot be unpacked. The page stays
+// unpacked until texture_pages_release().
+unsigned char* texture_page_pixels(int page, unsigned x, unsigned y, unsigned w, unsigned h);
+void texture_pages_release();
+// Forgets the packed pixels ahead of game_resources being closed, after which
+// released pages can't be unpacked again.
+void texture_pages_drop_packed();
+
+bool texture_is_page(int texture);
+// Copies the pixels of the image drawn from bounds of the texture, as
+// graphics_copy_texture_pixels does. For an image on a page only its own part
+// of the page is copied, so *fullwidth and *fullheight are its own size.
+unsigned char* texture_page_copy_pixels(int texture, const TexRect& bounds, unsigned* fullwidth, unsigned* fullheight);
+// Moves an image off its page into a texture of its own, so that it can be
+// changed without changing the images packed beside it. Returns whether it
+// was on a page; images with a texture of their own are left alone.
+bool texture_page_detach(int& texture, TexRect& bounds);
+// graphics_replace_texture_alpha_from_texture for images which may be on
+// pages. The image changed is moved off its page first.
+void texture_page_replace_alpha(int& texture, TexRect& bounds, int copy_texture, TexRect copy_bounds);
+
+}  //namespace enigma
+
+#endif  //ENIGMA_TEXTURE_PAGES_H
@@ -0,0 +1,171 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "benchmark.h"
+
+#include "Platforms/General/PFmain.h"
+#include "Universal_System/Instances/instance_system_base.h" // enigma::events
+#include "Widget_Systems/widgets_mandatory.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h> // getrusage
+#endif
+
+namespace enigma {
+
+bool benchmark_running = false;
+bool benchmark_instrumented = false;
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+long step_limit = 0, room_limit = 0;
+long steps = 0, rooms = 0;
+std::string report_path;
+bench_clock::time_point started;
+std::vector<bench_clock::duration> event_times;
+// The allocator can be called from the resource loaders' worker threads.
+std::atomic<unsigned long long> allocations(0), allocated_bytes(0);
+unsigned long long allocations_at_start = 0, bytes_at_start = 0;
+
+bool read_flag(const std::string &arg, const char *flag, std::string *value) {
+  const std::string prefix = std::string(flag) + "=";
+  if (arg.compare(0, prefix.size(), prefix)) return false;
+  *value = arg.substr(prefix.size());
+  return true;
+}
+
+// In bytes, or zero where the platform can't tell us.
+unsigned long long peak_resident_memory() {
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage)) return 0;
+  #ifdef __APPLE__
+    return usage.ru_maxrss;
+  #else
+    return usage.ru_maxrss * 1024ull;
+  #endif
+#else
+  return 0;
+#endif
+}
+
+std::string json_string(const std::string &str) {
+  std::string res = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') res += '\\';
+    res += c;
+  }
+  return res + '"';
+}
+
+}  // namespace
+
+void benchmark_start() {
+  bool requested = benchmark_instrumented;
+  for (int i = 1; i < parameterc; i++) {
+    const std::string &arg = parameters[i];
+    std::string value;
+    if (arg == "--benchmark") requested = true;
+    else if (read_flag(arg, "--benchmark-steps", &value)) step_limit = std::atol(value.c_str()), requested = true;
+    else if (read_flag(arg, "--benchmark-rooms", &value)) room_limit = std::atol(value.c_str()), requested = true;
+    else if (read_flag(arg, "--benchmark-report", &value)) report_path = value, requested = true;
+  }
+  if (!requested) return;
+
+  benchmark_running = true;
+  allocations_at_start = allocations;
+  bytes_at_start = allocated_bytes;
+  started = bench_clock::now();
+}
+
+void benchmark_step() {
+  steps++;
+  if (step_limit > 0 && steps >= step_limit) enigma_user::game_end();
+}
+
+void benchmark_room_entered() {
+  if (!benchmark_running) return;
+  rooms++;
+  if (room_limit > 0 && rooms >= room_limit) enigma_user::game_end();
+}
+
+void benchmark_add_event_time(int event, bench_clock::duration time) {
+  if (size_t(event) >= event_times.size()) event_times.resize(event + 1);
+  event_times[event] += time;
+}
+
+void benchmark_report() {
+  if (!benchmark_running) return;
+  const bench_clock::duration elapsed = bench_clock::now() - started;
+  benchmark_running = false;
+
+  FILE *out = report_path.empty() ? stdout : std::fopen(report_path.c_str(), "w");
+  if (!out) {
+    DEBUG_MESSAGE("Cannot write benchmark report to " + report_path, MESSAGE_TYPE::M_ERROR);
+    return;
+  }
+
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  std::fprintf(out, "{\n  \"steps\": %ld,\n  \"rooms\": %ld,\n  \"seconds\": %.6f,\n", steps, rooms, seconds);
+  std::fprintf(out, "  \"steps_per_second\": %.3f,\n", seconds > 0 ? steps / seconds : 0);
+
+  std::fprintf(out, "  \"events\": {");
+  bool first = true;
+  for (size_t i = 0; i < event_times.size(); i++) {
+    if (event_times[i] == bench_clock::duration::zero()) continue;
+    const double event_seconds = std::chrono::duration<double>(event_times[i]).count();
+    std::fprintf(out, "%s\n    %s: {\"seconds\": %.6f, \"us_per_step\": %.3f}", first ? "" : ",",
+                 json_string(events[i].name).c_str(), event_seconds, steps ? event_seconds * 1e6 / steps : 0);
+    first = false;
+  }
+  std::fprintf(out, first ? "},\n" : "\n  },\n");
+
+  if (benchmark_instrumented) {
+    std::fprintf(out, "  \"allocations\": %llu,\n  \"allocated_bytes\": %llu,\n",
+                 allocations - allocations_at_start, allocated_bytes - bytes_at_start);
+  } else {
+    std::fprintf(out, "  \"allocations\": null,\n  \"allocated_bytes\": null,\n");
+  }
+  if (const unsigned long long rss = peak_resident_memory())
+    std::fprintf(out, "  \"peak_rss_bytes\": %llu\n}\n", rss);
+  else
+    std::fprintf(out, "  \"peak_rss_bytes\": null\n}\n");
+
+  if (out != stdout) std::fclose(out);
+  else std::fflush(out);
+}
+
+void *benchmark_allocate(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  // The engine is built without exceptions, and operator new may not return
+  // null, so running out of memory ends the game.
+  if (void *ptr = std::malloc(size ? size : 1)) return ptr;
+  std::abort();
+}
+
+void benchmark_free(void *ptr) noexcept { std::free(ptr); }
+
+}  // namespace enigma
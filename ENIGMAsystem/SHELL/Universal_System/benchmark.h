@@ -0,0 +1,65 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+// Benchmark mode runs the game without the frame limiter for a fixed number of
+// steps or rooms, then writes a JSON report of how fast it went. Any game enters
+// it when started with --benchmark, --benchmark-steps=N or --benchmark-rooms=N;
+// --benchmark-report=FILE sends the report somewhere other than stdout.
+// Games built with the benchmark build setting always run in this mode, and
+// their generated event loop and allocator also report the time spent in each
+// event and the number of allocations made.
+
+#ifndef ENIGMA_BENCHMARK_H
+#define ENIGMA_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace enigma {
+
+extern bool benchmark_running;
+// Set by the generated code of benchmark builds.
+extern bool benchmark_instrumented;
+
+// Reads the command line and, if asked to, starts timing. Called once the game is loaded.
+void benchmark_start();
+// Counts a finished step, ending the game once enough have run.
+void benchmark_step();
+// Counts a room change, ending the game once enough rooms have been entered.
+void benchmark_room_entered();
+// Writes the report; called after the game has ended.
+void benchmark_report();
+
+void benchmark_add_event_time(int event, std::chrono::steady_clock::duration time);
+void *benchmark_allocate(std::size_t size);
+void benchmark_free(void *ptr) noexcept;
+
+// Adds the time until it goes out of scope to one of the game's events.
+struct benchmark_scope {
+  int event;
+  std::chrono::steady_clock::time_point start;
+  benchmark_scope(int ev): event(ev) {
+    if (benchmark_running) start = std::chrono::steady_clock::now();
+  }
+  ~benchmark_scope() {
+    if (benchmark_running) benchmark_add_event_time(event, std::chrono::steady_clock::now() - start);
+  }
+};
+
+}  // namespace enigma
+
+#endif  // ENIGMA_BENCHMARK_H
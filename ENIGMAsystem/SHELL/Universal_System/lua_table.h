@@ -19,26 +19,26 @@
 #ifndef ENIGMA_H_LUA_TABLE
 #define ENIGMA_H_LUA_TABLE
 
-#include <map>     // Sparse part
-#include <vector>  // Dense part
+#include <vector>  // Dense part, sparse slots
 #include <cstring> // Memcpy
 #include <cstddef>
+#include <cstdint>
+#include <utility>
 
 /**
   This file implements a Lua-table-like structure. It borrows ideas not only from
-  Lua, but from STL containers. It also borrows the entirety of std::map. This should
-  be replaced with a sparse hash map container when it's a "good time" to do so.
-
-  By ENIGMA-defined standard, this table class takes up sizeof(void*) bytes. The class
-  itself contains a single pointer to a dense part (dynamic array). This ctually points
-  to a fixed-length position from the beginning of an allocated block. At the beginning
-  of this block is precisely enough room for the table's map component. The implication
-  is that the dense segment can be dereferenced without additional arithmetic (by unary
-  operator*), while the map section requires taking dense[-sizeof(map)],  where `dense`
-  has been cast to char*, then casting back to maptype*.
-
-  NOTE: Memory layout is something like this:
-    <sparse_map><dense_length><max_elem+1><dense_elem[0],dense_elem[1],...>
+  Lua, but from STL containers. Indices below a moving boundary are stored in a
+  dense part (a vector); indices far beyond it go to a sparse part, which is an
+  open-addressing hash table with linear probing.
+
+  The dense part grows to take any index within twice its length (or within its
+  capacity, so reserve() keeps writes below the reserved length dense). When the
+  sparse part holds at least half of the indices below the highest one accessed,
+  everything is moved into the dense part, so an array written back to front or
+  in scattered order still ends up dense.
+
+  References returned by operator[] are invalidated by writes that grow either
+  part, as with a vector.
 */
 
 namespace {
@@ -48,10 +48,144 @@ T my_max(const T& lhs, const T& rhs) {
 }
 }
 
+/// Sparse part of a lua_table: a hash table from index to value. Removal
+/// shifts later entries of a probe run back, so there are no tombstones.
+template <class T> class lua_hash_part {
+  struct slot {
+    size_t key;
+    T value;
+    bool used;
+    slot(): key(0), value(), used(false) {}
+  };
+
+  std::vector<slot> slots; // Empty, or a power of two in size
+  size_t count;
+  int shift;               // 64 - log2(slots.size())
+
+  size_t home(size_t key) const {
+    return (uint64_t(key) * 0x9E3779B97F4A7C15ULL) >> shift;
+  }
+  size_t find_slot(size_t key) const {
+    const size_t mask = slots.size() - 1;
+    size_t i = home(key);
+    while (slots[i].used && slots[i].key != key) i = (i + 1) & mask;
+    return i;
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<slot> old;
+    old.swap(slots);
+    slots.resize(capacity);
+    shift = 64;
+    for (size_t c = capacity; c > 1; c >>= 1) --shift;
+    for (size_t i = 0; i < old.size(); ++i) {
+      if (!old[i].used) continue;
+      slot &s = slots[find_slot(old[i].key)];
+      s.key = old[i].key;
+      s.value = std::move(old[i].value);
+      s.used = true;
+    }
+  }
+
+ public:
+  lua_hash_part(): count(0), shift(64) {}
+  lua_hash_part(const lua_hash_part &x) = default;
+  lua_hash_part &operator=(const lua_hash_part &x) = default;
+#ifndef JUST_DEFINE_IT_RUN
+  // The source is left empty, with no slots to probe.
+  lua_hash_part(lua_hash_part &&x) noexcept:
+      slots(std::move(x.slots)), count(x.count), shift(x.shift) {
+    x.slots.clear();
+    x.count = 0;
+    x.shift = 64;
+  }
+  lua_hash_part &operator=(lua_hash_part &&x) noexcept {
+    slots = std::move(x.slots);
+    count = x.count;
+    shift = x.shift;
+    x.slots.clear();
+    x.count = 0;
+    x.shift = 64;
+    return *this;
+  }
+#endif
+
+  size_t size() const { return count; }
+
+  T *find(size_t key) {
+    if (!count) return NULL;
+    slot &s = slots[find_slot(key)];
+    return s.used ? &s.value : NULL;
+  }
+  const T *find(size_t key) const {
+    if (!count) return NULL;
+    const slot &s = slots[find_slot(key)];
+    return s.used ? &s.value : NULL;
+  }
+
+  // Returns the value for the key, inserting T() if it is not present.
+  T &operator[](size_t key) {
+    if (count) {
+      slot &s = slots[find_slot(key)];
+      if (s.used) return s.value;
+    }
+    // Keep the load at or below three quarters.
+    if ((count + 1) * 4 > slots.size() * 3)
+      rehash(slots.empty() ? 16 : slots.size() * 2);
+    slot &s = slots[find_slot(key)];
+    s.key = key;
+    s.used = true;
+    ++count;
+    return s.value;
+  }
+
+  void erase(size_t key) {
+    if (!count) return;
+    const size_t mask = slots.size() - 1;
+    size_t hole = find_slot(key);
+    if (!slots[hole].used) return;
+    // Move back any later entry of the run whose home is not between the
+    // hole and itself, so that probes for it still pass through the hole.
+    for (size_t i = (hole + 1) & mask; slots[i].used; i = (i + 1) & mask) {
+      const size_t h = home(slots[i].key);
+      if (((i - h) & mask) >= ((i - hole) & mask)) {
+        slots[hole].key = slots[i].key;
+        slots[hole].value = std::move(slots[i].value);
+        hole = i;
+      }
+    }
+    slots[hole].used = false;
+    slots[hole].value = T();
+    --count;
+  }
+
+  // Moves every value with a key below the given bound into dense[key].
+  void move_below(size_t bound, std::vector<T> &dense) {
+    if (!count) return;
+    size_t moved = 0;
+    for (size_t i = 0; i < slots.size(); ++i) {
+      if (slots[i].used && slots[i].key < bound) {
+        dense[slots[i].key] = std::move(slots[i].value);
+        slots[i].used = false;
+        ++moved;
+      }
+    }
+    if (!moved) return;
+    count -= moved;
+    if (count) rehash(slots.size());
+    else clear();
+  }
+
+  void clear() {
+    std::vector<slot>().swap(slots);
+    count = 0;
+    shift = 64;
+  }
+};
 
 template <class T> struct lua_table {
   typedef std::vector<T> dense_type;
-  typedef std::map<size_t,T> sparse_type;
+  typedef lua_hash_part<T> sparse_type;
 
  private:
   dense_type dense;
@@ -69,16 +203,14 @@ template <class T> struct lua_table {
 
   void upsize(const size_t c) {
     dense.resize(c);
-    //Copy sparse array values that are now within this reserve space.
-    for (typename sparse_type::iterator it=sparse.begin(); it!=sparse.end();) {
-      if (it->first >= c) {
-        break;
-      }
-      dense[it->first] = it->second;
-      sparse.erase(it++);
-    }
+    //Move sparse array values that are now within this reserve space.
+    sparse.move_below(c, dense);
   }
 
+  // Minimum sparse entries before considering promotion, so that a handful of
+  // scattered indices doesn't allocate a dense part spanning all of them.
+  static const size_t promote_min = 16;
+
 
  public:
   const dense_type &dense_part() const {
@@ -90,29 +222,42 @@ template <class T> struct lua_table {
     if (ind >= dense.size()) {
       size_t nsize = my_max(dense.size() << 1, dense.capacity());
       if (ind >= nsize) {
-        return sparse[ind];
+        const size_t count = sparse.size();
+        T &res = sparse[ind];
+        // Promote once at least half the indices up to mx_size are in use.
+        if (sparse.size() == count || count < promote_min
+            || (dense.size() + sparse.size()) * 2 < mx_size)
+          return res;
+        upsize(mx_size);
+      } else {
+        upsize(ind + 1);
       }
-      upsize(ind + 1);
     }
     return dense[ind];
   }
 
   const T& operator[] (size_t ind) const {
-    static const T sentinel;
+    static const T sentinel = T();
     if (ind >= dense.size()) {
-      auto f = sparse.find(ind);
-      return f == sparse.end()? sentinel : f->second;
+      const T *f = sparse.find(ind);
+      return f ? *f : sentinel;
     }
     return dense[ind];
   }
 
   void fill(const T &value, size_t length) {
-    upsize(length);
+    if (length > dense.size()) upsize(length);
     if (mx_size < length) mx_size = length;
     for (size_t i = 0; i < length; ++i)
       dense[i] = value;
   }
 
+  /// Makes room for indices below n in the dense part, so that filling the
+  /// table up to n doesn't reallocate or fall into the sparse part.
+  void reserve(size_t n) {
+    if (n > dense.capacity()) dense.reserve(n);
+  }
+
   T& operator*() {
     return dense[0];
   }
@@ -139,6 +284,23 @@ template <class T> struct lua_table {
   lua_table<T>(const lua_table<T> &x) {
     pick_up(x);
   }
+#ifndef JUST_DEFINE_IT_RUN
+  // Tables of tables (2D arrays) move their rows when growing.
+  // The source is left an empty table.
+  lua_table<T>(lua_table<T> &&x) noexcept:
+      dense(std::move(x.dense)), sparse(std::move(x.sparse)), mx_size(x.mx_size) {
+    x.dense.clear();
+    x.mx_size = 0;
+  }
+  lua_table<T>& operator= (lua_table<T> &&x) noexcept {
+    dense = std::move(x.dense);
+    sparse = std::move(x.sparse);
+    mx_size = x.mx_size;
+    x.dense.clear();
+    x.mx_size = 0;
+    return *this;
+  }
+#endif
   ~lua_table<T>() {}
 };
 
@@ -0,0 +1,182 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "profiler.h"
+
+#include "Universal_System/Instances/instance_system_base.h" // enigma::events
+#include "Universal_System/Resources/resource_data.h" // object_get_name, script_get_name
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace enigma {
+
+bool profiler_enabled = false;
+
+namespace {
+
+struct ProfileTotal {
+  unsigned long calls = 0;
+  uint64_t ticks = 0;
+};
+
+struct ProfileSample {
+  uint64_t start, end;
+  int id, object;
+  profile_kind kind;
+};
+
+// Must be a power of two.
+const size_t kRingSize = 1 << 16;
+
+int events_profiled = 0, objects_profiled = 0;
+// events_profiled rows of one column per object, then one for calls made without an instance.
+std::vector<ProfileTotal> event_totals;
+size_t row_size = 0;
+std::vector<ProfileTotal> script_totals;
+std::vector<ProfileSample> ring;
+uint64_t ring_head = 0;
+
+// The cycle counter's rate is worked out against the steady clock, over the whole run.
+uint64_t epoch_ticks;
+std::chrono::steady_clock::time_point epoch_time;
+
+double microseconds_per_tick() {
+  const double us = std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - epoch_time).count();
+  const uint64_t ticks = profiler_ticks() - epoch_ticks;
+  return ticks && us > 0 ? us / ticks : 0;
+}
+
+std::string json_string(const std::string &str) {
+  std::string res = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') res += '\\';
+    res += c;
+  }
+  return res + '"';
+}
+
+}  // namespace
+
+void profiler_initialize(int event_count, int object_count) {
+  events_profiled = event_count;
+  objects_profiled = object_count;
+  row_size = object_count + 1;
+  event_totals.assign(event_count * row_size, ProfileTotal());
+  ring.resize(kRingSize);
+  epoch_ticks = profiler_ticks();
+  epoch_time = std::chrono::steady_clock::now();
+  profiler_enabled = true;
+}
+
+void profiler_record(profile_kind kind, int id, int object, uint64_t start, uint64_t end) {
+  ProfileTotal *total = nullptr;
+  if (kind == profile_event) {
+    if (id >= 0 && id < events_profiled && object >= -1 && object < objects_profiled)
+      total = &event_totals[id * row_size + (object < 0 ? objects_profiled : object)];
+  } else if (id >= 0) {
+    if (size_t(id) >= script_totals.size()) script_totals.resize(id + 1);
+    total = &script_totals[id];
+  }
+  if (total) {
+    total->calls++;
+    total->ticks += end - start;
+  }
+  ring[ring_head++ & (kRingSize - 1)] = ProfileSample{start, end, id, object, kind};
+}
+
+}  // namespace enigma
+
+namespace enigma_user {
+
+void profiler_set_enabled(bool enable) {
+  enigma::profiler_enabled = enable && enigma::events_profiled;
+}
+
+bool profiler_get_enabled() { return enigma::profiler_enabled; }
+
+void profiler_reset() {
+  std::fill(enigma::event_totals.begin(), enigma::event_totals.end(), enigma::ProfileTotal());
+  enigma::script_totals.clear();
+  enigma::ring_head = 0;
+}
+
+int profiler_get_event_count() { return enigma::events_profiled; }
+
+std::string profiler_get_event_name(int event) {
+  if (event < 0 || event >= enigma::events_profiled) return "";
+  return enigma::events[event].name;
+}
+
+static enigma::ProfileTotal event_total(int event, int object) {
+  enigma::ProfileTotal res;
+  if (event < 0 || event >= enigma::events_profiled || object >= enigma::objects_profiled) return res;
+  const size_t row = event * enigma::row_size;
+  if (object >= 0) return enigma::event_totals[row + object];
+  for (size_t i = 0; i < enigma::row_size; i++) {
+    res.calls += enigma::event_totals[row + i].calls;
+    res.ticks += enigma::event_totals[row + i].ticks;
+  }
+  return res;
+}
+
+unsigned long profiler_get_calls(int event, int object) {
+  return event_total(event, object).calls;
+}
+
+double profiler_get_time(int event, int object) {
+  return event_total(event, object).ticks * enigma::microseconds_per_tick();
+}
+
+unsigned long profiler_get_script_calls(int script) {
+  if (script < 0 || size_t(script) >= enigma::script_totals.size()) return 0;
+  return enigma::script_totals[script].calls;
+}
+
+double profiler_get_script_time(int script) {
+  if (script < 0 || size_t(script) >= enigma::script_totals.size()) return 0;
+  return enigma::script_totals[script].ticks * enigma::microseconds_per_tick();
+}
+
+bool profiler_dump_trace(std::string fname) {
+  FILE *out = std::fopen(fname.c_str(), "w");
+  if (!out) return false;
+
+  const double us_per_tick = enigma::microseconds_per_tick();
+  const uint64_t count = std::min<uint64_t>(enigma::ring_head, enigma::kRingSize);
+  std::fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+  for (uint64_t i = enigma::ring_head - count; i < enigma::ring_head; i++) {
+    const enigma::ProfileSample &sample = enigma::ring[i & (enigma::kRingSize - 1)];
+    std::string name;
+    if (sample.kind == enigma::profile_event) {
+      name = profiler_get_event_name(sample.id);
+      if (sample.object >= 0) name += " " + object_get_name(sample.object);
+    } else {
+      name = script_get_name(sample.id);
+    }
+    std::fprintf(out, "%s\n  {\"name\": %s, \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 0, \"tid\": 0}",
+                 i == enigma::ring_head - count ? "" : ",", enigma::json_string(name).c_str(),
+                 sample.kind == enigma::profile_event ? "event" : "script",
+                 (sample.start - enigma::epoch_ticks) * us_per_tick, (sample.end - sample.start) * us_per_tick);
+  }
+  std::fprintf(out, "\n]}\n");
+  return !std::fclose(out);
+}
+
+}  // namespace enigma_user
@@ -0,0 +1,94 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+// Event profiler. Games compiled with the event profiling setting time every
+// event call by event and object (and, if asked, every script call) in CPU
+// cycles. Each call is added to per-event totals and to a ring buffer holding
+// the most recent calls, which can be dumped as a Chrome trace. Other games
+// never call into this and their profiler_get_* functions report nothing.
+
+#ifndef ENIGMA_PROFILER_H
+#define ENIGMA_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace enigma {
+
+enum profile_kind { profile_event, profile_script };
+
+extern bool profiler_enabled;
+
+// Sizes the per-event tables; called from the generated event_system_initialize.
+void profiler_initialize(int event_count, int object_count);
+void profiler_record(profile_kind kind, int id, int object, uint64_t start, uint64_t end);
+
+inline uint64_t profiler_ticks() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Records the time until it goes out of scope against an event or script.
+struct profiler_scope {
+  profile_kind kind;
+  int id, object;
+  bool timing;
+  uint64_t start;
+  profiler_scope(profile_kind k, int i, int obj = -1): kind(k), id(i), object(obj), timing(profiler_enabled) {
+    if (timing) start = profiler_ticks();
+  }
+  ~profiler_scope() {
+    if (timing) profiler_record(kind, id, object, start, profiler_ticks());
+  }
+};
+
+}  // namespace enigma
+
+namespace enigma_user {
+
+void profiler_set_enabled(bool enable);
+bool profiler_get_enabled();
+void profiler_reset();
+
+// Events are numbered as in the game's event list, from 0 to profiler_get_event_count() - 1.
+int profiler_get_event_count();
+std::string profiler_get_event_name(int event);
+// Times are in microseconds. An object of -1 gives the total over all objects,
+// including events such as Draw that are not run per instance.
+unsigned long profiler_get_calls(int event, int object = -1);
+double profiler_get_time(int event, int object = -1);
+unsigned long profiler_get_script_calls(int script);
+double profiler_get_script_time(int script);
+
+// Writes the calls still in the ring buffer as a Chrome trace-event JSON file,
+// for chrome://tracing or Perfetto. Returns false if the file can't be written.
+bool profiler_dump_trace(std::string fname);
+
+}  // namespace enigma_user
+
+#endif  // ENIGMA_PROFILER_H
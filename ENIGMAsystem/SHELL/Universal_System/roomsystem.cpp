@@ -33,9 +33,11 @@
 #include "Instances/instance.h"
 #include "Object_Tiers/planar_object.h"
 #include "Resources/backgrounds.h"
+#include "Resources/resinit.h"
 
 #include "roomsystem.h"
 #include "depth_draw.h"
+#include "benchmark.h"
 
 #include "Platforms/General/PFmain.h"
 
@@ -178,6 +180,10 @@ namespace enigma
 
     perform_callbacks_clean_up_roomend();
 
+    // Load what the room uses up front rather than on first draw.
+    resources_prefetch_room(id);
+    benchmark_room_entered();
+
     // Set the index to self
     room.rval.d = id;
     room_caption = cap;
@@ -0,0 +1,99 @@
+/** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "var4.h"
+
+#ifdef ENIGMA_COMPACT_VARIANT
+
+#include <cstdlib>
+
+#ifdef DEBUG_MODE
+#include "Instances/parallel_step.h"
+#include "Widget_Systems/widgets_mandatory.h"
+#endif
+
+namespace enigma {
+
+// The table is plain data so that it is usable by variants constructed during
+// static initialization, in any translation unit. Nothing here is synchronized;
+// see the comment on shared_string in var4.h.
+shared_string **shared_strings = NULL;
+static unsigned shared_strings_size = 1, shared_strings_capacity = 0; // Handle 0 is reserved
+static unsigned *free_handles = NULL, free_handles_size = 0;
+
+const std::string &shared_string_empty() {
+  static const std::string empty;
+  return empty;
+}
+
+#ifdef DEBUG_MODE
+// Parallel Step workers would race each other on the table.
+static void check_string_thread() {
+  if (parallel_step_worker)
+    DEBUG_MESSAGE("A string variable was made or dropped in a parallel Step event; "
+                  "string variables can't be used there when built with COMPACT_VARIANT.",
+                  MESSAGE_TYPE::M_FATAL_USER_ERROR);
+}
+#endif
+
+unsigned shared_string_alloc(std::string &&str) {
+  #ifdef DEBUG_MODE
+  check_string_thread();
+  #endif
+  unsigned handle;
+  if (free_handles_size) {
+    handle = free_handles[--free_handles_size];
+    shared_strings[handle]->str = std::move(str);
+  } else {
+    if (shared_strings_size >= shared_strings_capacity) {
+      shared_strings_capacity = shared_strings_capacity ? shared_strings_capacity * 2 : 256;
+      shared_strings = (shared_string**) realloc(shared_strings, shared_strings_capacity * sizeof(shared_string*));
+      free_handles = (unsigned*) realloc(free_handles, shared_strings_capacity * sizeof(unsigned));
+    }
+    handle = shared_strings_size++;
+    shared_strings[handle] = new shared_string{std::move(str), 0};
+  }
+  shared_strings[handle]->refs = 1;
+  return handle;
+}
+
+void shared_string_release(unsigned handle) {
+  #ifdef DEBUG_MODE
+  check_string_thread();
+  #endif
+  shared_string *entry = shared_strings[handle];
+  if (--entry->refs) return;
+  // Keep the entry, but not a large buffer, for the next string.
+  if (entry->str.capacity() > 64) std::string().swap(entry->str);
+  else entry->str.clear();
+  free_handles[free_handles_size++] = handle;
+}
+
+void variant_string_wrapper::unshare() {
+  const unsigned old = shandle;
+  shandle = shared_string_alloc(old ? std::string(shared_strings[old]->str) : std::string());
+  if (old) shared_string_release(old);
+}
+
+const var_arrays &var_arrays_empty() {
+  static const var_arrays empty;
+  return empty;
+}
+
+static_assert(sizeof(variant) == 16, "Compact variants should be a double and two 32-bit words");
+
+}  // namespace enigma
+
+#endif  // ENIGMA_COMPACT_VARIANT
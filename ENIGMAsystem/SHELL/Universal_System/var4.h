@@ -225,6 +225,9 @@ struct variant_real_union {
   variant_real_union(double x): rval(x) {}
   variant_real_union(const void *x): rval(x) {}
 };
+
+#if !defined(ENIGMA_COMPACT_VARIANT) || defined(JUST_DEFINE_IT_RUN)
+
 struct variant_string_wrapper : std::string {
   std::string &sval() { return *this; }
   const std::string &sval() const { return *this; }
@@ -234,8 +237,84 @@ struct variant_string_wrapper : std::string {
   std::string rvalue_ref release_sval() {
     return std::move(*(std::string*) this);
   }
+  void assign_sval(const variant_string_wrapper &x) { sval() = x.sval(); }
+  void move_sval(variant_string_wrapper &x) { sval() = std::move(x.sval()); }
+};
+
+#else
+
+// The compact layout (COMPACT_VARIANT=true in the SHELL Makefile) keeps a
+// variant to 16 bytes. Strings live out of line in a table of refcounted
+// entries, shared by copies of a variant until one of them writes to its
+// string. Variants hold a 32-bit handle into the table; handle 0 is "".
+// The table and its refcounts are not synchronized: string variants may only
+// be created, copied or destroyed on the main thread. DEBUG_MODE builds
+// stop a parallel Step event that makes or drops one (see var4.cpp).
+struct shared_string {
+  std::string str;
+  unsigned refs;
+};
+extern shared_string **shared_strings;  // Indexed by handle; see var4.cpp
+unsigned shared_string_alloc(std::string rvalue_ref str);
+void shared_string_release(unsigned handle);
+const std::string &shared_string_empty();
+
+struct variant_string_wrapper {
+  unsigned shandle;
+
+  const std::string &sval() const {
+    return shandle ? shared_strings[shandle]->str : shared_string_empty();
+  }
+  std::string &sval() {
+    if (!shandle || shared_strings[shandle]->refs > 1) unshare();
+    return shared_strings[shandle]->str;
+  }
+  operator const std::string&() const { return sval(); }
+
+  variant_string_wrapper(): shandle(0) {}
+  variant_string_wrapper(std::string const &x):
+      shandle(x.empty() ? 0 : shared_string_alloc(std::string(x))) {}
+  variant_string_wrapper(std::string rvalue_ref x):
+      shandle(x.empty() ? 0 : shared_string_alloc(std::move(x))) {}
+  variant_string_wrapper(const variant_string_wrapper &x): shandle(x.shandle) {
+    if (shandle) shared_strings[shandle]->refs++;
+  }
+  variant_string_wrapper(variant_string_wrapper rvalue_ref x): shandle(x.shandle) {
+    x.shandle = 0;
+  }
+  variant_string_wrapper &operator=(const variant_string_wrapper &x) {
+    assign_sval(x);
+    return *this;
+  }
+  ~variant_string_wrapper() {
+    if (shandle) shared_string_release(shandle);
+  }
+
+  std::string release_sval() {
+    std::string res = shandle && shared_strings[shandle]->refs == 1
+        ? std::move(shared_strings[shandle]->str) : sval();
+    if (shandle) shared_string_release(shandle);
+    shandle = 0;
+    return res;
+  }
+  void assign_sval(const variant_string_wrapper &x) {
+    if (x.shandle) shared_strings[x.shandle]->refs++;
+    if (shandle) shared_string_release(shandle);
+    shandle = x.shandle;
+  }
+  // Takes x's string without touching the refcounts; x releases ours.
+  void move_sval(variant_string_wrapper &x) {
+    const unsigned handle = shandle;
+    shandle = x.shandle;
+    x.shandle = handle;
+  }
+
+ private:
+  void unshare();  // Gives this variant an entry of its own
 };
 
+#endif
+
 }  // namespace enigma
 
 struct var;
@@ -323,11 +402,11 @@ struct variant : enigma::variant_real_union, enigma::variant_string_wrapper {
       enigma::variant_real_union(p), type(enigma_user::ty_pointer) {}
   variant(const variant &x):
       enigma::variant_real_union(x.rval.d),
-      enigma::variant_string_wrapper(x.sval()),
+      enigma::variant_string_wrapper(x),
       type(x.type) {}
   variant(variant rvalue_ref x):
       enigma::variant_real_union(x.rval.d),
-      enigma::variant_string_wrapper(x.release_sval()),
+      enigma::variant_string_wrapper(std::move(x)),
       type(x.type) {}
 
   // Construct a variant from numeric types
@@ -352,9 +431,16 @@ struct variant : enigma::variant_real_union, enigma::variant_string_wrapper {
 
   variant& operator=(const variant &v) {
     rval = v.rval;
-    if ((type = v.type) == ty_string) sval() = v.sval();
+    if ((type = v.type) == ty_string) assign_sval(v);
     return *this;
   }
+  #ifndef JUST_DEFINE_IT_RUN
+  variant& operator=(variant rvalue_ref v) {
+    rval = v.rval;
+    if ((type = v.type) == ty_string) move_sval(v);
+    return *this;
+  }
+  #endif
 
   // Assignment to a numeric type
   template<typename T, REQUIRE_NON_STRING_NUMBER(T)>
@@ -611,18 +697,69 @@ struct variant : enigma::variant_real_union, enigma::variant_string_wrapper {
 //██▙▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▄▟█████████████████████████████████████████
 //▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞▚▞
 
+#if defined(ENIGMA_COMPACT_VARIANT) && !defined(JUST_DEFINE_IT_RUN)
+namespace enigma {
+  struct var_arrays {
+    lua_table<variant> array1d;
+    lua_table<lua_table<variant>> array2d;
+  };
+  const var_arrays &var_arrays_empty();
+}
+#endif
+
 struct var : variant {
+#if !defined(ENIGMA_COMPACT_VARIANT) || defined(JUST_DEFINE_IT_RUN)
   lua_table<variant> array1d;
   lua_table<lua_table<variant>> array2d;
 
   var() {}
   var(const var&) = default;
+  #ifndef JUST_DEFINE_IT_RUN
+  var(var rvalue_ref) = default;
+  #endif
   var(variant value, size_t length, size_t height = 1):
       variant(value), array1d(value, length) {
+    array2d.reserve(height);
     for (size_t i = 1; i < height; ++i) array2d[i].fill(value, length);
   }
   template<typename T> var(const T &v): variant(v) {}
 
+  lua_table<variant> &array_1d() { return array1d; }
+  lua_table<lua_table<variant>> &array_2d() { return array2d; }
+  const lua_table<variant> &array_1d() const { return array1d; }
+  const lua_table<lua_table<variant>> &array_2d() const { return array2d; }
+#else
+  // Allocated on the first write to an index; most vars are never arrays.
+  enigma::var_arrays *arrays;
+
+  var(): arrays(NULL) {}
+  var(const var &v):
+      variant(v), arrays(v.arrays ? new enigma::var_arrays(*v.arrays) : NULL) {}
+  var(var rvalue_ref v): variant(std::move(v)), arrays(v.arrays) { v.arrays = NULL; }
+  var(variant value, size_t length, size_t height = 1):
+      variant(value), arrays(new enigma::var_arrays()) {
+    arrays->array1d.fill(value, length);
+    arrays->array2d.reserve(height);
+    for (size_t i = 1; i < height; ++i) arrays->array2d[i].fill(value, length);
+  }
+  template<typename T> var(const T &v): variant(v), arrays(NULL) {}
+
+  lua_table<variant> &array_1d() {
+    if (!arrays) arrays = new enigma::var_arrays();
+    return arrays->array1d;
+  }
+  lua_table<lua_table<variant>> &array_2d() {
+    if (!arrays) arrays = new enigma::var_arrays();
+    return arrays->array2d;
+  }
+  const lua_table<variant> &array_1d() const {
+    return (arrays ? *arrays : enigma::var_arrays_empty()).array1d;
+  }
+  const lua_table<lua_table<variant>> &array_2d() const {
+    return (arrays ? *arrays : enigma::var_arrays_empty()).array2d;
+  }
+#endif
+
   // Non-variant operators (matrix-related)
   // ===========================================================================
 
@@ -632,11 +769,11 @@ struct var : variant {
 
   variant& operator[] (int ind) {
     if (!ind) return *this;
-    return array1d[ind];
+    return array_1d()[ind];
   }
   variant& operator() (int ind_2d,int ind_1d) {
-    if (ind_2d) return array2d[ind_2d][ind_1d];
-    if (ind_1d) return array1d[ind_1d];
+    if (ind_2d) return array_2d()[ind_2d][ind_1d];
+    if (ind_1d) return array_1d()[ind_1d];
     return *this;
   }
 
@@ -646,11 +783,11 @@ struct var : variant {
 
   const variant& operator[] (int ind) const {
     if (!ind) return *this;
-    return array1d[ind];
+    return array_1d()[ind];
   }
   const variant& operator() (int ind_2d,int ind_1d) const {
-    if (ind_2d) return array2d[ind_2d][ind_1d];
-    if (ind_1d) return array1d[ind_1d];
+    if (ind_2d) return array_2d()[ind_2d][ind_1d];
+    if (ind_1d) return array_1d()[ind_1d];
     return *this;
   }
 
@@ -658,26 +795,38 @@ struct var : variant {
   // ===========================================================================
 
   // Calculate array lengths.
-  int array_len() const { return array1d.max_index(); }
-  int array_height() const { return array2d.max_index(); }
+  int array_len() const { return array_1d().max_index(); }
+  int array_height() const { return array_2d().max_index(); }
   int array_len(int row) const {
-    if (row) return array2d[row].max_index();
-    return array1d.max_index();
+    if (row) return array_2d()[row].max_index();
+    return array_1d().max_index();
   }
 
-  size_t dense_length() {
-    return array1d.dense_length();
+  size_t dense_length() const {
+    return array_1d().dense_length();
+  }
+
+  // Makes room for writing a length by height array without reallocating
+  // or falling back on the sparse part of either table. Rows which already
+  // exist are reserved too; lengths are unchanged.
+  void array_reserve(size_t length, size_t height = 1) {
+    array_1d().reserve(length);
+    if (height <= 1) return;
+    lua_table<lua_table<variant>> &rows = array_2d();
+    rows.reserve(height);
+    const size_t existing = rows.max_index();
+    for (size_t i = 1; i < existing && i < height; ++i) rows[i].reserve(length);
   }
 
   const std::vector<variant> &dense_array_1d() {
-    *array1d = *this;
-    return array1d.dense_part();
+    *array_1d() = *this;
+    return array_1d().dense_part();
   }
 
   template<typename T>
   std::vector<T> to_vector() const {
-    return {array1d.dense_part().begin(),
-            array1d.dense_part().end()};
+    return {array_1d().dense_part().begin(),
+            array_1d().dense_part().end()};
   }
 
   // Annoying overhead and var extensions of variant operators
@@ -704,6 +853,10 @@ struct var : variant {
     *(variant*) this = v;
     return *this;
   }
+  var &operator=(var rvalue_ref v) {
+    *(variant*) this = std::move(v);
+    return *this;
+  }
 
   template<typename T, REQUIRE_VARIANT_TYPE(T)>
   variant operator+(const T &v) {
@@ -711,7 +864,11 @@ struct var : variant {
   }
   #endif
 
+#if defined(ENIGMA_COMPACT_VARIANT) && !defined(JUST_DEFINE_IT_RUN)
+  ~var() { delete arrays; }
+#else
   ~var() {}
+#endif
 };
 
 
@@ -48,6 +48,7 @@ int array_length_1d(const var& v) { return v.array_len(); }
 int array_length_2d(const var& v, int n) { return v.array_len(n); }
 int array_height_2d(const var& v) { return v.array_height(); }
 void array_set(var& v, int pos, variant value) { v[pos] = value; }
+void array_reserve(var& v, size_t length, size_t height) { v.array_reserve(length, height); }
 bool is_array(const var& v) {
   //There is no way (currently) to downsize an array from >1 element, so this might not be accurate.
   return (v.array_height() > 1) || (v.array_len() > 1);
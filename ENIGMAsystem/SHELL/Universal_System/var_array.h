@@ -39,6 +39,9 @@ int array_length_1d(const var& v);
 int array_length_2d(const var& v, int n);
 int array_height_2d(const var& v);
 void array_set(var& v, int pos, variant value);
+// Makes room for a length by height array in v, so that filling it in any
+// order doesn't reallocate. Doesn't change the array's length or height.
+void array_reserve(var& v, size_t length, size_t height=1);
 bool is_array(const var& v);
 }  //namespace enigma_user
 
@@ -0,0 +1,109 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "worker_pool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace enigma {
+
+namespace {
+
+// Jobs are taken from a shared counter by the pool and the calling thread
+// alike until none are left.
+class worker_pool {
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable wake, done;
+  unsigned generation = 0, busy = 0;
+  bool stopping = false;
+
+  const std::function<void(size_t)> *job = nullptr;
+  size_t job_count = 0;
+  std::atomic<size_t> next_job{0};
+
+  void run_jobs() {
+    for (size_t i; (i = next_job++) < job_count; ) (*job)(i);
+  }
+
+  void work() {
+    unsigned seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      wake.wait(lock, [&]() { return stopping || generation != seen; });
+      if (stopping) return;
+      seen = generation;
+      lock.unlock();
+      run_jobs();
+      lock.lock();
+      if (!--busy) done.notify_one();
+    }
+  }
+
+ public:
+  std::atomic<bool> running{false};
+
+  void run(size_t count, const std::function<void(size_t)> &jobs) {
+    job = &jobs;
+    job_count = count;
+    next_job = 0;
+    if (count > 1 && threads.empty()) {
+      const unsigned cores = std::thread::hardware_concurrency();
+      for (unsigned i = 1; i < cores; i++) threads.emplace_back(&worker_pool::work, this);
+    }
+    if (count <= 1 || threads.empty()) {
+      run_jobs();
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      busy = threads.size();
+      generation++;
+    }
+    wake.notify_all();
+    run_jobs();
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return !busy; });
+  }
+
+  ~worker_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads) thread.join();
+  }
+} pool;
+
+}  // namespace
+
+void run_parallel_jobs(size_t count, const std::function<void(size_t)>& job) {
+  if (pool.running.exchange(true)) {
+    for (size_t i = 0; i < count; i++) job(i);
+    return;
+  }
+  pool.run(count, job);
+  pool.running = false;
+}
+
+}  // namespace enigma
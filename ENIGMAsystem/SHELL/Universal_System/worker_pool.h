@@ -0,0 +1,38 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+// Worker pool. One thread per core, less the calling thread, started the first
+// time there is more than one job and kept asleep between calls, so code which
+// splits up work every frame doesn't pay to start threads every frame.
+
+#ifndef ENIGMA_WORKER_POOL_H
+#define ENIGMA_WORKER_POOL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace enigma {
+
+// Calls job(0) through job(count - 1) across the pool and the calling thread,
+// and waits for them all. Jobs are handed out in order but finish in any order.
+// A call made while the pool is busy, as from inside a job, runs its jobs on
+// the calling thread alone.
+void run_parallel_jobs(size_t count, const std::function<void(size_t)>& job);
+
+}  // namespace enigma
+
+#endif  // ENIGMA_WORKER_POOL_H
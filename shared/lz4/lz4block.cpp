@@ -0,0 +1,155 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "lz4block.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace enigma {
+
+namespace lz4 {
+
+namespace {
+// Matches are at least this long, must start this far before the end and
+// leave the last bytes as literals, as the format requires.
+const size_t kMinMatch = 4, kMatchLimit = 12, kLastLiterals = 5;
+const size_t kMaxOffset = 65535;
+const int kHashLog = 16;
+
+inline uint32_t read32(const unsigned char* p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+inline uint32_t hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashLog);
+}
+
+unsigned char* write_length(unsigned char* op, size_t length) {
+  for (; length >= 255; length -= 255) *op++ = 255;
+  *op++ = (unsigned char) length;
+  return op;
+}
+
+// Writes the literals and then the match, if it has one; the last sequence does not.
+unsigned char* write_sequence(unsigned char* op, const unsigned char* literals, size_t literal_count,
+                              size_t offset, size_t match_length) {
+  unsigned char* token = op++;
+  *token = (literal_count < 15 ? literal_count : 15) << 4;
+  if (literal_count >= 15) op = write_length(op, literal_count - 15);
+  memcpy(op, literals, literal_count);
+  op += literal_count;
+  if (!match_length) return op;
+
+  *op++ = offset & 0xFF;
+  *op++ = offset >> 8;
+  match_length -= kMinMatch;
+  *token |= match_length < 15 ? match_length : 15;
+  if (match_length >= 15) op = write_length(op, match_length - 15);
+  return op;
+}
+
+bool read_length(const unsigned char*& ip, const unsigned char* end, size_t& length) {
+  unsigned char byte;
+  do {
+    if (ip >= end) return false;
+    byte = *ip++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+}
+
+size_t compress_bound(size_t size) {
+  return size + size / 255 + 16;
+}
+
+size_t compress(const unsigned char* src, size_t size, unsigned char* dst) {
+  const unsigned char *ip = src, *anchor = src, *const end = src + size;
+  unsigned char* op = dst;
+
+  if (size > kMatchLimit) {
+    std::vector<uint32_t> table(1 << kHashLog, 0);
+    const unsigned char* const limit = end - kMatchLimit;
+    const unsigned char* const match_end = end - kLastLiterals;
+    while (ip < limit) {
+      const uint32_t sequence = read32(ip);
+      uint32_t& entry = table[hash(sequence)];
+      const unsigned char* ref = src + entry;
+      entry = uint32_t(ip - src);
+      if (ref >= ip || size_t(ip - ref) > kMaxOffset || read32(ref) != sequence) {
+        ++ip;
+        continue;
+      }
+
+      const unsigned char *mp = ip + kMinMatch, *rp = ref + kMinMatch;
+      while (mp < match_end && *mp == *rp) ++mp, ++rp;
+      while (ip > anchor && ref > src && ip[-1] == ref[-1]) --ip, --ref;
+      op = write_sequence(op, anchor, ip - anchor, ip - ref, mp - ip);
+      ip = anchor = mp;
+    }
+  }
+
+  op = write_sequence(op, anchor, end - anchor, 0, 0);
+  return op - dst;
+}
+
+long decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity) {
+  const unsigned char *ip = src, *const end = src + size;
+  unsigned char *op = dst, *const out_end = dst + capacity;
+
+  while (ip < end) {
+    const unsigned token = *ip++;
+    size_t length = token >> 4;
+    if (length == 15 && !read_length(ip, end, length)) return -1;
+    if (size_t(end - ip) < length || size_t(out_end - op) < length) return -1;
+    memcpy(op, ip, length);
+    op += length;
+    ip += length;
+    if (ip == end) break;
+
+    if (end - ip < 2) return -1;
+    const size_t offset = ip[0] | ip[1] << 8;
+    ip += 2;
+    if (!offset || offset > size_t(op - dst)) return -1;
+    length = token & 15;
+    if (length == 15 && !read_length(ip, end, length)) return -1;
+    length += kMinMatch;
+    if (size_t(out_end - op) < length) return -1;
+
+    // A match may overlap what it writes; copy the repeating part in spans
+    // that double each time so none of them overlap.
+    const unsigned char* const match = op - offset;
+    size_t span = offset;
+    while (length > span) {
+      memcpy(op, match, span);
+      op += span;
+      length -= span;
+      span *= 2;
+    }
+    memcpy(op, match, length);
+    op += length;
+  }
+  return op - dst;
+}
+
+}  //namespace lz4
+
+}  //namespace enigma
@@ -0,0 +1,43 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_LZ4_BLOCK_H
+#define ENIGMA_LZ4_BLOCK_H
+
+#include <cstddef>
+
+// Compression in the LZ4 block format: a run of sequences, each a token, some
+// literal bytes and a back reference. It packs images a little worse than zlib
+// but unpacks them several times faster, which is what the game pays for.
+namespace enigma {
+
+namespace lz4 {
+// The most bytes compressing size bytes can take.
+size_t compress_bound(size_t size);
+
+// Compresses size bytes into dst, which must hold compress_bound(size) bytes.
+// Returns the compressed size.
+size_t compress(const unsigned char* src, size_t size, unsigned char* dst);
+
+// Decompresses into dst, writing at most capacity bytes. Returns the number of
+// bytes written, or -1 if the data is malformed or would overrun dst.
+long decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity);
+}  //namespace lz4
+
+}  //namespace enigma
+
+#endif  //ENIGMA_LZ4_BLOCK_H
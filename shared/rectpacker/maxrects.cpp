@@ -0,0 +1,95 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "maxrects.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace enigma {
+
+namespace rect_packer {
+
+namespace {
+bool intersects(const Rect<int>& a, const Rect<int>& b) {
+  return a.x < b.right() && b.x < a.right() && a.y < b.bottom() && b.y < a.bottom();
+}
+
+bool contains(const Rect<int>& outer, const Rect<int>& inner) {
+  return inner.x >= outer.x && inner.y >= outer.y && inner.right() <= outer.right() && inner.bottom() <= outer.bottom();
+}
+}
+
+MaxRectsBin::MaxRectsBin(int width, int height): width_(width), height_(height) {
+  free_.push_back(Rect<int>(0, 0, width, height));
+}
+
+bool MaxRectsBin::insert(int w, int h, Rect<int>* placed) {
+  const Rect<int>* best = nullptr;
+  int best_short = INT_MAX, best_long = INT_MAX;
+  for (const Rect<int>& f : free_) {
+    if (f.w < w || f.h < h) continue;
+    const int short_side = std::min(f.w - w, f.h - h), long_side = std::max(f.w - w, f.h - h);
+    if (short_side < best_short || (short_side == best_short && long_side < best_long)) {
+      best = &f;
+      best_short = short_side, best_long = long_side;
+    }
+  }
+  if (!best) return false;
+
+  *placed = Rect<int>(best->x, best->y, w, h);
+  split_free(*placed);
+  prune_free();
+  used_width_ = std::max(used_width_, placed->right());
+  used_height_ = std::max(used_height_, placed->bottom());
+  return true;
+}
+
+// Replaces each free rectangle the used one overlaps with the (up to four)
+// maximal rectangles left around it.
+void MaxRectsBin::split_free(const Rect<int>& used) {
+  std::vector<Rect<int>> result;
+  result.reserve(free_.size() + 4);
+  for (const Rect<int>& f : free_) {
+    if (!intersects(f, used)) {
+      result.push_back(f);
+      continue;
+    }
+    if (used.x > f.x) result.push_back(Rect<int>(f.x, f.y, used.x - f.x, f.h));
+    if (used.right() < f.right()) result.push_back(Rect<int>(used.right(), f.y, f.right() - used.right(), f.h));
+    if (used.y > f.y) result.push_back(Rect<int>(f.x, f.y, f.w, used.y - f.y));
+    if (used.bottom() < f.bottom()) result.push_back(Rect<int>(f.x, used.bottom(), f.w, f.bottom() - used.bottom()));
+  }
+  free_.swap(result);
+}
+
+// Drops the free rectangles that lie within another.
+void MaxRectsBin::prune_free() {
+  for (size_t i = 0; i < free_.size(); ++i) {
+    for (size_t j = i + 1; j < free_.size(); ++j) {
+      if (contains(free_[j], free_[i])) {
+        free_.erase(free_.begin() + i--);
+        break;
+      }
+      if (contains(free_[i], free_[j])) free_.erase(free_.begin() + j--);
+    }
+  }
+}
+
+}  //namespace rect_packer
+
+}  //namespace enigma
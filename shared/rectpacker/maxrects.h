@@ -0,0 +1,55 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_MAXRECTS_H
+#define ENIGMA_MAXRECTS_H
+
+#include "rect.h"
+
+#include <vector>
+
+namespace enigma {
+
+namespace rect_packer {
+// Packs rectangles into a fixed-size bin with the MaxRects method: the bin
+// keeps every maximal free rectangle, and each rectangle goes where it leaves
+// the shortest side over (best short side fit). This wastes far less space
+// than the binary tree of rninsert, at the cost of slower inserts.
+class MaxRectsBin {
+ public:
+  MaxRectsBin(int width, int height);
+
+  // Places a w by h rectangle and sets where; false if it does not fit.
+  bool insert(int w, int h, Rect<int>* placed);
+
+  // The extent of the rectangles placed so far.
+  int used_width() const { return used_width_; }
+  int used_height() const { return used_height_; }
+
+ private:
+  void split_free(const Rect<int>& used);
+  void prune_free();
+
+  int width_, height_;
+  int used_width_ = 0, used_height_ = 0;
+  std::vector<Rect<int>> free_;
+};
+}  //namespace rect_packer
+
+}  //namespace enigma
+
+#endif  //ENIGMA_MAXRECTS_H
@@ -0,0 +1,65 @@
+/** Copyright (C) 2024 ENIGMA Team
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_RESOURCE_FORMAT_H
+#define ENIGMA_RESOURCE_FORMAT_H
+
+// Layout of the resource data the compiler appends to a game, shared by the
+// compiler that writes it and the engine that reads it. All fields are 32-bit
+// little-endian integers.
+//
+// The data is a run of sections ("TXP ", "SPR ", "SND ", "BKG ", "FNT ", "PTH ")
+// that hold one record per asset, followed by an "IDX " section, the index. It ends
+// with a 12-byte trailer: the offset of the index from the start of the data,
+// the magic number "res0", and the offset of the start of the data in the file.
+//
+// Each sprite and background record gives the codec its images are packed
+// with, ahead of them. "TXP " holds the texture pages: their number, then for
+// each its width, height, codec, packed size and pixels. Sprite subimages and
+// backgrounds start with the page they are on and their position on it, or -1
+// and their own pixels.
+//
+// The index holds its flags and the number of entries, then for each the kind
+// of asset (the magic number of its section), its id, the offset of its record
+// from the start of the data, the size of the record and the codec of its
+// image or sound data. After that come the rooms: their number, then for each
+// its id, the number of assets its instances and tiles use, and the kind and
+// id of each.
+namespace enigma {
+namespace resource_format {
+
+enum IndexFlags : int {
+  // The game loads sprites and backgrounds when first used, not at startup.
+  INDEX_LAZY = 1
+};
+
+enum Codec : int {
+  CODEC_RAW = 0,
+  CODEC_ZLIB = 1,
+  // shared/lz4: larger than zlib, but much quicker to unpack.
+  CODEC_LZ4 = 2
+};
+
+// The magic number of a section, as an int read from the data.
+constexpr int kind(const char (&magic)[5]) {
+  return magic[0] | magic[1] << 8 | magic[2] << 16 | magic[3] << 24;
+}
+
+}  // namespace resource_format
+}  // namespace enigma
+
+#endif  // ENIGMA_RESOURCE_FORMAT_H
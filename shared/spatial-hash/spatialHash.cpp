@@ -1,156 +1,336 @@
-#include <algorithm>
+#include <cstdio>
 #include "spatialHash.h"
 
-// Methods
-void SpatialHash::copy(const SpatialHash& obj)
-{
-	cellSize = obj.cellSize;
-	sceneWidth = obj.sceneWidth;
-	sceneHeight = obj.sceneHeight;
-	numCells = obj.numCells;
-	hashmap = obj.hashmap;
-}
-
 // Constructors
 SpatialHash::SpatialHash()
 {
-	cellSize = 0;
-	sceneWidth = 0;
-	sceneHeight = 0;
-	numCells = 0;
-}
-
-SpatialHash::SpatialHash(const SpatialHash& obj)
-{
-	if (&obj != nullptr)
-		copy(obj);
+	maxCellsPerObject = 64;
+	count = 0;
+	queryStamp = 0;
+	freeNodes = -1;
+	resize(64, 0, 0);
 }
 
 SpatialHash::SpatialHash(int c, int w, int h)
 {
-	cellSize = c;
-	sceneWidth = w;
-	sceneHeight = h;
-	rows = sceneHeight / cellSize;
-	cols = sceneWidth / cellSize;
-	numCells = rows * cols;
+	maxCellsPerObject = 64;
+	count = 0;
+	queryStamp = 0;
+	freeNodes = -1;
+	resize(c, w, h);
 }
 
 // Getters and Setters
-int SpatialHash::getCellSize()
+int SpatialHash::getCellSize() const
 {
 	return cellSize;
 }
 
-int SpatialHash::getSceneWidth()
+int SpatialHash::getSceneWidth() const
 {
 	return sceneWidth;
 }
 
-int SpatialHash::getSceneHeight()
+int SpatialHash::getSceneHeight() const
 {
 	return sceneHeight;
 }
 
-int SpatialHash::getNumCells()
+int SpatialHash::getNumCells() const
 {
 	return numCells;
 }
 
-int SpatialHash::getColumns()
+int SpatialHash::getColumns() const
 {
 	return cols;
 }
 
-int SpatialHash::getRows()
+int SpatialHash::getRows() const
 {
 	return rows;
 }
 
+int SpatialHash::getCount() const
+{
+	return count;
+}
+
+void SpatialHash::setMaxCellsPerObject(int n)
+{
+	if (n < 1) n = 1;
+	if (n == maxCellsPerObject) return;
+	maxCellsPerObject = n;
+	resize(cellSize, sceneWidth, sceneHeight);
+}
+
+void SpatialHash::resize(int c, int w, int h)
+{
+	cellSize = c > 0 ? c : 1;
+	sceneWidth = w > 0 ? w : 0;
+	sceneHeight = h > 0 ? h : 0;
+	cols = sceneWidth / cellSize + (sceneWidth % cellSize != 0);
+	rows = sceneHeight / cellSize + (sceneHeight % cellSize != 0);
+	if (cols < 1) cols = 1;
+	if (rows < 1) rows = 1;
+	numCells = rows * cols;
+
+	// Vectors keep their capacity, so resizing to a room no larger than one
+	// seen before does not allocate.
+	cells.assign(numCells, -1);
+	nodes.clear();
+	freeNodes = -1;
+	oversized.clear();
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		records[i].firstNode = -1;
+		records[i].oversizedPos = -1;
+		if (records[i].registered)
+			link(i);
+	}
+}
+
+void SpatialHash::clear()
+{
+	cells.assign(numCells, -1);
+	nodes.clear();
+	freeNodes = -1;
+	oversized.clear();
+	records.clear();
+	count = 0;
+}
+
 // Utility functions
 void SpatialHash::print()
 {
-
+	printf("SpatialHash: %d x %d cells of %dpx over %d x %d, %d objects (%d oversized)\n",
+	       cols, rows, cellSize, sceneWidth, sceneHeight, count, (int)oversized.size());
+	for (int i = 0; i < numCells; ++i)
+	{
+		int n = 0;
+		for (int node = cells[i]; node != -1; node = nodes[node].next)
+			++n;
+		if (n)
+			printf("  cell (%d, %d): %d\n", i % cols, i / cols, n);
+	}
 }
 
 // Hashing Functions
-int SpatialHash::computeHash(int x, int y)
+void SpatialHash::cellRange(const BBOX& bbox, int& cx1, int& cy1, int& cx2, int& cy2) const
+{
+	cx1 = bbox.x1 < 0 ? 0 : bbox.x1 / cellSize;
+	cy1 = bbox.y1 < 0 ? 0 : bbox.y1 / cellSize;
+	cx2 = bbox.x2 < 0 ? 0 : bbox.x2 / cellSize;
+	cy2 = bbox.y2 < 0 ? 0 : bbox.y2 / cellSize;
+	if (cx1 >= cols) cx1 = cols - 1;
+	if (cx2 >= cols) cx2 = cols - 1;
+	if (cy1 >= rows) cy1 = rows - 1;
+	if (cy2 >= rows) cy2 = rows - 1;
+}
+
+int SpatialHash::computeHash(int x, int y) const
 {
-	return (x / cellSize) + ((y / cellSize) * cols);
+	int cx, cy;
+	const BBOX point = { x, y, x, y };
+	cellRange(point, cx, cy, cx, cy);
+	return cx + cy * cols;
 }
 
-std::vector<int>& SpatialHash::computeBuckets(BBOX bbox)
+int SpatialHash::allocNode()
 {
-	std::vector<int> buckets;
-	int minHash = computeHash(bbox.x1, bbox.y1);
-	int maxHash = computeHash(bbox.x2, bbox.y2);
-	for (int i = minHash; i <= maxHash; ++i)
+	if (freeNodes == -1)
 	{
-		buckets.push_back(i);
+		nodes.push_back(Node());
+		return nodes.size() - 1;
 	}
-	return buckets;
+	const int node = freeNodes;
+	freeNodes = nodes[node].next;
+	return node;
+}
+
+void SpatialHash::link(int obj_id)
+{
+	Record& rec = records[obj_id];
+	cellRange(rec.bbox, rec.cx1, rec.cy1, rec.cx2, rec.cy2);
+	if ((rec.cx2 - rec.cx1 + 1) * (rec.cy2 - rec.cy1 + 1) > maxCellsPerObject)
+	{
+		rec.oversizedPos = oversized.size();
+		oversized.push_back(obj_id);
+		return;
+	}
+
+	int first = -1;
+	for (int cy = rec.cy1; cy <= rec.cy2; ++cy)
+	{
+		for (int cx = rec.cx1; cx <= rec.cx2; ++cx)
+		{
+			const int cell = cx + cy * cols;
+			const int node = allocNode();
+			Node& n = nodes[node];
+			n.obj = obj_id;
+			n.cell = cell;
+			n.prev = -1;
+			n.next = cells[cell];
+			n.sibling = first;
+			if (n.next != -1)
+				nodes[n.next].prev = node;
+			cells[cell] = node;
+			first = node;
+		}
+	}
+	records[obj_id].firstNode = first;
+}
+
+void SpatialHash::unlink(int obj_id)
+{
+	Record& rec = records[obj_id];
+	if (rec.oversizedPos != -1)
+	{
+		const int moved = oversized.back();
+		oversized[rec.oversizedPos] = moved;
+		records[moved].oversizedPos = rec.oversizedPos;
+		oversized.pop_back();
+		rec.oversizedPos = -1;
+		return;
+	}
+
+	for (int node = rec.firstNode; node != -1; )
+	{
+		Node& n = nodes[node];
+		if (n.prev != -1)
+			nodes[n.prev].next = n.next;
+		else
+			cells[n.cell] = n.next;
+		if (n.next != -1)
+			nodes[n.next].prev = n.prev;
+
+		const int sibling = n.sibling;
+		n.next = freeNodes;
+		freeNodes = node;
+		node = sibling;
+	}
+	rec.firstNode = -1;
 }
 
 void SpatialHash::registerObject(int obj_id, int x, int y)
 {
-	hashmap[computeHash(x, y)].push_back(obj_id);
+	const BBOX point = { x, y, x, y };
+	registerObject(obj_id, point);
 }
 
 void SpatialHash::registerObject(int obj_id, BBOX bbox)
 {
-	std::vector<int> buckets = computeBuckets(bbox);
-	std::vector<int>::iterator it;
-	for (it = buckets.begin(); it != buckets.end(); ++it)
+	if (obj_id < 0) return;
+	if ((size_t)obj_id >= records.size())
+	{
+		Record blank = {};
+		blank.firstNode = blank.oversizedPos = -1;
+		records.resize(obj_id + 1, blank);
+	}
+	if (records[obj_id].registered)
 	{
-		hashmap[*it].push_back(obj_id);
+		updateHash(obj_id, bbox);
+		return;
 	}
+
+	Record& rec = records[obj_id];
+	rec.bbox = bbox;
+	rec.registered = true;
+	rec.stamp = 0;
+	++count;
+	link(obj_id);
 }
 
-std::vector<int> SpatialHash::getNearby(int obj_id, int x, int y)
+bool SpatialHash::updateHash(int obj_id, int x, int y)
 {
-	return hashmap[computeHash(x, y)];
+	const BBOX point = { x, y, x, y };
+	return updateHash(obj_id, point);
 }
 
-std::vector<int> SpatialHash::getNearby(int obj_id, BBOX bbox)
+bool SpatialHash::updateHash(int obj_id, BBOX bbox)
 {
-	std::vector<int> buckets;
-	int minHash = computeHash(bbox.x1, bbox.y1);
-	int maxHash = computeHash(bbox.x2, bbox.y2);
-	for (int i = minHash; i <= maxHash; ++i)
+	if (!contains(obj_id))
 	{
-		buckets.insert(buckets.end(), hashmap[i].begin(), hashmap[i].end());
+		registerObject(obj_id, bbox);
+		return true;
 	}
-	return buckets;
+
+	Record& rec = records[obj_id];
+	int cx1, cy1, cx2, cy2;
+	cellRange(bbox, cx1, cy1, cx2, cy2);
+	rec.bbox = bbox;
+	if (cx1 == rec.cx1 && cy1 == rec.cy1 && cx2 == rec.cx2 && cy2 == rec.cy2)
+		return false;
+
+	unlink(obj_id);
+	link(obj_id);
+	return true;
+}
+
+void SpatialHash::removeObject(int obj_id)
+{
+	if (!contains(obj_id)) return;
+	unlink(obj_id);
+	records[obj_id].registered = false;
+	--count;
+}
+
+bool SpatialHash::contains(int obj_id) const
+{
+	return obj_id >= 0 && (size_t)obj_id < records.size() && records[obj_id].registered;
 }
 
-void SpatialHash::removeObject(int obj_id, int x, int y)
+const BBOX& SpatialHash::getBBox(int obj_id) const
 {
-	int hash = computeHash(x, y);
-	std::vector<int>::iterator position = std::find(hashmap[hash].begin(), hashmap[hash].end(), obj_id);
-	if (position != hashmap[hash].end())
-		hashmap[hash].erase(position);
+	return records[obj_id].bbox;
 }
 
-void SpatialHash::removeObject(int obj_id, BBOX bbox)
+void SpatialHash::nextStamp()
 {
-	int minHash = computeHash(bbox.x1, bbox.y1);
-	int maxHash = computeHash(bbox.x1, bbox.y1);
-	for (int i = minHash; i <= maxHash; ++i)
+	if (++queryStamp == 0)
 	{
-		std::vector<int>::iterator position = std::find(hashmap[i].begin(), hashmap[i].end(), obj_id);
-		if (position != hashmap[i].end())
-			hashmap[i].erase(position);
+		// Wrapped around; forget the old stamps.
+		for (size_t i = 0; i < records.size(); ++i)
+			records[i].stamp = 0;
+		queryStamp = 1;
 	}
 }
 
-void SpatialHash::updateHash(int obj_id, int x_prev, int y_prev, int x_new, int y_new)
+inline void SpatialHash::visit(int obj_id, const BBOX& bbox, std::vector<int>& out)
 {
-	removeObject(obj_id, x_prev, y_prev);
-	registerObject(obj_id, x_new, y_new);
+	Record& rec = records[obj_id];
+	if (rec.stamp == queryStamp) return;
+	rec.stamp = queryStamp;
+	if (rec.bbox.x1 <= bbox.x2 && bbox.x1 <= rec.bbox.x2 && rec.bbox.y1 <= bbox.y2 && bbox.y1 <= rec.bbox.y2)
+		out.push_back(obj_id);
 }
 
-void SpatialHash::updateHash(int obj_id, BBOX bbox_prev, BBOX bbox_new)
+void SpatialHash::getNearby(int x, int y, std::vector<int>& out)
 {
-	removeObject(obj_id, bbox_prev);
-	registerObject(obj_id, bbox_new);
-}
\ No newline at end of file
+	const BBOX point = { x, y, x, y };
+	getNearby(point, out);
+}
+
+void SpatialHash::getNearby(BBOX bbox, std::vector<int>& out)
+{
+	if (bbox.x1 > bbox.x2 || bbox.y1 > bbox.y2 || !count) return;
+	nextStamp();
+
+	int cx1, cy1, cx2, cy2;
+	cellRange(bbox, cx1, cy1, cx2, cy2);
+	if ((cx2 - cx1 + 1) * (cy2 - cy1 + 1) > count)
+	{
+		// Walking the cells would cost more than walking the objects.
+		for (size_t i = 0; i < records.size(); ++i)
+			if (records[i].registered)
+				visit(i, bbox, out);
+		return;
+	}
+
+	for (int cy = cy1; cy <= cy2; ++cy)
+		for (int cx = cx1; cx <= cx2; ++cx)
+			for (int node = cells[cx + cy * cols]; node != -1; node = nodes[node].next)
+				visit(nodes[node].obj, bbox, out);
+	for (size_t i = 0; i < oversized.size(); ++i)
+		visit(oversized[i], bbox, out);
+}
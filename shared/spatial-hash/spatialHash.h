@@ -2,17 +2,43 @@
 #ifndef SPATIAL_HASH_H
 #define SPATIAL_HASH_H
 
-#include <unordered_map>
 #include <vector>
 
+// Inclusive bounding box, x1 <= x2 and y1 <= y2.
 struct BBOX
 {
 	int x1, y1, x2, y2;
 };
 
+// A uniform grid of cells covering a scene, usually the room.
+// Objects are identified by small non-negative ids, such as slots in a table,
+// and are kept in every cell their bounding box overlaps. Coordinates outside
+// the scene are clamped to the border cells, so objects outside it are still
+// found, just with less pruning.
+// Cells are intrusive lists over a pool of nodes; once the pool and the
+// record table have grown to fit, nothing here allocates.
 class SpatialHash
 {
 	private:
+		struct Node
+		{
+			int obj;     // Object in this cell
+			int cell;    // Cell this node is linked into
+			int prev;    // Previous node in the cell, or -1 for its head
+			int next;    // Next node in the cell, or -1; the free list when unused
+			int sibling; // Next node of the same object, or -1
+		};
+
+		struct Record
+		{
+			BBOX bbox;
+			int cx1, cy1, cx2, cy2; // Cell range of bbox
+			int firstNode;          // Nodes of this object, or -1 if it is oversized
+			int oversizedPos;       // Position in oversized, or -1
+			unsigned stamp;         // Last query which visited this object
+			bool registered;
+		};
+
 		// Attributes
 		int cellSize;
 		int sceneWidth;
@@ -20,43 +46,70 @@ class SpatialHash
 		int rows;
 		int cols;
 		int numCells;
-		std::unordered_map<int, std::vector<int>> hashmap;
+		int maxCellsPerObject;
+		int count;
+		unsigned queryStamp;
+
+		std::vector<int> cells; // Head node of each cell, or -1
+		std::vector<Node> nodes;
+		int freeNodes;
+		std::vector<Record> records; // Indexed by object id
+		std::vector<int> oversized;  // Objects spanning more than maxCellsPerObject cells
 
 		// Methods
-		void copy(const SpatialHash& obj);
+		void cellRange(const BBOX& bbox, int& cx1, int& cy1, int& cx2, int& cy2) const;
+		void link(int obj_id);
+		void unlink(int obj_id);
+		int allocNode();
+		void nextStamp();
+		void visit(int obj_id, const BBOX& bbox, std::vector<int>& out);
 
 	public:
 		// Constructors
 		SpatialHash();
-		SpatialHash(const SpatialHash& obj);
 		SpatialHash(int c, int w, int h);
 
 		// Getters and Setters
-		int getCellSize();
-		int getSceneWidth();
-		int getSceneHeight();
-		int getNumCells();
-		int getColumns();
-		int getRows();
+		int getCellSize() const;
+		int getSceneWidth() const;
+		int getSceneHeight() const;
+		int getNumCells() const;
+		int getColumns() const;
+		int getRows() const;
+		int getCount() const;
+
+		// Objects spanning more cells than this are kept in a single list
+		// tested by every query instead.
+		void setMaxCellsPerObject(int n);
+
+		// Changes the cell and scene size, rehashing the registered objects.
+		void resize(int c, int w, int h);
+		// Removes every object.
+		void clear();
 
 		// Utility functions
 		void print();
 
 		// Hashing functions
-		int computeHash(int x, int y);
-		std::vector<int>& computeBuckets(BBOX bbox);
+		int computeHash(int x, int y) const;
 
 		void registerObject(int obj_id, int x, int y);
 		void registerObject(int obj_id, BBOX bbox);
 
-		std::vector<int> getNearby(int obj_id, int x, int y);
-		std::vector<int> getNearby(int obj_id, BBOX bbox);
+		// Moves an object to its new box. Returns whether it changed cells;
+		// if not, only the stored box is updated.
+		bool updateHash(int obj_id, int x, int y);
+		bool updateHash(int obj_id, BBOX bbox);
+
+		void removeObject(int obj_id);
 
-		void removeObject(int obj_id, int x, int y);
-		void removeObject(int obj_id, BBOX bbox);
+		bool contains(int obj_id) const;
+		const BBOX& getBBox(int obj_id) const;
 
-		void updateHash(int obj_id, int x_prev, int y_prev, int x_new, int y_new);
-		void updateHash(int obj_id, BBOX bbox_prev, BBOX bbox_new);
+		// Appends the ids of the objects whose box overlaps the given point or
+		// box to out, each once, in no particular order.
+		void getNearby(int x, int y, std::vector<int>& out);
+		void getNearby(BBOX bbox, std::vector<int>& out);
 };
 
 #endif // !SPATIAL_HASH_H